@@ -0,0 +1,173 @@
+/*
+ * Per-algorithm op descriptors.
+ *
+ * Every NEA/NIA algorithm gets its own session setup, op fill and completion routine, generated from the
+ * algorithm lists in algo.h with all algorithm specific choices (cipher or hash, IV or AAD, AAD length) fixed
+ * at compile time. The descriptor is looked up once per session, after which ops go straight through the
+ * function pointers without testing op type or algorithm again.
+ */
+
+#include <string.h>
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+
+#include "algo.h"
+#include "utils.h"
+
+#define DEFINE_NEA_PATH(name, Name, cipherAlgo)                                                            \
+    static void name##SetupSession(const TestData *testData, CpaCySymSessionSetupData *sessionSetupData)  \
+    {                                                                                                      \
+        sessionSetupData->symOperation = CPA_CY_SYM_OP_CIPHER;                                             \
+        sessionSetupData->cipherSetupData.cipherAlgorithm = CPA_CY_SYM_CIPHER_##cipherAlgo;                \
+        sessionSetupData->cipherSetupData.pCipherKey = testData->key;                                      \
+        sessionSetupData->cipherSetupData.cipherKeyLenInBytes = testData->keySize;                         \
+        sessionSetupData->cipherSetupData.cipherDirection = getCipherDirection(testData);                  \
+    }                                                                                                      \
+                                                                                                           \
+    static void name##FillOpData(const OpDesc *opDesc,                                                     \
+                                 CpaCySymSessionCtx sessionCtx,                                            \
+                                 Cpa8U *ivBuffer,                                                          \
+                                 Cpa8U *digestBuffer,                                                      \
+                                 CpaCySymOpData *opData)                                                   \
+    {                                                                                                      \
+        opData->sessionCtx = sessionCtx;                                                                   \
+        opData->packetType = CPA_CY_SYM_PACKET_TYPE_FULL;                                                  \
+        opData->pIv = ivBuffer;                                                                            \
+        opData->ivLenInBytes = opDesc->ivSize;                                                             \
+        opData->cryptoStartSrcOffsetInBytes = 0;                                                           \
+        opData->messageLenToCipherInBytes = opDesc->inSize;                                                \
+        opData->pAdditionalAuthData = NULL;                                                                \
+    }
+
+#define DEFINE_NIA_PATH(name, Name, hashAlgo, aadLen)                                                      \
+    static void name##SetupSession(const TestData *testData, CpaCySymSessionSetupData *sessionSetupData)  \
+    {                                                                                                      \
+        sessionSetupData->symOperation = CPA_CY_SYM_OP_HASH;                                               \
+        sessionSetupData->hashSetupData.hashAlgorithm = CPA_CY_SYM_HASH_##hashAlgo;                        \
+        sessionSetupData->hashSetupData.hashMode = CPA_CY_SYM_HASH_MODE_AUTH;                              \
+        sessionSetupData->hashSetupData.digestResultLenInBytes = testData->outSize;                        \
+        sessionSetupData->hashSetupData.authModeSetupData.authKey = testData->key;                         \
+        sessionSetupData->hashSetupData.authModeSetupData.authKeyLenInBytes = testData->keySize;           \
+        sessionSetupData->hashSetupData.authModeSetupData.aadLenInBytes = (aadLen);                        \
+        sessionSetupData->digestIsAppended = CPA_FALSE;                                                    \
+        sessionSetupData->verifyDigest = CPA_FALSE;                                                        \
+    }                                                                                                      \
+                                                                                                           \
+    static void name##FillOpData(const OpDesc *opDesc,                                                     \
+                                 CpaCySymSessionCtx sessionCtx,                                            \
+                                 Cpa8U *ivBuffer,                                                          \
+                                 Cpa8U *digestBuffer,                                                      \
+                                 CpaCySymOpData *opData)                                                   \
+    {                                                                                                      \
+        opData->sessionCtx = sessionCtx;                                                                   \
+        opData->packetType = CPA_CY_SYM_PACKET_TYPE_FULL;                                                  \
+        opData->pIv = NULL;                                                                                \
+        opData->ivLenInBytes = 0;                                                                          \
+        opData->hashStartSrcOffsetInBytes = 0;                                                             \
+        opData->messageLenToHashInBytes = opDesc->inSize;                                                  \
+        opData->pDigestResult = digestBuffer;                                                              \
+        opData->pAdditionalAuthData = (0 < (aadLen)) ? ivBuffer : NULL;                                    \
+    }
+
+/*
+ * Ciphers operate on bit granularity, the trailing bits of the last byte beyond bitLen are not part of the
+ * expected output and are cleared.
+ */
+static Cpa8U *neaCompleteOp(const OpDesc *opDesc, CpaBufferList *dstBufferList, Cpa8U *digestBuffer)
+{
+    Cpa8U *dstBuffer = dstBufferList->pBuffers[0].pData;
+    Cpa32U byteLen = opDesc->bitLen / 8;
+    Cpa32U listIdx = 0;
+
+    for (listIdx = byteLen + 1; listIdx < opDesc->outSize; listIdx++)
+    {
+        dstBuffer[listIdx] = 0x0;
+    }
+    if ((opDesc->bitLen & 0x7) != 0)
+    {
+        dstBuffer[byteLen] = dstBuffer[byteLen] & (0xff << (8 - (opDesc->bitLen % 8)));
+    }
+
+    return dstBuffer;
+}
+
+static Cpa8U *niaCompleteOp(const OpDesc *opDesc, CpaBufferList *dstBufferList, Cpa8U *digestBuffer)
+{
+    return digestBuffer;
+}
+
+#define X(name, Name, cipherAlgo, keySize, experimental) DEFINE_NEA_PATH(name, Name, cipherAlgo)
+NEA_ALGO_LIST(X)
+#undef X
+#define X(name, Name, hashAlgo, aadLen, keySize, experimental) DEFINE_NIA_PATH(name, Name, hashAlgo, aadLen)
+NIA_ALGO_LIST(X)
+#undef X
+
+/* AES-CBC is not a 5G NR algorithm, it only serves the sample test data */
+DEFINE_NEA_PATH(sample, Sample, AES_CBC)
+
+static CpaStatus genSampleTestDataById(int testSetId, TestData *ret)
+{
+    return genSampleTestData(ret);
+}
+
+static const AlgoDesc algoDescs_g[] = {
+#define X(name, Name, cipherAlgo, keySize, experimental)                                             \
+    {#name, CPA_CY_SYM_OP_CIPHER, CPA_CY_SYM_CIPHER_##cipherAlgo, CPA_CY_SYM_HASH_NONE, keySize, 0,  \
+     (experimental) ? CPA_TRUE : CPA_FALSE, gen##Name##TestData, name##SetupSession, name##FillOpData,  \
+     neaCompleteOp},
+    NEA_ALGO_LIST(X)
+#undef X
+#define X(name, Name, hashAlgo, aadLen, keySize, experimental)                                        \
+    {#name, CPA_CY_SYM_OP_HASH, 0, CPA_CY_SYM_HASH_##hashAlgo, keySize, (0 < (aadLen)) ? 0 : 8,        \
+     (experimental) ? CPA_TRUE : CPA_FALSE, gen##Name##TestData, name##SetupSession, name##FillOpData,  \
+     niaCompleteOp},
+    NIA_ALGO_LIST(X)
+#undef X
+    {"sample", CPA_CY_SYM_OP_CIPHER, CPA_CY_SYM_CIPHER_AES_CBC, CPA_CY_SYM_HASH_NONE, 32, 0, CPA_FALSE,
+     genSampleTestDataById, sampleSetupSession, sampleFillOpData, neaCompleteOp},
+};
+
+#define NUM_ALGO_DESCS (sizeof(algoDescs_g) / sizeof(algoDescs_g[0]))
+
+const AlgoDesc *findAlgoDesc(const char *name)
+{
+    Cpa32U descIdx = 0;
+
+    for (descIdx = 0; descIdx < NUM_ALGO_DESCS; descIdx++)
+    {
+        if (0 == strcmp(algoDescs_g[descIdx].name, name))
+        {
+            return &algoDescs_g[descIdx];
+        }
+    }
+    return NULL;
+}
+
+const AlgoDesc *getAlgoDesc(const TestData *testData)
+{
+    Cpa32U descIdx = 0;
+    const AlgoDesc *desc = NULL;
+
+    for (descIdx = 0; descIdx < NUM_ALGO_DESCS; descIdx++)
+    {
+        desc = &algoDescs_g[descIdx];
+        if (desc->op != testData->op || desc->keySize != testData->keySize)
+        {
+            continue;
+        }
+        if ((CPA_CY_SYM_OP_CIPHER == desc->op && desc->cipherAlgo == testData->cipherAlgo) ||
+            (CPA_CY_SYM_OP_HASH == desc->op && desc->hashAlgo == testData->hashAlgo))
+        {
+            return desc;
+        }
+    }
+    return NULL;
+}
+
+const AlgoDesc *getAlgoDescs(Cpa32U *numDescs)
+{
+    *numDescs = NUM_ALGO_DESCS;
+    return algoDescs_g;
+}
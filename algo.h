@@ -0,0 +1,63 @@
+#ifndef ALGO_H
+#define ALGO_H
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+
+#include "utils.h"
+
+/*
+ * 5G NR security algorithms handled by the specialized op paths.
+ *
+ * NEA: X(name, Name, cipher algorithm, key size in bytes, experimental)
+ * NIA: X(name, Name, hash algorithm, AAD length in bytes, key size in bytes, experimental)
+ *
+ * A NIA algorithm without AAD (128-NIA2) takes its 8-byte IV in front of the message. The 256-bit variants run
+ * the same device algorithms under a 32 byte key, which for ZUC selects ZUC-256 and its 25 byte IV.
+ *
+ * 3GPP has not specified how COUNT, BEARER and DIRECTION map to the ZUC-256 IV yet. The _exp variants zero-pad
+ * the 128-bit IV instead, which interoperates with nothing: they are experimental, kept out of the daemon, the
+ * pre-warmed session contexts and the performance suite, and only reachable by name.
+ */
+#define NEA_ALGO_LIST(X)                              \
+    X(nea1, Nea1, SNOW3G_UEA2, 16, 0)                 \
+    X(nea2, Nea2, AES_CTR, 16, 0)                     \
+    X(nea3, Nea3, ZUC_EEA3, 16, 0)                    \
+    X(nea2_256, Nea2_256, AES_CTR, 32, 0)             \
+    X(nea3_256_exp, Nea3_256, ZUC_EEA3, 32, 1)
+
+#define NIA_ALGO_LIST(X)                                  \
+    X(nia1, Nia1, SNOW3G_UIA2, 16, 16, 0)                 \
+    X(nia2, Nia2, AES_CMAC, 0, 16, 0)                     \
+    X(nia3, Nia3, ZUC_EIA3, 16, 16, 0)                    \
+    X(nia2_256, Nia2_256, AES_CMAC, 0, 32, 0)             \
+    X(nia3_256_exp, Nia3_256, ZUC_EIA3, 25, 32, 1)
+
+typedef struct _AlgoDesc {
+    const char *name;
+    CpaCySymOp op;
+    CpaCySymCipherAlgorithm cipherAlgo;
+    CpaCySymHashAlgorithm hashAlgo;
+    Cpa32U keySize;
+    /* Bytes of IV carried in front of the message instead of in the IV or AAD field */
+    Cpa32U msgIvPrefixLen;
+    /* Not a specified 3GPP construction yet, see above */
+    CpaBoolean experimental;
+    CpaStatus (*genTestData)(int testSetId, TestData *ret);
+    /* Fill the algorithm specific part of the session setup data, called once per session */
+    void (*setupSession)(const TestData *testData, CpaCySymSessionSetupData *sessionSetupData);
+    /* Fill the op data of a single request, called per op */
+    void (*fillOpData)(const OpDesc *opDesc,
+                       CpaCySymSessionCtx sessionCtx,
+                       Cpa8U *ivBuffer,
+                       Cpa8U *digestBuffer,
+                       CpaCySymOpData *opData);
+    /* Post-process a completed request and return the output to be compared, called per op */
+    Cpa8U *(*completeOp)(const OpDesc *opDesc, CpaBufferList *dstBufferList, Cpa8U *digestBuffer);
+} AlgoDesc;
+
+const AlgoDesc *findAlgoDesc(const char *name);
+const AlgoDesc *getAlgoDesc(const TestData *testData);
+const AlgoDesc *getAlgoDescs(Cpa32U *numDescs);
+
+#endif
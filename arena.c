@@ -0,0 +1,289 @@
+/*
+ * Arena for host-side allocations.
+ *
+ * Buffer list headers, op data of the single shot paths and test vectors are small objects the device never
+ * touches. From malloc they are spread over 4 KB pages and every allocation takes the allocator lock, which
+ * shows up as TLB misses and contention once several workers run. They come from one mapping on huge pages
+ * instead: reserved ones when the system has them, transparent ones otherwise.
+ *
+ * The arena is a bump allocator handing out chunks to threads. A thread carves its chunk into power of two
+ * size classes and keeps the objects it frees on per-class free lists of its own, so most allocations and frees
+ * take no lock. Objects freed on another thread than the one allocating them, such as the retired sessions
+ * released by a poller, would pile up there: past two batches a free list hands a batch to a central list,
+ * where threads out of objects of a class look before carving new ones. Every object has a small header with
+ * its class and the generation it was allocated in; arenaDestroy() starts a new generation, so that every
+ * thread drops the chunk and free lists it had in the unmapped arena.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "cpa.h"
+
+#include "arena.h"
+#include "utils.h"
+
+typedef struct _ArenaHeader {
+    Cpa32U sizeClass;
+    Cpa32U generation;
+    Cpa64U reserved; /* keeps objects 16 byte aligned, as from malloc */
+} ArenaHeader;
+
+typedef struct _ArenaCache {
+    Cpa8U *cur;
+    Cpa8U *end;
+    void *freeLists[ARENA_NUM_CLASSES];
+    Cpa32U numFree[ARENA_NUM_CLASSES];
+    Cpa32U generation;
+} ArenaCache;
+
+static struct
+{
+    Cpa8U *base;
+    Cpa64U size;
+    Cpa64U used;
+    Cpa32U generation;
+    CpaBoolean hugeTlb;
+    Cpa64U numFallbacks;
+    void *centralLists[ARENA_NUM_CLASSES]; /* under arenaLock_g */
+} arena_g = {0};
+
+/* Guards the mapping and the central lists */
+static pthread_mutex_t arenaLock_g = PTHREAD_MUTEX_INITIALIZER;
+static __thread ArenaCache arenaCache_t = {0};
+
+static CpaBoolean arenaMap(void)
+{
+    const char *sizeMb = getenv("PDCP_ARENA_MB");
+    Cpa64U size = (Cpa64U)ARENA_DEFAULT_SIZE_MB << 20;
+    void *base = MAP_FAILED;
+
+    pthread_mutex_lock(&arenaLock_g);
+    if (NULL != arena_g.base)
+    {
+        pthread_mutex_unlock(&arenaLock_g);
+        return CPA_TRUE;
+    }
+
+    if (NULL != sizeMb && 0 < atoi(sizeMb))
+    {
+        size = (Cpa64U)atoi(sizeMb) << 20;
+    }
+    size = (size + ARENA_HUGE_PAGE_SIZE - 1) & ~((Cpa64U)ARENA_HUGE_PAGE_SIZE - 1);
+
+    base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    arena_g.hugeTlb = (MAP_FAILED != base) ? CPA_TRUE : CPA_FALSE;
+    if (MAP_FAILED == base)
+    {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (MAP_FAILED != base)
+        {
+            madvise(base, size, MADV_HUGEPAGE);
+        }
+    }
+    if (MAP_FAILED == base)
+    {
+        PRINT_ERR("Failed to map a host arena of %llu MB, host objects come from malloc\n",
+                  (unsigned long long)(size >> 20));
+        pthread_mutex_unlock(&arenaLock_g);
+        return CPA_FALSE;
+    }
+
+    arena_g.size = size;
+    arena_g.used = 0;
+    __atomic_store_n(&arena_g.base, (Cpa8U *)base, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&arenaLock_g);
+    PRINT_DBG("Host arena of %llu MB on %s huge pages\n",
+              (unsigned long long)(size >> 20),
+              (CPA_TRUE == arena_g.hugeTlb) ? "reserved" : "transparent");
+    return CPA_TRUE;
+}
+
+/* Size class of an object and its header, CPA_FALSE when too large for the arena */
+static CpaBoolean sizeClassOf(Cpa32U sizeBytes, Cpa32U *sizeClass)
+{
+    Cpa32U total = sizeBytes + sizeof(ArenaHeader);
+
+    for (*sizeClass = 0; *sizeClass < ARENA_NUM_CLASSES; (*sizeClass)++)
+    {
+        if (total <= (1U << (ARENA_MIN_CLASS_SHIFT + *sizeClass)))
+        {
+            return CPA_TRUE;
+        }
+    }
+    return CPA_FALSE;
+}
+
+static void *fallbackAlloc(Cpa32U sizeBytes)
+{
+    __atomic_add_fetch(&arena_g.numFallbacks, 1, __ATOMIC_RELAXED);
+    return malloc(sizeBytes);
+}
+
+static void resetCache(ArenaCache *cache, Cpa32U generation)
+{
+    memset(cache, 0, sizeof(ArenaCache));
+    cache->generation = generation;
+}
+
+/* Refill an empty free list with a batch from the central list */
+static void takeBatch(ArenaCache *cache, Cpa32U sizeClass)
+{
+    void *object = NULL;
+
+    if (NULL == __atomic_load_n(&arena_g.centralLists[sizeClass], __ATOMIC_RELAXED))
+    {
+        return;
+    }
+    pthread_mutex_lock(&arenaLock_g);
+    if (cache->generation == arena_g.generation)
+    {
+        while (ARENA_BATCH_SIZE > cache->numFree[sizeClass] && NULL != arena_g.centralLists[sizeClass])
+        {
+            object = arena_g.centralLists[sizeClass];
+            arena_g.centralLists[sizeClass] = *(void **)object;
+            *(void **)object = cache->freeLists[sizeClass];
+            cache->freeLists[sizeClass] = object;
+            cache->numFree[sizeClass]++;
+        }
+    }
+    pthread_mutex_unlock(&arenaLock_g);
+}
+
+static void giveBatch(ArenaCache *cache, Cpa32U sizeClass)
+{
+    void *object = NULL;
+
+    pthread_mutex_lock(&arenaLock_g);
+    if (cache->generation == arena_g.generation)
+    {
+        while (ARENA_BATCH_SIZE < cache->numFree[sizeClass])
+        {
+            object = cache->freeLists[sizeClass];
+            cache->freeLists[sizeClass] = *(void **)object;
+            cache->numFree[sizeClass]--;
+            *(void **)object = arena_g.centralLists[sizeClass];
+            arena_g.centralLists[sizeClass] = object;
+        }
+    }
+    pthread_mutex_unlock(&arenaLock_g);
+}
+
+void *arenaAlloc(Cpa32U sizeBytes)
+{
+    ArenaCache *cache = &arenaCache_t;
+    ArenaHeader *header = NULL;
+    Cpa32U generation = 0;
+    Cpa32U sizeClass = 0;
+    Cpa32U classSize = 0;
+    Cpa64U offset = 0;
+
+    if (CPA_TRUE != sizeClassOf(sizeBytes, &sizeClass) ||
+        (NULL == __atomic_load_n(&arena_g.base, __ATOMIC_ACQUIRE) && CPA_TRUE != arenaMap()))
+    {
+        return fallbackAlloc(sizeBytes);
+    }
+
+    generation = __atomic_load_n(&arena_g.generation, __ATOMIC_ACQUIRE);
+    if (cache->generation != generation)
+    {
+        resetCache(cache, generation);
+    }
+
+    if (NULL == cache->freeLists[sizeClass])
+    {
+        takeBatch(cache, sizeClass);
+    }
+    if (NULL != cache->freeLists[sizeClass])
+    {
+        header = cache->freeLists[sizeClass];
+        cache->freeLists[sizeClass] = *(void **)header;
+        cache->numFree[sizeClass]--;
+    }
+    else
+    {
+        classSize = 1U << (ARENA_MIN_CLASS_SHIFT + sizeClass);
+        if (cache->cur + classSize > cache->end)
+        {
+            offset = __atomic_fetch_add(&arena_g.used, ARENA_CHUNK_SIZE, __ATOMIC_RELAXED);
+            if (offset + ARENA_CHUNK_SIZE > arena_g.size)
+            {
+                return fallbackAlloc(sizeBytes);
+            }
+            cache->cur = arena_g.base + offset;
+            cache->end = cache->cur + ARENA_CHUNK_SIZE;
+        }
+        header = (ArenaHeader *)cache->cur;
+        cache->cur += classSize;
+    }
+
+    header->sizeClass = sizeClass;
+    header->generation = generation;
+    return header + 1;
+}
+
+void arenaFree(void *ptr)
+{
+    ArenaCache *cache = &arenaCache_t;
+    Cpa8U *base = __atomic_load_n(&arena_g.base, __ATOMIC_ACQUIRE);
+    ArenaHeader *header = NULL;
+    Cpa32U sizeClass = 0;
+
+    if (NULL == ptr)
+    {
+        return;
+    }
+    if (NULL == base || (Cpa8U *)ptr < base || (Cpa8U *)ptr >= base + arena_g.size)
+    {
+        free(ptr);
+        return;
+    }
+
+    header = (ArenaHeader *)ptr - 1;
+    if (header->generation != __atomic_load_n(&arena_g.generation, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+    if (cache->generation != header->generation)
+    {
+        resetCache(cache, header->generation);
+    }
+    /* The link to the next free object goes over the header */
+    sizeClass = header->sizeClass;
+    *(void **)header = cache->freeLists[sizeClass];
+    cache->freeLists[sizeClass] = header;
+    if (2 * ARENA_BATCH_SIZE < ++cache->numFree[sizeClass])
+    {
+        giveBatch(cache, sizeClass);
+    }
+}
+
+void arenaDestroy(void)
+{
+    pthread_mutex_lock(&arenaLock_g);
+    if (NULL != arena_g.base)
+    {
+        munmap(arena_g.base, arena_g.size);
+        __atomic_store_n(&arena_g.base, NULL, __ATOMIC_RELEASE);
+        arena_g.used = 0;
+        memset(arena_g.centralLists, 0, sizeof(arena_g.centralLists));
+        __atomic_add_fetch(&arena_g.generation, 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&arenaLock_g);
+}
+
+void arenaGetStats(ArenaStats *stats)
+{
+    memset(stats, 0, sizeof(ArenaStats));
+    stats->size = arena_g.size;
+    stats->used = __atomic_load_n(&arena_g.used, __ATOMIC_RELAXED);
+    if (stats->used > stats->size)
+    {
+        stats->used = stats->size;
+    }
+    stats->hugeTlb = arena_g.hugeTlb;
+    stats->numFallbacks = __atomic_load_n(&arena_g.numFallbacks, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,34 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "cpa.h"
+
+#define ARENA_DEFAULT_SIZE_MB 64
+#define ARENA_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define ARENA_CHUNK_SIZE (256 * 1024) /* taken from the arena by a thread at a time */
+#define ARENA_MIN_CLASS_SHIFT 5 /* 32 bytes */
+#define ARENA_NUM_CLASSES 8 /* up to 4 KB, header included, larger objects come from malloc */
+#define ARENA_BATCH_SIZE 32 /* objects moved between a thread and the central lists at a time */
+
+typedef struct _ArenaStats {
+    Cpa64U size;
+    Cpa64U used; /* handed out to threads as chunks */
+    CpaBoolean hugeTlb; /* backed by reserved huge pages, transparent ones otherwise */
+    Cpa64U numFallbacks; /* allocations that went to malloc */
+} ArenaStats;
+
+/*
+ * Host-side objects that the device never reads, such as CpaBufferList headers and test vectors. The arena is
+ * mapped on first use, PDCP_ARENA_MB sets its size.
+ */
+void *arenaAlloc(Cpa32U sizeBytes);
+void arenaFree(void *ptr);
+
+/*
+ * Unmap the arena at exit, once none of its objects is in use any more
+ */
+void arenaDestroy(void);
+
+void arenaGetStats(ArenaStats *stats);
+
+#endif
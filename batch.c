@@ -0,0 +1,95 @@
+/*
+ * Adaptive batching of a burst loop.
+ *
+ * Fixed batch sizes are wrong at one end of the load range: small batches spend a poll and a submit round on
+ * every few PDUs at busy hour, large ones hold PDUs back waiting for batches that fill slowly at night. The
+ * adaptive mode sizes batches from the observed load instead, against a latency target that is the knob
+ * between latency and throughput.
+ *
+ * Every BATCH_UPDATE_NS the arrival rate, the completion rate and the mean number of ops in flight are folded
+ * into moving averages. By Little's law the time an op spends in flight is the occupancy over the completion
+ * rate; what is left of the target after that is the budget for batching. The batch is what arrives within the
+ * budget, and a partial batch is held half the budget at most. Polls are spread so that each finds about a
+ * batch of completions, but never more than a quarter of the budget apart. At low load batches shrink to single PDUs
+ * submitted at once; under load they grow to maxBatch and polls get rarer. Once the ops in flight take the
+ * whole target, the batches stay at maxBatch rather than collapsing to single PDUs.
+ */
+
+#include <string.h>
+
+#include "cpa.h"
+
+#include "batch.h"
+
+#define BATCH_EWMA_WEIGHT 0.25
+
+void batchInit(BatchCtl *ctl, Cpa32U mode, Cpa32U maxBatch, Cpa32U targetUs)
+{
+    memset(ctl, 0, sizeof(BatchCtl));
+    ctl->mode = mode;
+    ctl->maxBatch = (0 < maxBatch) ? maxBatch : 1;
+    ctl->targetNs = (Cpa64U)targetUs * 1000;
+    ctl->batchSize = (BATCH_ADAPTIVE == mode) ? 1 : ctl->maxBatch;
+    ctl->flushNs = (BATCH_FIXED == mode) ? ctl->targetNs : 0;
+    ctl->pollIntervalNs = 0;
+}
+
+void batchUpdate(BatchCtl *ctl, Cpa64U now)
+{
+    double elapsed = (double)(now - ctl->windowStartNs) / 1e9;
+    double serviceNs = 0;
+    double budgetNs = 0;
+    double batchSize = 0;
+    double pollIntervalNs = 0;
+
+    if (0 == ctl->windowStartNs)
+    {
+        ctl->windowStartNs = now;
+        return;
+    }
+
+    ctl->arrivalRate += BATCH_EWMA_WEIGHT * ((double)ctl->numArrivals / elapsed - ctl->arrivalRate);
+    ctl->completionRate += BATCH_EWMA_WEIGHT * ((double)ctl->numCompletions / elapsed - ctl->completionRate);
+    if (0 < ctl->numSamples)
+    {
+        ctl->occupancy += BATCH_EWMA_WEIGHT * ((double)ctl->inflightSum / (double)ctl->numSamples - ctl->occupancy);
+    }
+    ctl->windowStartNs = now;
+    ctl->numArrivals = 0;
+    ctl->numCompletions = 0;
+    ctl->inflightSum = 0;
+    ctl->numSamples = 0;
+
+    if (0 < ctl->completionRate)
+    {
+        serviceNs = ctl->occupancy / ctl->completionRate * 1e9;
+    }
+    if ((double)ctl->targetNs <= serviceNs)
+    {
+        /*
+         * Overloaded: the ops in flight take the whole target already, so the target is missed whatever the
+         * batching does. What is left to win is throughput, with full batches held as long as the target allows.
+         */
+        ctl->batchSize = ctl->maxBatch;
+        ctl->flushNs = ctl->targetNs / 2;
+        pollIntervalNs = (0 < ctl->completionRate) ? ctl->batchSize / ctl->completionRate * 1e9 : 0;
+        if ((double)ctl->targetNs / 4 < pollIntervalNs)
+        {
+            pollIntervalNs = (double)ctl->targetNs / 4;
+        }
+        ctl->pollIntervalNs = (BATCH_MIN_POLL_NS > pollIntervalNs) ? 0 : (Cpa64U)pollIntervalNs;
+        return;
+    }
+    budgetNs = (double)ctl->targetNs - serviceNs;
+
+    batchSize = ctl->arrivalRate * budgetNs / 1e9;
+    ctl->batchSize = (1 > batchSize) ? 1 : (ctl->maxBatch < batchSize) ? ctl->maxBatch : (Cpa32U)batchSize;
+    ctl->flushNs = (Cpa64U)(budgetNs / 2);
+
+    pollIntervalNs = (0 < ctl->completionRate) ? ctl->batchSize / ctl->completionRate * 1e9 : budgetNs / 4;
+    if (budgetNs / 4 < pollIntervalNs)
+    {
+        pollIntervalNs = budgetNs / 4;
+    }
+    ctl->pollIntervalNs = (BATCH_MIN_POLL_NS > pollIntervalNs) ? 0 : (Cpa64U)pollIntervalNs;
+}
@@ -0,0 +1,86 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "cpa.h"
+
+#define BATCH_UPDATE_NS 1000000ULL /* between two updates of the adaptive settings */
+#define BATCH_MIN_POLL_NS 2000ULL
+#define BATCH_DEFAULT_TARGET_US 500
+
+enum
+{
+    BATCH_IMMEDIATE = 0, /* submit whatever came in and poll on every round */
+    BATCH_FIXED,         /* wait for full batches, up to the latency target */
+    BATCH_ADAPTIVE,      /* batch size, flush timeout and poll cadence follow the load */
+};
+
+/*
+ * Submit and poll policy of a burst loop. The loop reports arrivals, occupancy and completions; in adaptive
+ * mode the settings are worked out again every BATCH_UPDATE_NS from what was observed, see batch.c.
+ */
+typedef struct _BatchCtl {
+    Cpa32U mode;
+    Cpa32U maxBatch;
+    Cpa64U targetNs; /* the latency versus throughput knob */
+    /* Settings */
+    Cpa32U batchSize;
+    Cpa64U flushNs; /* longest a partial batch is held */
+    Cpa64U pollIntervalNs;
+    /* Observations since windowStartNs, and their moving averages */
+    Cpa64U windowStartNs;
+    Cpa64U lastPollNs;
+    Cpa64U numArrivals;
+    Cpa64U numCompletions;
+    Cpa64U inflightSum;
+    Cpa64U numSamples;
+    double arrivalRate; /* per second */
+    double completionRate;
+    double occupancy;
+} BatchCtl;
+
+/*
+ * maxBatch bounds the batch size of every mode, targetUs is the latency the fixed and adaptive modes may add
+ * waiting for batches, polls included
+ */
+void batchInit(BatchCtl *ctl, Cpa32U mode, Cpa32U maxBatch, Cpa32U targetUs);
+void batchUpdate(BatchCtl *ctl, Cpa64U now);
+
+/* Once per round of the loop, with now from CLOCK_MONOTONIC or 0 in immediate mode */
+static inline void batchTick(BatchCtl *ctl, Cpa64U now, Cpa32U numInflight)
+{
+    if (BATCH_ADAPTIVE == ctl->mode)
+    {
+        ctl->inflightSum += numInflight;
+        ctl->numSamples++;
+        if (now - ctl->windowStartNs >= BATCH_UPDATE_NS)
+        {
+            batchUpdate(ctl, now);
+        }
+    }
+}
+
+static inline void batchOnArrivals(BatchCtl *ctl, Cpa32U numDescs)
+{
+    ctl->numArrivals += numDescs;
+}
+
+/* pendingSinceNs is when the oldest descriptor not submitted came in */
+static inline CpaBoolean batchShouldSubmit(const BatchCtl *ctl, Cpa32U numPending, Cpa64U pendingSinceNs, Cpa64U now)
+{
+    return (BATCH_IMMEDIATE == ctl->mode || numPending >= ctl->batchSize || now - pendingSinceNs >= ctl->flushNs)
+               ? CPA_TRUE
+               : CPA_FALSE;
+}
+
+static inline CpaBoolean batchShouldPoll(const BatchCtl *ctl, Cpa64U now)
+{
+    return (BATCH_IMMEDIATE == ctl->mode || now - ctl->lastPollNs >= ctl->pollIntervalNs) ? CPA_TRUE : CPA_FALSE;
+}
+
+static inline void batchOnPoll(BatchCtl *ctl, Cpa32U numCompleted, Cpa64U now)
+{
+    ctl->numCompletions += numCompleted;
+    ctl->lastPollNs = now;
+}
+
+#endif
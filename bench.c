@@ -0,0 +1,2140 @@
+/*
+ * Benches of the run-to-completion workers, on synthetic traffic.
+ *
+ * runWorkers() drives the workers, each on its own bearers; runWorkerSteal() drives a group with skewed traffic,
+ * with and without stealing; runWorkerQos() overloads a worker with bulk traffic next to paced high priority
+ * flows; runWorkerReorder() spreads each bearer over every worker and puts its completions back in order
+ * through a reorder stage; runWorkerBatching() offers a worker open-loop traffic with each way of batching;
+ * runWorkerFailover() follows the workers through faults of their instances; runWorkerChurn() creates, re-keys
+ * and retires sessions at a handover rate while the workers send; runWorkerIdle() compares the CPU time a
+ * worker takes spinning and sleeping.
+ *
+ * Every bench starts the engine, runs its rounds and stops it again; their sessions all take the same key.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cpa.h"
+#include "cpa_sample_utils.h"
+
+#include "algo.h"
+#include "batch.h"
+#include "bench.h"
+#include "engine.h"
+#include "reorder.h"
+#include "utils.h"
+#include "worker.h"
+
+static Cpa64U nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Cpa64U)ts.tv_sec * 1000000000ULL + (Cpa64U)ts.tv_nsec;
+}
+
+/*
+ *******************
+ * Setup
+ *******************
+ */
+
+/*
+ * Start the engine. numWorkers, unless NULL, is clamped to the instances there are, 0 standing for one per
+ * instance; fewer than minWorkers of them and the bench cannot run.
+ */
+static CpaStatus benchStart(const char *benchName, Cpa32U minWorkers, Cpa32U *numWorkers)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+
+    stat = engineStart();
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        PRINT_ERR("Failed to start the engine\n");
+        return stat;
+    }
+    if (NULL == numWorkers)
+    {
+        return CPA_STATUS_SUCCESS;
+    }
+    if (0 == *numWorkers || engineNumInstances() < *numWorkers)
+    {
+        *numWorkers = engineNumInstances();
+    }
+    if (minWorkers > *numWorkers)
+    {
+        PRINT_ERR("%s needs %u instances at least\n", benchName, minWorkers);
+        engineStop();
+        return CPA_STATUS_UNSUPPORTED;
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+/* Free the region of benchAllocRegion(), if any, and stop the engine */
+static void benchStop(Cpa8U **region)
+{
+    if (NULL != region)
+    {
+        memFreeContig((void *)region);
+    }
+    engineStop();
+}
+
+/* Zeroed and cache line aligned, NULL when out of memory */
+static void *benchAlloc(size_t size)
+{
+    void *mem = aligned_alloc(RING_CACHE_LINE, size);
+
+    if (NULL != mem)
+    {
+        memset(mem, 0, size);
+    }
+    return mem;
+}
+
+/*
+ * Region for the PDUs a worker group works on, numSlots buffers of slotSize bytes each holding a PDU of
+ * pduSize bytes after the op headroom
+ */
+static CpaStatus benchAllocRegion(Cpa32U numSlots,
+                                  Cpa32U pduSize,
+                                  Cpa8U **region,
+                                  Cpa32U *regionSize,
+                                  Cpa32U *slotSize)
+{
+    *slotSize = (ENGINE_OP_HEADROOM + pduSize + BYTE_ALIGNMENT - 1) & ~(BYTE_ALIGNMENT - 1);
+    *regionSize = numSlots * *slotSize;
+    return memAllocContig((void *)region, *regionSize, BYTE_ALIGNMENT);
+}
+
+static void benchKey(Cpa8U *key)
+{
+    Cpa32U keyIdx = 0;
+
+    for (keyIdx = 0; keyIdx < WORKER_BENCH_KEY_SIZE; keyIdx++)
+    {
+        key[keyIdx] = (Cpa8U)(0x2b + 7 * keyIdx);
+    }
+}
+
+static Cpa32U benchDigestSize(const AlgoDesc *algoDesc)
+{
+    return (CPA_CY_SYM_OP_HASH == algoDesc->op) ? WORKER_BENCH_DIGEST_SIZE : 0;
+}
+
+/* Bulk session of a bench on a bearer, uplink */
+static CpaStatus benchCreateSession(Worker *worker, const AlgoDesc *algoDesc, Cpa8U bearer, Cpa32U *sessionId)
+{
+    Cpa8U key[WORKER_BENCH_KEY_SIZE];
+
+    benchKey(key);
+    return workerCreateSession(worker,
+                               algoDesc->name,
+                               key,
+                               algoDesc->keySize,
+                               bearer,
+                               0,
+                               benchDigestSize(algoDesc),
+                               CPA_FALSE,
+                               ENGINE_CLASS_BULK,
+                               sessionId);
+}
+
+/*
+ * Worker workerIdx owns instance workerIdx and WORKER_BENCH_SESSIONS bearers from workerIdx *
+ * WORKER_BENCH_SESSIONS on
+ */
+static CpaStatus benchInitWorker(Worker *worker, Cpa32U workerIdx, const AlgoDesc *algoDesc, Cpa32U *sessionIds)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Cpa32U sessionIdx = 0;
+
+    workerInit(worker, workerIdx);
+    for (sessionIdx = 0; CPA_STATUS_SUCCESS == stat && sessionIdx < WORKER_BENCH_SESSIONS; sessionIdx++)
+    {
+        stat = benchCreateSession(worker,
+                                  algoDesc,
+                                  (Cpa8U)((workerIdx * WORKER_BENCH_SESSIONS + sessionIdx) % 32),
+                                  &sessionIds[sessionIdx]);
+    }
+    CHECK_ERR_STATUS("workerCreateSession", stat);
+    return stat;
+}
+
+/* Uplink flow of a bench on a bearer, of trafficClass */
+static CpaStatus benchAddFlow(WorkerGroup *group, const AlgoDesc *algoDesc, Cpa8U bearer, Cpa32U trafficClass)
+{
+    Cpa8U key[WORKER_BENCH_KEY_SIZE];
+    Cpa32U flowIdx = 0;
+
+    benchKey(key);
+    return workerGroupAddFlow(group,
+                              algoDesc->name,
+                              key,
+                              algoDesc->keySize,
+                              bearer,
+                              0,
+                              benchDigestSize(algoDesc),
+                              CPA_FALSE,
+                              trafficClass,
+                              &flowIdx);
+}
+
+static Cpa32U latencyPercentile(const Cpa64U *latencyUs, Cpa64U numOps, double fraction)
+{
+    Cpa64U rank = (Cpa64U)(fraction * (double)numOps);
+    Cpa64U seen = 0;
+    Cpa32U us = 0;
+
+    for (us = 0; us < WORKER_BENCH_MAX_US; us++)
+    {
+        seen += latencyUs[us];
+        if (seen > rank)
+        {
+            break;
+        }
+    }
+    return us;
+}
+
+/*
+ *******************
+ * Synthetic traffic
+ *******************
+ */
+typedef struct _WorkerBench {
+    Cpa32U sessionIds[WORKER_BENCH_SESSIONS];
+    Cpa32U counts[WORKER_BENCH_SESSIONS];
+    Cpa32U nextSession;
+    Cpa32U pduSize;
+    Cpa32U numInflight;
+    volatile CpaBoolean sending;
+    Cpa64U numOps;
+    Cpa64U numErrors;
+    Cpa64U latencyUs[WORKER_BENCH_MAX_US + 1]; /* histogram, the last bucket holds everything slower */
+} __attribute__((aligned(RING_CACHE_LINE))) WorkerBench;
+
+static Cpa32U benchRx(Worker *worker, PdcpDesc *descs, Cpa32U maxDescs, void *arg)
+{
+    WorkerBench *bench = (WorkerBench *)arg;
+    Cpa64U now = nowNs();
+    Cpa32U numDescs = 0;
+    Cpa32U session = 0;
+    Cpa32U offset = 0;
+
+    while (CPA_TRUE == bench->sending && numDescs < maxDescs && WORKER_BENCH_DEPTH > bench->numInflight &&
+           NULL != workerAllocBuffer(worker, &offset))
+    {
+        session = bench->nextSession++ % WORKER_BENCH_SESSIONS;
+        memset(&descs[numDescs], 0, sizeof(PdcpDesc));
+        descs[numDescs].userTag = now;
+        descs[numDescs].sessionId = bench->sessionIds[session];
+        descs[numDescs].count = bench->counts[session]++;
+        descs[numDescs].offset = offset;
+        descs[numDescs].length = bench->pduSize;
+        bench->numInflight++;
+        numDescs++;
+    }
+    return numDescs;
+}
+
+static void benchTx(Worker *worker, const PdcpDesc *descs, Cpa32U numDescs, void *arg)
+{
+    WorkerBench *bench = (WorkerBench *)arg;
+    Cpa64U now = nowNs();
+    Cpa64U latencyUs = 0;
+    Cpa32U descIdx = 0;
+
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        bench->numInflight--;
+        if (CPA_STATUS_SUCCESS != descs[descIdx].status)
+        {
+            bench->numErrors++;
+            continue;
+        }
+        latencyUs = (now - descs[descIdx].userTag) / 1000;
+        bench->latencyUs[(WORKER_BENCH_MAX_US < latencyUs) ? WORKER_BENCH_MAX_US : latencyUs]++;
+        bench->numOps++;
+    }
+}
+
+CpaStatus runWorkers(const char *algoName, Cpa32U numWorkers, Cpa32U pduSize, Cpa32U seconds)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = findAlgoDesc(algoName);
+    Worker *workers = NULL;
+    WorkerBench *benches = NULL;
+    Cpa32U numStarted = 0;
+    Cpa32U workerIdx = 0;
+    Cpa64U numOps = 0;
+    Cpa64U numErrors = 0;
+    Cpa64U start = 0;
+    double elapsed = 0;
+
+    if (NULL == algoDesc || 0 == pduSize || ENGINE_MAX_PDU_SIZE < pduSize || 0 == seconds)
+    {
+        PRINT_ERR("Invalid worker parameters\n");
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    stat = benchStart("Workers", 1, &numWorkers);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+    workers = benchAlloc(numWorkers * sizeof(Worker));
+    benches = benchAlloc(numWorkers * sizeof(WorkerBench));
+    if (NULL == workers || NULL == benches)
+    {
+        free(workers);
+        free(benches);
+        benchStop(NULL);
+        return CPA_STATUS_RESOURCE;
+    }
+
+    for (workerIdx = 0; CPA_STATUS_SUCCESS == stat && workerIdx < numWorkers; workerIdx++)
+    {
+        benches[workerIdx].pduSize = pduSize;
+        benches[workerIdx].sending = CPA_TRUE;
+        stat = benchInitWorker(&workers[workerIdx], workerIdx, algoDesc, benches[workerIdx].sessionIds);
+    }
+
+    start = nowNs();
+    for (workerIdx = 0; CPA_STATUS_SUCCESS == stat && workerIdx < numWorkers; workerIdx++)
+    {
+        stat = workerStart(&workers[workerIdx], benchRx, benchTx, &benches[workerIdx]);
+        CHECK_ERR_STATUS("workerStart", stat);
+        numStarted += (CPA_STATUS_SUCCESS == stat) ? 1 : 0;
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT("%u workers running %s on %u byte PDUs for %u s\n", numWorkers, algoName, pduSize, seconds);
+        sleep(seconds);
+    }
+    for (workerIdx = 0; workerIdx < numStarted; workerIdx++)
+    {
+        benches[workerIdx].sending = CPA_FALSE;
+    }
+    elapsed = (double)(nowNs() - start) / 1e9;
+    for (workerIdx = 0; workerIdx < numWorkers; workerIdx++)
+    {
+        workerStop(&workers[workerIdx]);
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT("%-8s %12s %10s %8s %8s %10s\n", "worker", "Mbps", "kops", "p50 us", "p99 us", "idle %");
+        for (workerIdx = 0; workerIdx < numWorkers; workerIdx++)
+        {
+            PRINT("%-8u %12.1f %10.1f %8u %8u %10.1f\n",
+                  workerIdx,
+                  (double)benches[workerIdx].numOps * pduSize * 8 / elapsed / 1e6,
+                  (double)benches[workerIdx].numOps / elapsed / 1e3,
+                  latencyPercentile(benches[workerIdx].latencyUs, benches[workerIdx].numOps, 0.50),
+                  latencyPercentile(benches[workerIdx].latencyUs, benches[workerIdx].numOps, 0.99),
+                  100.0 * (double)workers[workerIdx].numIdleLoops /
+                      (double)((0 < workers[workerIdx].numLoops) ? workers[workerIdx].numLoops : 1));
+            numOps += benches[workerIdx].numOps;
+            numErrors += benches[workerIdx].numErrors;
+        }
+        PRINT("%-8s %12.1f %10.1f\n",
+              "total",
+              (double)numOps * pduSize * 8 / elapsed / 1e6,
+              (double)numOps / elapsed / 1e3);
+        if (0 < numErrors)
+        {
+            PRINT_ERR("%llu ops failed\n", (unsigned long long)numErrors);
+            stat = CPA_STATUS_FAIL;
+        }
+    }
+
+    free(workers);
+    free(benches);
+    benchStop(NULL);
+
+    return stat;
+}
+
+/*
+ * Per-flow state of the skewed traffic. The producer side is written by the thread queueing PDUs, the
+ * consumer side by whichever worker owns the flow.
+ */
+typedef struct _StealFlow {
+    Cpa32U numProduced;
+    Cpa32U numCompleted __attribute__((aligned(RING_CACHE_LINE)));
+    Cpa32U nextCount;
+    Cpa64U numReordered;
+} __attribute__((aligned(RING_CACHE_LINE))) StealFlow;
+
+typedef struct _StealWorker {
+    Cpa64U numOps;
+    Cpa64U numErrors;
+} __attribute__((aligned(RING_CACHE_LINE))) StealWorker;
+
+typedef struct _StealBench {
+    WorkerGroup *group;
+    StealFlow flows[WORKER_MAX_FLOWS];
+    StealWorker workers[MAX_INSTANCES];
+} StealBench;
+
+/* What a round of the stealing run is compared on */
+typedef struct _StealResult {
+    double kops;
+    double imbalance; /* share of the busiest worker over its fair share, in percentage points */
+} StealResult;
+
+static void stealTx(Worker *worker, const PdcpDesc *descs, Cpa32U numDescs, void *arg)
+{
+    StealBench *bench = (StealBench *)arg;
+    StealWorker *stealWorker = &bench->workers[worker - bench->group->workers];
+    StealFlow *flow = NULL;
+    Cpa32U descIdx = 0;
+
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        flow = &bench->flows[descs[descIdx].sessionId];
+        if (descs[descIdx].count != flow->nextCount)
+        {
+            flow->numReordered++;
+        }
+        flow->nextCount = descs[descIdx].count + 1;
+        if (CPA_STATUS_SUCCESS != descs[descIdx].status)
+        {
+            stealWorker->numErrors++;
+        }
+        stealWorker->numOps++;
+        __atomic_store_n(&flow->numCompleted, flow->numCompleted + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/*
+ * Offer rate PDUs per second for seconds, skewPercent of them on the flows homed on worker 0, then wait for all
+ * of them; a rate of 0 offers PDUs as fast as they can be queued. The traffic is open-loop: a PDU drawn for a
+ * flow that is full is dropped rather than drawn again elsewhere, so that the skew offered is the one asked for
+ * whatever the workers keep up with.
+ */
+static CpaStatus runStealRound(const AlgoDesc *algoDesc,
+                               Cpa32U numWorkers,
+                               Cpa32U skewPercent,
+                               Cpa32U seconds,
+                               Cpa8U *region,
+                               Cpa32U regionSize,
+                               Cpa32U slotSize,
+                               Cpa64U rate,
+                               CpaBoolean stealing,
+                               StealResult *result)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    WorkerGroup *group = NULL;
+    StealBench *bench = NULL;
+    StealFlow *flow = NULL;
+    PdcpDesc desc = {0};
+    Cpa32U numFlows = numWorkers * WORKER_BENCH_SESSIONS;
+    Cpa32U flowIdx = 0;
+    Cpa32U workerIdx = 0;
+    Cpa32U random = 0x2545f491;
+    Cpa64U numOps = 0;
+    Cpa64U numErrors = 0;
+    Cpa64U numReordered = 0;
+    Cpa64U numOffered = 0;
+    Cpa64U numOfferedHot = 0;
+    Cpa64U numDropped = 0;
+    Cpa64U maxOps = 0;
+    Cpa64U start = 0;
+    Cpa64U end = 0;
+    Cpa64U now = 0;
+    double elapsed = 0;
+
+    group = benchAlloc(sizeof(WorkerGroup));
+    bench = benchAlloc(sizeof(StealBench));
+    if (NULL == group || NULL == bench)
+    {
+        free(group);
+        free(bench);
+        return CPA_STATUS_RESOURCE;
+    }
+    bench->group = group;
+
+    stat = workerGroupInit(group, numWorkers, region, regionSize, stealing);
+    for (flowIdx = 0; CPA_STATUS_SUCCESS == stat && flowIdx < numFlows; flowIdx++)
+    {
+        stat = benchAddFlow(group, algoDesc, (Cpa8U)(flowIdx % 32), ENGINE_CLASS_BULK);
+    }
+    CHECK_ERR_STATUS("workerGroupAddFlow", stat);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = workerGroupStart(group, stealTx, bench);
+    }
+
+    start = nowNs();
+    end = start + (Cpa64U)seconds * 1000000000ULL;
+    while (CPA_STATUS_SUCCESS == stat && (now = nowNs()) < end)
+    {
+        if (0 < rate && numOffered >= (now - start) * rate / 1000000000ULL)
+        {
+            continue;
+        }
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        if (random % 100 < skewPercent)
+        {
+            /* Flows of worker 0 are the ones numbered 0, numWorkers, 2 * numWorkers... */
+            flowIdx = (random / 100) % WORKER_BENCH_SESSIONS * numWorkers;
+        }
+        else
+        {
+            flowIdx = (random / 100) % numFlows;
+        }
+        numOffered++;
+        if (0 == flowIdx % numWorkers)
+        {
+            numOfferedHot++;
+        }
+
+        flow = &bench->flows[flowIdx];
+        if (WORKER_FLOW_DEPTH <= flow->numProduced - __atomic_load_n(&flow->numCompleted, __ATOMIC_ACQUIRE))
+        {
+            numDropped++;
+            continue;
+        }
+        desc.count = flow->numProduced;
+        desc.offset =
+            (flowIdx * WORKER_FLOW_DEPTH + flow->numProduced % WORKER_FLOW_DEPTH) * slotSize + ENGINE_OP_HEADROOM;
+        desc.length = WORKER_BENCH_PDU_SIZE;
+        desc.userTag = flowIdx;
+        if (1 == workerGroupEnqueue(group, flowIdx, &desc, 1))
+        {
+            flow->numProduced++;
+        }
+        else
+        {
+            numDropped++;
+        }
+    }
+
+    /* Let every queued PDU complete before stopping */
+    for (flowIdx = 0; CPA_STATUS_SUCCESS == stat && flowIdx < numFlows; flowIdx++)
+    {
+        flow = &bench->flows[flowIdx];
+        while (flow->numProduced != __atomic_load_n(&flow->numCompleted, __ATOMIC_ACQUIRE))
+        {
+            OS_SLEEP(1);
+        }
+    }
+    elapsed = (double)(nowNs() - start) / 1e9;
+    workerGroupFree(group);
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        if (0 == rate)
+        {
+            PRINT("Stealing %s, as fast as PDUs can be queued:\n", (CPA_TRUE == stealing) ? "on" : "off");
+        }
+        else
+        {
+            PRINT("Stealing %s, %.1f kops offered:\n", (CPA_TRUE == stealing) ? "on" : "off", (double)rate / 1e3);
+        }
+        PRINT("%-8s %10s %8s %8s %10s\n", "worker", "kops", "share %", "steals", "handoffs");
+        for (workerIdx = 0; workerIdx < group->numWorkers; workerIdx++)
+        {
+            numOps += bench->workers[workerIdx].numOps;
+            numErrors += bench->workers[workerIdx].numErrors;
+            if (maxOps < bench->workers[workerIdx].numOps)
+            {
+                maxOps = bench->workers[workerIdx].numOps;
+            }
+        }
+        for (workerIdx = 0; workerIdx < group->numWorkers; workerIdx++)
+        {
+            PRINT("%-8u %10.1f %8.1f %8llu %10llu\n",
+                  workerIdx,
+                  (double)bench->workers[workerIdx].numOps / elapsed / 1e3,
+                  100.0 * (double)bench->workers[workerIdx].numOps / (double)((0 < numOps) ? numOps : 1),
+                  (unsigned long long)group->workers[workerIdx].numSteals,
+                  (unsigned long long)group->workers[workerIdx].numHandoffs);
+        }
+        for (flowIdx = 0; flowIdx < numFlows; flowIdx++)
+        {
+            numReordered += bench->flows[flowIdx].numReordered;
+        }
+        PRINT("%-8s %10.1f, %.1f Mbps, %llu out of order\n",
+              "total",
+              (double)numOps / elapsed / 1e3,
+              (double)numOps * WORKER_BENCH_PDU_SIZE * 8 / elapsed / 1e6,
+              (unsigned long long)numReordered);
+        PRINT("%.1f%% offered to worker 0, %.1f%% dropped on full flows\n",
+              100.0 * (double)numOfferedHot / (double)((0 < numOffered) ? numOffered : 1),
+              100.0 * (double)numDropped / (double)((0 < numOffered) ? numOffered : 1));
+        result->kops = (double)numOps / elapsed / 1e3;
+        result->imbalance = 100.0 * (double)maxOps / (double)((0 < numOps) ? numOps : 1) - 100.0 / numWorkers;
+        if (0 < numErrors || 0 < numReordered)
+        {
+            PRINT_ERR("%llu ops failed, %llu out of order\n",
+                      (unsigned long long)numErrors,
+                      (unsigned long long)numReordered);
+            stat = CPA_STATUS_FAIL;
+        }
+    }
+
+    free(group);
+    free(bench);
+    return stat;
+}
+
+CpaStatus runWorkerSteal(const char *algoName, Cpa32U numWorkers, Cpa32U skewPercent, Cpa32U seconds)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = findAlgoDesc(algoName);
+    StealResult capacity = {0};
+    StealResult off = {0};
+    StealResult on = {0};
+    Cpa64U rate = 0;
+    Cpa8U *region = NULL;
+    Cpa32U slotSize = 0;
+    Cpa32U regionSize = 0;
+
+    if (NULL == algoDesc || 100 < skewPercent || 0 == seconds)
+    {
+        PRINT_ERR("Invalid work stealing parameters\n");
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    stat = benchStart("Work stealing", 2, &numWorkers);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+
+    /* Every flow has a buffer per PDU it may have outstanding */
+    stat = benchAllocRegion(
+        numWorkers * WORKER_BENCH_SESSIONS * WORKER_FLOW_DEPTH, WORKER_BENCH_PDU_SIZE, &region, &regionSize, &slotSize);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT("%u workers, %u%% of the %s traffic on the flows of worker 0, %u s per round\n",
+              numWorkers,
+              skewPercent,
+              algoName,
+              seconds);
+        /* Uniform traffic as fast as it goes first, for the capacity the skewed rounds are offered a share of */
+        stat = runStealRound(algoDesc, numWorkers, 0, seconds, region, regionSize, slotSize, 0, CPA_FALSE, &capacity);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        rate = (Cpa64U)(capacity.kops * 1e3 * WORKER_STEAL_LOAD / 100);
+        stat = runStealRound(
+            algoDesc, numWorkers, skewPercent, seconds, region, regionSize, slotSize, rate, CPA_FALSE, &off);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = runStealRound(
+            algoDesc, numWorkers, skewPercent, seconds, region, regionSize, slotSize, rate, CPA_TRUE, &on);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT("With stealing: throughput %+.1f%%, busiest worker %.1f -> %.1f points over its fair share\n",
+              100.0 * (on.kops - off.kops) / ((0 < off.kops) ? off.kops : 1),
+              off.imbalance,
+              on.imbalance);
+    }
+
+    benchStop(&region);
+    return stat;
+}
+
+/*
+ * Flows of the QoS run: the producer side is written by the thread queueing PDUs, the consumer side by the
+ * worker. Latency is counted per traffic class.
+ */
+typedef struct _QosFlow {
+    Cpa32U trafficClass;
+    Cpa32U pduSize;
+    Cpa32U numProduced;
+    Cpa32U numCompleted __attribute__((aligned(RING_CACHE_LINE)));
+} __attribute__((aligned(RING_CACHE_LINE))) QosFlow;
+
+typedef struct _QosClass {
+    Cpa64U numOps;
+    Cpa64U numErrors;
+    Cpa64U latencyUs[WORKER_BENCH_MAX_US + 1];
+} QosClass;
+
+typedef struct _QosBench {
+    QosFlow flows[WORKER_QOS_BULK_FLOWS + 2];
+    QosClass classes[ENGINE_NUM_CLASSES];
+} QosBench;
+
+static const char *className(Cpa32U trafficClass)
+{
+    switch (trafficClass)
+    {
+        case ENGINE_CLASS_SIGNALLING:
+            return "signalling";
+        case ENGINE_CLASS_LOW_LATENCY:
+            return "low latency";
+        default:
+            return "bulk";
+    }
+}
+
+static void qosTx(Worker *worker, const PdcpDesc *descs, Cpa32U numDescs, void *arg)
+{
+    QosBench *bench = (QosBench *)arg;
+    QosFlow *flow = NULL;
+    QosClass *qosClass = NULL;
+    Cpa64U now = nowNs();
+    Cpa64U latencyUs = 0;
+    Cpa32U descIdx = 0;
+
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        flow = &bench->flows[descs[descIdx].sessionId];
+        qosClass = &bench->classes[flow->trafficClass];
+        if (CPA_STATUS_SUCCESS != descs[descIdx].status)
+        {
+            qosClass->numErrors++;
+        }
+        else
+        {
+            latencyUs = (now - descs[descIdx].userTag) / 1000;
+            qosClass->latencyUs[(WORKER_BENCH_MAX_US < latencyUs) ? WORKER_BENCH_MAX_US : latencyUs]++;
+            qosClass->numOps++;
+        }
+        __atomic_store_n(&flow->numCompleted, flow->numCompleted + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/*
+ * Queue a PDU on a flow unless it has WORKER_FLOW_DEPTH of them outstanding; userTag holds the queueing time
+ */
+static void qosEnqueue(WorkerGroup *group, QosBench *bench, Cpa32U flowIdx, Cpa32U slotSize)
+{
+    QosFlow *flow = &bench->flows[flowIdx];
+    PdcpDesc desc = {0};
+
+    if (WORKER_FLOW_DEPTH <= flow->numProduced - __atomic_load_n(&flow->numCompleted, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+    desc.count = flow->numProduced;
+    desc.offset = (flowIdx * WORKER_FLOW_DEPTH + flow->numProduced % WORKER_FLOW_DEPTH) * slotSize + ENGINE_OP_HEADROOM;
+    desc.length = flow->pduSize;
+    desc.userTag = nowNs();
+    if (1 == workerGroupEnqueue(group, flowIdx, &desc, 1))
+    {
+        flow->numProduced++;
+    }
+}
+
+static CpaStatus runQosRound(const AlgoDesc *algoDesc,
+                             Cpa32U seconds,
+                             Cpa8U *region,
+                             Cpa32U regionSize,
+                             Cpa32U slotSize,
+                             CpaBoolean classes)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    WorkerGroup *group = NULL;
+    QosBench *bench = NULL;
+    QosClass *qosClass = NULL;
+    Cpa32U numFlows = WORKER_QOS_BULK_FLOWS + 2;
+    Cpa32U flowIdx = 0;
+    Cpa32U classIdx = 0;
+    Cpa64U start = 0;
+    Cpa64U end = 0;
+    Cpa64U nextPaced = 0;
+    double elapsed = 0;
+
+    group = benchAlloc(sizeof(WorkerGroup));
+    bench = benchAlloc(sizeof(QosBench));
+    if (NULL == group || NULL == bench)
+    {
+        free(group);
+        free(bench);
+        return CPA_STATUS_RESOURCE;
+    }
+
+    /* Flow 0 is the signalling flow, flow 1 the low latency one, the others are bulk */
+    for (flowIdx = 0; flowIdx < numFlows; flowIdx++)
+    {
+        bench->flows[flowIdx].trafficClass =
+            (0 == flowIdx) ? ENGINE_CLASS_SIGNALLING : (1 == flowIdx) ? ENGINE_CLASS_LOW_LATENCY : ENGINE_CLASS_BULK;
+        bench->flows[flowIdx].pduSize = (0 == flowIdx)   ? WORKER_QOS_SIGNALLING_PDU_SIZE
+                                        : (1 == flowIdx) ? WORKER_QOS_LOW_LATENCY_PDU_SIZE
+                                                         : WORKER_QOS_BULK_PDU_SIZE;
+    }
+
+    stat = workerGroupInit(group, 1, region, regionSize, CPA_FALSE);
+    for (flowIdx = 0; CPA_STATUS_SUCCESS == stat && flowIdx < numFlows; flowIdx++)
+    {
+        stat = benchAddFlow(group,
+                            algoDesc,
+                            (Cpa8U)flowIdx,
+                            (CPA_TRUE == classes) ? bench->flows[flowIdx].trafficClass : ENGINE_CLASS_BULK);
+    }
+    CHECK_ERR_STATUS("workerGroupAddFlow", stat);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = workerGroupStart(group, qosTx, bench);
+    }
+
+    /* Bulk flows are kept full, the other two get a PDU every WORKER_QOS_INTERVAL_US */
+    start = nowNs();
+    end = start + (Cpa64U)seconds * 1000000000ULL;
+    nextPaced = start;
+    while (CPA_STATUS_SUCCESS == stat && nowNs() < end)
+    {
+        for (flowIdx = 2; flowIdx < numFlows; flowIdx++)
+        {
+            qosEnqueue(group, bench, flowIdx, slotSize);
+        }
+        if (nowNs() >= nextPaced)
+        {
+            qosEnqueue(group, bench, 0, slotSize);
+            qosEnqueue(group, bench, 1, slotSize);
+            nextPaced += WORKER_QOS_INTERVAL_US * 1000ULL;
+        }
+        usleep(WORKER_QOS_INTERVAL_US / 4);
+    }
+
+    for (flowIdx = 0; CPA_STATUS_SUCCESS == stat && flowIdx < numFlows; flowIdx++)
+    {
+        while (bench->flows[flowIdx].numProduced !=
+               __atomic_load_n(&bench->flows[flowIdx].numCompleted, __ATOMIC_ACQUIRE))
+        {
+            OS_SLEEP(1);
+        }
+    }
+    elapsed = (double)(nowNs() - start) / 1e9;
+    workerGroupFree(group);
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT("Traffic classes %s:\n", (CPA_TRUE == classes) ? "on" : "off");
+        PRINT("%-12s %10s %8s %8s\n", "class", "kops", "p50 us", "p99 us");
+        for (classIdx = ENGINE_NUM_CLASSES; 0 < classIdx--;)
+        {
+            qosClass = &bench->classes[classIdx];
+            PRINT("%-12s %10.1f %8u %8u\n",
+                  className(classIdx),
+                  (double)qosClass->numOps / elapsed / 1e3,
+                  latencyPercentile(qosClass->latencyUs, qosClass->numOps, 0.50),
+                  latencyPercentile(qosClass->latencyUs, qosClass->numOps, 0.99));
+            if (0 < qosClass->numErrors)
+            {
+                PRINT_ERR("%llu %s ops failed\n", (unsigned long long)qosClass->numErrors, className(classIdx));
+                stat = CPA_STATUS_FAIL;
+            }
+        }
+    }
+
+    free(group);
+    free(bench);
+    return stat;
+}
+
+CpaStatus runWorkerQos(const char *algoName, Cpa32U seconds)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = findAlgoDesc(algoName);
+    Cpa8U *region = NULL;
+    Cpa32U slotSize = 0;
+    Cpa32U regionSize = 0;
+
+    if (NULL == algoDesc || 0 == seconds)
+    {
+        PRINT_ERR("Invalid QoS parameters\n");
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    stat = benchStart("QoS", 1, NULL);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+
+    stat = benchAllocRegion((WORKER_QOS_BULK_FLOWS + 2) * WORKER_FLOW_DEPTH,
+                            WORKER_QOS_BULK_PDU_SIZE,
+                            &region,
+                            &regionSize,
+                            &slotSize);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT("%u bulk flows of %s saturating one worker, a signalling and a low latency flow every %u us, %u s "
+              "per round\n",
+              WORKER_QOS_BULK_FLOWS,
+              algoName,
+              WORKER_QOS_INTERVAL_US,
+              seconds);
+        stat = runQosRound(algoDesc, seconds, region, regionSize, slotSize, CPA_FALSE);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = runQosRound(algoDesc, seconds, region, regionSize, slotSize, CPA_TRUE);
+    }
+
+    benchStop(&region);
+    return stat;
+}
+
+/*
+ * Bearers of the reorder run. Their PDUs are spread over lanes, one flow per worker, so that completions of a
+ * bearer come back from every worker in whatever order the instances finish them. numArrived is counted by the
+ * workers, the rest by the thread queueing and releasing PDUs.
+ */
+typedef struct _ReorderFlow {
+    Cpa32U numProduced;
+    Cpa32U nextDelivered;
+    Cpa64U numMisordered;
+    Cpa32U numArrived __attribute__((aligned(RING_CACHE_LINE)));
+    Cpa64U numOutOfOrder;
+    Cpa64U numLost;
+    Cpa64U numErrors;
+} __attribute__((aligned(RING_CACHE_LINE))) ReorderFlow;
+
+typedef struct _ReorderBench {
+    ReorderStage stage;
+    ReorderFlow bearers[WORKER_BENCH_SESSIONS];
+    Cpa32U numWorkers;
+} ReorderBench;
+
+static void reorderTx(Worker *worker, const PdcpDesc *descs, Cpa32U numDescs, void *arg)
+{
+    ReorderBench *bench = (ReorderBench *)arg;
+    ReorderFlow *bearer = NULL;
+    Cpa32U bearerIdx = 0;
+    Cpa32U descIdx = 0;
+
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        bearerIdx = descs[descIdx].sessionId / bench->numWorkers;
+        bearer = &bench->bearers[bearerIdx];
+        if (descs[descIdx].count != __atomic_fetch_add(&bearer->numArrived, 1, __ATOMIC_RELAXED))
+        {
+            __atomic_fetch_add(&bearer->numOutOfOrder, 1, __ATOMIC_RELAXED);
+        }
+        if (WORKER_REORDER_LOSS - 1 == descs[descIdx].count % WORKER_REORDER_LOSS)
+        {
+            /* Stands for a PDU lost on the way, for the reorder stage to give up on */
+            __atomic_fetch_add(&bearer->numLost, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (CPA_STATUS_SUCCESS != descs[descIdx].status ||
+            CPA_STATUS_SUCCESS != reorderInsert(&bench->stage, bearerIdx, &descs[descIdx]))
+        {
+            __atomic_fetch_add(&bearer->numErrors, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void reorderDeliver(Cpa32U bearerIdx, const PdcpDesc *descs, Cpa32U numDescs, void *arg)
+{
+    ReorderBench *bench = (ReorderBench *)arg;
+    ReorderFlow *bearer = &bench->bearers[bearerIdx];
+    Cpa32U descIdx = 0;
+
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        /* Skipped COUNTs are the only gaps allowed */
+        if (0 > (Cpa32S)(descs[descIdx].count - bearer->nextDelivered))
+        {
+            bearer->numMisordered++;
+        }
+        bearer->nextDelivered = descs[descIdx].count + 1;
+    }
+}
+
+CpaStatus runWorkerReorder(const char *algoName, Cpa32U numWorkers, Cpa32U seconds)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = findAlgoDesc(algoName);
+    WorkerGroup *group = NULL;
+    ReorderBench *bench = NULL;
+    ReorderFlow *bearer = NULL;
+    ReorderStats stats = {0};
+    PdcpDesc desc = {0};
+    Cpa8U *region = NULL;
+    Cpa32U slotSize = 0;
+    Cpa32U regionSize = 0;
+    Cpa32U bearerIdx = 0;
+    Cpa32U laneIdx = 0;
+    Cpa32U flowIdx = 0;
+    CpaBoolean lostTail = CPA_FALSE;
+    Cpa64U numOutOfOrder = 0;
+    Cpa64U numMisordered = 0;
+    Cpa64U numLost = 0;
+    Cpa64U numErrors = 0;
+    Cpa64U start = 0;
+    Cpa64U end = 0;
+    double elapsed = 0;
+
+    if (NULL == algoDesc || 0 == seconds)
+    {
+        PRINT_ERR("Invalid reorder parameters\n");
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    stat = benchStart("Reordering", 2, &numWorkers);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+
+    group = benchAlloc(sizeof(WorkerGroup));
+    bench = benchAlloc(sizeof(ReorderBench));
+    stat = (NULL == group || NULL == bench) ? CPA_STATUS_RESOURCE : CPA_STATUS_SUCCESS;
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        bench->numWorkers = numWorkers;
+        stat = reorderInit(&bench->stage,
+                           WORKER_BENCH_SESSIONS,
+                           REORDER_DEFAULT_WINDOW,
+                           REORDER_DEFAULT_TIMEOUT_US,
+                           reorderDeliver,
+                           bench);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = benchAllocRegion(
+            WORKER_BENCH_SESSIONS * REORDER_DEFAULT_WINDOW, WORKER_BENCH_PDU_SIZE, &region, &regionSize, &slotSize);
+    }
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        free(group);
+        if (NULL != bench)
+        {
+            reorderFree(&bench->stage);
+        }
+        free(bench);
+        benchStop(&region);
+        return stat;
+    }
+
+    /* Flow bearer * numWorkers + lane is homed on worker lane, and stays there */
+    stat = workerGroupInit(group, numWorkers, region, regionSize, CPA_FALSE);
+    for (flowIdx = 0; CPA_STATUS_SUCCESS == stat && flowIdx < WORKER_BENCH_SESSIONS * numWorkers; flowIdx++)
+    {
+        stat = benchAddFlow(group, algoDesc, (Cpa8U)(flowIdx / numWorkers), ENGINE_CLASS_BULK);
+    }
+    CHECK_ERR_STATUS("workerGroupAddFlow", stat);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = workerGroupStart(group, reorderTx, bench);
+    }
+
+    /* PDU count of a bearer goes to lane count % numWorkers, in a buffer that is free once it was released */
+    PRINT("%u bearers of %s spread over %u workers, one completion in %u lost, %u s\n",
+          WORKER_BENCH_SESSIONS,
+          algoName,
+          numWorkers,
+          WORKER_REORDER_LOSS,
+          seconds);
+    start = nowNs();
+    end = start + (Cpa64U)seconds * 1000000000ULL;
+    /* A lost PDU is only given up on once a later one of its bearer arrived, so that no bearer ends on one */
+    while (CPA_STATUS_SUCCESS == stat && (nowNs() < end || CPA_TRUE == lostTail))
+    {
+        lostTail = CPA_FALSE;
+        for (bearerIdx = 0; bearerIdx < WORKER_BENCH_SESSIONS; bearerIdx++)
+        {
+            bearer = &bench->bearers[bearerIdx];
+            if (WORKER_REORDER_LOSS - 1 == (bearer->numProduced - 1) % WORKER_REORDER_LOSS)
+            {
+                lostTail = CPA_TRUE;
+            }
+            if (WORKER_REORDER_DEPTH <= bearer->numProduced - bench->stage.bearers[bearerIdx].nextCount)
+            {
+                continue;
+            }
+            desc.count = bearer->numProduced;
+            desc.offset = (bearerIdx * REORDER_DEFAULT_WINDOW + desc.count % REORDER_DEFAULT_WINDOW) * slotSize +
+                          ENGINE_OP_HEADROOM;
+            desc.length = WORKER_BENCH_PDU_SIZE;
+            desc.userTag = bearerIdx;
+            laneIdx = desc.count % numWorkers;
+            if (1 == workerGroupEnqueue(group, bearerIdx * numWorkers + laneIdx, &desc, 1))
+            {
+                bearer->numProduced++;
+            }
+        }
+        reorderRelease(&bench->stage);
+    }
+
+    /* Release what is still in flight, lost PDUs included once they timed out */
+    for (bearerIdx = 0; CPA_STATUS_SUCCESS == stat && bearerIdx < WORKER_BENCH_SESSIONS; bearerIdx++)
+    {
+        while (bench->bearers[bearerIdx].numProduced != bench->stage.bearers[bearerIdx].nextCount)
+        {
+            if (0 == reorderRelease(&bench->stage))
+            {
+                OS_SLEEP(1);
+            }
+        }
+    }
+    elapsed = (double)(nowNs() - start) / 1e9;
+    workerGroupFree(group);
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        reorderGetStats(&bench->stage, &stats);
+        for (bearerIdx = 0; bearerIdx < WORKER_BENCH_SESSIONS; bearerIdx++)
+        {
+            bearer = &bench->bearers[bearerIdx];
+            numOutOfOrder += bearer->numOutOfOrder;
+            numMisordered += bearer->numMisordered;
+            numLost += bearer->numLost;
+            numErrors += bearer->numErrors;
+        }
+        PRINT("%-24s %12.1f\n", "kops", (double)stats.numDelivered / elapsed / 1e3);
+        PRINT("%-24s %12llu\n", "Completed out of order", (unsigned long long)numOutOfOrder);
+        PRINT("%-24s %12llu\n", "Delivered", (unsigned long long)stats.numDelivered);
+        PRINT("%-24s %12llu\n", "Delivered out of order", (unsigned long long)numMisordered);
+        PRINT("%-24s %12llu\n", "Lost", (unsigned long long)numLost);
+        PRINT("%-24s %12llu\n", "Skipped after timeout", (unsigned long long)stats.numSkipped);
+        if (0 < numErrors || 0 < numMisordered || numLost != stats.numSkipped)
+        {
+            PRINT_ERR("%llu ops failed, %llu delivered out of order, %llu lost but %llu skipped\n",
+                      (unsigned long long)numErrors,
+                      (unsigned long long)numMisordered,
+                      (unsigned long long)numLost,
+                      (unsigned long long)stats.numSkipped);
+            stat = CPA_STATUS_FAIL;
+        }
+    }
+
+    reorderFree(&bench->stage);
+    free(group);
+    free(bench);
+    benchStop(&region);
+    return stat;
+}
+
+/*
+ * Open-loop traffic of the batching run: PDUs are due at a fixed rate, and their latency counts from when they
+ * were due. PDUs that would overflow the buffers of a worker falling behind are counted as missed.
+ */
+typedef struct _BatchBench {
+    Cpa32U sessionId;
+    Cpa64U rate;
+    Cpa64U startNs;
+    Cpa64U numDue;
+    Cpa64U numMissed;
+    volatile CpaBoolean sending;
+    Cpa64U numOps;
+    Cpa64U numErrors;
+    Cpa64U latencyUs[WORKER_BENCH_MAX_US + 1];
+    DescRing *queue; /* of the idle run, PDUs handed over by another thread */
+} __attribute__((aligned(RING_CACHE_LINE))) BatchBench;
+
+static Cpa32U batchBenchRx(Worker *worker, PdcpDesc *descs, Cpa32U maxDescs, void *arg)
+{
+    BatchBench *bench = (BatchBench *)arg;
+    Cpa64U due = 0;
+    Cpa32U numDescs = 0;
+    Cpa32U offset = 0;
+
+    if (CPA_TRUE != bench->sending)
+    {
+        return 0;
+    }
+    due = (nowNs() - bench->startNs) * bench->rate / 1000000000ULL;
+    if (due - bench->numDue > WORKER_NUM_BUFFERS)
+    {
+        bench->numMissed += due - bench->numDue - WORKER_NUM_BUFFERS;
+        bench->numDue = due - WORKER_NUM_BUFFERS;
+    }
+    while (bench->numDue < due && numDescs < maxDescs && NULL != workerAllocBuffer(worker, &offset))
+    {
+        memset(&descs[numDescs], 0, sizeof(PdcpDesc));
+        /* PDU n is due once n + 1 PDUs were */
+        descs[numDescs].userTag = bench->startNs + (bench->numDue + 1) * 1000000000ULL / bench->rate;
+        descs[numDescs].sessionId = bench->sessionId;
+        descs[numDescs].count = (Cpa32U)bench->numDue++;
+        descs[numDescs].offset = offset;
+        descs[numDescs].length = WORKER_BATCH_PDU_SIZE;
+        numDescs++;
+    }
+    return numDescs;
+}
+
+static void batchBenchTx(Worker *worker, const PdcpDesc *descs, Cpa32U numDescs, void *arg)
+{
+    BatchBench *bench = (BatchBench *)arg;
+    Cpa64U now = nowNs();
+    Cpa64U latencyUs = 0;
+    Cpa32U descIdx = 0;
+
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        /* Under overload the worker may stop with PDUs the instance never took */
+        if (CPA_STATUS_RETRY == descs[descIdx].status)
+        {
+            bench->numMissed++;
+            continue;
+        }
+        if (CPA_STATUS_SUCCESS != descs[descIdx].status)
+        {
+            bench->numErrors++;
+            continue;
+        }
+        latencyUs = (now - descs[descIdx].userTag) / 1000;
+        bench->latencyUs[(WORKER_BENCH_MAX_US < latencyUs) ? WORKER_BENCH_MAX_US : latencyUs]++;
+        bench->numOps++;
+    }
+}
+
+static const char *batchModeName(Cpa32U mode)
+{
+    switch (mode)
+    {
+        case BATCH_IMMEDIATE:
+            return "immediate";
+        case BATCH_FIXED:
+            return "fixed";
+        default:
+            return "adaptive";
+    }
+}
+
+/*
+ * One worker on one bearer at rate PDUs per second for seconds, batching in mode
+ */
+static CpaStatus runBatchRound(const AlgoDesc *algoDesc,
+                               Cpa32U mode,
+                               Cpa32U targetUs,
+                               Cpa64U rate,
+                               Cpa32U seconds)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Worker *worker = NULL;
+    BatchBench *bench = NULL;
+    Cpa64U start = 0;
+    double elapsed = 0;
+
+    worker = benchAlloc(sizeof(Worker));
+    bench = benchAlloc(sizeof(BatchBench));
+    if (NULL == worker || NULL == bench)
+    {
+        free(worker);
+        free(bench);
+        return CPA_STATUS_RESOURCE;
+    }
+
+    workerInit(worker, 0);
+    batchInit(&worker->batch, mode, WORKER_BURST_SIZE, targetUs);
+    stat = benchCreateSession(worker, algoDesc, 0, &bench->sessionId);
+    CHECK_ERR_STATUS("workerCreateSession", stat);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        bench->rate = rate;
+        bench->startNs = nowNs();
+        bench->sending = CPA_TRUE;
+        start = bench->startNs;
+        stat = workerStart(worker, batchBenchRx, batchBenchTx, bench);
+        CHECK_ERR_STATUS("workerStart", stat);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        sleep(seconds);
+        bench->sending = CPA_FALSE;
+        elapsed = (double)(nowNs() - start) / 1e9;
+    }
+    workerStop(worker);
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT("%-10s %10.1f %10.1f %8u %8u %10.1f %10.1f %8.2f\n",
+              batchModeName(mode),
+              (double)rate / 1e3,
+              (double)bench->numOps / elapsed / 1e3,
+              latencyPercentile(bench->latencyUs, bench->numOps, 0.50),
+              latencyPercentile(bench->latencyUs, bench->numOps, 0.99),
+              (double)worker->numRx / (double)((0 < worker->numBatches) ? worker->numBatches : 1),
+              (double)worker->numPolls / (double)((0 < worker->numTx) ? worker->numTx : 1),
+              100.0 * (double)bench->numMissed / (double)((0 < bench->numDue) ? bench->numDue : 1));
+        if (0 < bench->numErrors)
+        {
+            PRINT_ERR("%llu ops failed\n", (unsigned long long)bench->numErrors);
+            stat = CPA_STATUS_FAIL;
+        }
+    }
+
+    free(worker);
+    free(bench);
+    return stat;
+}
+
+CpaStatus runWorkerBatching(const char *algoName, Cpa32U targetUs, Cpa32U seconds)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = findAlgoDesc(algoName);
+    Cpa64U rates[] = {WORKER_BATCH_LOW_RATE, WORKER_BATCH_HIGH_RATE, WORKER_BATCH_OVERLOAD_RATE};
+    Cpa32U modes[] = {BATCH_IMMEDIATE, BATCH_FIXED, BATCH_ADAPTIVE};
+    Cpa32U rateIdx = 0;
+    Cpa32U modeIdx = 0;
+
+    if (NULL == algoDesc || 0 == targetUs || 0 == seconds)
+    {
+        PRINT_ERR("Invalid batching parameters\n");
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    stat = benchStart("Batching", 1, NULL);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+
+    PRINT("One worker on %u byte PDUs of %s, latency target %u us, %u s per round\n",
+          WORKER_BATCH_PDU_SIZE,
+          algoName,
+          targetUs,
+          seconds);
+    PRINT("%-10s %10s %10s %8s %8s %10s %10s %8s\n",
+          "batching",
+          "offered k",
+          "kops",
+          "p50 us",
+          "p99 us",
+          "per batch",
+          "polls/op",
+          "missed %");
+    for (rateIdx = 0; CPA_STATUS_SUCCESS == stat && rateIdx < sizeof(rates) / sizeof(rates[0]); rateIdx++)
+    {
+        for (modeIdx = 0; CPA_STATUS_SUCCESS == stat && modeIdx < sizeof(modes) / sizeof(modes[0]); modeIdx++)
+        {
+            stat = runBatchRound(algoDesc, modes[modeIdx], targetUs, rates[rateIdx], seconds);
+        }
+    }
+
+    benchStop(NULL);
+    return stat;
+}
+
+/*
+ * Synthetic traffic of a worker of the failover run, with the completions of every bearer timed. numOps is
+ * read by the thread printing the timeline.
+ */
+typedef struct _FailoverBench {
+    Cpa32U sessionIds[WORKER_BENCH_SESSIONS];
+    Cpa32U counts[WORKER_BENCH_SESSIONS];
+    Cpa64U numDone[WORKER_BENCH_SESSIONS];
+    Cpa64U numErrors[WORKER_BENCH_SESSIONS];
+    Cpa64U lastDoneNs[WORKER_BENCH_SESSIONS];
+    Cpa64U maxGapNs[WORKER_BENCH_SESSIONS];
+    Cpa32U nextSession;
+    Cpa32U numInflight;
+    volatile CpaBoolean sending;
+    Cpa64U numOps;
+} __attribute__((aligned(RING_CACHE_LINE))) FailoverBench;
+
+static Cpa32U failoverRx(Worker *worker, PdcpDesc *descs, Cpa32U maxDescs, void *arg)
+{
+    FailoverBench *bench = (FailoverBench *)arg;
+    Cpa32U numDescs = 0;
+    Cpa32U session = 0;
+    Cpa32U offset = 0;
+
+    while (CPA_TRUE == bench->sending && numDescs < maxDescs && WORKER_BENCH_DEPTH > bench->numInflight &&
+           NULL != workerAllocBuffer(worker, &offset))
+    {
+        session = bench->nextSession++ % WORKER_BENCH_SESSIONS;
+        memset(&descs[numDescs], 0, sizeof(PdcpDesc));
+        descs[numDescs].userTag = session;
+        descs[numDescs].sessionId = bench->sessionIds[session];
+        descs[numDescs].count = bench->counts[session]++;
+        descs[numDescs].offset = offset;
+        descs[numDescs].length = WORKER_BENCH_PDU_SIZE;
+        bench->numInflight++;
+        numDescs++;
+    }
+    return numDescs;
+}
+
+static void failoverTx(Worker *worker, const PdcpDesc *descs, Cpa32U numDescs, void *arg)
+{
+    FailoverBench *bench = (FailoverBench *)arg;
+    Cpa64U now = nowNs();
+    Cpa32U session = 0;
+    Cpa32U descIdx = 0;
+
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        bench->numInflight--;
+        session = (Cpa32U)descs[descIdx].userTag;
+        if (CPA_STATUS_SUCCESS != descs[descIdx].status)
+        {
+            bench->numErrors[session]++;
+            continue;
+        }
+        if (now - bench->lastDoneNs[session] > bench->maxGapNs[session])
+        {
+            bench->maxGapNs[session] = now - bench->lastDoneNs[session];
+        }
+        bench->lastDoneNs[session] = now;
+        bench->numDone[session]++;
+        __atomic_store_n(&bench->numOps, bench->numOps + 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void printFailoverTick(const FailoverBench *benches, Cpa32U numWorkers, Cpa64U elapsedMs, Cpa64U *numOps)
+{
+    EngineStats stats = {0};
+    static Cpa64U numCpuOps = 0;
+    char states[MAX_INSTANCES * 10] = {0};
+    Cpa64U total = 0;
+    Cpa32U workerIdx = 0;
+    Cpa32U length = 0;
+
+    for (workerIdx = 0; workerIdx < numWorkers; workerIdx++)
+    {
+        total += __atomic_load_n(&benches[workerIdx].numOps, __ATOMIC_RELAXED);
+        length += snprintf(states + length,
+                           sizeof(states) - length,
+                           " %-8s",
+                           healthStateName(engineInstanceHealth(workerIdx)));
+    }
+    engineGetStats(&stats);
+    if (0 == elapsedMs)
+    {
+        numCpuOps = stats.numCpuOps;
+    }
+    PRINT("%6.1f %10.1f %10.1f%s\n",
+          (double)elapsedMs / 1000,
+          (double)(total - *numOps) / WORKER_FAILOVER_TICK_MS,
+          (double)(stats.numCpuOps - numCpuOps) / WORKER_FAILOVER_TICK_MS,
+          states);
+    *numOps = total;
+    numCpuOps = stats.numCpuOps;
+}
+
+CpaStatus runWorkerFailover(const char *algoName, Cpa32U seconds)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = findAlgoDesc(algoName);
+    Worker *workers = NULL;
+    FailoverBench *benches = NULL;
+    EngineStats stats = {0};
+    Cpa32U numWorkers = 0;
+    Cpa32U numStarted = 0;
+    Cpa32U numStalled = 0;
+    Cpa32U workerIdx = 0;
+    Cpa32U sessionIdx = 0;
+    Cpa64U numOps = 0;
+    Cpa64U start = 0;
+    Cpa64U end = 0;
+    Cpa64U tick = 0;
+    Cpa64U gapNs = 0;
+
+    if (NULL == algoDesc || 0 == seconds)
+    {
+        PRINT_ERR("Invalid failover parameters\n");
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    /* A worker per instance */
+    stat = benchStart("Failover", 1, &numWorkers);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+    workers = benchAlloc(numWorkers * sizeof(Worker));
+    benches = benchAlloc(numWorkers * sizeof(FailoverBench));
+    if (NULL == workers || NULL == benches)
+    {
+        free(workers);
+        free(benches);
+        benchStop(NULL);
+        return CPA_STATUS_RESOURCE;
+    }
+
+    for (workerIdx = 0; CPA_STATUS_SUCCESS == stat && workerIdx < numWorkers; workerIdx++)
+    {
+        benches[workerIdx].sending = CPA_TRUE;
+        stat = benchInitWorker(&workers[workerIdx], workerIdx, algoDesc, benches[workerIdx].sessionIds);
+    }
+
+    start = nowNs();
+    for (workerIdx = 0; workerIdx < numWorkers; workerIdx++)
+    {
+        for (sessionIdx = 0; sessionIdx < WORKER_BENCH_SESSIONS; sessionIdx++)
+        {
+            benches[workerIdx].lastDoneNs[sessionIdx] = start;
+        }
+    }
+    for (workerIdx = 0; CPA_STATUS_SUCCESS == stat && workerIdx < numWorkers; workerIdx++)
+    {
+        stat = workerStart(&workers[workerIdx], failoverRx, failoverTx, &benches[workerIdx]);
+        CHECK_ERR_STATUS("workerStart", stat);
+        numStarted += (CPA_STATUS_SUCCESS == stat) ? 1 : 0;
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT("%u workers running %s on %u byte PDUs for %u s\n", numWorkers, algoName, WORKER_BENCH_PDU_SIZE, seconds);
+        PRINT("%6s %10s %10s  health of every instance\n", "s", "kops", "cpu kops");
+        printFailoverTick(benches, numWorkers, 0, &numOps);
+        for (tick = 1; tick <= (Cpa64U)seconds * 1000 / WORKER_FAILOVER_TICK_MS; tick++)
+        {
+            OS_SLEEP(WORKER_FAILOVER_TICK_MS);
+            printFailoverTick(benches, numWorkers, tick * WORKER_FAILOVER_TICK_MS, &numOps);
+        }
+    }
+    for (workerIdx = 0; workerIdx < numStarted; workerIdx++)
+    {
+        benches[workerIdx].sending = CPA_FALSE;
+    }
+    for (workerIdx = 0; workerIdx < numWorkers; workerIdx++)
+    {
+        workerStop(&workers[workerIdx]);
+    }
+    /* After the drain, the last completions may come from it */
+    end = nowNs();
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        engineGetStats(&stats);
+        PRINT("%-8s %-8s %10s %10s %14s\n", "bearer", "worker", "ops", "failed", "longest gap ms");
+        for (workerIdx = 0; workerIdx < numWorkers; workerIdx++)
+        {
+            for (sessionIdx = 0; sessionIdx < WORKER_BENCH_SESSIONS; sessionIdx++)
+            {
+                /* Up to the end of the run, a bearer stalled for good has no completion to end its gap */
+                gapNs = end - benches[workerIdx].lastDoneNs[sessionIdx];
+                if (benches[workerIdx].maxGapNs[sessionIdx] > gapNs)
+                {
+                    gapNs = benches[workerIdx].maxGapNs[sessionIdx];
+                }
+                numStalled += (gapNs > (Cpa64U)WORKER_FAILOVER_STALL_MS * 1000000) ? 1 : 0;
+                PRINT("%-8u %-8u %10llu %10llu %14.1f\n",
+                      workerIdx * WORKER_BENCH_SESSIONS + sessionIdx,
+                      workerIdx,
+                      (unsigned long long)benches[workerIdx].numDone[sessionIdx],
+                      (unsigned long long)benches[workerIdx].numErrors[sessionIdx],
+                      (double)gapNs / 1e6);
+            }
+        }
+        PRINT("Failovers %llu, probes %llu, readmissions %llu, %llu ops on the software engine, %llu failed back\n",
+              (unsigned long long)stats.numFailovers,
+              (unsigned long long)stats.numProbes,
+              (unsigned long long)stats.numReadmissions,
+              (unsigned long long)stats.numCpuOps,
+              (unsigned long long)stats.numAbandoned);
+        if (0 < numStalled)
+        {
+            PRINT_ERR("%u bearers went more than %u ms without a completed PDU\n",
+                      numStalled,
+                      WORKER_FAILOVER_STALL_MS);
+            stat = CPA_STATUS_FAIL;
+        }
+        else
+        {
+            PRINT_COLOR(ANSI_COLOR_GREEN, "No bearer stalled\n");
+        }
+    }
+
+    free(workers);
+    free(benches);
+    benchStop(NULL);
+
+    return stat;
+}
+
+/*
+ * Paced traffic of a worker of the churn run, spread over its bearers, timed from when each PDU was due as in
+ * the batching run
+ */
+typedef struct _ChurnBench {
+    Cpa32U sessionIds[WORKER_BENCH_SESSIONS];
+    Cpa32U counts[WORKER_BENCH_SESSIONS];
+    Cpa64U startNs;
+    Cpa64U numDue;
+    Cpa64U numMissed;
+    volatile CpaBoolean sending;
+    Cpa64U numOps;
+    Cpa64U numErrors;
+    Cpa64U latencyUs[WORKER_BENCH_MAX_US + 1];
+} __attribute__((aligned(RING_CACHE_LINE))) ChurnBench;
+
+/* Session calls of a handover, timed on the thread making them */
+enum
+{
+    CHURN_CREATE,
+    CHURN_REKEY,
+    CHURN_RETIRE,
+    CHURN_NUM_CALLS
+};
+
+typedef struct _ChurnControl {
+    Cpa32U liveIds[WORKER_CHURN_LIVE_SESSIONS];
+    Cpa32U numLive;
+    Cpa32U oldest;
+    Cpa64U numHandovers;
+    Cpa64U numCalls[CHURN_NUM_CALLS];
+    Cpa64U numFailed[CHURN_NUM_CALLS];
+    Cpa32U *callNs[CHURN_NUM_CALLS]; /* duration of every call */
+    Cpa32U maxCalls;
+    Cpa64U seed;
+} ChurnControl;
+
+static Cpa32U churnRx(Worker *worker, PdcpDesc *descs, Cpa32U maxDescs, void *arg)
+{
+    ChurnBench *bench = (ChurnBench *)arg;
+    Cpa64U due = 0;
+    Cpa32U numDescs = 0;
+    Cpa32U session = 0;
+    Cpa32U offset = 0;
+
+    if (CPA_TRUE != bench->sending)
+    {
+        return 0;
+    }
+    due = (nowNs() - bench->startNs) * WORKER_CHURN_PDU_RATE / 1000000000ULL;
+    if (due - bench->numDue > WORKER_NUM_BUFFERS)
+    {
+        bench->numMissed += due - bench->numDue - WORKER_NUM_BUFFERS;
+        bench->numDue = due - WORKER_NUM_BUFFERS;
+    }
+    while (bench->numDue < due && numDescs < maxDescs && NULL != workerAllocBuffer(worker, &offset))
+    {
+        session = (Cpa32U)(bench->numDue % WORKER_BENCH_SESSIONS);
+        memset(&descs[numDescs], 0, sizeof(PdcpDesc));
+        descs[numDescs].userTag = bench->startNs + (bench->numDue + 1) * 1000000000ULL / WORKER_CHURN_PDU_RATE;
+        descs[numDescs].sessionId = bench->sessionIds[session];
+        descs[numDescs].count = bench->counts[session]++;
+        descs[numDescs].offset = offset;
+        descs[numDescs].length = WORKER_BENCH_PDU_SIZE;
+        bench->numDue++;
+        numDescs++;
+    }
+    return numDescs;
+}
+
+static void churnTx(Worker *worker, const PdcpDesc *descs, Cpa32U numDescs, void *arg)
+{
+    ChurnBench *bench = (ChurnBench *)arg;
+    Cpa64U now = nowNs();
+    Cpa64U latencyUs = 0;
+    Cpa32U descIdx = 0;
+
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        if (CPA_STATUS_SUCCESS != descs[descIdx].status)
+        {
+            bench->numErrors++;
+            continue;
+        }
+        latencyUs = (now - descs[descIdx].userTag) / 1000;
+        bench->latencyUs[(WORKER_BENCH_MAX_US < latencyUs) ? WORKER_BENCH_MAX_US : latencyUs]++;
+        bench->numOps++;
+    }
+}
+
+static void randomKey(ChurnControl *control, Cpa8U *key)
+{
+    Cpa32U keyIdx = 0;
+
+    /* xorshift64, keys only need to differ */
+    for (keyIdx = 0; keyIdx < WORKER_BENCH_KEY_SIZE; keyIdx++)
+    {
+        control->seed ^= control->seed << 13;
+        control->seed ^= control->seed >> 7;
+        control->seed ^= control->seed << 17;
+        key[keyIdx] = (Cpa8U)control->seed;
+    }
+}
+
+static void timeCall(ChurnControl *control, Cpa32U call, CpaStatus stat, Cpa64U startNs)
+{
+    Cpa64U ns = nowNs() - startNs;
+
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        control->numFailed[call]++;
+        return;
+    }
+    if (control->numCalls[call] < control->maxCalls)
+    {
+        control->callNs[call][control->numCalls[call]] = (0xffffffffULL < ns) ? 0xffffffff : (Cpa32U)ns;
+    }
+    control->numCalls[call]++;
+}
+
+/*
+ * One handover: a session for the UE on the target, a new key for one of the bearers in traffic, and the
+ * session of the UE that arrived longest ago goes once WORKER_CHURN_LIVE_SESSIONS are up
+ */
+static void churnHandover(ChurnControl *control,
+                          const AlgoDesc *algoDesc,
+                          Worker *workers,
+                          ChurnBench *benches,
+                          Cpa32U numWorkers)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Cpa8U key[WORKER_BENCH_KEY_SIZE];
+    Cpa64U handover = control->numHandovers++;
+    Cpa32U workerIdx = (Cpa32U)(handover % numWorkers);
+    Cpa32U sessionIdx = (Cpa32U)(handover / numWorkers % WORKER_BENCH_SESSIONS);
+    Cpa32U sessionId = 0;
+    Cpa64U start = 0;
+
+    if (WORKER_CHURN_LIVE_SESSIONS == control->numLive)
+    {
+        start = nowNs();
+        stat = engineRetireSession(control->liveIds[control->oldest], control);
+        timeCall(control, CHURN_RETIRE, stat, start);
+        control->oldest = (control->oldest + 1) % WORKER_CHURN_LIVE_SESSIONS;
+        control->numLive--;
+    }
+
+    randomKey(control, key);
+    start = nowNs();
+    stat = engineCreateSession(algoDesc->name,
+                               key,
+                               algoDesc->keySize,
+                               (Cpa8U)(handover % 32),
+                               0,
+                               benchDigestSize(algoDesc),
+                               CPA_FALSE,
+                               ENGINE_CLASS_BULK,
+                               control,
+                               &sessionId);
+    timeCall(control, CHURN_CREATE, stat, start);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        control->liveIds[(control->oldest + control->numLive) % WORKER_CHURN_LIVE_SESSIONS] = sessionId;
+        control->numLive++;
+    }
+
+    randomKey(control, key);
+    start = nowNs();
+    stat = engineRekeySession(
+        benches[workerIdx].sessionIds[sessionIdx], key, algoDesc->keySize, &workers[workerIdx]);
+    timeCall(control, CHURN_REKEY, stat, start);
+}
+
+static int compareNs(const void *a, const void *b)
+{
+    Cpa32U x = *(const Cpa32U *)a;
+    Cpa32U y = *(const Cpa32U *)b;
+
+    return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
+
+static void printChurnCalls(ChurnControl *control, double elapsed)
+{
+    const char *names[CHURN_NUM_CALLS] = {"create", "rekey", "retire"};
+    Cpa32U *samples = NULL;
+    Cpa64U numSamples = 0;
+    Cpa32U call = 0;
+
+    PRINT("  %-8s %10s %8s %8s %8s %8s\n", "call", "k/s", "failed", "p50 us", "p99 us", "max us");
+    for (call = 0; call < CHURN_NUM_CALLS; call++)
+    {
+        samples = control->callNs[call];
+        numSamples = (control->numCalls[call] < control->maxCalls) ? control->numCalls[call] : control->maxCalls;
+        if (0 == numSamples)
+        {
+            PRINT("  %-8s %10s\n", names[call], "none");
+            continue;
+        }
+        qsort(samples, numSamples, sizeof(Cpa32U), compareNs);
+        PRINT("  %-8s %10.1f %8llu %8.1f %8.1f %8.1f\n",
+              names[call],
+              (double)control->numCalls[call] / elapsed / 1e3,
+              (unsigned long long)control->numFailed[call],
+              (double)samples[numSamples / 2] / 1e3,
+              (double)samples[numSamples * 99 / 100] / 1e3,
+              (double)samples[numSamples - 1] / 1e3);
+    }
+}
+
+/*
+ * A worker per instance on paced traffic for seconds, with rate handovers per second made on the calling
+ * thread meanwhile (none for 0)
+ */
+static CpaStatus runChurnRound(const AlgoDesc *algoDesc,
+                               Cpa32U numWorkers,
+                               Cpa32U rate,
+                               Cpa32U seconds)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Worker *workers = NULL;
+    ChurnBench *benches = NULL;
+    ChurnControl control;
+    EngineStats stats = {0};
+    struct timespec due;
+    Cpa32U numStarted = 0;
+    Cpa32U workerIdx = 0;
+    Cpa32U call = 0;
+    Cpa32U us = 0;
+    Cpa64U numRekeys = 0;
+    Cpa64U numOps = 0;
+    Cpa64U numDue = 0;
+    Cpa64U numMissed = 0;
+    Cpa64U numErrors = 0;
+    Cpa64U maxUs = 0;
+    Cpa64U start = 0;
+    Cpa64U end = 0;
+    Cpa64U dueNs = 0;
+    Cpa64U *latencyUs = NULL;
+    double elapsed = 0;
+
+    memset(&control, 0, sizeof(ChurnControl));
+    control.seed = 0x9e3779b97f4a7c15ULL;
+    control.maxCalls = rate * seconds + 1;
+    workers = benchAlloc(numWorkers * sizeof(Worker));
+    benches = benchAlloc(numWorkers * sizeof(ChurnBench));
+    latencyUs = calloc(WORKER_BENCH_MAX_US + 1, sizeof(Cpa64U));
+    for (call = 0; call < CHURN_NUM_CALLS; call++)
+    {
+        control.callNs[call] = malloc(control.maxCalls * sizeof(Cpa32U));
+        stat = (NULL == control.callNs[call]) ? CPA_STATUS_RESOURCE : stat;
+    }
+    if (NULL == workers || NULL == benches || NULL == latencyUs || CPA_STATUS_SUCCESS != stat)
+    {
+        stat = CPA_STATUS_RESOURCE;
+        numWorkers = 0;
+    }
+
+    for (workerIdx = 0; CPA_STATUS_SUCCESS == stat && workerIdx < numWorkers; workerIdx++)
+    {
+        stat = benchInitWorker(&workers[workerIdx], workerIdx, algoDesc, benches[workerIdx].sessionIds);
+    }
+
+    engineGetStats(&stats);
+    numRekeys = stats.numRekeys;
+    start = nowNs();
+    for (workerIdx = 0; CPA_STATUS_SUCCESS == stat && workerIdx < numWorkers; workerIdx++)
+    {
+        benches[workerIdx].startNs = start;
+        benches[workerIdx].sending = CPA_TRUE;
+        stat = workerStart(&workers[workerIdx], churnRx, churnTx, &benches[workerIdx]);
+        CHECK_ERR_STATUS("workerStart", stat);
+        numStarted += (CPA_STATUS_SUCCESS == stat) ? 1 : 0;
+    }
+    end = start + (Cpa64U)seconds * 1000000000ULL;
+    if (CPA_STATUS_SUCCESS == stat && 0 == rate)
+    {
+        sleep(seconds);
+    }
+    /* Handover n is due n / rate after the start, those fallen behind on go at once */
+    while (CPA_STATUS_SUCCESS == stat && 0 < rate && nowNs() < end)
+    {
+        dueNs = start + control.numHandovers * 1000000000ULL / rate;
+        due.tv_sec = (time_t)(dueNs / 1000000000ULL);
+        due.tv_nsec = (long)(dueNs % 1000000000ULL);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+        churnHandover(&control, algoDesc, workers, benches, numWorkers);
+    }
+    elapsed = (double)(nowNs() - start) / 1e9;
+    for (workerIdx = 0; workerIdx < numStarted; workerIdx++)
+    {
+        benches[workerIdx].sending = CPA_FALSE;
+    }
+    for (workerIdx = 0; workerIdx < numWorkers; workerIdx++)
+    {
+        workerStop(&workers[workerIdx]);
+    }
+    while (0 < control.numLive)
+    {
+        engineRetireSession(control.liveIds[control.oldest], &control);
+        control.oldest = (control.oldest + 1) % WORKER_CHURN_LIVE_SESSIONS;
+        control.numLive--;
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        engineGetStats(&stats);
+        for (workerIdx = 0; workerIdx < numWorkers; workerIdx++)
+        {
+            numOps += benches[workerIdx].numOps;
+            numDue += benches[workerIdx].numDue;
+            numMissed += benches[workerIdx].numMissed;
+            numErrors += benches[workerIdx].numErrors;
+            for (us = 0; us <= WORKER_BENCH_MAX_US; us++)
+            {
+                latencyUs[us] += benches[workerIdx].latencyUs[us];
+                maxUs = (0 < benches[workerIdx].latencyUs[us] && us > maxUs) ? us : maxUs;
+            }
+        }
+        PRINT("%-10s %10.1f %10.1f %8u %8u %8u %8llu %8.2f\n",
+              (0 < rate) ? "churn" : "quiet",
+              (double)control.numHandovers / elapsed,
+              (double)numOps / elapsed / 1e3,
+              latencyPercentile(latencyUs, numOps, 0.50),
+              latencyPercentile(latencyUs, numOps, 0.99),
+              latencyPercentile(latencyUs, numOps, 0.999),
+              (unsigned long long)maxUs,
+              100.0 * (double)numMissed / (double)((0 < numDue) ? numDue : 1));
+        if (0 < rate)
+        {
+            printChurnCalls(&control, elapsed);
+            PRINT("  %llu sessions re-keyed\n", (unsigned long long)(stats.numRekeys - numRekeys));
+        }
+        if (0 < numErrors)
+        {
+            PRINT_ERR("%llu ops failed\n", (unsigned long long)numErrors);
+            stat = CPA_STATUS_FAIL;
+        }
+        for (call = 0; call < CHURN_NUM_CALLS; call++)
+        {
+            if (0 < control.numFailed[call])
+            {
+                PRINT_ERR("%llu session calls failed\n", (unsigned long long)control.numFailed[call]);
+                stat = CPA_STATUS_FAIL;
+            }
+        }
+    }
+
+    for (call = 0; call < CHURN_NUM_CALLS; call++)
+    {
+        free(control.callNs[call]);
+    }
+    free(latencyUs);
+    free(workers);
+    free(benches);
+    return stat;
+}
+
+CpaStatus runWorkerChurn(const char *algoName, Cpa32U rate, Cpa32U seconds)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = findAlgoDesc(algoName);
+    Cpa32U numWorkers = 0;
+
+    if (NULL == algoDesc || 0 == rate || 0 == seconds)
+    {
+        PRINT_ERR("Invalid churn parameters\n");
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    /* A worker per instance, as long as the sessions of its bearers fit next to those handed over */
+    stat = benchStart("Churn", 1, &numWorkers);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+    if (ENGINE_MAX_SESSIONS < numWorkers * WORKER_BENCH_SESSIONS + WORKER_CHURN_LIVE_SESSIONS)
+    {
+        numWorkers = (ENGINE_MAX_SESSIONS - WORKER_CHURN_LIVE_SESSIONS) / WORKER_BENCH_SESSIONS;
+    }
+
+    PRINT("%u workers, %u bearers each, %u PDUs/s of %u bytes of %s per worker, %u s per round\n",
+          numWorkers,
+          WORKER_BENCH_SESSIONS,
+          WORKER_CHURN_PDU_RATE,
+          WORKER_BENCH_PDU_SIZE,
+          algoName,
+          seconds);
+    PRINT("%-10s %10s %10s %8s %8s %8s %8s %8s\n",
+          "round",
+          "handover/s",
+          "kops",
+          "p50 us",
+          "p99 us",
+          "p99.9 us",
+          "max us",
+          "missed %");
+    stat = runChurnRound(algoDesc, numWorkers, 0, seconds);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = runChurnRound(algoDesc, numWorkers, rate, seconds);
+    }
+
+    benchStop(NULL);
+    return stat;
+}
+
+/*
+ * The idle run shares the open-loop traffic of the batching run, only the PDUs come from a producer thread
+ * standing for the NIC: it queues them when due and wakes the worker, whose rx takes them as buffers allow
+ */
+static Cpa32U idleBenchRx(Worker *worker, PdcpDesc *descs, Cpa32U maxDescs, void *arg)
+{
+    BatchBench *bench = (BatchBench *)arg;
+    Cpa32U numDescs = 0;
+    Cpa32U descIdx = 0;
+    Cpa32U offset = 0;
+
+    if (maxDescs > worker->numFreeBuffers)
+    {
+        maxDescs = worker->numFreeBuffers;
+    }
+    numDescs = ringDequeueBurst(bench->queue, descs, maxDescs);
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        workerAllocBuffer(worker, &offset);
+        descs[descIdx].sessionId = bench->sessionId;
+        descs[descIdx].count = (Cpa32U)worker->numRx + descIdx;
+        descs[descIdx].offset = offset;
+        descs[descIdx].length = WORKER_IDLE_PDU_SIZE;
+    }
+    return numDescs;
+}
+
+static const char *pollModeName(Cpa32U pollMode)
+{
+    switch (pollMode)
+    {
+        case WORKER_POLL_BUSY:
+            return "busy";
+        case WORKER_POLL_EVENT:
+            return "event";
+        default:
+            return "adaptive";
+    }
+}
+
+/*
+ * One worker on one bearer in pollMode, handed rate PDUs per second for seconds
+ */
+static CpaStatus runIdleRound(const AlgoDesc *algoDesc,
+                              Cpa32U pollMode,
+                              Cpa64U rate,
+                              Cpa32U seconds)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Worker *worker = NULL;
+    BatchBench *bench = NULL;
+    PdcpDesc desc;
+    struct timespec due;
+    Cpa64U now = 0;
+    Cpa64U end = 0;
+    Cpa64U dueNs = 0;
+    double elapsed = 0;
+
+    worker = benchAlloc(sizeof(Worker));
+    bench = benchAlloc(sizeof(BatchBench));
+    if (NULL != bench)
+    {
+        bench->queue = aligned_alloc(RING_CACHE_LINE, RING_MEM_SIZE(WORKER_IDLE_DEPTH));
+    }
+    if (NULL == worker || NULL == bench || NULL == bench->queue)
+    {
+        free(worker);
+        if (NULL != bench)
+        {
+            free(bench->queue);
+        }
+        free(bench);
+        return CPA_STATUS_RESOURCE;
+    }
+    ringInit(bench->queue, WORKER_IDLE_DEPTH);
+
+    workerInit(worker, 0);
+    workerSetPollMode(worker, pollMode);
+    stat = benchCreateSession(worker, algoDesc, 0, &bench->sessionId);
+    CHECK_ERR_STATUS("workerCreateSession", stat);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = workerStart(worker, idleBenchRx, batchBenchTx, bench);
+        CHECK_ERR_STATUS("workerStart", stat);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        /* Queue what is due and wake the worker, then sleep until the next PDU is due */
+        bench->rate = rate;
+        bench->startNs = nowNs();
+        end = bench->startNs + seconds * 1000000000ULL;
+        memset(&desc, 0, sizeof(desc));
+        for (now = bench->startNs; now < end; now = nowNs())
+        {
+            while (bench->numDue < (now - bench->startNs) * rate / 1000000000ULL)
+            {
+                /* PDU n is due once n + 1 PDUs were */
+                desc.userTag = bench->startNs + (bench->numDue + 1) * 1000000000ULL / rate;
+                bench->numMissed += 1 - ringEnqueueBurst(bench->queue, &desc, 1);
+                bench->numDue++;
+            }
+            workerWake(worker);
+            dueNs = bench->startNs + (bench->numDue + 1) * 1000000000ULL / rate;
+            due.tv_sec = (time_t)(dueNs / 1000000000ULL);
+            due.tv_nsec = (long)(dueNs % 1000000000ULL);
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+        }
+        elapsed = (double)(nowNs() - bench->startNs) / 1e9;
+    }
+    workerStop(worker);
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT("%-10s %10.1f %10.1f %8u %8u %8.1f %10.2f %8.2f\n",
+              pollModeName(pollMode),
+              (double)rate / 1e3,
+              (double)bench->numOps / elapsed / 1e3,
+              latencyPercentile(bench->latencyUs, bench->numOps, 0.50),
+              latencyPercentile(bench->latencyUs, bench->numOps, 0.99),
+              100.0 * (double)worker->cpuNs / (elapsed * 1e9),
+              (double)worker->numSleeps / (double)((0 < worker->numTx) ? worker->numTx : 1),
+              100.0 * (double)bench->numMissed / (double)((0 < bench->numDue) ? bench->numDue : 1));
+        if (0 < bench->numErrors)
+        {
+            PRINT_ERR("%llu ops failed\n", (unsigned long long)bench->numErrors);
+            stat = CPA_STATUS_FAIL;
+        }
+    }
+
+    free(worker);
+    free(bench->queue);
+    free(bench);
+    return stat;
+}
+
+CpaStatus runWorkerIdle(const char *algoName, Cpa32U rate, Cpa32U seconds)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = findAlgoDesc(algoName);
+    Cpa64U rates[] = {rate, WORKER_BATCH_HIGH_RATE};
+    Cpa32U pollModes[] = {WORKER_POLL_BUSY, WORKER_POLL_EVENT, WORKER_POLL_ADAPTIVE};
+    int eventFds[MAX_INSTANCES];
+    Cpa32U numEventFds = 0;
+    Cpa32U rateIdx = 0;
+    Cpa32U modeIdx = 0;
+
+    if (NULL == algoDesc || 0 == rate || 0 == seconds)
+    {
+        PRINT_ERR("Invalid idle parameters\n");
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    stat = benchStart("Idle", 1, NULL);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+
+    PRINT("One worker on %u byte PDUs of %s handed over by another thread, %u s per round\n",
+          WORKER_IDLE_PDU_SIZE,
+          algoName,
+          seconds);
+    engineGetEventFds(eventFds, MAX_INSTANCES, &numEventFds);
+    if (numEventFds < engineNumInstances())
+    {
+        PRINT("Instances without event fd are polled while requests are in flight\n");
+    }
+    PRINT("%-10s %10s %10s %8s %8s %8s %10s %8s\n",
+          "polling",
+          "offered k",
+          "kops",
+          "p50 us",
+          "p99 us",
+          "CPU %",
+          "sleeps/op",
+          "missed %");
+    for (rateIdx = 0; CPA_STATUS_SUCCESS == stat && rateIdx < sizeof(rates) / sizeof(rates[0]); rateIdx++)
+    {
+        for (modeIdx = 0; CPA_STATUS_SUCCESS == stat && modeIdx < sizeof(pollModes) / sizeof(pollModes[0]);
+             modeIdx++)
+        {
+            stat = runIdleRound(algoDesc, pollModes[modeIdx], rates[rateIdx], seconds);
+        }
+    }
+
+    benchStop(NULL);
+    return stat;
+}
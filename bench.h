@@ -0,0 +1,87 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "cpa.h"
+
+#define WORKER_BENCH_SESSIONS 8
+#define WORKER_BENCH_DEPTH 64
+#define WORKER_BENCH_PDU_SIZE 1500
+#define WORKER_BENCH_SECONDS 5
+#define WORKER_BENCH_MAX_US 10000
+#define WORKER_BENCH_KEY_SIZE 32 /* key buffer, sessions take the key size of their algorithm */
+#define WORKER_BENCH_DIGEST_SIZE 4
+#define WORKER_BENCH_SKEW 80
+#define WORKER_STEAL_LOAD 80 /* percent of the capacity offered to the skewed rounds of the stealing run */
+#define WORKER_QOS_BULK_FLOWS 6
+#define WORKER_QOS_BULK_PDU_SIZE 1500
+#define WORKER_QOS_SIGNALLING_PDU_SIZE 100
+#define WORKER_QOS_LOW_LATENCY_PDU_SIZE 200
+#define WORKER_QOS_INTERVAL_US 100 /* between two PDUs of a signalling or low latency flow */
+#define WORKER_BATCH_PDU_SIZE 512
+#define WORKER_BATCH_LOW_RATE 1000 /* PDUs per second at night */
+#define WORKER_BATCH_HIGH_RATE 50000 /* and at busy hour */
+#define WORKER_BATCH_OVERLOAD_RATE 5000000 /* beyond what one worker keeps up with */
+#define WORKER_REORDER_DEPTH 128 /* PDUs of a bearer in flight, less than the reorder window */
+#define WORKER_REORDER_LOSS 4096 /* one completion in that many is dropped */
+#define WORKER_FAILOVER_TICK_MS 500 /* between two lines of the failover timeline */
+#define WORKER_FAILOVER_STALL_MS 1000 /* longest a bearer may go without a completed PDU */
+#define WORKER_CHURN_RATE 5000 /* handovers per second */
+#define WORKER_CHURN_PDU_RATE 20000 /* PDUs per second of a worker */
+#define WORKER_CHURN_LIVE_SESSIONS 256 /* sessions of UEs handed over, the oldest goes with each new one */
+#define WORKER_IDLE_RATE 1000 /* PDUs per second of a cell site at 1% load */
+#define WORKER_IDLE_PDU_SIZE 512
+#define WORKER_IDLE_DEPTH 1024 /* PDUs handed to a worker and not yet taken */
+
+/*
+ * Run numWorkers workers (0 for one per instance) on synthetic traffic of pduSize byte PDUs for seconds and
+ * report the throughput and latency of each
+ */
+CpaStatus runWorkers(const char *algoName, Cpa32U numWorkers, Cpa32U pduSize, Cpa32U seconds);
+
+/*
+ * Run skewed traffic, skewPercent of it on the flows of the first worker, through a worker group without and
+ * then with stealing; per-bearer order is checked on every completion
+ */
+CpaStatus runWorkerSteal(const char *algoName, Cpa32U numWorkers, Cpa32U skewPercent, Cpa32U seconds);
+
+/*
+ * Overload one worker with bulk flows next to a paced signalling and a paced low latency flow, first with every
+ * flow in the bulk class and then with traffic classes, and report the latency of each class
+ */
+CpaStatus runWorkerQos(const char *algoName, Cpa32U seconds);
+
+/*
+ * Spread the PDUs of every bearer over numWorkers workers (0 for one per instance) for seconds, put the
+ * completions back in COUNT order through a reorder stage and check the order delivered; a few completions are
+ * dropped to be skipped after the timeout
+ */
+CpaStatus runWorkerReorder(const char *algoName, Cpa32U numWorkers, Cpa32U seconds);
+
+/*
+ * Offer a worker PDUs at a night time and at a busy hour rate, 50 times higher, with immediate, fixed and
+ * adaptive batching for a latency target of targetUs, and report latency, throughput, batch size and polls
+ * per PDU of each
+ */
+CpaStatus runWorkerBatching(const char *algoName, Cpa32U targetUs, Cpa32U seconds);
+
+/*
+ * Run a worker per instance for seconds and print a timeline of the throughput, of the ops run on the software
+ * engine and of the health of every instance, then the longest gap between completions of every bearer. Meant
+ * for faults injected into the mock backend (MOCK_QAT_FAULT): no bearer may stall.
+ */
+CpaStatus runWorkerFailover(const char *algoName, Cpa32U seconds);
+
+/*
+ * Run a worker per instance on paced traffic for seconds, first quiet and then with rate handovers per second
+ * made meanwhile: each creates a session, re-keys a bearer in traffic and retires the oldest session. Reports
+ * the latency of the traffic in both rounds and the rate and latency of each session call.
+ */
+CpaStatus runWorkerChurn(const char *algoName, Cpa32U rate, Cpa32U seconds);
+
+/*
+ * Hand a worker PDUs from another thread at rate PDUs per second and then at a busy hour rate, spinning, in
+ * event mode and adaptive, and report the CPU time the worker took next to the latency of each
+ */
+CpaStatus runWorkerIdle(const char *algoName, Cpa32U rate, Cpa32U seconds);
+
+#endif
@@ -0,0 +1,347 @@
+/*
+ * Client side of the PDCP daemon protocol, see daemon.h. Built into libpdcp_client.a for PDCP processes.
+ *
+ * A connection is used by one thread: it is the single producer of the request ring and the single consumer
+ * of the completion ring.
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "cpa.h"
+
+#include "client.h"
+#include "daemon.h"
+#include "utils.h"
+
+static CpaStatus transact(ClientConn *conn, DaemonRequest *req, DaemonResponse *rsp, int *passedFd)
+{
+    struct msghdr msg = {0};
+    struct iovec iov = {0};
+    char control[CMSG_SPACE(sizeof(int))];
+    struct cmsghdr *cmsg = NULL;
+
+    if (sizeof(DaemonRequest) != send(conn->fd, req, sizeof(DaemonRequest), MSG_NOSIGNAL))
+    {
+        return CPA_STATUS_FAIL;
+    }
+
+    iov.iov_base = rsp;
+    iov.iov_len = sizeof(DaemonResponse);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (sizeof(DaemonResponse) != recvmsg(conn->fd, &msg, 0))
+    {
+        return CPA_STATUS_FAIL;
+    }
+
+    if (NULL != passedFd)
+    {
+        *passedFd = -1;
+        cmsg = CMSG_FIRSTHDR(&msg);
+        if (NULL != cmsg && SOL_SOCKET == cmsg->cmsg_level && SCM_RIGHTS == cmsg->cmsg_type)
+        {
+            memcpy(passedFd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+
+    return rsp->status;
+}
+
+static CpaStatus mapRings(ClientConn *conn)
+{
+    Cpa32U slotIdx = 0;
+
+    conn->shmHeader = (ShmHeader *)conn->shm;
+    if (DAEMON_SHM_MAGIC != conn->shmHeader->magic || conn->shmSize < conn->shmHeader->bufferOffset ||
+        conn->shmSize - conn->shmHeader->bufferOffset < conn->shmHeader->bufferSize)
+    {
+        PRINT_ERR("Unexpected shared memory layout\n");
+        return CPA_STATUS_FAIL;
+    }
+
+    conn->reqRing = (DescRing *)(conn->shm + conn->shmHeader->reqRingOffset);
+    conn->hiReqRing = (DescRing *)(conn->shm + conn->shmHeader->hiReqRingOffset);
+    conn->cplRing = (DescRing *)(conn->shm + conn->shmHeader->cplRingOffset);
+    conn->buffers = conn->shm + conn->shmHeader->bufferOffset;
+    conn->numInflight = 0;
+
+    /* Hand out the low slots first */
+    conn->numFreeSlots = conn->shmHeader->bufferSize / DAEMON_SLOT_SIZE;
+    if (CLIENT_MAX_SLOTS < conn->numFreeSlots)
+    {
+        conn->numFreeSlots = CLIENT_MAX_SLOTS;
+    }
+    for (slotIdx = 0; slotIdx < conn->numFreeSlots; slotIdx++)
+    {
+        conn->freeSlots[slotIdx] = conn->numFreeSlots - 1 - slotIdx;
+    }
+
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus clientConnect(const char *socketPath, ClientConn *conn)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    struct sockaddr_un addr = {0};
+    DaemonRequest req = {0};
+    DaemonResponse rsp = {0};
+    int shmFd = -1;
+
+    memset(conn, 0, sizeof(ClientConn));
+    conn->fd = -1;
+    if (sizeof(addr.sun_path) <= strlen(socketPath))
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    conn->fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socketPath);
+    if (0 > conn->fd || 0 != connect(conn->fd, (struct sockaddr *)&addr, sizeof(addr)))
+    {
+        PRINT_ERR("Failed to connect to %s\n", socketPath);
+        clientDisconnect(conn);
+        return CPA_STATUS_FAIL;
+    }
+
+    req.type = DAEMON_MSG_HELLO;
+    stat = transact(conn, &req, &rsp, &shmFd);
+    if (CPA_STATUS_SUCCESS == stat && 0 > shmFd)
+    {
+        stat = CPA_STATUS_FAIL;
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        conn->shm = mmap(NULL, rsp.u.hello.shmSize, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+        if (MAP_FAILED == conn->shm)
+        {
+            conn->shm = NULL;
+            stat = CPA_STATUS_RESOURCE;
+        }
+        else
+        {
+            conn->shmSize = rsp.u.hello.shmSize;
+        }
+    }
+    if (0 <= shmFd)
+    {
+        close(shmFd);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = mapRings(conn);
+    }
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        clientDisconnect(conn);
+    }
+
+    return stat;
+}
+
+void clientDisconnect(ClientConn *conn)
+{
+    if (NULL != conn->shm)
+    {
+        munmap(conn->shm, conn->shmSize);
+        conn->shm = NULL;
+    }
+    if (0 <= conn->fd)
+    {
+        close(conn->fd);
+    }
+    conn->fd = -1;
+}
+
+CpaStatus clientCreateSession(ClientConn *conn,
+                              const char *algoName,
+                              const Cpa8U *key,
+                              Cpa32U keySize,
+                              Cpa8U bearer,
+                              Cpa8U dir,
+                              Cpa32U digestSize,
+                              CpaBoolean verifyDigest,
+                              Cpa32U trafficClass,
+                              Cpa32U *sessionId)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    DaemonRequest req = {0};
+    DaemonResponse rsp = {0};
+
+    if (DAEMON_ALGO_NAME_SIZE <= strlen(algoName) || ENGINE_MAX_KEY_SIZE < keySize ||
+        ENGINE_NUM_CLASSES <= trafficClass)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    req.type = DAEMON_MSG_SESSION_CREATE;
+    strcpy(req.u.session.algo, algoName);
+    memcpy(req.u.session.key, key, keySize);
+    req.u.session.keySize = keySize;
+    req.u.session.digestSize = digestSize;
+    req.u.session.bearer = bearer;
+    req.u.session.verifyDigest = verifyDigest;
+    req.u.session.dir = dir;
+    req.u.session.trafficClass = trafficClass;
+
+    stat = transact(conn, &req, &rsp, NULL);
+    if (CPA_STATUS_SUCCESS == stat && ENGINE_MAX_SESSIONS > rsp.u.session.sessionId)
+    {
+        conn->sessionClass[rsp.u.session.sessionId] = (Cpa8U)trafficClass;
+        *sessionId = rsp.u.session.sessionId;
+    }
+    return stat;
+}
+
+CpaStatus clientRetireSession(ClientConn *conn, Cpa32U sessionId)
+{
+    DaemonRequest req = {0};
+    DaemonResponse rsp = {0};
+
+    req.type = DAEMON_MSG_SESSION_RETIRE;
+    req.u.retire.sessionId = sessionId;
+    return transact(conn, &req, &rsp, NULL);
+}
+
+CpaStatus clientExecOp(ClientConn *conn,
+                       Cpa32U sessionId,
+                       Cpa32U count,
+                       Cpa32U fresh,
+                       Cpa32U offset,
+                       Cpa32U length,
+                       Cpa8U *digest)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    DaemonRequest req = {0};
+    DaemonResponse rsp = {0};
+
+    req.type = DAEMON_MSG_OP;
+    req.u.op.sessionId = sessionId;
+    req.u.op.count = count;
+    req.u.op.fresh = fresh;
+    req.u.op.offset = offset;
+    req.u.op.length = length;
+
+    stat = transact(conn, &req, &rsp, NULL);
+    if (CPA_STATUS_SUCCESS == stat && NULL != digest)
+    {
+        memcpy(digest, rsp.u.op.digest, ENGINE_MAX_DIGEST_SIZE);
+    }
+    return stat;
+}
+
+Cpa8U *clientAllocBuffer(ClientConn *conn, Cpa32U *offset)
+{
+    if (0 == conn->numFreeSlots)
+    {
+        return NULL;
+    }
+
+    /* Leave headroom in front of the payload for the prefix the engine may prepend */
+    *offset = conn->freeSlots[--conn->numFreeSlots] * DAEMON_SLOT_SIZE + ENGINE_OP_HEADROOM;
+    return conn->buffers + *offset;
+}
+
+void clientFreeBuffer(ClientConn *conn, Cpa32U offset)
+{
+    conn->freeSlots[conn->numFreeSlots++] = offset / DAEMON_SLOT_SIZE;
+}
+
+static DescRing *reqRingOf(const ClientConn *conn, const PdcpDesc *desc)
+{
+    if (ENGINE_MAX_SESSIONS > desc->sessionId && ENGINE_IS_HIGH_PRIORITY(conn->sessionClass[desc->sessionId]))
+    {
+        return conn->hiReqRing;
+    }
+    return conn->reqRing;
+}
+
+Cpa32U clientSubmitBurst(ClientConn *conn, const PdcpDesc *descs, Cpa32U numDescs)
+{
+    DaemonRequest req = {0};
+    DescRing *ring = NULL;
+    Cpa32U numQueued = 0;
+    Cpa32U numRun = 0;
+    Cpa32U numRunQueued = 0;
+
+    /* Never have more descriptors out than the completion ring can hold */
+    if (conn->shmHeader->ringSize - conn->numInflight < numDescs)
+    {
+        numDescs = conn->shmHeader->ringSize - conn->numInflight;
+    }
+    /* Runs of descriptors of the same priority go to their ring in one go */
+    while (numQueued < numDescs)
+    {
+        ring = reqRingOf(conn, &descs[numQueued]);
+        numRun = 1;
+        while (numQueued + numRun < numDescs && ring == reqRingOf(conn, &descs[numQueued + numRun]))
+        {
+            numRun++;
+        }
+        numRunQueued = ringEnqueueBurst(ring, descs + numQueued, numRun);
+        numQueued += numRunQueued;
+        if (numRunQueued != numRun)
+        {
+            break;
+        }
+    }
+    conn->numInflight += numQueued;
+
+    /* Pairs with the fence in the daemon between setting the flag and checking the rings */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (0 < numQueued && 0 != __atomic_load_n(&conn->shmHeader->daemonSleeping, __ATOMIC_RELAXED))
+    {
+        req.type = DAEMON_MSG_KICK;
+        send(conn->fd, &req, sizeof(DaemonRequest), MSG_NOSIGNAL | MSG_DONTWAIT);
+    }
+
+    return numQueued;
+}
+
+Cpa32U clientPollBurst(ClientConn *conn, PdcpDesc *descs, Cpa32U maxDescs, Cpa64U *passBitmap)
+{
+    Cpa32U numDescs = ringDequeueBurst(conn->cplRing, descs, maxDescs);
+
+    conn->numInflight -= numDescs;
+    if (NULL != passBitmap)
+    {
+        ringPassBitmap(descs, numDescs, passBitmap);
+    }
+    return numDescs;
+}
+
+CpaStatus clientGetHealth(ClientConn *conn, DaemonHealth *health)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    DaemonRequest req = {0};
+    DaemonResponse rsp = {0};
+
+    req.type = DAEMON_MSG_HEALTH;
+    stat = transact(conn, &req, &rsp, NULL);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        *health = rsp.u.health;
+    }
+    return stat;
+}
+
+CpaStatus clientGetStats(ClientConn *conn, EngineStats *stats)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    DaemonRequest req = {0};
+    DaemonResponse rsp = {0};
+
+    req.type = DAEMON_MSG_STATS;
+    stat = transact(conn, &req, &rsp, NULL);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        *stats = rsp.u.stats;
+    }
+    return stat;
+}
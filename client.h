@@ -0,0 +1,68 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include "cpa.h"
+
+#include "daemon.h"
+#include "ring.h"
+
+#define CLIENT_MAX_SLOTS (DAEMON_SHM_SIZE / DAEMON_SLOT_SIZE)
+
+typedef struct _ClientConn {
+    int fd;
+    Cpa8U *shm;
+    Cpa32U shmSize;
+    ShmHeader *shmHeader;
+    DescRing *reqRing;
+    DescRing *hiReqRing;
+    DescRing *cplRing;
+    Cpa8U *buffers;
+    Cpa32U numInflight;
+    Cpa32U numFreeSlots;
+    Cpa32U freeSlots[CLIENT_MAX_SLOTS];
+    Cpa8U sessionClass[ENGINE_MAX_SESSIONS]; /* picks the request ring of a descriptor */
+} ClientConn;
+
+/*
+ ***************************
+ * Client of the PDCP daemon
+ ***************************
+ */
+CpaStatus clientConnect(const char *socketPath, ClientConn *conn);
+void clientDisconnect(ClientConn *conn);
+
+CpaStatus clientCreateSession(ClientConn *conn,
+                              const char *algoName,
+                              const Cpa8U *key,
+                              Cpa32U keySize,
+                              Cpa8U bearer,
+                              Cpa8U dir,
+                              Cpa32U digestSize,
+                              CpaBoolean verifyDigest,
+                              Cpa32U trafficClass,
+                              Cpa32U *sessionId);
+CpaStatus clientRetireSession(ClientConn *conn, Cpa32U sessionId);
+CpaStatus clientExecOp(ClientConn *conn,
+                       Cpa32U sessionId,
+                       Cpa32U count,
+                       Cpa32U fresh,
+                       Cpa32U offset,
+                       Cpa32U length,
+                       Cpa8U *digest);
+
+/*
+ * Burst API over the shared memory rings, same shape as engineSubmitBurst/enginePollBurst. Payloads live in
+ * buffers from clientAllocBuffer, descriptor offsets are the ones it returns. clientSubmitBurst returns the
+ * number of descriptors queued, fewer than numDescs when the rings are full; descriptors of high priority
+ * sessions go on a ring of their own and overtake bulk ones queued before them. clientPollBurst optionally fills
+ * a pass/fail bitmap of the returned descriptors, see ringPassBitmap().
+ */
+Cpa8U *clientAllocBuffer(ClientConn *conn, Cpa32U *offset);
+void clientFreeBuffer(ClientConn *conn, Cpa32U offset);
+Cpa32U clientSubmitBurst(ClientConn *conn, const PdcpDesc *descs, Cpa32U numDescs);
+Cpa32U clientPollBurst(ClientConn *conn, PdcpDesc *descs, Cpa32U maxDescs, Cpa64U *passBitmap);
+
+CpaStatus clientGetHealth(ClientConn *conn, DaemonHealth *health);
+CpaStatus clientGetStats(ClientConn *conn, EngineStats *stats);
+
+#endif
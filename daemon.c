@@ -0,0 +1,537 @@
+/*
+ * Resident service mode.
+ *
+ * The daemon starts the engine once and then serves PDCP processes over a local UNIX socket. Each client gets
+ * its own shared memory region holding a request ring, a completion ring and the payload buffers, see
+ * daemon.h; descriptors point into the buffers so payloads never cross the process boundary. Descriptors of
+ * high priority sessions come on a ring of their own, which is served first and with a larger weight so that
+ * bulk traffic queued ahead does not delay them. The socket only
+ * carries control messages (sessions, health, statistics) and wake-ups. Sessions are owned by the client that
+ * created them and are retired when it disconnects.
+ *
+ * The daemon spins while it has work. With requests in flight and nothing else to do for DAEMON_SPIN_ROUNDS
+ * rounds, it sleeps on the event fds of the instances next to the sockets when the instances have them.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cpa.h"
+
+#include "algo.h"
+#include "daemon.h"
+#include "engine.h"
+#include "utils.h"
+
+typedef struct _DaemonClient {
+    int fd;
+    int shmFd;
+    Cpa8U *shm;
+    ShmHeader *shmHeader;
+    DescRing *reqRing;
+    DescRing *hiReqRing;
+    EnginePort *port;
+} DaemonClient;
+
+static volatile sig_atomic_t stop_g = 0;
+static DaemonClient clients_g[DAEMON_MAX_CLIENTS];
+static Cpa32U numClients_g = 0;
+static time_t startTime_g = 0;
+static DaemonState state_g = DAEMON_STATE_STARTING;
+
+static void stopHandler(int sig)
+{
+    stop_g = 1;
+}
+
+static void closeClient(DaemonClient *client)
+{
+    engineRetireSessionsOf(client);
+    if (NULL != client->port)
+    {
+        engineClosePort(client->port);
+        client->port = NULL;
+    }
+    if (NULL != client->shm)
+    {
+        munmap(client->shm, DAEMON_SHM_SIZE);
+        client->shm = NULL;
+    }
+    if (0 <= client->shmFd)
+    {
+        close(client->shmFd);
+        client->shmFd = -1;
+    }
+    close(client->fd);
+    client->fd = -1;
+    numClients_g--;
+}
+
+static int sendResponse(DaemonClient *client, DaemonResponse *rsp, int passFd)
+{
+    struct msghdr msg = {0};
+    struct iovec iov = {0};
+    char control[CMSG_SPACE(sizeof(int))];
+    struct cmsghdr *cmsg = NULL;
+
+    iov.iov_base = rsp;
+    iov.iov_len = sizeof(DaemonResponse);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    if (0 <= passFd)
+    {
+        memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &passFd, sizeof(int));
+    }
+
+    return (sizeof(DaemonResponse) == sendmsg(client->fd, &msg, MSG_NOSIGNAL)) ? 0 : -1;
+}
+
+static CpaStatus mapShm(DaemonClient *client, unsigned int flags)
+{
+    client->shmFd = memfd_create("pdcp_qat", flags);
+    if (0 > client->shmFd)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+    client->shm = NULL;
+    if (0 == ftruncate(client->shmFd, DAEMON_SHM_SIZE))
+    {
+        client->shm = mmap(NULL, DAEMON_SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, client->shmFd, 0);
+    }
+    if (NULL == client->shm || MAP_FAILED == client->shm)
+    {
+        client->shm = NULL;
+        close(client->shmFd);
+        client->shmFd = -1;
+        return CPA_STATUS_RESOURCE;
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+static CpaStatus handleHello(DaemonClient *client, DaemonResponse *rsp)
+{
+    if (NULL != client->shm)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    /* Huge pages keep every slot physically contiguous, fall back to normal pages when none are reserved */
+    if (CPA_STATUS_SUCCESS != mapShm(client, MFD_CLOEXEC | MFD_HUGETLB) &&
+        CPA_STATUS_SUCCESS != mapShm(client, MFD_CLOEXEC))
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+
+    client->shmHeader = (ShmHeader *)client->shm;
+    client->shmHeader->magic = DAEMON_SHM_MAGIC;
+    client->shmHeader->ringSize = DAEMON_RING_SIZE;
+    client->shmHeader->reqRingOffset = RING_CACHE_LINE * 2;
+    client->shmHeader->hiReqRingOffset = client->shmHeader->reqRingOffset + RING_MEM_SIZE(DAEMON_RING_SIZE);
+    client->shmHeader->cplRingOffset = client->shmHeader->hiReqRingOffset + RING_MEM_SIZE(DAEMON_RING_SIZE);
+    client->shmHeader->bufferOffset = DAEMON_SHM_HEADER_SIZE;
+    client->shmHeader->bufferSize = DAEMON_SHM_SIZE - DAEMON_SHM_HEADER_SIZE;
+    client->reqRing = (DescRing *)(client->shm + client->shmHeader->reqRingOffset);
+    client->hiReqRing = (DescRing *)(client->shm + client->shmHeader->hiReqRingOffset);
+    ringInit(client->reqRing, DAEMON_RING_SIZE);
+    ringInit(client->hiReqRing, DAEMON_RING_SIZE);
+    ringInit((DescRing *)(client->shm + client->shmHeader->cplRingOffset), DAEMON_RING_SIZE);
+
+    client->port = engineOpenPort(client->shm + client->shmHeader->bufferOffset,
+                                  client->shmHeader->bufferSize,
+                                  (DescRing *)(client->shm + client->shmHeader->cplRingOffset),
+                                  client);
+    if (NULL == client->port)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+
+    rsp->u.hello.shmSize = DAEMON_SHM_SIZE;
+    return CPA_STATUS_SUCCESS;
+}
+
+static CpaStatus handleOp(DaemonClient *client, DaemonRequest *req, DaemonResponse *rsp)
+{
+    if (NULL == client->shm || client->shmHeader->bufferSize < req->u.op.length ||
+        client->shmHeader->bufferSize - req->u.op.length < req->u.op.offset)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    return engineExecOp(req->u.op.sessionId,
+                        req->u.op.count,
+                        req->u.op.fresh,
+                        client->shm + client->shmHeader->bufferOffset + req->u.op.offset,
+                        req->u.op.length,
+                        rsp->u.op.digest,
+                        client);
+}
+
+/*
+ * Serve one request of the client, returns non-zero when the client is gone
+ */
+static int handleRequest(DaemonClient *client)
+{
+    DaemonRequest req = {0};
+    DaemonResponse rsp = {0};
+    EngineStats stats = {0};
+    const AlgoDesc *algoDesc = NULL;
+    ssize_t len = 0;
+    int passFd = -1;
+
+    len = recv(client->fd, &req, sizeof(req), 0);
+    if (0 >= len)
+    {
+        return -1;
+    }
+    if (sizeof(req) != len)
+    {
+        rsp.status = CPA_STATUS_INVALID_PARAM;
+        return sendResponse(client, &rsp, -1);
+    }
+
+    switch (req.type)
+    {
+    case DAEMON_MSG_KICK:
+        return 0;
+    case DAEMON_MSG_HELLO:
+        rsp.status = handleHello(client, &rsp);
+        passFd = (CPA_STATUS_SUCCESS == rsp.status) ? client->shmFd : -1;
+        break;
+    case DAEMON_MSG_SESSION_CREATE:
+        req.u.session.algo[DAEMON_ALGO_NAME_SIZE - 1] = '\0';
+        /* Experimental algorithms interoperate with nothing, PDCP processes do not get them */
+        algoDesc = findAlgoDesc(req.u.session.algo);
+        if (NULL != algoDesc && CPA_TRUE == algoDesc->experimental)
+        {
+            rsp.status = CPA_STATUS_UNSUPPORTED;
+            break;
+        }
+        rsp.status = engineCreateSession(req.u.session.algo,
+                                         req.u.session.key,
+                                         req.u.session.keySize,
+                                         req.u.session.bearer,
+                                         req.u.session.dir,
+                                         req.u.session.digestSize,
+                                         req.u.session.verifyDigest,
+                                         req.u.session.trafficClass,
+                                         client,
+                                         &rsp.u.session.sessionId);
+        break;
+    case DAEMON_MSG_SESSION_RETIRE:
+        rsp.status = engineRetireSession(req.u.retire.sessionId, client);
+        break;
+    case DAEMON_MSG_OP:
+        rsp.status = handleOp(client, &req, &rsp);
+        break;
+    case DAEMON_MSG_HEALTH:
+        engineGetStats(&stats);
+        rsp.u.health.state = state_g;
+        rsp.u.health.numInstances = stats.numInstances;
+        rsp.u.health.numClients = numClients_g;
+        rsp.u.health.uptimeSec = (Cpa64U)(time(NULL) - startTime_g);
+        rsp.status = CPA_STATUS_SUCCESS;
+        break;
+    case DAEMON_MSG_STATS:
+        engineGetStats(&rsp.u.stats);
+        rsp.status = CPA_STATUS_SUCCESS;
+        break;
+    default:
+        rsp.status = CPA_STATUS_UNSUPPORTED;
+        break;
+    }
+
+    return sendResponse(client, &rsp, passFd);
+}
+
+/*
+ * Hand up to numBursts bursts of a request ring to the engine, returns the number of descriptors taken
+ */
+static Cpa32U serveRing(DaemonClient *client, DescRing *ring, Cpa32U numBursts)
+{
+    PdcpDesc descs[DAEMON_BURST_SIZE];
+    Cpa32U numDescs = 0;
+    Cpa32U numTaken = 0;
+    Cpa32U burstIdx = 0;
+
+    for (burstIdx = 0; burstIdx < numBursts; burstIdx++)
+    {
+        numDescs = ringPeekBurst(ring, descs, DAEMON_BURST_SIZE);
+        if (0 == numDescs)
+        {
+            break;
+        }
+        numDescs = engineSubmitBurst(client->port, descs, numDescs);
+        ringConsume(ring, numDescs);
+        numTaken += numDescs;
+        if (DAEMON_BURST_SIZE != numDescs)
+        {
+            break;
+        }
+    }
+
+    return numTaken;
+}
+
+/*
+ * Hand the descriptors queued by every client to the engine, high priority ones first, returns the number taken
+ */
+static Cpa32U serveRings(void)
+{
+    Cpa32U numTaken = 0;
+    Cpa32U clientIdx = 0;
+
+    for (clientIdx = 0; clientIdx < DAEMON_MAX_CLIENTS; clientIdx++)
+    {
+        if (NULL != clients_g[clientIdx].port)
+        {
+            numTaken += serveRing(&clients_g[clientIdx], clients_g[clientIdx].hiReqRing, ENGINE_HIGH_PRIORITY_WEIGHT);
+        }
+    }
+    for (clientIdx = 0; clientIdx < DAEMON_MAX_CLIENTS; clientIdx++)
+    {
+        if (NULL != clients_g[clientIdx].port)
+        {
+            numTaken += serveRing(&clients_g[clientIdx], clients_g[clientIdx].reqRing, 1);
+        }
+    }
+
+    return numTaken;
+}
+
+/*
+ * Tell the clients that the daemon is about to sleep, returns CPA_FALSE when descriptors arrived meanwhile
+ */
+static CpaBoolean setSleeping(Cpa32U sleeping)
+{
+    CpaBoolean canSleep = CPA_TRUE;
+    Cpa32U clientIdx = 0;
+
+    for (clientIdx = 0; clientIdx < DAEMON_MAX_CLIENTS; clientIdx++)
+    {
+        if (NULL != clients_g[clientIdx].port)
+        {
+            __atomic_store_n(&clients_g[clientIdx].shmHeader->daemonSleeping, sleeping, __ATOMIC_SEQ_CST);
+        }
+    }
+    if (0 == sleeping)
+    {
+        return CPA_FALSE;
+    }
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (clientIdx = 0; clientIdx < DAEMON_MAX_CLIENTS; clientIdx++)
+    {
+        if (NULL != clients_g[clientIdx].port &&
+            (0 < ringCount(clients_g[clientIdx].reqRing) || 0 < ringCount(clients_g[clientIdx].hiReqRing)))
+        {
+            canSleep = CPA_FALSE;
+        }
+    }
+    return canSleep;
+}
+
+static void acceptClient(int listenFd)
+{
+    Cpa32U clientIdx = 0;
+    int fd = -1;
+
+    fd = accept(listenFd, NULL, NULL);
+    if (0 > fd)
+    {
+        return;
+    }
+    for (clientIdx = 0; clientIdx < DAEMON_MAX_CLIENTS; clientIdx++)
+    {
+        if (0 > clients_g[clientIdx].fd)
+        {
+            clients_g[clientIdx].fd = fd;
+            clients_g[clientIdx].shmFd = -1;
+            clients_g[clientIdx].shm = NULL;
+            clients_g[clientIdx].shmHeader = NULL;
+            clients_g[clientIdx].reqRing = NULL;
+            clients_g[clientIdx].hiReqRing = NULL;
+            clients_g[clientIdx].port = NULL;
+            numClients_g++;
+            PRINT_DBG("Client %u connected\n", clientIdx);
+            return;
+        }
+    }
+    PRINT_ERR("Too many clients\n");
+    close(fd);
+}
+
+CpaStatus runDaemon(const char *socketPath, Cpa32U shadowRate)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    struct sockaddr_un addr = {0};
+    struct pollfd pollFds[DAEMON_MAX_CLIENTS + 1 + MAX_INSTANCES];
+    DaemonClient *pollClients[DAEMON_MAX_CLIENTS + 1];
+    int eventFds[MAX_INSTANCES];
+    Cpa32U numPollFds = 0;
+    Cpa32U numClientFds = 0;
+    Cpa32U numEventFds = 0;
+    Cpa32U numIdleRounds = 0;
+    Cpa32U clientIdx = 0;
+    Cpa32U fdIdx = 0;
+    int listenFd = -1;
+    int timeout = 0;
+    CpaBoolean busy = CPA_FALSE;
+    EngineStats stats = {0};
+
+    if (sizeof(addr.sun_path) <= strlen(socketPath))
+    {
+        PRINT_ERR("Socket path too long\n");
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    signal(SIGINT, stopHandler);
+    signal(SIGTERM, stopHandler);
+    signal(SIGPIPE, SIG_IGN);
+    startTime_g = time(NULL);
+    for (clientIdx = 0; clientIdx < DAEMON_MAX_CLIENTS; clientIdx++)
+    {
+        clients_g[clientIdx].fd = -1;
+        clients_g[clientIdx].shmFd = -1;
+        clients_g[clientIdx].shm = NULL;
+        clients_g[clientIdx].port = NULL;
+    }
+
+    /*
+     * Pay the whole start up cost once
+     */
+    stat = engineStart();
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        PRINT_ERR("Failed to start the engine\n");
+        return stat;
+    }
+
+    /* Serve from the cores of a local instance so client regions and completion rings land on its node */
+    engineBindThread();
+
+    if (CPA_STATUS_SUCCESS != engineEnableShadow(shadowRate))
+    {
+        PRINT_ERR("Failed to start the shadow checks\n");
+    }
+
+    listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socketPath);
+    unlink(socketPath);
+    if (0 > listenFd || 0 != bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) || 0 != listen(listenFd, 16))
+    {
+        PRINT_ERR("Failed to listen on %s: %s\n", socketPath, strerror(errno));
+        if (0 <= listenFd)
+        {
+            close(listenFd);
+        }
+        engineStop();
+        return CPA_STATUS_FAIL;
+    }
+
+    state_g = DAEMON_STATE_UP;
+    PRINT("Serving on %s\n", socketPath);
+
+    while (!stop_g)
+    {
+        numPollFds = 0;
+        pollFds[numPollFds].fd = listenFd;
+        pollFds[numPollFds].events = POLLIN;
+        pollClients[numPollFds++] = NULL;
+        for (clientIdx = 0; clientIdx < DAEMON_MAX_CLIENTS; clientIdx++)
+        {
+            if (0 <= clients_g[clientIdx].fd)
+            {
+                pollFds[numPollFds].fd = clients_g[clientIdx].fd;
+                pollFds[numPollFds].events = POLLIN;
+                pollClients[numPollFds++] = &clients_g[clientIdx];
+            }
+        }
+
+        numClientFds = numPollFds;
+
+        /*
+         * Spin while there is work, sleep on the sockets when idle; clients kick the socket to wake us. With
+         * requests in flight, sleep on the event fds of the instances as well after a few rounds without work.
+         */
+        timeout = 0;
+        if (CPA_TRUE != busy && 0 == stats.numInflight && CPA_TRUE == setSleeping(1))
+        {
+            timeout = DAEMON_POLL_TIMEOUT_MS;
+        }
+        else if (CPA_TRUE != busy && DAEMON_SPIN_ROUNDS <= numIdleRounds &&
+                 CPA_TRUE == engineGetEventFds(eventFds, MAX_INSTANCES, &numEventFds) && CPA_TRUE == setSleeping(1))
+        {
+            for (fdIdx = 0; fdIdx < numEventFds; fdIdx++)
+            {
+                pollFds[numPollFds].fd = eventFds[fdIdx];
+                pollFds[numPollFds++].events = POLLIN;
+            }
+            timeout = ENGINE_EVENT_TIMEOUT_MS;
+        }
+
+        if (0 < poll(pollFds, numPollFds, timeout))
+        {
+            for (fdIdx = 1; fdIdx < numClientFds; fdIdx++)
+            {
+                if (0 != (pollFds[fdIdx].revents & (POLLIN | POLLHUP | POLLERR)) &&
+                    0 != handleRequest(pollClients[fdIdx]))
+                {
+                    PRINT_DBG("Client disconnected\n");
+                    closeClient(pollClients[fdIdx]);
+                }
+            }
+            if (0 != (pollFds[0].revents & POLLIN))
+            {
+                acceptClient(listenFd);
+            }
+        }
+
+        if (0 < timeout)
+        {
+            setSleeping(0);
+        }
+
+        /* Move new descriptors to the engine, complete finished ones and reclaim retired sessions */
+        busy = (0 < serveRings()) ? CPA_TRUE : CPA_FALSE;
+        if (0 < enginePoll())
+        {
+            busy = CPA_TRUE;
+        }
+        engineGetStats(&stats);
+        numIdleRounds = (CPA_TRUE == busy) ? 0 : numIdleRounds + 1;
+    }
+
+    state_g = DAEMON_STATE_STOPPING;
+    PRINT("Stopping\n");
+    for (clientIdx = 0; clientIdx < DAEMON_MAX_CLIENTS; clientIdx++)
+    {
+        if (0 <= clients_g[clientIdx].fd)
+        {
+            closeClient(&clients_g[clientIdx]);
+        }
+    }
+    close(listenFd);
+    unlink(socketPath);
+    engineStop();
+
+    return CPA_STATUS_SUCCESS;
+}
@@ -0,0 +1,114 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include "cpa.h"
+
+#include "engine.h"
+#include "ring.h"
+
+#define DAEMON_DEFAULT_SOCKET "/tmp/pdcp_qat.sock"
+#define DAEMON_MAX_CLIENTS 64
+#define DAEMON_SHM_SIZE (4 * 1024 * 1024)
+#define DAEMON_SHM_MAGIC 0x50444350
+#define DAEMON_SHM_HEADER_SIZE (64 * 1024)
+#define DAEMON_SLOT_SIZE (16 * 1024)
+#define DAEMON_RING_SIZE 256
+#define DAEMON_BURST_SIZE 32
+#define DAEMON_POLL_TIMEOUT_MS 100
+#define DAEMON_SPIN_ROUNDS 64 /* without work before the daemon sleeps with requests in flight */
+#define DAEMON_ALGO_NAME_SIZE 16
+
+/*
+ * Layout of the shared memory region of a client: this header, the request rings (client to daemon) for
+ * bulk and for high priority sessions, the completion ring (daemon to client) and the buffer area. Descriptor offsets are relative to the buffer area,
+ * and ops may use up to ENGINE_OP_HEADROOM bytes in front of a payload. The buffer area is carved into
+ * DAEMON_SLOT_SIZE slots, none of which crosses a huge page.
+ */
+typedef struct _ShmHeader {
+    Cpa32U magic;
+    Cpa32U ringSize;
+    Cpa32U reqRingOffset;
+    Cpa32U hiReqRingOffset;
+    Cpa32U cplRingOffset;
+    Cpa32U bufferOffset;
+    Cpa32U bufferSize;
+    Cpa32U daemonSleeping __attribute__((aligned(RING_CACHE_LINE)));
+} ShmHeader;
+
+/*
+ * Control messages exchanged over the UNIX socket (SOCK_SEQPACKET, one message per request). Data moves
+ * through the rings in the shared memory region handed out in the HELLO response; KICK wakes up an idle
+ * daemon after descriptors were queued and has no response. OP runs one PDU synchronously.
+ */
+typedef enum _DaemonMsgType {
+    DAEMON_MSG_HELLO = 1,
+    DAEMON_MSG_SESSION_CREATE,
+    DAEMON_MSG_SESSION_RETIRE,
+    DAEMON_MSG_OP,
+    DAEMON_MSG_HEALTH,
+    DAEMON_MSG_STATS,
+    DAEMON_MSG_KICK
+} DaemonMsgType;
+
+typedef enum _DaemonState {
+    DAEMON_STATE_STARTING = 0,
+    DAEMON_STATE_UP,
+    DAEMON_STATE_STOPPING
+} DaemonState;
+
+typedef struct _DaemonHealth {
+    Cpa32U state;
+    Cpa32U numInstances;
+    Cpa32U numClients;
+    Cpa64U uptimeSec;
+} DaemonHealth;
+
+typedef struct _DaemonRequest {
+    Cpa32U type;
+    union {
+        struct {
+            char algo[DAEMON_ALGO_NAME_SIZE];
+            Cpa8U key[ENGINE_MAX_KEY_SIZE];
+            Cpa32U keySize;
+            Cpa32U digestSize;
+            Cpa8U bearer;
+            Cpa8U dir;
+            CpaBoolean verifyDigest;
+            Cpa32U trafficClass;
+        } session;
+        struct {
+            Cpa32U sessionId;
+        } retire;
+        struct {
+            Cpa32U sessionId;
+            Cpa32U count;
+            Cpa32U fresh;
+            Cpa32U offset; /* payload in the buffer area, processed in place */
+            Cpa32U length;
+        } op;
+    } u;
+} DaemonRequest;
+
+typedef struct _DaemonResponse {
+    Cpa32S status;
+    union {
+        struct {
+            Cpa32U shmSize; /* the region itself is passed as a file descriptor */
+        } hello;
+        struct {
+            Cpa32U sessionId;
+        } session;
+        struct {
+            Cpa8U digest[ENGINE_MAX_DIGEST_SIZE];
+        } op;
+        DaemonHealth health;
+        EngineStats stats;
+    } u;
+} DaemonResponse;
+
+/*
+ * Serve clients on socketPath until SIGINT or SIGTERM, shadow checking 1 in shadowRate ops (0 for none)
+ */
+CpaStatus runDaemon(const char *socketPath, Cpa32U shadowRate);
+
+#endif
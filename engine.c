@@ -0,0 +1,1878 @@
+/*
+ * Resident crypto engine.
+ *
+ * The engine does the expensive work once: it initializes the memory driver and the user space access to the
+ * QAT endpoint, starts every crypto instance and pre-allocates the pinned op buffers and session contexts.
+ * After engineStart() sessions are created and ops are executed without any further allocation. The data path
+ * (alloc, submit, poll) is driven from a single thread; session retirement follows session.c and never blocks.
+ * Alternatively, each instance is driven by a thread of its own through an instance port (see worker.c): ops,
+ * sessions and counters belong to an instance, so such threads share nothing on the data path.
+ *
+ * Instances are grouped by the NUMA node the driver reports for them. Op buffers and session contexts of an
+ * instance are allocated on its node, and new sessions go to an instance on the node of the calling thread.
+ *
+ * Every instance has a health monitor (see health.c), checked whenever the instance is polled. An instance that
+ * fails to start, returns errors or stops answering is taken out of service: its sessions move to a healthy
+ * instance, and those pinned to it (instance ports) run on the software engine in sw/ meanwhile. A request the
+ * device refuses runs there as well. Requests stuck on the instance are failed back to their users; the device
+ * may still hand them back later, and their ops only return to the pool then. A probe brings the instance back.
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cpa.h"
+#include "cpa_cy_common.h"
+#include "cpa_cy_im.h"
+#include "cpa_cy_sym.h"
+#include "cpa_sample_utils.h"
+#include "icp_sal_poll.h"
+#include "icp_sal_user.h"
+#include "qae_mem.h"
+
+#include "arena.h"
+#include "engine.h"
+#include "pmu.h"
+#include "session.h"
+#include "trace.h"
+#include "utils.h"
+
+#define ENGINE_ALIGN(size) (((size) + BYTE_ALIGNMENT - 1) & ~(BYTE_ALIGNMENT - 1))
+
+/*
+ * A new key of a session, with the session context for it, until the data path of the session takes it over
+ */
+typedef struct _EngineRekey {
+    EngineInstance *instance;
+    CpaCySymSessionCtx sessionCtx; /* NULL when the instance was out of service */
+    Cpa8U key[ENGINE_MAX_KEY_SIZE];
+} EngineRekey;
+
+static EngineInstance instances_g[MAX_INSTANCES];
+static Cpa16U numInstances_g = 0;
+static Cpa16U nextInstance_g[MAX_NODES];
+/* The probe session of instance i comes after the others, at ENGINE_MAX_SESSIONS + i */
+static EngineSession sessions_g[ENGINE_MAX_SESSIONS + MAX_INSTANCES];
+static EngineStats stats_g = {0};
+static CpaBoolean running_g = CPA_FALSE;
+static EnginePort *ports_g[ENGINE_MAX_PORTS];
+
+static Cpa64U nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Cpa64U)ts.tv_sec * 1000000000ULL + (Cpa64U)ts.tv_nsec;
+}
+
+static void completePortOp(EngineOp *op)
+{
+    EnginePort *port = op->port;
+    PdcpDesc *desc = &op->desc;
+
+    desc->flags = 0;
+    if (CPA_STATUS_SUCCESS == desc->status)
+    {
+        if (CPA_TRUE == op->session->verifyDigest)
+        {
+            desc->flags |= (CPA_TRUE == op->verifyResult) ? 0 : RING_DESC_VERIFY_FAILED;
+        }
+        else if (CPA_CY_SYM_OP_HASH == op->opDesc.op)
+        {
+            memcpy(desc->digest, op->digestBuffer, op->opDesc.outSize);
+        }
+        else if (CPA_TRUE == op->bounced)
+        {
+            memcpy(port->region + desc->offset, op->data, desc->length);
+        }
+    }
+    if (1 != ringEnqueueBurst(port->cplRing, desc, 1))
+    {
+        PRINT_ERR("Completion ring overflow, descriptor %llu lost\n", (unsigned long long)desc->userTag);
+    }
+    port->numInflight--;
+    engineFreeOp(op);
+}
+
+/*
+ * Hand a finished op to its user, from the device or the software engine
+ */
+static void completeOp(EngineOp *op, CpaStatus status, CpaBoolean verifyResult)
+{
+    op->status = status;
+    op->verifyResult = verifyResult;
+    op->instance->numCompleted++;
+    if (CPA_STATUS_SUCCESS != status)
+    {
+        op->instance->numErrors++;
+    }
+    else if (CPA_TRUE == op->session->verifyDigest && CPA_TRUE != verifyResult)
+    {
+        op->instance->numVerifyFailures++;
+    }
+
+    if (NULL != op->port)
+    {
+        op->desc.status = status;
+        completePortOp(op);
+        return;
+    }
+    __atomic_store_n(&op->done, 1, __ATOMIC_RELEASE);
+}
+
+static void completeProbe(EngineOp *op, CpaStatus status)
+{
+    EngineInstance *instance = op->instance;
+
+    instance->numCompleted++;
+    healthOnProbeResult(&instance->health, (CPA_STATUS_SUCCESS == status) ? CPA_TRUE : CPA_FALSE, nowNs());
+    if (HEALTH_UP == instance->health.state)
+    {
+        PRINT("Instance %u back in service\n", (Cpa32U)(instance - instances_g));
+    }
+    engineFreeOp(op);
+}
+
+static void completeCallback(EngineOp *op, CpaStatus status, CpaBoolean verifyResult)
+{
+    TRACE_EVENT(TRACE_COMPLETE, op, (Cpa32U)(op->session - sessions_g), op->opDesc.bitLen / 8, status);
+    op->inflight = CPA_FALSE;
+    if (CPA_TRUE == op->abandoned)
+    {
+        /* Already failed back to its user */
+        if (CPA_TRUE == op->released)
+        {
+            engineFreeOp(op);
+        }
+        return;
+    }
+    op->instance->numInflight--;
+    healthOnResult(&op->instance->health, (CPA_STATUS_SUCCESS != status) ? CPA_TRUE : CPA_FALSE);
+    if (NULL != op->shadow)
+    {
+        shadowComplete(op->shadow, status, &op->bufferList, op->digestBuffer, verifyResult);
+        op->shadow = NULL;
+    }
+
+    if (CPA_TRUE == op->probe)
+    {
+        completeProbe(op, status);
+        return;
+    }
+    completeOp(op, status, verifyResult);
+}
+
+static void engineCallback(void *callbackTag,
+                           CpaStatus status,
+                           const CpaCySymOp operationType,
+                           void *opData,
+                           CpaBufferList *dstBuffer,
+                           CpaBoolean verifyResult)
+{
+    EngineOp *op = (EngineOp *)callbackTag;
+    /* Taken first, the op may go back to the pool on completion */
+    const AlgoDesc *algoDesc = (NULL != op->session) ? op->session->algoDesc : NULL;
+    PmuSample pmuSample;
+
+    PMU_BEGIN(&pmuSample, PMU_STAGE_CALLBACK);
+    completeCallback(op, status, verifyResult);
+    PMU_END(&pmuSample, PMU_STAGE_CALLBACK, algoDesc, 1);
+}
+
+static CpaStatus prewarmOps(EngineInstance *instance)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Cpa32U bufferMetaSize = 0;
+    Cpa32U pinnedSize = 0;
+    Cpa32U opIdx = 0;
+    EngineOp *op = NULL;
+
+    /* Room for the longest chain plus an IV prefix */
+    stat = cpaCyBufferListGetMetaSize(instance->cyInstHandle, ENGINE_MAX_SEGMENTS + 1, &bufferMetaSize);
+    CHECK_ERR_STATUS("cpaCyBufferListGetMetaSize", stat);
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = memAllocOs((void *)&instance->ops, ENGINE_OPS_PER_INSTANCE * sizeof(EngineOp));
+        CHECK_ERR_STATUS("memAllocOs", stat);
+    }
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+    memset(instance->ops, 0, ENGINE_OPS_PER_INSTANCE * sizeof(EngineOp));
+
+    /* IV, digest, buffer list meta data, headroom and payload, each starting on its own cache line */
+    pinnedSize = BYTE_ALIGNMENT + BYTE_ALIGNMENT + ENGINE_ALIGN(bufferMetaSize) + ENGINE_OP_HEADROOM +
+                 ENGINE_MAX_PDU_SIZE;
+    for (opIdx = 0; opIdx < ENGINE_OPS_PER_INSTANCE; opIdx++)
+    {
+        op = &instance->ops[opIdx];
+        stat = memAllocContigNode((void *)&op->pinned, pinnedSize, BYTE_ALIGNMENT, instance->node);
+        CHECK_ERR_STATUS("memAllocContigNode", stat);
+        if (CPA_STATUS_SUCCESS != stat)
+        {
+            break;
+        }
+
+        op->instance = instance;
+        op->ivBuffer = op->pinned;
+        op->digestBuffer = op->pinned + BYTE_ALIGNMENT;
+        op->bufferList.numBuffers = 1;
+        op->bufferList.pBuffers = op->flatBuffers;
+        op->bufferList.pPrivateMetaData = op->pinned + 2 * BYTE_ALIGNMENT;
+        op->data = op->pinned + 2 * BYTE_ALIGNMENT + ENGINE_ALIGN(bufferMetaSize) + ENGINE_OP_HEADROOM;
+        op->next = instance->freeOps;
+        instance->freeOps = op;
+        instance->numFreeOps++;
+    }
+
+    return stat;
+}
+
+static void freeOps(EngineInstance *instance)
+{
+    Cpa32U opIdx = 0;
+
+    if (NULL == instance->ops)
+    {
+        return;
+    }
+    for (opIdx = 0; opIdx < ENGINE_OPS_PER_INSTANCE; opIdx++)
+    {
+        memFreeContig((void *)&instance->ops[opIdx].pinned);
+    }
+    memFreeOs((void *)&instance->ops);
+    instance->freeOps = NULL;
+    instance->numFreeOps = 0;
+}
+
+/*
+ * Size the session context cache of the instance's node for the largest context any of the algorithms needs
+ */
+static CpaStatus prewarmSessions(EngineInstance *instance)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDescs = NULL;
+    Cpa32U numDescs = 0;
+    Cpa32U descIdx = 0;
+    Cpa32U sessionCtxSize = 0;
+    Cpa32U maxSessionCtxSize = 0;
+    Cpa8U key[ENGINE_MAX_KEY_SIZE] = {0};
+    TestData params = {0};
+    CpaCySymSessionSetupData sessionSetupData = {0};
+
+    algoDescs = getAlgoDescs(&numDescs);
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        /* Sessions of experimental algorithms get their contexts as they come */
+        if (CPA_TRUE == algoDescs[descIdx].experimental)
+        {
+            continue;
+        }
+        memset(&params, 0, sizeof(params));
+        memset(&sessionSetupData, 0, sizeof(sessionSetupData));
+        params.op = algoDescs[descIdx].op;
+        params.key = key;
+        params.keySize = algoDescs[descIdx].keySize;
+        params.outSize = 4;
+        sessionSetupData.sessionPriority = CPA_CY_PRIORITY_NORMAL;
+        algoDescs[descIdx].setupSession(&params, &sessionSetupData);
+
+        stat = cpaCySymSessionCtxGetSize(instance->cyInstHandle, &sessionSetupData, &sessionCtxSize);
+        if (CPA_STATUS_SUCCESS == stat && sessionCtxSize > maxSessionCtxSize)
+        {
+            maxSessionCtxSize = sessionCtxSize;
+        }
+    }
+
+    if (0 == maxSessionCtxSize)
+    {
+        /* Not started, contexts are allocated as sessions come */
+        return CPA_STATUS_SUCCESS;
+    }
+    return prewarmSessionCtxs(instance->node, ENGINE_MAX_SESSIONS, maxSessionCtxSize);
+}
+
+/*
+ * Order the instances by node so that the instances of a node are adjacent, keeping the driver's order within
+ * a node
+ */
+static void sortInstancesByNode(CpaInstanceHandle *cyInstHandles, Cpa32U *nodes, Cpa16U numInstances)
+{
+    CpaInstanceHandle cyInstHandle = NULL;
+    Cpa32U node = 0;
+    Cpa16U instIdx = 0;
+    Cpa16U pos = 0;
+
+    for (instIdx = 0; instIdx < numInstances; instIdx++)
+    {
+        nodes[instIdx] = getInstanceNode(cyInstHandles[instIdx]);
+    }
+    for (instIdx = 1; instIdx < numInstances; instIdx++)
+    {
+        cyInstHandle = cyInstHandles[instIdx];
+        node = nodes[instIdx];
+        for (pos = instIdx; 0 < pos && nodes[pos - 1] > node; pos--)
+        {
+            cyInstHandles[pos] = cyInstHandles[pos - 1];
+            nodes[pos] = nodes[pos - 1];
+        }
+        cyInstHandles[pos] = cyInstHandle;
+        nodes[pos] = node;
+    }
+}
+
+/*
+ * Next healthy instance on the node of the calling thread in round-robin order, any healthy instance when the
+ * node has none, any instance at all when none is healthy
+ */
+static EngineInstance *pickInstance(void)
+{
+    Cpa32U node = getCurrentNode();
+    Cpa16U candidates[MAX_INSTANCES];
+    Cpa16U numCandidates = 0;
+    Cpa16U instIdx = 0;
+    Cpa32U pass = 0;
+
+    for (pass = 0; 0 == numCandidates && pass < 3; pass++)
+    {
+        for (instIdx = 0; instIdx < numInstances_g; instIdx++)
+        {
+            if ((0 < pass || node == instances_g[instIdx].node) &&
+                (2 == pass || HEALTH_UP == instances_g[instIdx].health.state))
+            {
+                candidates[numCandidates++] = instIdx;
+            }
+        }
+    }
+    if (1 < pass)
+    {
+        node = 0;
+    }
+
+    instIdx = candidates[nextInstance_g[node] % numCandidates];
+    nextInstance_g[node]++;
+    return &instances_g[instIdx];
+}
+
+static CpaStatus startInstance(EngineInstance *instance)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+
+    stat = cpaCyStartInstance(instance->cyInstHandle);
+    CHECK_ERR_STATUS("cpaCyStartInstance", stat);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+    instance->started = CPA_TRUE;
+
+    stat = cpaCySetAddressTranslation(instance->cyInstHandle, engineVirtToPhys);
+    CHECK_ERR_STATUS("cpaCySetAddressTranslation", stat);
+    return stat;
+}
+
+CpaStatus engineStart(void)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    CpaInstanceHandle cyInstHandles[MAX_INSTANCES];
+    Cpa32U nodes[MAX_INSTANCES];
+    Cpa16U numInstances = 0;
+    Cpa16U instIdx = 0;
+    EngineInstance *instance = NULL;
+
+    PRINT_DBG("qaeMemInit()\n");
+    stat = qaeMemInit();
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        PRINT_ERR("Failed to initialise memory driver\n");
+        return stat;
+    }
+
+    PRINT_DBG("icp_sal_userStart()\n");
+    stat = icp_sal_userStart("PDCP");
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        PRINT_ERR("Failed to start user process 'PDCP'\n");
+        qaeMemDestroy();
+        return stat;
+    }
+
+    stat = cpaCyGetNumInstances(&numInstances);
+    CHECK_ERR_STATUS("cpaCyGetNumInstances", stat);
+    if (CPA_STATUS_SUCCESS == stat && 0 == numInstances)
+    {
+        PRINT_ERR("No instances found for 'PDCP'\n");
+        stat = CPA_STATUS_FAIL;
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        if (numInstances > MAX_INSTANCES)
+        {
+            numInstances = MAX_INSTANCES;
+        }
+        stat = cpaCyGetInstances(numInstances, cyInstHandles);
+        CHECK_ERR_STATUS("cpaCyGetInstances", stat);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        sortInstancesByNode(cyInstHandles, nodes, numInstances);
+    }
+
+    /*
+     * Start every instance and give each one its pool of pinned op buffers and session contexts, allocated on
+     * the node the instance lives on. An instance that does not start is out of service, a probe starts it
+     * later.
+     */
+    for (instIdx = 0; CPA_STATUS_SUCCESS == stat && instIdx < numInstances; instIdx++)
+    {
+        instance = &instances_g[instIdx];
+        memset(instance, 0, sizeof(EngineInstance));
+        instance->cyInstHandle = cyInstHandles[instIdx];
+        instance->node = nodes[instIdx];
+        instance->eventFd = -1;
+        healthInit(&instance->health);
+        PRINT_DBG("Instance %u on node %u\n", instIdx, instance->node);
+        numInstances_g++;
+
+        if (CPA_STATUS_SUCCESS != startInstance(instance))
+        {
+            PRINT_ERR("Instance %u out of service (%s)\n", instIdx, healthReasonName(HEALTH_REASON_START));
+            healthMarkDown(&instance->health, HEALTH_REASON_START, nowNs());
+        }
+
+        stat = prewarmOps(instance);
+        if (CPA_STATUS_SUCCESS == stat)
+        {
+            stat = prewarmSessions(instance);
+        }
+    }
+
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        engineStop();
+        return stat;
+    }
+
+    memset(sessions_g, 0, sizeof(sessions_g));
+    memset(nextInstance_g, 0, sizeof(nextInstance_g));
+    memset(&stats_g, 0, sizeof(stats_g));
+    stats_g.numInstances = numInstances_g;
+    running_g = CPA_TRUE;
+    PRINT("Engine started with %u instances\n", numInstances_g);
+
+    return CPA_STATUS_SUCCESS;
+}
+
+Cpa32U engineNumInstances(void)
+{
+    return numInstances_g;
+}
+
+CpaStatus engineBindThreadToInstance(Cpa32U instanceIdx)
+{
+    if (numInstances_g <= instanceIdx)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    return bindThreadToInstance(instances_g[instanceIdx].cyInstHandle);
+}
+
+CpaStatus engineBindThread(void)
+{
+    Cpa32U node = getCurrentNode();
+    Cpa16U instIdx = 0;
+
+    for (instIdx = 0; instIdx < numInstances_g; instIdx++)
+    {
+        if (node == instances_g[instIdx].node)
+        {
+            return bindThreadToInstance(instances_g[instIdx].cyInstHandle);
+        }
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+void engineStop(void)
+{
+    Cpa32U sessionIdx = 0;
+    Cpa32U waitMs = 0;
+    Cpa16U instIdx = 0;
+
+    running_g = CPA_FALSE;
+
+    for (sessionIdx = 0; sessionIdx < ENGINE_MAX_SESSIONS; sessionIdx++)
+    {
+        if (CPA_TRUE == sessions_g[sessionIdx].inUse)
+        {
+            engineRetireSession(sessionIdx, sessions_g[sessionIdx].owner);
+        }
+    }
+    for (instIdx = 0; instIdx < numInstances_g; instIdx++)
+    {
+        if (NULL != sessions_g[ENGINE_MAX_SESSIONS + instIdx].sessionCtx)
+        {
+            retireSession(instances_g[instIdx].cyInstHandle, sessions_g[ENGINE_MAX_SESSIONS + instIdx].sessionCtx);
+            sessions_g[ENGINE_MAX_SESSIONS + instIdx].sessionCtx = NULL;
+        }
+    }
+    for (waitMs = 0; 0 < numRetiredSessions(NULL) && ENGINE_STOP_TIMEOUT_MS > waitMs; waitMs++)
+    {
+        enginePoll();
+        if (0 < numRetiredSessions(NULL))
+        {
+            OS_SLEEP(1);
+        }
+    }
+    if (0 < numRetiredSessions(NULL))
+    {
+        PRINT_ERR("%u retired sessions still have requests in flight\n", numRetiredSessions(NULL));
+    }
+
+    for (instIdx = 0; instIdx < numInstances_g; instIdx++)
+    {
+        if (0 <= instances_g[instIdx].eventFd)
+        {
+            icp_sal_CyPutFileDescriptor(instances_g[instIdx].cyInstHandle, instances_g[instIdx].eventFd);
+            instances_g[instIdx].eventFd = -1;
+        }
+        if (CPA_TRUE == instances_g[instIdx].started)
+        {
+            PRINT_DBG("cpaCyStopInstance()\n");
+            cpaCyStopInstance(instances_g[instIdx].cyInstHandle);
+            instances_g[instIdx].started = CPA_FALSE;
+        }
+        freeOps(&instances_g[instIdx]);
+        instances_g[instIdx].cyInstHandle = NULL;
+    }
+    numInstances_g = 0;
+    freeSessionCtxs();
+    shadowStop();
+
+    PRINT_DBG("icp_sal_userStop()\n");
+    icp_sal_userStop();
+    qaeMemDestroy();
+}
+
+CpaBoolean engineIsRunning(void)
+{
+    return running_g;
+}
+
+/*
+ * Recompute 1 in sampleRate ops on the software engine from now on, see shadow.c
+ */
+CpaStatus engineEnableShadow(Cpa32U sampleRate)
+{
+    if (CPA_TRUE != running_g)
+    {
+        return CPA_STATUS_FAIL;
+    }
+    return shadowStart(sampleRate);
+}
+
+void engineGetStats(EngineStats *stats)
+{
+    ShadowStats shadowStats = {0};
+    Cpa16U instIdx = 0;
+
+    EngineInstance *instance = NULL;
+
+    memset(stats, 0, sizeof(EngineStats));
+    stats->numErrors = __atomic_load_n(&stats_g.numErrors, __ATOMIC_RELAXED);
+    stats->numInstances = numInstances_g;
+    stats->numSessions = stats_g.numSessions;
+    stats->numRetiredSessions = numRetiredSessions(NULL);
+    for (instIdx = 0; instIdx < numInstances_g; instIdx++)
+    {
+        /* Counters of an instance are only written by the thread driving it, a read may be slightly stale */
+        instance = &instances_g[instIdx];
+        stats->numSubmitted += __atomic_load_n(&instance->numSubmitted, __ATOMIC_RELAXED);
+        stats->numCompleted += __atomic_load_n(&instance->numCompleted, __ATOMIC_RELAXED);
+        stats->numErrors += __atomic_load_n(&instance->numErrors, __ATOMIC_RELAXED);
+        stats->numRetries += __atomic_load_n(&instance->numRetries, __ATOMIC_RELAXED);
+        stats->numInflight += __atomic_load_n(&instance->numInflight, __ATOMIC_RELAXED);
+        stats->numZeroCopy += __atomic_load_n(&instance->numZeroCopy, __ATOMIC_RELAXED);
+        stats->numBounced += __atomic_load_n(&instance->numBounced, __ATOMIC_RELAXED);
+        stats->numVerifyFailures += __atomic_load_n(&instance->numVerifyFailures, __ATOMIC_RELAXED);
+        stats->numThrottled += __atomic_load_n(&instance->numThrottled, __ATOMIC_RELAXED);
+        stats->numCpuOps += __atomic_load_n(&instance->numCpuOps, __ATOMIC_RELAXED);
+        stats->numAbandoned += __atomic_load_n(&instance->numAbandoned, __ATOMIC_RELAXED);
+        stats->numFailovers += __atomic_load_n(&instance->health.numFailovers, __ATOMIC_RELAXED);
+        stats->numProbes += __atomic_load_n(&instance->health.numProbes, __ATOMIC_RELAXED);
+        stats->numReadmissions += __atomic_load_n(&instance->health.numReadmissions, __ATOMIC_RELAXED);
+        stats->numInstancesDown += (HEALTH_UP != instance->health.state) ? 1 : 0;
+    }
+    stats->numMigrations = __atomic_load_n(&stats_g.numMigrations, __ATOMIC_RELAXED);
+    stats->numRekeys = __atomic_load_n(&stats_g.numRekeys, __ATOMIC_RELAXED);
+    shadowGetStats(&shadowStats);
+    stats->numShadowChecked = shadowStats.numChecked;
+    stats->numShadowMismatches = shadowStats.numMismatches;
+    stats->numShadowSkipped = shadowStats.numSkipped;
+}
+
+Cpa32U engineInstanceHealth(Cpa32U instanceIdx)
+{
+    if (numInstances_g <= instanceIdx)
+    {
+        return HEALTH_DOWN;
+    }
+    return instances_g[instanceIdx].health.state;
+}
+
+CpaInstanceHandle engineInstanceHandle(Cpa32U instanceIdx)
+{
+    if (numInstances_g <= instanceIdx || CPA_TRUE != instances_g[instanceIdx].started ||
+        HEALTH_UP != instances_g[instanceIdx].health.state)
+    {
+        return NULL;
+    }
+    return instances_g[instanceIdx].cyInstHandle;
+}
+
+/*
+ * Fill in a session on instance, without its session context
+ */
+static void initEngineSession(EngineSession *session,
+                              EngineInstance *instance,
+                              const AlgoDesc *algoDesc,
+                              const Cpa8U *key,
+                              Cpa32U keySize,
+                              Cpa8U bearer,
+                              Cpa8U dir,
+                              Cpa32U digestSize,
+                              CpaBoolean verifyDigest,
+                              Cpa32U trafficClass)
+{
+    Cpa8U iv[MAX_IV_SIZE];
+
+    memset(session, 0, sizeof(EngineSession));
+    memcpy(session->key, key, keySize);
+    session->algoDesc = algoDesc;
+    session->params.op = algoDesc->op;
+    session->params.cipherAlgo = algoDesc->cipherAlgo;
+    session->params.hashAlgo = algoDesc->hashAlgo;
+    session->params.key = session->key;
+    session->params.keySize = keySize;
+    session->params.bearer = bearer;
+    session->params.dir = dir;
+    session->params.outSize = digestSize;
+    opDescInit(&session->opDesc, &session->params);
+    session->opDesc.ivSize = (Cpa8U)buildIv(&session->opDesc, iv);
+    session->verifyDigest = verifyDigest;
+    session->trafficClass = trafficClass;
+    session->instance = instance;
+
+    /* High priority sessions go to the high priority rings of the instance */
+    session->setupData.sessionPriority =
+        ENGINE_IS_HIGH_PRIORITY(trafficClass) ? CPA_CY_PRIORITY_HIGH : CPA_CY_PRIORITY_NORMAL;
+    algoDesc->setupSession(&session->params, &session->setupData);
+    if (CPA_TRUE == verifyDigest)
+    {
+        /* Uplink: the device compares the MAC-I following the message and reports it in verifyResult */
+        session->setupData.verifyDigest = CPA_TRUE;
+        session->setupData.digestIsAppended = CPA_TRUE;
+    }
+}
+
+/*
+ * Sessions go to the given instance, or are spread over the healthy instances local to the caller when it is
+ * NULL. The session context is created once the instance is in service.
+ */
+static CpaStatus createEngineSession(EngineInstance *instance,
+                                     const char *algoName,
+                                     const Cpa8U *key,
+                                     Cpa32U keySize,
+                                     Cpa8U bearer,
+                                     Cpa8U dir,
+                                     Cpa32U digestSize,
+                                     CpaBoolean verifyDigest,
+                                     Cpa32U trafficClass,
+                                     void *owner,
+                                     Cpa32U *sessionId)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = NULL;
+    EngineSession *session = NULL;
+    Cpa32U sessionIdx = 0;
+
+    algoDesc = findAlgoDesc(algoName);
+    if (CPA_TRUE != running_g || NULL == algoDesc || algoDesc->keySize != keySize ||
+        ENGINE_MAX_DIGEST_SIZE < digestSize || (CPA_TRUE == verifyDigest && CPA_CY_SYM_OP_HASH != algoDesc->op) ||
+        ENGINE_NUM_CLASSES <= trafficClass)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    for (sessionIdx = 0; sessionIdx < ENGINE_MAX_SESSIONS; sessionIdx++)
+    {
+        if (CPA_TRUE != sessions_g[sessionIdx].inUse)
+        {
+            session = &sessions_g[sessionIdx];
+            break;
+        }
+    }
+    if (NULL == session)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+
+    initEngineSession(session,
+                      (NULL != instance) ? instance : pickInstance(),
+                      algoDesc,
+                      key,
+                      keySize,
+                      bearer,
+                      dir,
+                      digestSize,
+                      verifyDigest,
+                      trafficClass);
+    session->pinned = (NULL != instance) ? CPA_TRUE : CPA_FALSE;
+    if (HEALTH_UP == session->instance->health.state)
+    {
+        stat = createSession(
+            session->instance->cyInstHandle, engineCallback, &session->setupData, &session->sessionCtx);
+        if (CPA_STATUS_UNSUPPORTED == stat && CPA_STATUS_SUCCESS == swInitSession(&session->sw, &session->setupData))
+        {
+            /* Not on this device, but the CPU has it: no instance will take it, so it stays in software */
+            session->cpuOnly = CPA_TRUE;
+            session->swReady = CPA_TRUE;
+            stat = CPA_STATUS_SUCCESS;
+        }
+        if (CPA_STATUS_SUCCESS != stat)
+        {
+            return stat;
+        }
+    }
+
+    session->owner = owner;
+    session->inUse = CPA_TRUE;
+    stats_g.numSessions++;
+    *sessionId = sessionIdx;
+
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus engineCreateSession(const char *algoName,
+                              const Cpa8U *key,
+                              Cpa32U keySize,
+                              Cpa8U bearer,
+                              Cpa8U dir,
+                              Cpa32U digestSize,
+                              CpaBoolean verifyDigest,
+                              Cpa32U trafficClass,
+                              void *owner,
+                              Cpa32U *sessionId)
+{
+    return createEngineSession(
+        NULL, algoName, key, keySize, bearer, dir, digestSize, verifyDigest, trafficClass, owner, sessionId);
+}
+
+CpaStatus engineCreateInstanceSession(Cpa32U instanceIdx,
+                                      const char *algoName,
+                                      const Cpa8U *key,
+                                      Cpa32U keySize,
+                                      Cpa8U bearer,
+                                      Cpa8U dir,
+                                      Cpa32U digestSize,
+                                      CpaBoolean verifyDigest,
+                                      Cpa32U trafficClass,
+                                      void *owner,
+                                      Cpa32U *sessionId)
+{
+    if (numInstances_g <= instanceIdx)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    return createEngineSession(&instances_g[instanceIdx],
+                               algoName,
+                               key,
+                               keySize,
+                               bearer,
+                               dir,
+                               digestSize,
+                               verifyDigest,
+                               trafficClass,
+                               owner,
+                               sessionId);
+}
+
+static void dropRekey(EngineRekey *rekey)
+{
+    if (NULL != rekey->sessionCtx)
+    {
+        retireSession(rekey->instance->cyInstHandle, rekey->sessionCtx);
+    }
+    arenaFree(rekey);
+}
+
+CpaStatus engineRekeySession(Cpa32U sessionId, const Cpa8U *key, Cpa32U keySize, void *owner)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    CpaCySymSessionSetupData setupData;
+    EngineSession *session = NULL;
+    EngineRekey *rekey = NULL;
+
+    if (ENGINE_MAX_SESSIONS <= sessionId)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    session = &sessions_g[sessionId];
+    if (CPA_TRUE != session->inUse || owner != session->owner || keySize != session->params.keySize)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    rekey = arenaAlloc(sizeof(EngineRekey));
+    if (NULL == rekey)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+    memcpy(rekey->key, key, keySize);
+    rekey->instance = session->instance;
+    rekey->sessionCtx = NULL;
+
+    setupData = session->setupData;
+    if (CPA_CY_SYM_OP_CIPHER == session->params.op)
+    {
+        setupData.cipherSetupData.pCipherKey = rekey->key;
+    }
+    else
+    {
+        setupData.hashSetupData.authModeSetupData.authKey = rekey->key;
+    }
+    if (HEALTH_UP == rekey->instance->health.state && CPA_TRUE != session->cpuOnly)
+    {
+        stat = createSession(rekey->instance->cyInstHandle, engineCallback, &setupData, &rekey->sessionCtx);
+        if (CPA_STATUS_SUCCESS != stat)
+        {
+            arenaFree(rekey);
+            return stat;
+        }
+    }
+
+    /* A key the data path has not taken yet is superseded */
+    rekey = __atomic_exchange_n(&session->rekey, rekey, __ATOMIC_ACQ_REL);
+    if (NULL != rekey)
+    {
+        dropRekey(rekey);
+    }
+    __atomic_add_fetch(&stats_g.numRekeys, 1, __ATOMIC_RELAXED);
+
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ * Switch a session to its new key, on the thread driving its data path
+ */
+static void applyRekey(EngineSession *session)
+{
+    EngineRekey *rekey = __atomic_exchange_n(&session->rekey, NULL, __ATOMIC_ACQ_REL);
+
+    if (NULL == rekey)
+    {
+        return;
+    }
+    memcpy(session->key, rekey->key, session->params.keySize);
+    session->swReady = CPA_FALSE;
+    if (NULL != session->sessionCtx)
+    {
+        retireSession(session->instance->cyInstHandle, session->sessionCtx);
+    }
+    session->sessionCtx = NULL;
+    if (rekey->instance == session->instance)
+    {
+        session->sessionCtx = rekey->sessionCtx;
+        rekey->sessionCtx = NULL;
+    }
+    /* Set up for an instance the session has moved off since, it gets a new context where it is now */
+    dropRekey(rekey);
+}
+
+CpaStatus engineRetireSession(Cpa32U sessionId, void *owner)
+{
+    EngineRekey *rekey = NULL;
+    EngineSession *session = NULL;
+
+    if (ENGINE_MAX_SESSIONS <= sessionId)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    session = &sessions_g[sessionId];
+    if (CPA_TRUE != session->inUse || owner != session->owner)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    if (NULL != session->sessionCtx)
+    {
+        retireSession(session->instance->cyInstHandle, session->sessionCtx);
+    }
+    session->sessionCtx = NULL;
+    rekey = __atomic_exchange_n(&session->rekey, NULL, __ATOMIC_ACQ_REL);
+    if (NULL != rekey)
+    {
+        dropRekey(rekey);
+    }
+    session->inUse = CPA_FALSE;
+    stats_g.numSessions--;
+
+    return CPA_STATUS_SUCCESS;
+}
+
+Cpa32U engineSessionClass(Cpa32U sessionId)
+{
+    if (ENGINE_MAX_SESSIONS <= sessionId || CPA_TRUE != sessions_g[sessionId].inUse)
+    {
+        return ENGINE_CLASS_BULK;
+    }
+    return sessions_g[sessionId].trafficClass;
+}
+
+void engineRetireSessionsOf(void *owner)
+{
+    Cpa32U sessionIdx = 0;
+
+    for (sessionIdx = 0; sessionIdx < ENGINE_MAX_SESSIONS; sessionIdx++)
+    {
+        if (CPA_TRUE == sessions_g[sessionIdx].inUse && owner == sessions_g[sessionIdx].owner)
+        {
+            engineRetireSession(sessionIdx, owner);
+        }
+    }
+}
+
+static EngineOp *takeOp(EngineInstance *instance)
+{
+    EngineOp *op = instance->freeOps;
+
+    if (NULL != op)
+    {
+        instance->freeOps = op->next;
+        instance->numFreeOps--;
+        op->port = NULL;
+        op->next = NULL;
+    }
+    return op;
+}
+
+/*
+ * Move a session off an instance out of service, onto a healthy instance when there is one. Its requests in
+ * flight complete where they are.
+ */
+static void migrateSession(EngineSession *session)
+{
+    EngineInstance *instance = pickInstance();
+    CpaCySymSessionCtx sessionCtx = NULL;
+
+    if (instance == session->instance || HEALTH_UP != instance->health.state ||
+        CPA_STATUS_SUCCESS != createSession(instance->cyInstHandle, engineCallback, &session->setupData, &sessionCtx))
+    {
+        return;
+    }
+    if (NULL != session->sessionCtx)
+    {
+        retireSession(session->instance->cyInstHandle, session->sessionCtx);
+    }
+    session->instance = instance;
+    session->sessionCtx = sessionCtx;
+    __atomic_add_fetch(&stats_g.numMigrations, 1, __ATOMIC_RELAXED);
+}
+
+EngineOp *engineAllocOp(Cpa32U sessionId)
+{
+    EngineSession *session = NULL;
+    EngineOp *op = NULL;
+
+    if (ENGINE_MAX_SESSIONS <= sessionId || CPA_TRUE != sessions_g[sessionId].inUse)
+    {
+        return NULL;
+    }
+    session = &sessions_g[sessionId];
+
+    if (NULL != __atomic_load_n(&session->rekey, __ATOMIC_ACQUIRE))
+    {
+        applyRekey(session);
+    }
+    if (HEALTH_UP != session->instance->health.state && CPA_TRUE != session->pinned && CPA_TRUE != session->cpuOnly)
+    {
+        migrateSession(session);
+    }
+    if (HEALTH_UP == session->instance->health.state && NULL == session->sessionCtx && CPA_TRUE != session->cpuOnly)
+    {
+        /* Back in service, or first time in; the software engine keeps the session while this fails */
+        if (CPA_STATUS_UNSUPPORTED ==
+            createSession(session->instance->cyInstHandle, engineCallback, &session->setupData, &session->sessionCtx))
+        {
+            session->cpuOnly = CPA_TRUE;
+        }
+    }
+
+    /* The last ENGINE_RESERVED_OPS ops are kept for high priority sessions */
+    if (!ENGINE_IS_HIGH_PRIORITY(session->trafficClass) && ENGINE_RESERVED_OPS >= session->instance->numFreeOps)
+    {
+        session->instance->numThrottled++;
+        return NULL;
+    }
+    op = takeOp(session->instance);
+    if (NULL != op)
+    {
+        op->session = session;
+    }
+    return op;
+}
+
+void engineFreeOp(EngineOp *op)
+{
+    if (CPA_TRUE == op->inflight)
+    {
+        /* Failed back while the device still holds it, the op goes back to the pool once the device lets go */
+        op->released = CPA_TRUE;
+        return;
+    }
+    op->session = NULL;
+    op->abandoned = CPA_FALSE;
+    op->released = CPA_FALSE;
+    op->probe = CPA_FALSE;
+    op->next = op->instance->freeOps;
+    op->instance->freeOps = op;
+    op->instance->numFreeOps++;
+}
+
+/*
+ * Run an op on the software engine and complete it at once, as the device would have
+ */
+static CpaStatus performCpuOp(EngineOp *op)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    EngineSession *session = op->session;
+    CpaBoolean verifyResult = CPA_TRUE;
+
+    if (CPA_TRUE != session->swReady)
+    {
+        if (CPA_STATUS_SUCCESS != swInitSession(&session->sw, &session->setupData))
+        {
+            /* Not an algorithm the software engine knows */
+            op->instance->numErrors++;
+            return CPA_STATUS_UNSUPPORTED;
+        }
+        session->swReady = CPA_TRUE;
+    }
+
+    stat = swProcessBufferList(&session->sw, &session->setupData, &op->opData, &op->bufferList, &verifyResult);
+    op->instance->numSubmitted++;
+    op->instance->numCpuOps++;
+    completeOp(op, stat, verifyResult);
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ * descSample measures building the op, begun by the caller and ended here once the op data is filled
+ */
+static CpaStatus performOp(EngineOp *op, PmuSample *descSample)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    EngineSession *session = op->session;
+    PmuSample pmuSample;
+
+    session->algoDesc->fillOpData(&op->opDesc, session->sessionCtx, op->ivBuffer, op->digestBuffer, &op->opData);
+    PMU_END(descSample, PMU_STAGE_DESC, session->algoDesc, 1);
+
+    if (CPA_TRUE != op->probe && (HEALTH_UP != op->instance->health.state || NULL == session->sessionCtx))
+    {
+        return performCpuOp(op);
+    }
+
+    /* The device may work in place as soon as the request is queued, sample the input first */
+    op->shadow =
+        shadowCapture(session->algoDesc, &session->params, &op->opDesc, session->verifyDigest, &op->bufferList);
+
+    /* Traced before the submission, the completion may be polled on another thread right after it */
+    TRACE_EVENT(TRACE_SUBMIT, op, (Cpa32U)(session - sessions_g), op->opDesc.bitLen / 8, CPA_STATUS_SUCCESS);
+    op->done = 0;
+    healthOnSubmit(&op->instance->health, op->instance->numInflight);
+    PMU_BEGIN(&pmuSample, PMU_STAGE_SUBMIT);
+    stat = cpaCySymPerformOp(op->instance->cyInstHandle,
+                             (void *)op,
+                             &op->opData,
+                             &op->bufferList,
+                             &op->bufferList,
+                             NULL);
+    PMU_END(&pmuSample, PMU_STAGE_SUBMIT, session->algoDesc, 1);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        op->inflight = CPA_TRUE;
+        op->instance->numInflight++;
+        op->instance->numSubmitted++;
+        return stat;
+    }
+
+    if (NULL != op->shadow)
+    {
+        shadowComplete(op->shadow, stat, NULL, NULL, CPA_FALSE);
+        op->shadow = NULL;
+    }
+    TRACE_EVENT(CPA_STATUS_RETRY == stat ? TRACE_RETRY : TRACE_ERROR,
+                op,
+                (Cpa32U)(session - sessions_g),
+                op->opDesc.bitLen / 8,
+                stat);
+    if (CPA_STATUS_RETRY == stat)
+    {
+        op->instance->numRetries++;
+        return stat;
+    }
+    op->instance->numErrors++;
+
+    if ((CPA_STATUS_FAIL == stat || CPA_STATUS_RESTARTING == stat) && CPA_TRUE != op->probe)
+    {
+        /* Refused by the device, not by its parameters: the software engine takes it */
+        healthOnError(&op->instance->health);
+        return performCpuOp(op);
+    }
+    return stat;
+}
+
+/*
+ * length covers the whole PDU, including the MAC-I of a verifying session which is not part of the message. iv
+ * is the IV built for the op beforehand, NULL to build it here.
+ */
+static CpaStatus prepareOp(EngineOp *op, Cpa32U count, Cpa32U fresh, Cpa32U length, const Cpa8U *iv)
+{
+    PmuSample pmuSample;
+
+    if (CPA_TRUE == op->session->verifyDigest)
+    {
+        if (op->session->params.outSize >= length)
+        {
+            return CPA_STATUS_INVALID_PARAM;
+        }
+        length -= op->session->params.outSize;
+    }
+
+    op->opDesc = op->session->opDesc;
+    op->opDesc.count = count;
+    op->opDesc.fresh = fresh;
+    op->opDesc.bitLen = length * 8;
+    if (NULL != iv)
+    {
+        memcpy(op->ivBuffer, iv, op->opDesc.ivSize);
+    }
+    else
+    {
+        PMU_BEGIN(&pmuSample, PMU_STAGE_IV);
+        op->opDesc.ivSize = (Cpa8U)buildIv(&op->opDesc, op->ivBuffer);
+        PMU_END(&pmuSample, PMU_STAGE_IV, op->session->algoDesc, 1);
+    }
+    op->opDesc.inSize = op->session->algoDesc->msgIvPrefixLen + length;
+    return CPA_STATUS_SUCCESS;
+}
+
+static CpaStatus submitOp(EngineOp *op, Cpa32U count, Cpa32U fresh, Cpa32U length, const Cpa8U *iv)
+{
+    Cpa32U prefixLen = op->session->algoDesc->msgIvPrefixLen;
+    PmuSample pmuSample;
+
+    PMU_BEGIN(&pmuSample, PMU_STAGE_DESC);
+    if (CPA_STATUS_SUCCESS != prepareOp(op, count, fresh, length, iv))
+    {
+        PMU_END(&pmuSample, PMU_STAGE_DESC, op->session->algoDesc, 0);
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    /* 128-NIA2 takes COUNT, BEARER and DIRECTION in front of the message */
+    memcpy(op->payload - prefixLen, op->ivBuffer, prefixLen);
+    op->bufferList.pBuffers = op->flatBuffers;
+    op->bufferList.numBuffers = 1;
+    op->flatBuffers[0].pData = op->payload - prefixLen;
+    op->flatBuffers[0].dataLenInBytes = prefixLen + length;
+
+    return performOp(op, &pmuSample);
+}
+
+CpaStatus engineSubmitOp(EngineOp *op, Cpa32U count, Cpa32U fresh, Cpa32U length)
+{
+    return submitOp(op, count, fresh, length, NULL);
+}
+
+/*
+ * Process a chained packet in place from byte offset on, leading headers stay untouched. The IV prefix goes
+ * in a flat buffer of its own in front of the segments.
+ */
+CpaStatus engineSubmitChainOp(EngineOp *op, Cpa32U count, Cpa32U fresh, const PktBuf *chain, Cpa32U offset)
+{
+    Cpa32U prefixLen = op->session->algoDesc->msgIvPrefixLen;
+    Cpa32U length = 0;
+    Cpa32U numBuffers = 0;
+    PmuSample pmuSample;
+
+    PMU_BEGIN(&pmuSample, PMU_STAGE_DESC);
+    length = chainLength(chain);
+    if (offset < length)
+    {
+        numBuffers = fillChainBuffers(chain, offset, op->flatBuffers + 1, ENGINE_MAX_SEGMENTS);
+    }
+    if (0 == numBuffers || CPA_STATUS_SUCCESS != prepareOp(op, count, fresh, length - offset, NULL))
+    {
+        PMU_END(&pmuSample, PMU_STAGE_DESC, op->session->algoDesc, 0);
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    op->payload = NULL;
+    if (0 < prefixLen)
+    {
+        op->flatBuffers[0].pData = op->ivBuffer;
+        op->flatBuffers[0].dataLenInBytes = prefixLen;
+        op->bufferList.pBuffers = op->flatBuffers;
+        op->bufferList.numBuffers = numBuffers + 1;
+    }
+    else
+    {
+        op->bufferList.pBuffers = op->flatBuffers + 1;
+        op->bufferList.numBuffers = numBuffers;
+    }
+
+    return performOp(op, &pmuSample);
+}
+
+/*
+ * Fail back every op the device holds, it stopped answering
+ */
+static Cpa32U abandonOps(EngineInstance *instance)
+{
+    EngineOp *op = NULL;
+    Cpa32U numAbandoned = 0;
+    Cpa32U opIdx = 0;
+
+    for (opIdx = 0; opIdx < ENGINE_OPS_PER_INSTANCE; opIdx++)
+    {
+        op = &instance->ops[opIdx];
+        if (CPA_TRUE != op->inflight || CPA_TRUE == op->abandoned)
+        {
+            continue;
+        }
+        op->abandoned = CPA_TRUE;
+        instance->numInflight--;
+        instance->numAbandoned++;
+        numAbandoned++;
+        if (NULL != op->shadow)
+        {
+            shadowComplete(op->shadow, CPA_STATUS_FAIL, NULL, NULL, CPA_FALSE);
+            op->shadow = NULL;
+        }
+        if (CPA_TRUE == op->probe)
+        {
+            op->released = CPA_TRUE;
+            continue;
+        }
+        completeOp(op, CPA_STATUS_FAIL, CPA_FALSE);
+    }
+    return numAbandoned;
+}
+
+/*
+ * One small request on the probe session of the instance, which is started first if it never was
+ */
+static CpaStatus submitProbe(EngineInstance *instance)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    EngineSession *session = &sessions_g[ENGINE_MAX_SESSIONS + (instance - instances_g)];
+    EngineOp *op = NULL;
+    Cpa8U key[ENGINE_PROBE_KEY_SIZE] = {0};
+    Cpa32U byteIdx = 0;
+
+    if (CPA_TRUE != running_g)
+    {
+        return CPA_STATUS_FAIL;
+    }
+    if (CPA_TRUE != instance->started && CPA_STATUS_SUCCESS != startInstance(instance))
+    {
+        return CPA_STATUS_FAIL;
+    }
+    if (NULL == session->sessionCtx)
+    {
+        initEngineSession(session,
+                          instance,
+                          findAlgoDesc(ENGINE_PROBE_ALGO),
+                          key,
+                          sizeof(key),
+                          0,
+                          0,
+                          0,
+                          CPA_FALSE,
+                          ENGINE_CLASS_SIGNALLING);
+        session->pinned = CPA_TRUE;
+        stat = createSession(instance->cyInstHandle, engineCallback, &session->setupData, &session->sessionCtx);
+        if (CPA_STATUS_SUCCESS != stat)
+        {
+            return stat;
+        }
+    }
+
+    op = takeOp(instance);
+    if (NULL == op)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+    op->session = session;
+    op->probe = CPA_TRUE;
+    for (byteIdx = 0; byteIdx < ENGINE_PROBE_SIZE; byteIdx++)
+    {
+        op->data[byteIdx] = (Cpa8U)byteIdx;
+    }
+    op->payload = op->data;
+    stat = submitOp(op, (Cpa32U)instance->health.numProbes, 0, ENGINE_PROBE_SIZE, NULL);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        engineFreeOp(op);
+    }
+    return stat;
+}
+
+static void checkInstance(EngineInstance *instance)
+{
+    Cpa32U instIdx = (Cpa32U)(instance - instances_g);
+    Cpa32U state = instance->health.state;
+    Cpa64U now = nowNs();
+    Cpa32U numAbandoned = 0;
+
+    switch (healthCheck(&instance->health, now, instance->numInflight))
+    {
+        case HEALTH_ACTION_FAILOVER:
+            PRINT_ERR("Instance %u out of service (%s)\n", instIdx, healthReasonName(instance->health.reason));
+            break;
+        case HEALTH_ACTION_ABANDON:
+            if (HEALTH_UP == state)
+            {
+                PRINT_ERR("Instance %u out of service (%s)\n", instIdx, healthReasonName(instance->health.reason));
+            }
+            numAbandoned = abandonOps(instance);
+            PRINT_DBG("%u requests stuck on instance %u failed back\n", numAbandoned, instIdx);
+            break;
+        case HEALTH_ACTION_PROBE:
+            if (CPA_STATUS_SUCCESS != submitProbe(instance))
+            {
+                healthOnProbeResult(&instance->health, CPA_FALSE, now);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static Cpa32U pollEngineInstance(EngineInstance *instance)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Cpa64U numCompleted = instance->numCompleted;
+    PmuSample pmuSample;
+
+    if (CPA_TRUE == instance->started)
+    {
+        PMU_BEGIN(&pmuSample, PMU_STAGE_POLL);
+        stat = pollInstanceQuota(instance->cyInstHandle, ENGINE_POLL_QUOTA);
+        PMU_END(&pmuSample, PMU_STAGE_POLL, NULL, (Cpa32U)(instance->numCompleted - numCompleted));
+        if (CPA_STATUS_SUCCESS != stat && CPA_STATUS_RETRY != stat)
+        {
+            instance->numErrors++;
+            healthOnError(&instance->health);
+        }
+    }
+    checkInstance(instance);
+    return (Cpa32U)(instance->numCompleted - numCompleted);
+}
+
+Cpa32U enginePoll(void)
+{
+    Cpa32U numCompleted = 0;
+    Cpa16U instIdx = 0;
+
+    for (instIdx = 0; instIdx < numInstances_g; instIdx++)
+    {
+        numCompleted += pollEngineInstance(&instances_g[instIdx]);
+    }
+
+    return numCompleted;
+}
+
+/*
+ * Whether completions of the instance wake a thread sleeping on its event fd. The fd is only asked for when a
+ * thread first wants to sleep on it: signalling it costs the driver on every busy period, which instances that
+ * are only polled need not pay. Only instances configured for epoll mode have one.
+ */
+static CpaBoolean hasEvents(EngineInstance *instance)
+{
+    if (CPA_TRUE != instance->started || HEALTH_UP != instance->health.state)
+    {
+        return CPA_FALSE;
+    }
+    if (CPA_TRUE != instance->eventFdTried)
+    {
+        instance->eventFdTried = CPA_TRUE;
+        if (CPA_STATUS_SUCCESS != icp_sal_CyGetFileDescriptor(instance->cyInstHandle, &instance->eventFd))
+        {
+            instance->eventFd = -1;
+        }
+    }
+    return (0 <= instance->eventFd) ? CPA_TRUE : CPA_FALSE;
+}
+
+CpaBoolean engineGetEventFds(int *fds, Cpa32U maxFds, Cpa32U *numFds)
+{
+    EngineInstance *instance = NULL;
+    Cpa16U instIdx = 0;
+
+    *numFds = 0;
+    for (instIdx = 0; instIdx < numInstances_g; instIdx++)
+    {
+        instance = &instances_g[instIdx];
+        if (CPA_TRUE == hasEvents(instance) && *numFds < maxFds)
+        {
+            fds[(*numFds)++] = instance->eventFd;
+        }
+        else if (0 < instance->numInflight)
+        {
+            return CPA_FALSE;
+        }
+    }
+    return CPA_TRUE;
+}
+
+CpaStatus engineExecOp(Cpa32U sessionId,
+                       Cpa32U count,
+                       Cpa32U fresh,
+                       Cpa8U *data,
+                       Cpa32U length,
+                       Cpa8U *digest,
+                       void *owner)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    EngineOp *op = NULL;
+
+    if (ENGINE_MAX_SESSIONS <= sessionId || owner != sessions_g[sessionId].owner || ENGINE_MAX_PDU_SIZE < length)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    op = engineAllocOp(sessionId);
+    if (NULL == op)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+
+    memcpy(op->data, data, length);
+    op->payload = op->data;
+    do
+    {
+        stat = engineSubmitOp(op, count, fresh, length);
+        if (CPA_STATUS_RETRY == stat)
+        {
+            enginePoll();
+        }
+    } while (CPA_STATUS_RETRY == stat);
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        while (0 == __atomic_load_n(&op->done, __ATOMIC_ACQUIRE))
+        {
+            enginePoll();
+        }
+        stat = op->status;
+        if (CPA_STATUS_SUCCESS == stat && CPA_TRUE == op->session->verifyDigest && CPA_TRUE != op->verifyResult)
+        {
+            stat = CPA_STATUS_FAIL;
+        }
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        if (CPA_CY_SYM_OP_CIPHER == op->opDesc.op)
+        {
+            memcpy(data, op->data, length);
+        }
+        else if (NULL != digest && CPA_TRUE != op->session->verifyDigest)
+        {
+            memcpy(digest, op->digestBuffer, op->opDesc.outSize);
+        }
+    }
+    engineFreeOp(op);
+
+    return stat;
+}
+
+CpaStatus engineExecChainOp(Cpa32U sessionId,
+                            Cpa32U count,
+                            Cpa32U fresh,
+                            const PktBuf *chain,
+                            Cpa32U offset,
+                            Cpa8U *digest)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    EngineOp *op = NULL;
+
+    op = engineAllocOp(sessionId);
+    if (NULL == op)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+
+    do
+    {
+        stat = engineSubmitChainOp(op, count, fresh, chain, offset);
+        if (CPA_STATUS_RETRY == stat)
+        {
+            enginePoll();
+        }
+    } while (CPA_STATUS_RETRY == stat);
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        while (0 == __atomic_load_n(&op->done, __ATOMIC_ACQUIRE))
+        {
+            enginePoll();
+        }
+        stat = op->status;
+        if (CPA_STATUS_SUCCESS == stat && CPA_TRUE == op->session->verifyDigest && CPA_TRUE != op->verifyResult)
+        {
+            stat = CPA_STATUS_FAIL;
+        }
+    }
+
+    if (CPA_STATUS_SUCCESS == stat && CPA_CY_SYM_OP_HASH == op->opDesc.op && NULL != digest &&
+        CPA_TRUE != op->session->verifyDigest)
+    {
+        memcpy(digest, op->digestBuffer, op->opDesc.outSize);
+    }
+    engineFreeOp(op);
+
+    return stat;
+}
+
+/*
+ * Record the physical address of every page of the region so that payloads can be handed to the device in
+ * place. Needs the pages locked and /proc/self/pagemap readable with frame numbers (root); without either the
+ * port falls back to bouncing payloads through the op buffers.
+ */
+static void pinPortRegion(EnginePort *port)
+{
+    Cpa64U entry = 0;
+    Cpa8U *page = NULL;
+    Cpa32U pageIdx = 0;
+    int fd = -1;
+
+    port->pageBase = (Cpa8U *)((uintptr_t)port->region & ~(((uintptr_t)1 << ENGINE_PAGE_SHIFT) - 1));
+    port->numPages = ((port->region + port->regionSize - port->pageBase) + (1 << ENGINE_PAGE_SHIFT) - 1) >>
+                     ENGINE_PAGE_SHIFT;
+
+    if (0 != mlock(port->pageBase, (size_t)port->numPages << ENGINE_PAGE_SHIFT))
+    {
+        PRINT_DBG("Region %p is not pinned, payloads are copied\n", port->region);
+        return;
+    }
+    if (CPA_STATUS_SUCCESS != memAllocOs((void *)&port->physPages, port->numPages * sizeof(Cpa64U)))
+    {
+        return;
+    }
+
+    fd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+    for (pageIdx = 0; 0 <= fd && pageIdx < port->numPages; pageIdx++)
+    {
+        /* Fault the page in before asking for its frame, touching only bytes that belong to the region */
+        page = port->pageBase + ((size_t)pageIdx << ENGINE_PAGE_SHIFT);
+        *(volatile Cpa8U *)((page < port->region) ? port->region : page) += 0;
+        if (sizeof(entry) != pread(fd,
+                                   &entry,
+                                   sizeof(entry),
+                                   (((uintptr_t)port->pageBase >> ENGINE_PAGE_SHIFT) + pageIdx) * sizeof(entry)) ||
+            0 == (entry & (1ULL << 63)) || 0 == (entry & ((1ULL << 55) - 1)))
+        {
+            break;
+        }
+        port->physPages[pageIdx] = (entry & ((1ULL << 55) - 1)) << ENGINE_PAGE_SHIFT;
+    }
+    if (0 <= fd)
+    {
+        close(fd);
+    }
+
+    if (pageIdx != port->numPages)
+    {
+        PRINT_DBG("No physical addresses for region %p, payloads are copied\n", port->region);
+        memFreeOs((void *)&port->physPages);
+    }
+}
+
+static CpaBoolean isPortRangeContiguous(const EnginePort *port, Cpa32U offset, Cpa32U length)
+{
+    Cpa32U firstPage = (port->region + offset - port->pageBase) >> ENGINE_PAGE_SHIFT;
+    Cpa32U lastPage = (port->region + offset + length - 1 - port->pageBase) >> ENGINE_PAGE_SHIFT;
+    Cpa32U pageIdx = 0;
+
+    if (NULL == port->physPages)
+    {
+        return CPA_FALSE;
+    }
+    for (pageIdx = firstPage + 1; pageIdx <= lastPage; pageIdx++)
+    {
+        if (port->physPages[pageIdx] != port->physPages[pageIdx - 1] + (1 << ENGINE_PAGE_SHIFT))
+        {
+            return CPA_FALSE;
+        }
+    }
+    return CPA_TRUE;
+}
+
+CpaPhysicalAddr engineVirtToPhys(void *virtAddr)
+{
+    Cpa8U *addr = (Cpa8U *)virtAddr;
+    EnginePort *port = NULL;
+    Cpa32U portIdx = 0;
+    Cpa32U pageIdx = 0;
+
+    for (portIdx = 0; portIdx < ENGINE_MAX_PORTS; portIdx++)
+    {
+        port = ports_g[portIdx];
+        if (NULL != port && NULL != port->physPages && addr >= port->region &&
+            addr < port->region + port->regionSize)
+        {
+            pageIdx = (addr - port->pageBase) >> ENGINE_PAGE_SHIFT;
+            return port->physPages[pageIdx] + ((uintptr_t)addr & ((1 << ENGINE_PAGE_SHIFT) - 1));
+        }
+    }
+    return (CpaPhysicalAddr)qaeVirtToPhysNUMA(virtAddr);
+}
+
+static EnginePort *openPort(EngineInstance *instance,
+                            Cpa8U *region,
+                            Cpa32U regionSize,
+                            DescRing *cplRing,
+                            void *owner)
+{
+    EnginePort *port = NULL;
+    Cpa32U portIdx = 0;
+
+    for (portIdx = 0; portIdx < ENGINE_MAX_PORTS; portIdx++)
+    {
+        if (NULL == ports_g[portIdx])
+        {
+            break;
+        }
+    }
+    if (ENGINE_MAX_PORTS == portIdx || CPA_STATUS_SUCCESS != memAllocOs((void *)&port, sizeof(EnginePort)))
+    {
+        return NULL;
+    }
+    memset(port, 0, sizeof(EnginePort));
+    port->region = region;
+    port->regionSize = regionSize;
+    port->owner = owner;
+    port->instance = instance;
+
+    port->cplRing = cplRing;
+    if (NULL == port->cplRing)
+    {
+        /* In-process users get a private ring with room for every op the engine can have in flight */
+        if (CPA_STATUS_SUCCESS !=
+            memAllocContig((void *)&port->cplRing, RING_MEM_SIZE(ENGINE_OPS_PER_INSTANCE * MAX_INSTANCES), BYTE_ALIGNMENT))
+        {
+            memFreeOs((void *)&port);
+            return NULL;
+        }
+        ringInit(port->cplRing, ENGINE_OPS_PER_INSTANCE * MAX_INSTANCES);
+        port->ownRing = CPA_TRUE;
+    }
+
+    pinPortRegion(port);
+    ports_g[portIdx] = port;
+
+    return port;
+}
+
+EnginePort *engineOpenPort(Cpa8U *region, Cpa32U regionSize, DescRing *cplRing, void *owner)
+{
+    return openPort(NULL, region, regionSize, cplRing, owner);
+}
+
+/*
+ * Port of the thread owning an instance: only sessions of that instance are accepted, and polling the port
+ * polls no other instance
+ */
+EnginePort *engineOpenInstancePort(Cpa32U instanceIdx,
+                                   Cpa8U *region,
+                                   Cpa32U regionSize,
+                                   DescRing *cplRing,
+                                   void *owner)
+{
+    if (numInstances_g <= instanceIdx)
+    {
+        return NULL;
+    }
+    return openPort(&instances_g[instanceIdx], region, regionSize, cplRing, owner);
+}
+
+void engineClosePort(EnginePort *port)
+{
+    Cpa32U portIdx = 0;
+
+    /* Ops still in flight complete onto the port */
+    while (0 < port->numInflight)
+    {
+        if (NULL != port->instance)
+        {
+            pollEngineInstance(port->instance);
+        }
+        else
+        {
+            enginePoll();
+        }
+    }
+
+    for (portIdx = 0; portIdx < ENGINE_MAX_PORTS; portIdx++)
+    {
+        if (port == ports_g[portIdx])
+        {
+            ports_g[portIdx] = NULL;
+        }
+    }
+    if (NULL != port->physPages)
+    {
+        munlock(port->pageBase, (size_t)port->numPages << ENGINE_PAGE_SHIFT);
+        memFreeOs((void *)&port->physPages);
+    }
+    if (CPA_TRUE == port->ownRing)
+    {
+        memFreeContig((void *)&port->cplRing);
+    }
+    memFreeOs((void *)&port);
+}
+
+static void rejectDesc(EnginePort *port, const PdcpDesc *desc, CpaStatus status)
+{
+    PdcpDesc rejected = *desc;
+
+    rejected.status = status;
+    ringEnqueueBurst(port->cplRing, &rejected, 1);
+    __atomic_add_fetch(&stats_g.numErrors, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * Descriptors are taken in runs on one session, whose IVs are built together in an OpBurst before the ops of
+ * the run are submitted one by one
+ */
+Cpa32U engineSubmitBurst(EnginePort *port, const PdcpDesc *descs, Cpa32U numDescs)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const PdcpDesc *desc = NULL;
+    EngineSession *session = NULL;
+    EngineOp *op = NULL;
+    OpBurst burst;
+    PmuSample pmuSample;
+    Cpa32U prefixLen = 0;
+    Cpa32U descIdx = 0;
+    Cpa32U runStart = 0;
+    Cpa32U runEnd = 0;
+
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        desc = &descs[descIdx];
+        session = (ENGINE_MAX_SESSIONS > desc->sessionId) ? &sessions_g[desc->sessionId] : NULL;
+        if (NULL == session || CPA_TRUE != session->inUse || port->owner != session->owner ||
+            (NULL != port->instance && port->instance != session->instance) ||
+            ENGINE_OP_HEADROOM > desc->offset || ENGINE_MAX_PDU_SIZE < desc->length ||
+            port->regionSize < desc->offset || port->regionSize - desc->offset < desc->length)
+        {
+            rejectDesc(port, desc, CPA_STATUS_INVALID_PARAM);
+            continue;
+        }
+
+        if (runEnd <= descIdx)
+        {
+            burst.numOps = 0;
+            for (runStart = descIdx, runEnd = descIdx;
+                 runEnd < numDescs && OP_BURST_SIZE > burst.numOps && desc->sessionId == descs[runEnd].sessionId;
+                 runEnd++)
+            {
+                burst.counts[burst.numOps] = descs[runEnd].count;
+                burst.freshes[burst.numOps] = descs[runEnd].fresh;
+                burst.offsets[burst.numOps] = descs[runEnd].offset;
+                burst.lengths[burst.numOps++] = descs[runEnd].length;
+            }
+            PMU_BEGIN(&pmuSample, PMU_STAGE_IV);
+            buildIvBurst(&session->opDesc, &burst);
+            PMU_END(&pmuSample, PMU_STAGE_IV, session->algoDesc, burst.numOps);
+        }
+
+        op = engineAllocOp(desc->sessionId);
+        if (NULL == op)
+        {
+            break;
+        }
+        op->port = port;
+        op->desc = *desc;
+
+        prefixLen = session->algoDesc->msgIvPrefixLen;
+        if (CPA_TRUE == isPortRangeContiguous(port, desc->offset - prefixLen, desc->length + prefixLen))
+        {
+            op->payload = port->region + desc->offset;
+            op->bounced = CPA_FALSE;
+            op->instance->numZeroCopy++;
+        }
+        else
+        {
+            memcpy(op->data, port->region + desc->offset, desc->length);
+            op->payload = op->data;
+            op->bounced = CPA_TRUE;
+            op->instance->numBounced++;
+        }
+
+        /* Counted first, the software engine completes the op before submitOp() returns */
+        port->numInflight++;
+        stat = submitOp(op,
+                        burst.counts[descIdx - runStart],
+                        burst.freshes[descIdx - runStart],
+                        burst.lengths[descIdx - runStart],
+                        burst.ivs[descIdx - runStart]);
+        if (CPA_STATUS_SUCCESS != stat)
+        {
+            port->numInflight--;
+            engineFreeOp(op);
+        }
+        if (CPA_STATUS_RETRY == stat)
+        {
+            break;
+        }
+        if (CPA_STATUS_SUCCESS != stat)
+        {
+            rejectDesc(port, desc, stat);
+            continue;
+        }
+    }
+
+    return descIdx;
+}
+
+Cpa32U enginePollBurst(EnginePort *port, PdcpDesc *descs, Cpa32U maxDescs, Cpa64U *passBitmap)
+{
+    Cpa32U numDescs = 0;
+
+    if (NULL != port->instance)
+    {
+        pollEngineInstance(port->instance);
+    }
+    else
+    {
+        enginePoll();
+    }
+    numDescs = ringDequeueBurst(port->cplRing, descs, maxDescs);
+    if (NULL != passBitmap)
+    {
+        ringPassBitmap(descs, numDescs, passBitmap);
+    }
+    return numDescs;
+}
+
+int enginePortEventFd(const EnginePort *port)
+{
+    return (NULL != port->instance && CPA_TRUE == hasEvents(port->instance)) ? port->instance->eventFd : -1;
+}
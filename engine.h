@@ -0,0 +1,292 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+
+#include "algo.h"
+#include "health.h"
+#include "ring.h"
+#include "shadow.h"
+#include "sw_crypto.h"
+#include "utils.h"
+
+#define ENGINE_MAX_PDU_SIZE 9216
+#define ENGINE_OP_HEADROOM 64
+#define ENGINE_OPS_PER_INSTANCE 256
+#define ENGINE_MAX_SESSIONS 1024
+#define ENGINE_MAX_KEY_SIZE 32
+#define ENGINE_MAX_DIGEST_SIZE RING_MAX_DIGEST_SIZE
+#define ENGINE_MAX_PORTS 128
+#define ENGINE_PAGE_SHIFT 12
+#define ENGINE_MAX_SEGMENTS 16
+/* Ops of an instance only sessions of a high priority class may take, so that bulk traffic cannot use up all */
+#define ENGINE_RESERVED_OPS 32
+/* Responses handled per poll of an instance, high priority ones first */
+#define ENGINE_POLL_QUOTA 32
+/* Bursts host queues take of high priority work for every bulk one while both have a backlog */
+#define ENGINE_HIGH_PRIORITY_WEIGHT 4
+/* Request probing an instance out of service */
+#define ENGINE_PROBE_ALGO "nea2"
+#define ENGINE_PROBE_KEY_SIZE 16
+#define ENGINE_PROBE_SIZE 64
+/* Longest engineStop() waits for retired sessions, those of a wedged instance never drain */
+#define ENGINE_STOP_TIMEOUT_MS 1000
+/* Longest a thread sleeps on the event fds with requests in flight, so that the health checks still run */
+#define ENGINE_EVENT_TIMEOUT_MS 10
+
+/*
+ * Traffic classes of sessions. Signalling (SRB) and low latency (URLLC, VoNR) bearers get high priority
+ * sessions, whose requests the device serves ahead of those of bulk (eMBB) bearers.
+ */
+typedef enum _EngineClass {
+    ENGINE_CLASS_BULK = 0,
+    ENGINE_CLASS_LOW_LATENCY,
+    ENGINE_CLASS_SIGNALLING,
+    ENGINE_NUM_CLASSES
+} EngineClass;
+
+#define ENGINE_IS_HIGH_PRIORITY(trafficClass) (ENGINE_CLASS_BULK != (trafficClass))
+
+typedef struct _EngineInstance EngineInstance;
+typedef struct _EngineSession EngineSession;
+
+/*
+ * Submission port of one user of the burst API. Payloads are taken from the port's buffer region in place
+ * whenever the region is pinned and the payload is physically contiguous, and bounced through the op's own
+ * pinned buffer otherwise. Completed descriptors are put on the completion ring, which may live in memory
+ * shared with another process.
+ */
+typedef struct _EnginePort {
+    Cpa8U *region;
+    Cpa32U regionSize;
+    Cpa8U *pageBase;
+    Cpa64U *physPages; /* physical address of every page of the region, NULL when not pinned */
+    Cpa32U numPages;
+    DescRing *cplRing;
+    CpaBoolean ownRing;
+    void *owner;
+    EngineInstance *instance; /* only instance the port submits to and polls, NULL for all */
+    Cpa32U numInflight;
+    Cpa64U numZeroCopy;
+    Cpa64U numBounced;
+} EnginePort;
+
+/*
+ * One request in flight. The op data comes first so that the completion callback can get back to the op, the
+ * payload lives in a pre-allocated pinned buffer with headroom for an IV prefix. Chained packets are processed
+ * in their own segments instead, with the IV prefix in a flat buffer of its own.
+ */
+typedef struct _EngineOp {
+    CpaCySymOpData opData;
+    CpaBufferList bufferList;
+    CpaFlatBuffer flatBuffers[ENGINE_MAX_SEGMENTS + 1];
+    OpDesc opDesc; /* COUNT, bearer, direction and lengths of this op */
+    EngineSession *session;
+    EngineInstance *instance;
+    EnginePort *port;
+    PdcpDesc desc;
+    Cpa8U *payload;
+    CpaBoolean bounced;
+    Cpa8U *ivBuffer;
+    Cpa8U *digestBuffer;
+    Cpa8U *data;
+    Cpa8U *pinned;
+    ShadowSlot *shadow; /* copy of a sampled op for the shadow check, see shadow.c */
+    CpaStatus status;
+    CpaBoolean verifyResult;
+    CpaBoolean inflight; /* held by the device */
+    CpaBoolean abandoned; /* failed back to its user while still held by the device */
+    CpaBoolean released; /* freed by its user, back to the pool once the device lets go of it */
+    CpaBoolean probe;
+    volatile Cpa32U done;
+    void *userTag;
+    struct _EngineOp *next;
+} EngineOp;
+
+/*
+ * Everything the data path of an instance writes lives here, on cache lines of its own, so that threads driving
+ * different instances share nothing
+ */
+struct _EngineInstance {
+    CpaInstanceHandle cyInstHandle;
+    Cpa32U node;
+    EngineOp *ops;
+    EngineOp *freeOps;
+    Cpa32U numFreeOps;
+    Cpa32U numInflight;
+    Cpa64U numSubmitted;
+    Cpa64U numCompleted;
+    Cpa64U numErrors;
+    Cpa64U numRetries;
+    Cpa64U numVerifyFailures;
+    Cpa64U numZeroCopy;
+    Cpa64U numBounced;
+    Cpa64U numThrottled; /* bulk ops turned away to keep the reserved ops */
+    Cpa64U numCpuOps; /* run on the software engine while the instance was out of service */
+    Cpa64U numAbandoned;
+    HealthMonitor health;
+    CpaBoolean started;
+    int eventFd; /* readable while responses wait to be polled, -1 until first asked for or in poll mode only */
+    CpaBoolean eventFdTried;
+} __attribute__((aligned(RING_CACHE_LINE)));
+
+struct _EngineSession {
+    const AlgoDesc *algoDesc;
+    EngineInstance *instance;
+    CpaBoolean pinned; /* stays on its instance, runs on the software engine while the instance is down */
+    CpaCySymSessionCtx sessionCtx; /* NULL until the instance first came up */
+    CpaCySymSessionSetupData setupData;
+    SwSession sw; /* set up on the first op run on the software engine */
+    CpaBoolean swReady;
+    CpaBoolean cpuOnly; /* an algorithm the device refused, such as ZUC-256 before QAT 2.0 */
+    TestData params; /* key, bearer, direction and digest size of the session */
+    OpDesc opDesc; /* what every op of the session starts from */
+    Cpa8U key[ENGINE_MAX_KEY_SIZE];
+    CpaBoolean verifyDigest; /* PDUs carry their MAC-I, checked by the device */
+    Cpa32U trafficClass;
+    void *owner;
+    struct _EngineRekey *rekey; /* new key waiting for the data path, see engineRekeySession() */
+    CpaBoolean inUse;
+};
+
+typedef struct _EngineStats {
+    Cpa64U numSubmitted;
+    Cpa64U numCompleted;
+    Cpa64U numErrors;
+    Cpa64U numRetries;
+    Cpa32U numInstances;
+    Cpa32U numSessions;
+    Cpa32U numRetiredSessions;
+    Cpa32U numInflight;
+    Cpa64U numZeroCopy;
+    Cpa64U numBounced;
+    Cpa64U numVerifyFailures;
+    Cpa64U numThrottled;
+    Cpa64U numShadowChecked;
+    Cpa64U numShadowMismatches;
+    Cpa64U numShadowSkipped;
+    Cpa64U numCpuOps;
+    Cpa64U numAbandoned;
+    Cpa64U numFailovers;
+    Cpa64U numProbes;
+    Cpa64U numReadmissions;
+    Cpa64U numMigrations;
+    Cpa64U numRekeys;
+    Cpa32U numInstancesDown;
+} EngineStats;
+
+/*
+ ****************
+ * Engine control
+ ****************
+ */
+CpaStatus engineStart(void);
+void engineStop(void);
+CpaBoolean engineIsRunning(void);
+CpaStatus engineEnableShadow(Cpa32U sampleRate);
+CpaStatus engineBindThread(void);
+Cpa32U engineNumInstances(void);
+CpaStatus engineBindThreadToInstance(Cpa32U instanceIdx);
+void engineGetStats(EngineStats *stats);
+/* HealthState of an instance */
+Cpa32U engineInstanceHealth(Cpa32U instanceIdx);
+/* Handle of an instance in service, for requests on sessions of its own such as the KDF; NULL otherwise */
+CpaInstanceHandle engineInstanceHandle(Cpa32U instanceIdx);
+
+/*
+ *****************
+ * Engine sessions
+ *****************
+ */
+
+/*
+ * keySize must be the key size of the algorithm. A session the device does not support is run on the software
+ * engine for its lifetime when the software engine has the algorithm.
+ */
+CpaStatus engineCreateSession(const char *algoName,
+                              const Cpa8U *key,
+                              Cpa32U keySize,
+                              Cpa8U bearer,
+                              Cpa8U dir,
+                              Cpa32U digestSize,
+                              CpaBoolean verifyDigest,
+                              Cpa32U trafficClass,
+                              void *owner,
+                              Cpa32U *sessionId);
+CpaStatus engineCreateInstanceSession(Cpa32U instanceIdx,
+                                      const char *algoName,
+                                      const Cpa8U *key,
+                                      Cpa32U keySize,
+                                      Cpa8U bearer,
+                                      Cpa8U dir,
+                                      Cpa32U digestSize,
+                                      CpaBoolean verifyDigest,
+                                      Cpa32U trafficClass,
+                                      void *owner,
+                                      Cpa32U *sessionId);
+/*
+ * New key for a session, as on a handover. The session context for it is set up on the calling thread and
+ * taken over by the data path of the session with its next op, so a control thread may re-key the sessions of
+ * a worker while it sends; requests already in flight complete on the old key.
+ */
+CpaStatus engineRekeySession(Cpa32U sessionId, const Cpa8U *key, Cpa32U keySize, void *owner);
+CpaStatus engineRetireSession(Cpa32U sessionId, void *owner);
+Cpa32U engineSessionClass(Cpa32U sessionId);
+void engineRetireSessionsOf(void *owner);
+
+/*
+ ******************
+ * Engine data path
+ ******************
+ */
+EngineOp *engineAllocOp(Cpa32U sessionId);
+void engineFreeOp(EngineOp *op);
+CpaStatus engineSubmitOp(EngineOp *op, Cpa32U count, Cpa32U fresh, Cpa32U length);
+Cpa32U enginePoll(void);
+/*
+ * Event mode: rather than spinning on enginePoll() with requests in flight, a thread may sleep in poll() or
+ * epoll_wait() on the event fds of the instances (icp_sal_CyGetFileDescriptor(), instances configured for
+ * epoll), for ENGINE_EVENT_TIMEOUT_MS at most, and poll once woken. Fills up to maxFds fds and returns CPA_FALSE
+ * when an instance with requests in flight has no event fd or is out of service, and must be polled.
+ */
+CpaBoolean engineGetEventFds(int *fds, Cpa32U maxFds, Cpa32U *numFds);
+/* Only ops of the owner the session was created for are run */
+CpaStatus engineExecOp(Cpa32U sessionId,
+                       Cpa32U count,
+                       Cpa32U fresh,
+                       Cpa8U *data,
+                       Cpa32U length,
+                       Cpa8U *digest,
+                       void *owner);
+CpaStatus engineSubmitChainOp(EngineOp *op, Cpa32U count, Cpa32U fresh, const PktBuf *chain, Cpa32U offset);
+CpaStatus engineExecChainOp(Cpa32U sessionId,
+                            Cpa32U count,
+                            Cpa32U fresh,
+                            const PktBuf *chain,
+                            Cpa32U offset,
+                            Cpa8U *digest);
+
+/*
+ ******************
+ * Engine burst API
+ ******************
+ */
+EnginePort *engineOpenPort(Cpa8U *region, Cpa32U regionSize, DescRing *cplRing, void *owner);
+EnginePort *engineOpenInstancePort(Cpa32U instanceIdx,
+                                   Cpa8U *region,
+                                   Cpa32U regionSize,
+                                   DescRing *cplRing,
+                                   void *owner);
+void engineClosePort(EnginePort *port);
+Cpa32U engineSubmitBurst(EnginePort *port, const PdcpDesc *descs, Cpa32U numDescs);
+Cpa32U enginePollBurst(EnginePort *port, PdcpDesc *descs, Cpa32U maxDescs, Cpa64U *passBitmap);
+/*
+ * Event fd of the instance of a port, see engineGetEventFds(); -1 when the port must be polled while it has
+ * requests in flight, such as a port on every instance
+ */
+int enginePortEventFd(const EnginePort *port);
+
+CpaPhysicalAddr engineVirtToPhys(void *virtAddr);
+
+#endif
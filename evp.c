@@ -0,0 +1,238 @@
+/*
+ * NEA2 and NIA2 on OpenSSL EVP.
+ *
+ * The reference software library for the engine comparison of perf.c: AES-CTR through an EVP_CIPHER_CTX and
+ * AES-CMAC through an EVP_MAC_CTX (the CMAC API before OpenSSL 3.0), both keyed once per session. OpenSSL picks
+ * its own AES-NI and VAES code paths, so this is what a tuned CPU implementation achieves on the host. Built
+ * without OpenSSL (`make OPENSSL=0`) every session is unsupported.
+ */
+
+#include <string.h>
+
+#ifdef PDCP_OPENSSL
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/opensslv.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#else
+#include <openssl/cmac.h>
+#endif
+#endif
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+
+#include "evp.h"
+
+#define EVP_MAX_MAC_SIZE 16
+
+#ifdef PDCP_OPENSSL
+
+CpaBoolean evpAvailable(void)
+{
+    return CPA_TRUE;
+}
+
+const char *evpVersion(void)
+{
+    return OpenSSL_version(OPENSSL_VERSION);
+}
+
+static CpaStatus initCipher(EvpSession *session, const CpaCySymCipherSetupData *cipherSetupData)
+{
+    const EVP_CIPHER *cipher = NULL;
+
+    if (CPA_CY_SYM_CIPHER_AES_CTR != cipherSetupData->cipherAlgorithm)
+    {
+        return CPA_STATUS_UNSUPPORTED;
+    }
+    switch (cipherSetupData->cipherKeyLenInBytes)
+    {
+        case 16:
+            cipher = EVP_aes_128_ctr();
+            break;
+        case 32:
+            cipher = EVP_aes_256_ctr();
+            break;
+        default:
+            return CPA_STATUS_INVALID_PARAM;
+    }
+
+    session->cipherCtx = EVP_CIPHER_CTX_new();
+    if (NULL == session->cipherCtx)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+    /* Counter mode decrypts by encrypting */
+    if (1 != EVP_EncryptInit_ex(session->cipherCtx, cipher, NULL, cipherSetupData->pCipherKey, NULL))
+    {
+        return CPA_STATUS_FAIL;
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+static CpaStatus initMac(EvpSession *session, const CpaCySymHashSetupData *hashSetupData)
+{
+    const Cpa8U *key = hashSetupData->authModeSetupData.authKey;
+    Cpa32U keySize = hashSetupData->authModeSetupData.authKeyLenInBytes;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    OSSL_PARAM params[2];
+    EVP_MAC *mac = NULL;
+#endif
+
+    if (CPA_CY_SYM_HASH_AES_CMAC != hashSetupData->hashAlgorithm)
+    {
+        return CPA_STATUS_UNSUPPORTED;
+    }
+    if ((16 != keySize && 32 != keySize) || EVP_MAX_MAC_SIZE < hashSetupData->digestResultLenInBytes)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    session->digestSize = hashSetupData->digestResultLenInBytes;
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    mac = EVP_MAC_fetch(NULL, "CMAC", NULL);
+    if (NULL == mac)
+    {
+        return CPA_STATUS_UNSUPPORTED;
+    }
+    session->macCtx = EVP_MAC_CTX_new(mac);
+    EVP_MAC_free(mac);
+    if (NULL == session->macCtx)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+    params[0] = OSSL_PARAM_construct_utf8_string(
+        OSSL_MAC_PARAM_CIPHER, (16 == keySize) ? "AES-128-CBC" : "AES-256-CBC", 0);
+    params[1] = OSSL_PARAM_construct_end();
+    if (1 != EVP_MAC_init(session->macCtx, key, keySize, params))
+    {
+        return CPA_STATUS_FAIL;
+    }
+#else
+    session->macCtx = CMAC_CTX_new();
+    if (NULL == session->macCtx)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+    if (1 != CMAC_Init(session->macCtx, key, keySize, (16 == keySize) ? EVP_aes_128_cbc() : EVP_aes_256_cbc(), NULL))
+    {
+        return CPA_STATUS_FAIL;
+    }
+#endif
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus evpInitSession(EvpSession *session, const CpaCySymSessionSetupData *setupData)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+
+    memset(session, 0, sizeof(EvpSession));
+    session->symOperation = setupData->symOperation;
+    switch (setupData->symOperation)
+    {
+        case CPA_CY_SYM_OP_CIPHER:
+            stat = initCipher(session, &setupData->cipherSetupData);
+            break;
+        case CPA_CY_SYM_OP_HASH:
+            stat = initMac(session, &setupData->hashSetupData);
+            break;
+        default:
+            stat = CPA_STATUS_UNSUPPORTED;
+            break;
+    }
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        evpFreeSession(session);
+    }
+    return stat;
+}
+
+CpaStatus evpProcess(EvpSession *session, const CpaCySymOpData *opData, Cpa8U *data, Cpa8U *mac)
+{
+    Cpa8U *message = NULL;
+    Cpa8U fullMac[EVP_MAX_MAC_SIZE];
+    size_t macLen = 0;
+    int outLen = 0;
+
+    if (CPA_CY_SYM_OP_CIPHER == session->symOperation)
+    {
+        message = data + opData->cryptoStartSrcOffsetInBytes;
+        if (1 != EVP_EncryptInit_ex(session->cipherCtx, NULL, NULL, NULL, opData->pIv) ||
+            1 != EVP_EncryptUpdate(
+                     session->cipherCtx, message, &outLen, message, (int)opData->messageLenToCipherInBytes))
+        {
+            return CPA_STATUS_FAIL;
+        }
+        return CPA_STATUS_SUCCESS;
+    }
+
+    message = data + opData->hashStartSrcOffsetInBytes;
+    /* Without a key, initialization starts a new message on the key of the session */
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    if (1 != EVP_MAC_init(session->macCtx, NULL, 0, NULL) ||
+        1 != EVP_MAC_update(session->macCtx, message, opData->messageLenToHashInBytes) ||
+        1 != EVP_MAC_final(session->macCtx, fullMac, &macLen, sizeof(fullMac)))
+    {
+        return CPA_STATUS_FAIL;
+    }
+#else
+    if (1 != CMAC_Init(session->macCtx, NULL, 0, NULL, NULL) ||
+        1 != CMAC_Update(session->macCtx, message, opData->messageLenToHashInBytes) ||
+        1 != CMAC_Final(session->macCtx, fullMac, &macLen))
+    {
+        return CPA_STATUS_FAIL;
+    }
+#endif
+    memcpy(mac, fullMac, session->digestSize);
+    return CPA_STATUS_SUCCESS;
+}
+
+void evpFreeSession(EvpSession *session)
+{
+    if (NULL != session->cipherCtx)
+    {
+        EVP_CIPHER_CTX_free(session->cipherCtx);
+        session->cipherCtx = NULL;
+    }
+    if (NULL != session->macCtx)
+    {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        EVP_MAC_CTX_free(session->macCtx);
+#else
+        CMAC_CTX_free(session->macCtx);
+#endif
+        session->macCtx = NULL;
+    }
+}
+
+#else
+
+CpaBoolean evpAvailable(void)
+{
+    return CPA_FALSE;
+}
+
+const char *evpVersion(void)
+{
+    return "none";
+}
+
+CpaStatus evpInitSession(EvpSession *session, const CpaCySymSessionSetupData *setupData)
+{
+    memset(session, 0, sizeof(EvpSession));
+    return CPA_STATUS_UNSUPPORTED;
+}
+
+CpaStatus evpProcess(EvpSession *session, const CpaCySymOpData *opData, Cpa8U *data, Cpa8U *mac)
+{
+    return CPA_STATUS_UNSUPPORTED;
+}
+
+void evpFreeSession(EvpSession *session)
+{
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef EVP_H
+#define EVP_H
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+
+/*
+ * OpenSSL EVP counterpart of a session, to compare the engine with a tuned software library: 128-NEA2 and
+ * 128-NIA2 (AES-CTR and AES-CMAC) and their 256 bit key variants. The OpenSSL contexts are set up once per
+ * session and only re-initialized with the IV of every request.
+ */
+typedef struct _EvpSession {
+    CpaCySymOp symOperation;
+    Cpa32U digestSize;
+    void *cipherCtx; /* EVP_CIPHER_CTX */
+    void *macCtx; /* EVP_MAC_CTX, CMAC_CTX before OpenSSL 3.0 */
+} EvpSession;
+
+/* CPA_FALSE when built with OPENSSL=0 */
+CpaBoolean evpAvailable(void);
+const char *evpVersion(void);
+
+CpaStatus evpInitSession(EvpSession *session, const CpaCySymSessionSetupData *setupData);
+
+/*
+ * Process the request as swProcess() does, on the contiguous data its offsets refer to. Ciphers work in place,
+ * hashes put the digest in mac.
+ */
+CpaStatus evpProcess(EvpSession *session, const CpaCySymOpData *opData, Cpa8U *data, Cpa8U *mac);
+
+void evpFreeSession(EvpSession *session);
+
+#endif
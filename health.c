@@ -0,0 +1,158 @@
+/*
+ * Health of an instance.
+ *
+ * An accelerator rarely fails cleanly. Requests may come back with errors, submissions may be refused, or the
+ * instance may wedge and simply stop answering. The monitor of an instance counts what its data path sees and
+ * is checked on every poll. The instance goes down when too many of the results of a window are errors, on a
+ * run of consecutive errors, or when requests are in flight and nothing completed for HEALTH_STUCK_NS. Stuck
+ * requests are then given up on, whatever the state of the instance.
+ *
+ * A down instance takes no traffic; the engine moves it elsewhere. After a backoff the instance gets a probe,
+ * one small request of its own. A probe that completes in time brings the instance back. A failed or late one
+ * doubles the backoff, up to HEALTH_MAX_BACKOFF_NS, so a dead instance costs little.
+ *
+ * The data path never reads the clock for this. A completion only sets a flag, and the check turns it into a
+ * timestamp.
+ */
+
+#include <string.h>
+
+#include "cpa.h"
+
+#include "health.h"
+
+static void resetWindow(HealthMonitor *mon, Cpa64U now)
+{
+    mon->windowStartNs = now;
+    mon->numOps = 0;
+    mon->numErrors = 0;
+}
+
+static void goDown(HealthMonitor *mon, Cpa32U reason, Cpa64U now)
+{
+    mon->state = HEALTH_DOWN;
+    mon->reason = reason;
+    mon->nextProbeNs = now + mon->probeBackoffNs;
+    mon->numFailovers++;
+}
+
+void healthInit(HealthMonitor *mon)
+{
+    memset(mon, 0, sizeof(HealthMonitor));
+    mon->state = HEALTH_UP;
+    mon->probeBackoffNs = HEALTH_MIN_BACKOFF_NS;
+}
+
+void healthMarkDown(HealthMonitor *mon, Cpa32U reason, Cpa64U now)
+{
+    goDown(mon, reason, now);
+}
+
+Cpa32U healthCheck(HealthMonitor *mon, Cpa64U now, Cpa32U numInflight)
+{
+    /* An idle instance is not stuck: the clock starts with the first request in flight */
+    if (CPA_TRUE == mon->progressed || 0 == numInflight)
+    {
+        mon->lastProgressNs = now;
+        mon->progressed = CPA_FALSE;
+    }
+
+    /* Requests stuck on a down instance are failed back too, they would hold up their bearers */
+    if ((0 < numInflight && now - mon->lastProgressNs >= HEALTH_STUCK_NS) ||
+        (HEALTH_PROBING == mon->state && now - mon->probeSinceNs >= HEALTH_STUCK_NS))
+    {
+        if (HEALTH_UP == mon->state)
+        {
+            goDown(mon, HEALTH_REASON_STUCK, now);
+        }
+        else
+        {
+            healthOnProbeResult(mon, CPA_FALSE, now);
+        }
+        mon->lastProgressNs = now;
+        return HEALTH_ACTION_ABANDON;
+    }
+
+    if (HEALTH_DOWN == mon->state && now >= mon->nextProbeNs)
+    {
+        mon->state = HEALTH_PROBING;
+        mon->probeSinceNs = now;
+        mon->numProbes++;
+        return HEALTH_ACTION_PROBE;
+    }
+    if (HEALTH_UP != mon->state)
+    {
+        return HEALTH_ACTION_NONE;
+    }
+
+    if (HEALTH_MAX_CONSECUTIVE_ERRORS <= mon->numConsecutiveErrors)
+    {
+        goDown(mon, HEALTH_REASON_ERRORS, now);
+        return HEALTH_ACTION_FAILOVER;
+    }
+    if (now - mon->windowStartNs >= HEALTH_WINDOW_NS)
+    {
+        if (HEALTH_MIN_WINDOW_OPS <= mon->numOps && mon->numErrors * 100 >= mon->numOps * HEALTH_MAX_ERROR_PERCENT)
+        {
+            goDown(mon, HEALTH_REASON_ERRORS, now);
+            resetWindow(mon, now);
+            return HEALTH_ACTION_FAILOVER;
+        }
+        resetWindow(mon, now);
+    }
+    return HEALTH_ACTION_NONE;
+}
+
+void healthOnProbeResult(HealthMonitor *mon, CpaBoolean passed, Cpa64U now)
+{
+    if (HEALTH_PROBING != mon->state)
+    {
+        return;
+    }
+    if (CPA_TRUE == passed)
+    {
+        mon->state = HEALTH_UP;
+        mon->reason = HEALTH_REASON_NONE;
+        mon->probeBackoffNs = HEALTH_MIN_BACKOFF_NS;
+        mon->numConsecutiveErrors = 0;
+        mon->lastProgressNs = now;
+        resetWindow(mon, now);
+        mon->numReadmissions++;
+        return;
+    }
+
+    mon->state = HEALTH_DOWN;
+    mon->nextProbeNs = now + mon->probeBackoffNs;
+    mon->probeBackoffNs =
+        (HEALTH_MAX_BACKOFF_NS / 2 < mon->probeBackoffNs) ? HEALTH_MAX_BACKOFF_NS : 2 * mon->probeBackoffNs;
+}
+
+const char *healthStateName(Cpa32U state)
+{
+    switch (state)
+    {
+        case HEALTH_UP:
+            return "up";
+        case HEALTH_DOWN:
+            return "down";
+        case HEALTH_PROBING:
+            return "probing";
+        default:
+            return "?";
+    }
+}
+
+const char *healthReasonName(Cpa32U reason)
+{
+    switch (reason)
+    {
+        case HEALTH_REASON_ERRORS:
+            return "error rate";
+        case HEALTH_REASON_STUCK:
+            return "stuck requests";
+        case HEALTH_REASON_START:
+            return "failed to start";
+        default:
+            return "none";
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef HEALTH_H
+#define HEALTH_H
+
+#include "cpa.h"
+
+#define HEALTH_WINDOW_NS 100000000ULL /* over which the error rate is taken */
+#define HEALTH_MIN_WINDOW_OPS 64 /* results a window needs before its error rate counts */
+#define HEALTH_MAX_ERROR_PERCENT 5
+#define HEALTH_MAX_CONSECUTIVE_ERRORS 8
+#define HEALTH_STUCK_NS 100000000ULL /* without a completion while requests are in flight, probes included */
+#define HEALTH_MIN_BACKOFF_NS 10000000ULL /* between a failure and the next probe, doubled on every failed probe */
+#define HEALTH_MAX_BACKOFF_NS 1000000000ULL
+
+typedef enum _HealthState {
+    HEALTH_UP = 0, /* takes traffic */
+    HEALTH_DOWN, /* out of service until a probe passes */
+    HEALTH_PROBING, /* a probe is in flight */
+} HealthState;
+
+enum
+{
+    HEALTH_REASON_NONE = 0,
+    HEALTH_REASON_ERRORS,
+    HEALTH_REASON_STUCK,
+    HEALTH_REASON_START,
+};
+
+/* What healthCheck() asks of the caller */
+enum
+{
+    HEALTH_ACTION_NONE = 0,
+    HEALTH_ACTION_FAILOVER, /* went down, what is in flight still completes */
+    HEALTH_ACTION_ABANDON, /* requests are stuck: fail back what is in flight, the probe included */
+    HEALTH_ACTION_PROBE, /* submit a probe, and report it with healthOnProbeResult() */
+};
+
+/*
+ * Health of one instance, fed from its data path and checked by the thread polling it, see health.c
+ */
+typedef struct _HealthMonitor {
+    volatile Cpa32U state;
+    Cpa32U reason; /* of the last failover */
+    /* Results since windowStartNs */
+    Cpa64U windowStartNs;
+    Cpa32U numOps;
+    Cpa32U numErrors;
+    Cpa32U numConsecutiveErrors;
+    CpaBoolean progressed; /* a request completed since the last check */
+    Cpa64U lastProgressNs;
+    Cpa64U nextProbeNs;
+    Cpa64U probeBackoffNs;
+    Cpa64U probeSinceNs;
+    Cpa64U numFailovers;
+    Cpa64U numProbes;
+    Cpa64U numReadmissions;
+} HealthMonitor;
+
+void healthInit(HealthMonitor *mon);
+/* Out of service at once, for an instance that fails to start */
+void healthMarkDown(HealthMonitor *mon, Cpa32U reason, Cpa64U now);
+/* With now from CLOCK_MONOTONIC and the requests of the instance in flight, on every poll */
+Cpa32U healthCheck(HealthMonitor *mon, Cpa64U now, Cpa32U numInflight);
+void healthOnProbeResult(HealthMonitor *mon, CpaBoolean passed, Cpa64U now);
+const char *healthStateName(Cpa32U state);
+const char *healthReasonName(Cpa32U reason);
+
+/* Before a request is submitted, with the requests of the instance in flight */
+static inline void healthOnSubmit(HealthMonitor *mon, Cpa32U numInflight)
+{
+    if (0 == numInflight)
+    {
+        /* Idle until now, the stuck clock starts here and not at the last check */
+        mon->progressed = CPA_TRUE;
+    }
+}
+
+/* A request completed, with an error or not */
+static inline void healthOnResult(HealthMonitor *mon, CpaBoolean failed)
+{
+    mon->numOps++;
+    mon->progressed = CPA_TRUE;
+    if (CPA_TRUE == failed)
+    {
+        mon->numErrors++;
+        mon->numConsecutiveErrors++;
+    }
+    else
+    {
+        mon->numConsecutiveErrors = 0;
+    }
+}
+
+/* A submission or a poll failed */
+static inline void healthOnError(HealthMonitor *mon)
+{
+    mon->numOps++;
+    mon->numErrors++;
+    mon->numConsecutiveErrors++;
+}
+
+#endif
@@ -0,0 +1,643 @@
+/*
+ * Batched 5G key derivation.
+ *
+ * Every handover re-keys a UE: KgNB* for the target cell, then KRRCenc/int and KUPenc/int from it, each a run
+ * of the TS 33.220 KDF, HMAC-SHA-256 over a short S under a 256 bit key. One derivation is cheap, but in a
+ * handover storm thousands of UEs re-key at once, one after the other on the thread handling them. Requests are
+ * therefore derived in batches.
+ *
+ * On the CPU a batch goes through sw_sha256.c, which hashes eight derivations side by side on AVX2 or one at a
+ * time on the SHA extensions, whichever the CPU has. On the accelerator HMAC is taken apart into its two plain
+ * SHA-256 passes, H(K ^ opad || H(K ^ ipad || S)): an HMAC session would carry the key of one UE, while one plain
+ * hash session serves all of them and no session is set up per derivation. KDF_QAT_DEPTH requests are kept in
+ * flight, each going back for its outer pass as its inner one completes. Requests the instance fails are derived
+ * on the CPU, as is the rest of a batch when the instance stops answering.
+ *
+ * The output of an algorithm key derivation goes to engineCreateSession() as it is, through kdfAlgoKey().
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+#include "cpa_sample_utils.h"
+
+#include "algo.h"
+#include "engine.h"
+#include "kdf.h"
+#include "session.h"
+#include "sw_crypto.h"
+#include "utils.h"
+
+/* Pinned data of a request: key block and S or inner digest, then the digest */
+#define KDF_SLOT_DATA_SIZE (2 * SW_SHA256_BLOCK_SIZE)
+#define KDF_SLOT_SIZE (KDF_SLOT_DATA_SIZE + BYTE_ALIGNMENT)
+/* Requests derived per call of the CPU batch */
+#define KDF_CPU_CHUNK 64
+
+typedef struct _KdfQat KdfQat;
+
+/*
+ * One request in flight on the accelerator, req is NULL while the slot is free
+ */
+typedef struct _KdfSlot {
+    CpaCySymOpData opData;
+    CpaBufferList bufferList;
+    CpaFlatBuffer flatBuffer;
+    Cpa8U *data;
+    Cpa8U *digest;
+    KdfRequest *req;
+    Cpa32U pass; /* 0 for the inner hash, 1 for the outer one */
+    CpaStatus status;
+    KdfQat *qat;
+} KdfSlot;
+
+struct _KdfQat {
+    CpaInstanceHandle cyInstHandle;
+    CpaCySymSessionCtx sessionCtx;
+    Cpa8U *region;
+    Cpa8U *metaRegion;
+    KdfSlot slots[KDF_QAT_DEPTH];
+    KdfSlot *freeSlots[KDF_QAT_DEPTH];
+    Cpa32U numFree;
+    KdfSlot *done[KDF_QAT_DEPTH]; /* filled by the callback */
+    Cpa32U numDone;
+    Cpa32U numInflight;
+    Cpa64U numCpu;
+};
+
+static Cpa64U nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Cpa64U)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void kdfInitRequest(KdfRequest *req, const Cpa8U *key, Cpa8U fc)
+{
+    memset(req, 0, sizeof(KdfRequest));
+    memcpy(req->key, key, KDF_KEY_SIZE);
+    req->s[0] = fc;
+    req->sLen = 1;
+}
+
+CpaStatus kdfAddParam(KdfRequest *req, const Cpa8U *param, Cpa16U paramLen)
+{
+    if (req->sLen + paramLen + 2 > KDF_MAX_S_SIZE)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    memcpy(req->s + req->sLen, param, paramLen);
+    req->sLen += paramLen;
+    req->s[req->sLen++] = (Cpa8U)(paramLen >> 8);
+    req->s[req->sLen++] = (Cpa8U)paramLen;
+    return CPA_STATUS_SUCCESS;
+}
+
+void kdfInitKgnbStar(KdfRequest *req, const Cpa8U *kgnb, Cpa16U pci, Cpa32U arfcnDl)
+{
+    Cpa8U pciBytes[2] = {(Cpa8U)(pci >> 8), (Cpa8U)pci};
+    Cpa8U arfcnBytes[3] = {(Cpa8U)(arfcnDl >> 16), (Cpa8U)(arfcnDl >> 8), (Cpa8U)arfcnDl};
+
+    kdfInitRequest(req, kgnb, KDF_FC_KGNB_STAR);
+    kdfAddParam(req, pciBytes, sizeof(pciBytes));
+    kdfAddParam(req, arfcnBytes, sizeof(arfcnBytes));
+}
+
+CpaStatus kdfInitAlgoKey(KdfRequest *req, const Cpa8U *kgnb, Cpa8U distinguisher, const char *algoName)
+{
+    const AlgoDesc *algoDesc = findAlgoDesc(algoName);
+    Cpa8U algoId = 0;
+
+    /*
+     * The algorithm identity is the number of 128-NEAx or 128-NIAx. The 256-bit algorithms have no identity
+     * assigned yet and take the whole output as key, which kdfAlgoKey() does not give.
+     */
+    if (NULL == algoDesc || KDF_ALGO_KEY_SIZE != algoDesc->keySize || '1' > algoName[3] || '9' < algoName[3])
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    algoId = (Cpa8U)(algoName[3] - '0');
+
+    kdfInitRequest(req, kgnb, KDF_FC_ALGO_KEY);
+    kdfAddParam(req, &distinguisher, 1);
+    kdfAddParam(req, &algoId, 1);
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ *******************
+ * CPU
+ *******************
+ */
+
+CpaStatus kdfDeriveCpu(KdfRequest *reqs, Cpa32U numReqs, Cpa32U impl)
+{
+    SwHmacMsg msgs[KDF_CPU_CHUNK];
+    Cpa32U numMsgs = 0;
+    Cpa32U reqIdx = 0;
+
+    if (CPA_TRUE != swSha256Supported(impl))
+    {
+        return CPA_STATUS_UNSUPPORTED;
+    }
+    for (reqIdx = 0; reqIdx < numReqs; reqIdx++)
+    {
+        msgs[numMsgs].key = reqs[reqIdx].key;
+        msgs[numMsgs].keySize = KDF_KEY_SIZE;
+        msgs[numMsgs].data = reqs[reqIdx].s;
+        msgs[numMsgs].length = reqs[reqIdx].sLen;
+        msgs[numMsgs].mac = reqs[reqIdx].out;
+        if (KDF_CPU_CHUNK == ++numMsgs)
+        {
+            swHmacSha256Batch(impl, msgs, numMsgs);
+            numMsgs = 0;
+        }
+    }
+    swHmacSha256Batch(impl, msgs, numMsgs);
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ *******************
+ * Accelerator
+ *******************
+ */
+
+static void kdfCallback(void *callbackTag,
+                        CpaStatus status,
+                        const CpaCySymOp operationType,
+                        void *opData,
+                        CpaBufferList *dstBuffer,
+                        CpaBoolean verifyResult)
+{
+    KdfSlot *slot = (KdfSlot *)callbackTag;
+
+    slot->status = status;
+    slot->qat->done[slot->qat->numDone++] = slot;
+}
+
+static void closeQat(KdfQat *qat)
+{
+    if (NULL != qat->sessionCtx)
+    {
+        retireSession(qat->cyInstHandle, qat->sessionCtx);
+        drainRetiredSessions(qat->cyInstHandle);
+    }
+    memFreeContig((void *)&qat->region);
+    memFreeContig((void *)&qat->metaRegion);
+    free(qat);
+}
+
+static KdfQat *openQat(CpaInstanceHandle cyInstHandle)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    CpaCySymSessionSetupData sessionSetupData = {0};
+    KdfQat *qat = NULL;
+    KdfSlot *slot = NULL;
+    Cpa32U bufferMetaSize = 0;
+    Cpa32U slotIdx = 0;
+
+    qat = calloc(1, sizeof(KdfQat));
+    if (NULL == qat)
+    {
+        return NULL;
+    }
+    qat->cyInstHandle = cyInstHandle;
+
+    stat = cpaCyBufferListGetMetaSize(cyInstHandle, 1, &bufferMetaSize);
+    CHECK_ERR_STATUS("cpaCyBufferListGetMetaSize", stat);
+    bufferMetaSize = (bufferMetaSize + BYTE_ALIGNMENT - 1) & ~(BYTE_ALIGNMENT - 1);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = memAllocContig((void *)&qat->region, KDF_QAT_DEPTH * KDF_SLOT_SIZE, BYTE_ALIGNMENT);
+        CHECK_ERR_STATUS("memAllocContig", stat);
+    }
+    if (CPA_STATUS_SUCCESS == stat && 0 < bufferMetaSize)
+    {
+        stat = memAllocContig((void *)&qat->metaRegion, KDF_QAT_DEPTH * bufferMetaSize, BYTE_ALIGNMENT);
+        CHECK_ERR_STATUS("memAllocContig", stat);
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        sessionSetupData.sessionPriority = CPA_CY_PRIORITY_NORMAL;
+        sessionSetupData.symOperation = CPA_CY_SYM_OP_HASH;
+        sessionSetupData.hashSetupData.hashAlgorithm = CPA_CY_SYM_HASH_SHA256;
+        sessionSetupData.hashSetupData.hashMode = CPA_CY_SYM_HASH_MODE_PLAIN;
+        sessionSetupData.hashSetupData.digestResultLenInBytes = SW_SHA256_DIGEST_SIZE;
+        sessionSetupData.digestIsAppended = CPA_FALSE;
+        sessionSetupData.verifyDigest = CPA_FALSE;
+        stat = createSession(cyInstHandle, kdfCallback, &sessionSetupData, &qat->sessionCtx);
+        CHECK_ERR_STATUS("createSession", stat);
+    }
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        closeQat(qat);
+        return NULL;
+    }
+
+    for (slotIdx = 0; slotIdx < KDF_QAT_DEPTH; slotIdx++)
+    {
+        slot = &qat->slots[slotIdx];
+        slot->qat = qat;
+        slot->data = qat->region + slotIdx * KDF_SLOT_SIZE;
+        slot->digest = slot->data + KDF_SLOT_DATA_SIZE;
+        slot->bufferList.numBuffers = 1;
+        slot->bufferList.pBuffers = &slot->flatBuffer;
+        slot->bufferList.pPrivateMetaData = (NULL != qat->metaRegion) ? qat->metaRegion + slotIdx * bufferMetaSize
+                                                                       : NULL;
+        slot->opData.sessionCtx = qat->sessionCtx;
+        slot->opData.packetType = CPA_CY_SYM_PACKET_TYPE_FULL;
+        slot->opData.hashStartSrcOffsetInBytes = 0;
+        slot->opData.pDigestResult = slot->digest;
+        qat->freeSlots[qat->numFree++] = slot;
+    }
+    return qat;
+}
+
+static void releaseSlot(KdfQat *qat, KdfSlot *slot)
+{
+    slot->req = NULL;
+    qat->freeSlots[qat->numFree++] = slot;
+    qat->numInflight--;
+}
+
+/* Derive the request of a slot the instance failed on the CPU instead */
+static void failSlot(KdfQat *qat, KdfSlot *slot)
+{
+    kdfDeriveCpu(slot->req, 1, SW_SHA256_AUTO);
+    qat->numCpu++;
+    releaseSlot(qat, slot);
+}
+
+/* Send one pass: the key block XORed with pad, followed by length bytes of message */
+static CpaStatus submitPass(KdfQat *qat, KdfSlot *slot, Cpa8U pad, const Cpa8U *message, Cpa32U length)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Cpa32U i = 0;
+
+    memset(slot->data, pad, SW_SHA256_BLOCK_SIZE);
+    for (i = 0; i < KDF_KEY_SIZE; i++)
+    {
+        slot->data[i] ^= slot->req->key[i];
+    }
+    memcpy(slot->data + SW_SHA256_BLOCK_SIZE, message, length);
+    slot->flatBuffer.pData = slot->data;
+    slot->flatBuffer.dataLenInBytes = SW_SHA256_BLOCK_SIZE + length;
+    slot->opData.messageLenToHashInBytes = SW_SHA256_BLOCK_SIZE + length;
+
+    do
+    {
+        stat = cpaCySymPerformOp(qat->cyInstHandle,
+                                 (void *)slot,
+                                 &slot->opData,
+                                 &slot->bufferList,
+                                 &slot->bufferList,
+                                 NULL);
+        if (CPA_STATUS_RETRY == stat)
+        {
+            pollInstance(qat->cyInstHandle);
+        }
+    } while (CPA_STATUS_RETRY == stat);
+    return stat;
+}
+
+/* Handle what the callback collected, sending inner passes that completed back for their outer pass */
+static void handleDone(KdfQat *qat)
+{
+    KdfSlot *slot = NULL;
+    Cpa32U doneIdx = 0;
+
+    /* The submits below may poll, which appends to the list */
+    for (doneIdx = 0; doneIdx < qat->numDone; doneIdx++)
+    {
+        slot = qat->done[doneIdx];
+        if (CPA_STATUS_SUCCESS != slot->status)
+        {
+            failSlot(qat, slot);
+        }
+        else if (0 == slot->pass)
+        {
+            slot->pass = 1;
+            if (CPA_STATUS_SUCCESS != submitPass(qat, slot, 0x5c, slot->digest, SW_SHA256_DIGEST_SIZE))
+            {
+                failSlot(qat, slot);
+            }
+        }
+        else
+        {
+            memcpy(slot->req->out, slot->digest, KDF_KEY_SIZE);
+            releaseSlot(qat, slot);
+        }
+    }
+    qat->numDone = 0;
+}
+
+CpaStatus kdfDeriveQat(CpaInstanceHandle cyInstHandle, KdfRequest *reqs, Cpa32U numReqs)
+{
+    KdfQat *qat = NULL;
+    KdfSlot *slot = NULL;
+    Cpa32U reqIdx = 0;
+    Cpa32U slotIdx = 0;
+    Cpa64U lastProgressNs = 0;
+    CpaBoolean timedOut = CPA_FALSE;
+
+    qat = openQat(cyInstHandle);
+    if (NULL == qat)
+    {
+        return CPA_STATUS_FAIL;
+    }
+
+    lastProgressNs = nowNs();
+    while (reqIdx < numReqs || 0 < qat->numInflight)
+    {
+        while (reqIdx < numReqs && 0 < qat->numFree)
+        {
+            slot = qat->freeSlots[--qat->numFree];
+            slot->req = &reqs[reqIdx++];
+            slot->pass = 0;
+            qat->numInflight++;
+            if (CPA_STATUS_SUCCESS != submitPass(qat, slot, 0x36, slot->req->s, slot->req->sLen))
+            {
+                failSlot(qat, slot);
+            }
+        }
+
+        pollInstance(cyInstHandle);
+        if (0 < qat->numDone)
+        {
+            handleDone(qat);
+            lastProgressNs = nowNs();
+        }
+        else if (nowNs() - lastProgressNs >= (Cpa64U)KDF_QAT_TIMEOUT_MS * 1000000)
+        {
+            timedOut = CPA_TRUE;
+            break;
+        }
+    }
+
+    if (CPA_TRUE == timedOut)
+    {
+        /* The device may still write the pinned data of what is in flight, which is left to it */
+        PRINT_ERR("Instance stopped answering, deriving the rest of the batch on the CPU\n");
+        for (slotIdx = 0; slotIdx < KDF_QAT_DEPTH; slotIdx++)
+        {
+            if (NULL != qat->slots[slotIdx].req)
+            {
+                kdfDeriveCpu(qat->slots[slotIdx].req, 1, SW_SHA256_AUTO);
+                qat->numCpu++;
+            }
+        }
+        kdfDeriveCpu(&reqs[reqIdx], numReqs - reqIdx, SW_SHA256_AUTO);
+        qat->numCpu += numReqs - reqIdx;
+    }
+    if (0 < qat->numCpu)
+    {
+        PRINT_DBG("%llu of %u derivations ran on the CPU\n", (unsigned long long)qat->numCpu, numReqs);
+    }
+    if (CPA_TRUE != timedOut)
+    {
+        closeQat(qat);
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus kdfDeriveBatch(CpaInstanceHandle cyInstHandle, KdfRequest *reqs, Cpa32U numReqs)
+{
+    if (NULL != cyInstHandle && CPA_STATUS_SUCCESS == kdfDeriveQat(cyInstHandle, reqs, numReqs))
+    {
+        return CPA_STATUS_SUCCESS;
+    }
+    return kdfDeriveCpu(reqs, numReqs, SW_SHA256_AUTO);
+}
+
+/*
+ *******************
+ * Benchmark
+ *******************
+ */
+
+/* KgNB of every UE, and the KgNB* and AS key requests made from it */
+static void initStorm(KdfRequest *reqs, Cpa32U numUes)
+{
+    static const Cpa8U distinguishers[] = {KDF_RRC_ENC, KDF_RRC_INT, KDF_UP_ENC, KDF_UP_INT};
+    static const char *algoNames[] = {"nea2", "nia2", "nea2", "nia2"};
+    Cpa8U kgnb[KDF_KEY_SIZE];
+    Cpa32U ueIdx = 0;
+    Cpa32U keyIdx = 0;
+
+    for (ueIdx = 0; ueIdx < numUes; ueIdx++)
+    {
+        for (keyIdx = 0; keyIdx < KDF_KEY_SIZE; keyIdx++)
+        {
+            kgnb[keyIdx] = (Cpa8U)(ueIdx * 131 + keyIdx * 7 + (ueIdx >> 8));
+        }
+        kdfInitKgnbStar(&reqs[ueIdx], kgnb, (Cpa16U)(ueIdx % 1008), 632628);
+        for (keyIdx = 0; keyIdx < 4; keyIdx++)
+        {
+            /* Keyed with KgNB* once the first batch is done */
+            kdfInitAlgoKey(&reqs[numUes + 4 * ueIdx + keyIdx], kgnb, distinguishers[keyIdx], algoNames[keyIdx]);
+        }
+    }
+}
+
+/* Both batches of a storm: KgNB* of every UE, then its AS keys from it */
+static CpaStatus deriveStorm(CpaInstanceHandle cyInstHandle, Cpa32U impl, KdfRequest *reqs, Cpa32U numUes)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Cpa32U ueIdx = 0;
+    Cpa32U keyIdx = 0;
+
+    stat = (NULL != cyInstHandle) ? kdfDeriveQat(cyInstHandle, reqs, numUes) : kdfDeriveCpu(reqs, numUes, impl);
+    for (ueIdx = 0; CPA_STATUS_SUCCESS == stat && ueIdx < numUes; ueIdx++)
+    {
+        for (keyIdx = 0; keyIdx < 4; keyIdx++)
+        {
+            memcpy(reqs[numUes + 4 * ueIdx + keyIdx].key, reqs[ueIdx].out, KDF_KEY_SIZE);
+        }
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = (NULL != cyInstHandle) ? kdfDeriveQat(cyInstHandle, reqs + numUes, 4 * numUes)
+                                      : kdfDeriveCpu(reqs + numUes, 4 * numUes, impl);
+    }
+    return stat;
+}
+
+/*
+ * RFC 4231 test case 2. HMAC pads the key with zeros to a block, so the 4 byte key is the same as a KDF key
+ * padded to 32 bytes.
+ */
+static CpaBoolean checkKnownAnswer(CpaInstanceHandle cyInstHandle, Cpa32U impl)
+{
+    static const Cpa8U expected[KDF_KEY_SIZE] = {
+        0x5b, 0xdc, 0xc1, 0x46, 0xbf, 0x60, 0x75, 0x4e, 0x6a, 0x04, 0x24, 0x26, 0x08, 0x95, 0x75, 0xc7,
+        0x5a, 0x00, 0x3f, 0x08, 0x9d, 0x27, 0x39, 0x83, 0x9d, 0xec, 0x58, 0xb9, 0x64, 0xec, 0x38, 0x43,
+    };
+    static const char message[] = "what do ya want for nothing?";
+    KdfRequest req = {{0}};
+
+    memcpy(req.key, "Jefe", 4);
+    memcpy(req.s, message, sizeof(message) - 1);
+    req.sLen = sizeof(message) - 1;
+    if (NULL != cyInstHandle)
+    {
+        kdfDeriveQat(cyInstHandle, &req, 1);
+    }
+    else
+    {
+        kdfDeriveCpu(&req, 1, impl);
+    }
+    return (0 == memcmp(req.out, expected, KDF_KEY_SIZE)) ? CPA_TRUE : CPA_FALSE;
+}
+
+static CpaStatus benchPath(const char *name,
+                           CpaInstanceHandle cyInstHandle,
+                           Cpa32U impl,
+                           KdfRequest *reqs,
+                           const KdfRequest *reference,
+                           Cpa32U numUes)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    CpaBoolean known = checkKnownAnswer(cyInstHandle, impl);
+    Cpa32U numReqs = 5 * numUes;
+    Cpa32U numMismatches = 0;
+    Cpa32U reqIdx = 0;
+    Cpa64U start = 0;
+    Cpa64U elapsed = 0;
+
+    initStorm(reqs, numUes);
+    start = nowNs();
+    stat = deriveStorm(cyInstHandle, impl, reqs, numUes);
+    elapsed = nowNs() - start;
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        PRINT("%-10s failed\n", name);
+        return stat;
+    }
+
+    for (reqIdx = 0; NULL != reference && reqIdx < numReqs; reqIdx++)
+    {
+        numMismatches += (0 != memcmp(reqs[reqIdx].out, reference[reqIdx].out, KDF_KEY_SIZE)) ? 1 : 0;
+    }
+    PRINT("%-10s %12.0f %10.2f %10s %10u\n",
+          name,
+          (double)numReqs * 1e9 / (elapsed ? elapsed : 1),
+          (double)elapsed / 1000 / numUes,
+          (CPA_TRUE == known) ? "pass" : "FAIL",
+          numMismatches);
+    return (CPA_TRUE == known && 0 == numMismatches) ? CPA_STATUS_SUCCESS : CPA_STATUS_FAIL;
+}
+
+/*
+ * Create a session on the KUPenc of every UE, as the target gNB does once the keys are in
+ */
+static CpaStatus benchSessions(const KdfRequest *reqs, Cpa32U numUes)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Cpa32U *sessionIds = NULL;
+    Cpa32U numSessions = (ENGINE_MAX_SESSIONS < numUes) ? ENGINE_MAX_SESSIONS : numUes;
+    Cpa32U numCreated = 0;
+    Cpa32U ueIdx = 0;
+    Cpa64U start = 0;
+    Cpa64U elapsed = 0;
+
+    sessionIds = malloc(numSessions * sizeof(Cpa32U));
+    if (NULL == sessionIds)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+
+    start = nowNs();
+    for (ueIdx = 0; CPA_STATUS_SUCCESS == stat && ueIdx < numSessions; ueIdx++)
+    {
+        /* KUPenc is the third AS key of the UE */
+        stat = engineCreateSession("nea2",
+                                   kdfAlgoKey(&reqs[numUes + 4 * ueIdx + 2]),
+                                   KDF_ALGO_KEY_SIZE,
+                                   (Cpa8U)(ueIdx % 32),
+                                   0,
+                                   0,
+                                   CPA_FALSE,
+                                   ENGINE_CLASS_BULK,
+                                   NULL,
+                                   &sessionIds[numCreated]);
+        numCreated += (CPA_STATUS_SUCCESS == stat) ? 1 : 0;
+    }
+    elapsed = nowNs() - start;
+    CHECK_ERR_STATUS("engineCreateSession", stat);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT("%u sessions on the derived KUPenc keys in %.2f ms, %.0f per second\n",
+              numCreated,
+              (double)elapsed / 1e6,
+              (double)numCreated * 1e9 / (elapsed ? elapsed : 1));
+    }
+
+    for (ueIdx = 0; ueIdx < numCreated; ueIdx++)
+    {
+        engineRetireSession(sessionIds[ueIdx], NULL);
+    }
+    free(sessionIds);
+    return stat;
+}
+
+CpaStatus runKdfBench(Cpa32U numUes)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    CpaStatus pathStat = CPA_STATUS_SUCCESS;
+    CpaInstanceHandle cyInstHandle = NULL;
+    KdfRequest *reference = NULL;
+    KdfRequest *reqs = NULL;
+    Cpa32U impl = 0;
+
+    if (0 == numUes)
+    {
+        PRINT_ERR("Invalid number of UEs\n");
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    reference = malloc(5 * numUes * sizeof(KdfRequest));
+    reqs = malloc(5 * numUes * sizeof(KdfRequest));
+    if (NULL == reference || NULL == reqs)
+    {
+        free(reference);
+        free(reqs);
+        return CPA_STATUS_RESOURCE;
+    }
+
+    /* The portable implementation is the reference the others are checked against */
+    initStorm(reference, numUes);
+    deriveStorm(NULL, SW_SHA256_SCALAR, reference, numUes);
+
+    PRINT("Re-keying %u UEs, KgNB* and 4 AS keys each: %u derivations\n", numUes, 5 * numUes);
+    PRINT("%-10s %12s %10s %10s %10s\n", "path", "kdf/s", "us/UE", "RFC 4231", "mismatch");
+    for (impl = SW_SHA256_SCALAR; impl <= SW_SHA256_AVX2; impl++)
+    {
+        if (CPA_TRUE == swSha256Supported(impl))
+        {
+            pathStat = benchPath(swSha256ImplName(impl), NULL, impl, reqs, reference, numUes);
+            stat = (CPA_STATUS_SUCCESS == stat) ? pathStat : stat;
+        }
+    }
+
+    if (CPA_STATUS_SUCCESS == engineStart())
+    {
+        cyInstHandle = engineInstanceHandle(0);
+        if (NULL != cyInstHandle)
+        {
+            /* Only reported: the mock device does not compute digests */
+            benchPath("qat", cyInstHandle, SW_SHA256_AUTO, reqs, reference, numUes);
+        }
+        pathStat = benchSessions(reference, numUes);
+        stat = (CPA_STATUS_SUCCESS == stat) ? pathStat : stat;
+        engineStop();
+    }
+
+    free(reference);
+    free(reqs);
+    return stat;
+}
@@ -0,0 +1,75 @@
+#ifndef KDF_H
+#define KDF_H
+
+#include "cpa.h"
+
+#define KDF_KEY_SIZE 32
+#define KDF_ALGO_KEY_SIZE 16 /* NEA/NIA keys are the 128 least significant bits of the output */
+/* FC and parameters, so that S fits in one SHA-256 block with its padding, see sw_sha256.c */
+#define KDF_MAX_S_SIZE 55
+#define KDF_QAT_DEPTH 256 /* requests in flight on the accelerator */
+#define KDF_QAT_TIMEOUT_MS 1000 /* without a completion before the rest of a batch goes to the CPU */
+#define KDF_BENCH_UES 4096
+
+/* Function codes, TS 33.501 Annex A */
+#define KDF_FC_ALGO_KEY 0x69
+#define KDF_FC_KGNB_STAR 0x70
+
+/* Algorithm type distinguishers of KDF_FC_ALGO_KEY */
+enum
+{
+    KDF_NAS_ENC = 0x01,
+    KDF_NAS_INT = 0x02,
+    KDF_RRC_ENC = 0x03,
+    KDF_RRC_INT = 0x04,
+    KDF_UP_ENC = 0x05,
+    KDF_UP_INT = 0x06,
+};
+
+/*
+ * One derivation of the TS 33.220 Annex B.2 KDF: HMAC-SHA-256 of S = FC || P0 || L0 || P1 || L1 ... under a
+ * 256 bit key
+ */
+typedef struct _KdfRequest {
+    Cpa8U key[KDF_KEY_SIZE];
+    Cpa8U s[KDF_MAX_S_SIZE];
+    Cpa32U sLen;
+    Cpa8U out[KDF_KEY_SIZE];
+} KdfRequest;
+
+void kdfInitRequest(KdfRequest *req, const Cpa8U *key, Cpa8U fc);
+/* Append P and its 2 byte length L to S */
+CpaStatus kdfAddParam(KdfRequest *req, const Cpa8U *param, Cpa16U paramLen);
+/* KgNB* for a handover to the cell PCI on the downlink ARFCN, TS 33.501 A.11 */
+void kdfInitKgnbStar(KdfRequest *req, const Cpa8U *kgnb, Cpa16U pci, Cpa32U arfcnDl);
+/* KRRCenc, KRRCint, KUPenc or KUPint from KgNB for the algorithm of algoName (e.g. "nea2"), TS 33.501 A.8 */
+CpaStatus kdfInitAlgoKey(KdfRequest *req, const Cpa8U *kgnb, Cpa8U distinguisher, const char *algoName);
+
+/* Key for engineCreateSession() from an algorithm key derivation */
+static inline const Cpa8U *kdfAlgoKey(const KdfRequest *req)
+{
+    return req->out + KDF_KEY_SIZE - KDF_ALGO_KEY_SIZE;
+}
+
+/*
+ * Derive a batch on the CPU with the SHA-256 implementation impl (SwSha256Impl, SW_SHA256_AUTO for the
+ * fastest)
+ */
+CpaStatus kdfDeriveCpu(KdfRequest *reqs, Cpa32U numReqs, Cpa32U impl);
+
+/*
+ * Derive a batch on the accelerator, KDF_QAT_DEPTH requests in flight. The caller's thread polls the instance,
+ * nothing else may poll it meanwhile. Requests the instance fails or does not answer are derived on the CPU.
+ */
+CpaStatus kdfDeriveQat(CpaInstanceHandle cyInstHandle, KdfRequest *reqs, Cpa32U numReqs);
+
+/* On the accelerator when given an instance, on the CPU otherwise */
+CpaStatus kdfDeriveBatch(CpaInstanceHandle cyInstHandle, KdfRequest *reqs, Cpa32U numReqs);
+
+/*
+ * Re-key numUes UEs as in a handover storm: KgNB* and then the four AS keys of every UE, on every CPU
+ * implementation and on the accelerator, and create engine sessions on the derived keys
+ */
+CpaStatus runKdfBench(Cpa32U numUes);
+
+#endif
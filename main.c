@@ -12,10 +12,30 @@
 #include "qae_mem.h"
 #include "qae_mem_utils.h"
 
+#include "algo.h"
+#include "arena.h"
+#include "batch.h"
+#include "bench.h"
+#include "client.h"
+#include "daemon.h"
+#include "kdf.h"
+#include "perf.h"
+#include "pmu.h"
+#include "session.h"
+#include "stream.h"
+#include "sw_crypto.h"
+#include "trace.h"
 #include "utils.h"
 
 CpaInstanceHandle *inst_g = NULL;
 
+#define CHAIN_DEFAULT_SEGMENT_SIZE 48
+#define CHAIN_HEADER_SIZE 2
+#define VERIFY_DEFAULT_BURST_SIZE 32
+#define VERIFY_MAX_BURST_SIZE 256
+#define EXEC_POLL_TIMEOUT_MS 1000 /* before the op is given up on and computed on the CPU */
+#define ISOLATION_PDU_SIZE 16
+
 void usage(const char *cmd)
 {
     PRINT("Test 5G NR Security with Intel QAT\n");
@@ -24,7 +44,703 @@ void usage(const char *cmd)
     PRINT("Arguments:\n");
     PRINT("    ALGO        Security algorithm - nea1, nea2 or nea3 (for cipher)\n");
     PRINT("                                     nia1, nia2 or nia3 (for hash)\n");
+    PRINT("                                     nea2_256 or nia2_256 (256-bit keys)\n");
+    PRINT("                                     nea3_256_exp or nia3_256_exp (experimental ZUC-256, see README)\n");
     PRINT("    TESTSET     Test set number - 1 to 5 (not all test sets supported)\n");
+    PRINT("\n");
+    PRINT("Service mode:\n");
+    PRINT("    sudo %s --daemon [SOCKET] [SHADOW]       Serve PDCP processes on SOCKET, recomputing 1 in SHADOW\n", cmd);
+    PRINT("                                             ops on the CPU as a check (e.g. 10000, off by default)\n");
+    PRINT("    %s --remote [ALGO] [TESTSET] [SOCKET]    Run the test set through the daemon\n", cmd);
+    PRINT("    %s --health [SOCKET]                     Query health and statistics of the daemon\n", cmd);
+    PRINT("    %s --isolation [SOCKET]                  Check that a client cannot use the sessions of another\n", cmd);
+    PRINT("    SOCKET defaults to %s\n", DAEMON_DEFAULT_SOCKET);
+    PRINT("\n");
+    PRINT("Streaming mode:\n");
+    PRINT("    sudo %s --stream [ALGO] [TESTSET] [CHUNK]  Run the test set as partial packets of CHUNK bytes\n", cmd);
+    PRINT("    CHUNK is a multiple of 16 and defaults to %u, only AES based algorithms can stream\n",
+          STREAM_DEFAULT_CHUNK_SIZE);
+    PRINT("\n");
+    PRINT("Chained buffers:\n");
+    PRINT("    sudo %s --chain [ALGO] [TESTSET] [SEGMENT]  Run the test set behind a PDCP header, split into\n", cmd);
+    PRINT("                                              segments of SEGMENT bytes (default %u)\n", CHAIN_DEFAULT_SEGMENT_SIZE);
+    PRINT("\n");
+    PRINT("Uplink MAC-I verification:\n");
+    PRINT("    sudo %s --verify [ALGO] [TESTSET] [BURST]   Verify a burst of PDUs in the device, every other one\n", cmd);
+    PRINT("                                              with a forged MAC-I (BURST defaults to %u)\n", VERIFY_DEFAULT_BURST_SIZE);
+    PRINT("\n");
+    PRINT("Per-core workers:\n");
+    PRINT("    sudo %s --workers [ALGO] [WORKERS] [PDU] [SECONDS]  Run WORKERS run-to-completion workers, one per\n", cmd);
+    PRINT("                                              instance, on synthetic PDUs of PDU bytes (defaults: one\n");
+    PRINT("                                              per instance, %u bytes, %u s)\n", WORKER_BENCH_PDU_SIZE, WORKER_BENCH_SECONDS);
+    PRINT("    sudo %s --steal [ALGO] [WORKERS] [SKEW] [SECONDS]  Queue per-bearer flows to a worker group, SKEW %%\n", cmd);
+    PRINT("                                              of the traffic on the bearers of one worker, and compare\n");
+    PRINT("                                              static placement to work stealing (defaults: %u %%, %u s)\n", WORKER_BENCH_SKEW, WORKER_BENCH_SECONDS);
+    PRINT("    sudo %s --qos [ALGO] [SECONDS]            Overload a worker with bulk flows next to a signalling and a\n", cmd);
+    PRINT("                                              low latency flow, without and with traffic classes\n");
+    PRINT("    sudo %s --reorder [ALGO] [WORKERS] [SECONDS]  Spread every bearer over WORKERS workers and deliver\n", cmd);
+    PRINT("                                              its completions in COUNT order through a reorder window\n");
+    PRINT("    sudo %s --batching [ALGO] [TARGET] [SECONDS]  Compare immediate, fixed and adaptive batching at a\n", cmd);
+    PRINT("                                              low, a high and an overload rate for a latency target of\n");
+    PRINT("                                              TARGET us (default %u us)\n", BATCH_DEFAULT_TARGET_US);
+    PRINT("    sudo %s --failover [ALGO] [SECONDS]       Run a worker per instance through the faults injected by\n", cmd);
+    PRINT("                                              MOCK_QAT_FAULT and check that no bearer stalls (%u s)\n", WORKER_BENCH_SECONDS);
+    PRINT("    sudo %s --churn [ALGO] [RATE] [SECONDS]   Create, re-key and retire sessions at RATE handovers/s\n", cmd);
+    PRINT("                                              (default %u) while workers send, and compare the latency\n", WORKER_CHURN_RATE);
+    PRINT("                                              of the traffic to a quiet round (%u s each)\n", WORKER_BENCH_SECONDS);
+    PRINT("    sudo %s --idle [ALGO] [RATE] [SECONDS]    Hand a worker RATE PDUs/s (default %u) and then a busy hour\n", cmd, WORKER_IDLE_RATE);
+    PRINT("                                              rate, spinning, in event mode and adaptive, and compare the\n");
+    PRINT("                                              CPU time of the worker (%u s each)\n", WORKER_BENCH_SECONDS);
+    PRINT("\n");
+    PRINT("Key derivation:\n");
+    PRINT("    sudo %s --kdf [UES]                       Re-key UES UEs (default %u) as in a handover storm, with the\n", cmd, KDF_BENCH_UES);
+    PRINT("                                              batched KDF on the CPU and on the accelerator\n");
+    PRINT("\n");
+    PRINT("Performance suite:\n");
+    PRINT("    sudo %s --perf [RESULTS] [BASELINE]        Sweep algorithms, PDU sizes and in-flight depths, write\n", cmd);
+    PRINT("                                              RESULTS (default %s) and fail on\n", PERF_DEFAULT_RESULTS);
+    PRINT("                                              regressions against BASELINE\n");
+    PRINT("    sudo %s --perf-baseline BASELINE          Record BASELINE from %u sweeps, with tolerances as wide as\n", cmd, PERF_BASELINE_SWEEPS);
+    PRINT("                                              the noise measured across them\n");
+    PRINT("    sudo %s --compare [ALGO]                  Sweep the PDU sizes of nea2/nia2 (or ALGO) through the\n", cmd);
+    PRINT("                                              engine, the software engine and OpenSSL EVP side by side\n");
+    PRINT("\n");
+    PRINT("Logging and tracing:\n");
+    PRINT("    PDCP_LOG_LEVEL=err|debug|dump              Log level (default debug), capped by LOG_MAX_LEVEL at build\n");
+    PRINT("    PDCP_TRACE=FILE                            Record submit, completion and retry of every op, written\n");
+    PRINT("                                              to FILE on exit\n");
+    PRINT("    %s --trace-decode FILE [text|chrome]       Print a trace as text or as Chrome trace JSON\n", cmd);
+    PRINT("    PDCP_PMU=RATE                              Count cycles, instructions, LLC and branch misses of one\n");
+    PRINT("                                              in RATE runs of every data path stage, printed per stage\n");
+    PRINT("                                              and algorithm on exit\n");
+}
+
+static CpaStatus verifyOutput(const Cpa8U *output, const TestData *testData)
+{
+    Cpa32U listIdx = 0;
+
+    if (0 == memcmp(output, testData->out, testData->outSize))
+    {
+        PRINT_COLOR(ANSI_COLOR_GREEN, "Output matches expected output!\n");
+        return CPA_STATUS_SUCCESS;
+    }
+
+    PRINT_COLOR(ANSI_COLOR_RED, "Output does not match expected output\n");
+    for (listIdx = 0; listIdx < testData->outSize; listIdx++)
+    {
+        if (0 == memcmp(output + listIdx, testData->out + listIdx, 1))
+        {
+            PRINT("%02x ", output[listIdx]);
+        }
+        else
+        {
+            PRINT_COLOR(ANSI_COLOR_RED, "%02x ", output[listIdx]);
+        }
+        if (listIdx % 8 == 7)
+        {
+            PRINT("\n");
+        }
+    }
+    PRINT("\n");
+    return CPA_STATUS_FAIL;
+}
+
+/*
+ * Run a test set through a running daemon instead of owning the device
+ */
+static CpaStatus execRemote(const char *socketPath, const TestData *testData)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = getAlgoDesc(testData);
+    OpDesc opDesc;
+    ClientConn conn = {0};
+    Cpa32U sessionId = 0;
+    PdcpDesc desc = {0};
+    Cpa8U *payload = NULL;
+    CpaFlatBuffer flatBuffer = {0};
+    CpaBufferList bufferList = {0};
+
+    if (NULL == algoDesc)
+    {
+        PRINT_ERR("No op path for the algorithm of the test data\n");
+        return CPA_STATUS_UNSUPPORTED;
+    }
+
+    stat = clientConnect(socketPath, &conn);
+    CHECK_ERR_STATUS("clientConnect", stat);
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = clientCreateSession(&conn,
+                                   algoDesc->name,
+                                   testData->key,
+                                   testData->keySize,
+                                   testData->bearer,
+                                   testData->dir,
+                                   (CPA_CY_SYM_OP_HASH == algoDesc->op) ? testData->outSize : 0,
+                                   CPA_FALSE,
+                                   ENGINE_CLASS_BULK,
+                                   &sessionId);
+        CHECK_ERR_STATUS("clientCreateSession", stat);
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        /* The daemon builds the IV prefix itself, only the message goes over */
+        payload = clientAllocBuffer(&conn, &desc.offset);
+        desc.sessionId = sessionId;
+        desc.count = testData->count;
+        desc.fresh = testData->fresh;
+        desc.length = testData->inSize - algoDesc->msgIvPrefixLen;
+        memcpy(payload, testData->in + algoDesc->msgIvPrefixLen, desc.length);
+
+        while (1 != clientSubmitBurst(&conn, &desc, 1))
+        {
+            OS_SLEEP(1);
+        }
+        while (1 != clientPollBurst(&conn, &desc, 1, NULL))
+        {
+            OS_SLEEP(1);
+        }
+        stat = desc.status;
+        CHECK_ERR_STATUS("clientPollBurst", stat);
+        clientRetireSession(&conn, sessionId);
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        flatBuffer.pData = payload;
+        flatBuffer.dataLenInBytes = desc.length;
+        bufferList.numBuffers = 1;
+        bufferList.pBuffers = &flatBuffer;
+        opDescInit(&opDesc, testData);
+        stat = verifyOutput(algoDesc->completeOp(&opDesc, &bufferList, desc.digest), testData);
+    }
+
+    clientDisconnect(&conn);
+
+    return stat;
+}
+
+/*
+ * Connect two clients to a running daemon and check that the second one can neither run ops on a session of the
+ * first, through a request or its ring, nor retire it, while the first one can
+ */
+static CpaStatus checkIsolation(const char *socketPath)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = findAlgoDesc("nea2");
+    ClientConn owner = {0};
+    ClientConn other = {0};
+    PdcpDesc desc = {0};
+    Cpa8U key[ENGINE_MAX_KEY_SIZE] = {0};
+    Cpa8U *payload = NULL;
+    Cpa32U sessionId = 0;
+    Cpa32U offset = 0;
+    Cpa32U numRefused = 0;
+
+    stat = clientConnect(socketPath, &owner);
+    CHECK_ERR_STATUS("clientConnect", stat);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        clientDisconnect(&owner);
+        return stat;
+    }
+    stat = clientConnect(socketPath, &other);
+    CHECK_ERR_STATUS("clientConnect", stat);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = clientCreateSession(
+            &owner, algoDesc->name, key, algoDesc->keySize, 1, 0, 0, CPA_FALSE, ENGINE_CLASS_BULK, &sessionId);
+        CHECK_ERR_STATUS("clientCreateSession", stat);
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        payload = clientAllocBuffer(&owner, &offset);
+        memset(payload, 0, ISOLATION_PDU_SIZE);
+        stat = clientExecOp(&owner, sessionId, 0, 0, offset, ISOLATION_PDU_SIZE, NULL);
+        CHECK_ERR_STATUS("clientExecOp", stat);
+        clientFreeBuffer(&owner, offset);
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        payload = clientAllocBuffer(&other, &offset);
+        memset(payload, 0, ISOLATION_PDU_SIZE);
+        numRefused += (CPA_STATUS_INVALID_PARAM ==
+                       clientExecOp(&other, sessionId, 0, 0, offset, ISOLATION_PDU_SIZE, NULL)) ? 1 : 0;
+
+        desc.sessionId = sessionId;
+        desc.offset = offset;
+        desc.length = ISOLATION_PDU_SIZE;
+        while (1 != clientSubmitBurst(&other, &desc, 1))
+        {
+            OS_SLEEP(1);
+        }
+        while (1 != clientPollBurst(&other, &desc, 1, NULL))
+        {
+            OS_SLEEP(1);
+        }
+        numRefused += (CPA_STATUS_INVALID_PARAM == desc.status) ? 1 : 0;
+        clientFreeBuffer(&other, offset);
+
+        numRefused += (CPA_STATUS_INVALID_PARAM == clientRetireSession(&other, sessionId)) ? 1 : 0;
+        stat = clientRetireSession(&owner, sessionId);
+        CHECK_ERR_STATUS("clientRetireSession", stat);
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        if (3 == numRefused)
+        {
+            PRINT_COLOR(ANSI_COLOR_GREEN, "Sessions of a client refused to another one\n");
+        }
+        else
+        {
+            PRINT_COLOR(ANSI_COLOR_RED, "%u of 3 requests on the session of another client refused\n", numRefused);
+            stat = CPA_STATUS_FAIL;
+        }
+    }
+
+    clientDisconnect(&other);
+    clientDisconnect(&owner);
+
+    return stat;
+}
+
+static CpaStatus printHealth(const char *socketPath)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    ClientConn conn = {0};
+    DaemonHealth health = {0};
+    EngineStats stats = {0};
+
+    stat = clientConnect(socketPath, &conn);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = clientGetHealth(&conn, &health);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = clientGetStats(&conn, &stats);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT("State: %s\n", (DAEMON_STATE_UP == health.state) ? "up" : "not ready");
+        PRINT("Uptime: %llu s\n", (unsigned long long)health.uptimeSec);
+        PRINT("Instances: %u\n", health.numInstances);
+        PRINT("Clients: %u\n", health.numClients);
+        PRINT("Sessions: %u (%u retired), %llu re-keys\n",
+              stats.numSessions,
+              stats.numRetiredSessions,
+              (unsigned long long)stats.numRekeys);
+        PRINT("Requests: %llu submitted, %llu completed, %llu errors, %llu retries, %u in flight\n",
+              (unsigned long long)stats.numSubmitted,
+              (unsigned long long)stats.numCompleted,
+              (unsigned long long)stats.numErrors,
+              (unsigned long long)stats.numRetries,
+              stats.numInflight);
+        PRINT("Payloads: %llu zero-copy, %llu bounced\n",
+              (unsigned long long)stats.numZeroCopy,
+              (unsigned long long)stats.numBounced);
+        PRINT("MAC-I verify failures: %llu\n", (unsigned long long)stats.numVerifyFailures);
+        PRINT("Bulk ops held back for high priority: %llu\n", (unsigned long long)stats.numThrottled);
+        PRINT("Shadow checks: %llu checked, %llu mismatches, %llu skipped\n",
+              (unsigned long long)stats.numShadowChecked,
+              (unsigned long long)stats.numShadowMismatches,
+              (unsigned long long)stats.numShadowSkipped);
+        PRINT("Failover: %u instances down, %llu failovers, %llu probes, %llu readmissions\n",
+              stats.numInstancesDown,
+              (unsigned long long)stats.numFailovers,
+              (unsigned long long)stats.numProbes,
+              (unsigned long long)stats.numReadmissions);
+        PRINT("Software engine: %llu ops, %llu stuck requests failed back, %llu sessions moved\n",
+              (unsigned long long)stats.numCpuOps,
+              (unsigned long long)stats.numAbandoned,
+              (unsigned long long)stats.numMigrations);
+    }
+    clientDisconnect(&conn);
+
+    return stat;
+}
+
+typedef struct _StreamOutput {
+    Cpa8U *data;
+    Cpa32U length;
+} StreamOutput;
+
+static void collectStreamOutput(void *sinkArg, const Cpa8U *data, Cpa32U length)
+{
+    StreamOutput *output = (StreamOutput *)sinkArg;
+
+    memcpy(output->data + output->length, data, length);
+    output->length += length;
+}
+
+/*
+ * Run a test set as a stream of partial packets of chunkSize bytes on an instance of our node
+ */
+static CpaStatus execStream(const TestData *testData, Cpa32U chunkSize)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = getAlgoDesc(testData);
+    OpDesc opDesc;
+    CpaInstanceHandle cyInstHandles[MAX_INSTANCES];
+    CpaInstanceHandle cyInstHandle = NULL;
+    Cpa16U numInstances = 0;
+    StreamCtx streamCtx = {0};
+    StreamOutput output = {0};
+    Cpa8U digest[MAX_IV_SIZE] = {0};
+    CpaFlatBuffer flatBuffer = {0};
+    CpaBufferList bufferList = {0};
+
+    if (NULL == algoDesc)
+    {
+        PRINT_ERR("No op path for the algorithm of the test data\n");
+        return CPA_STATUS_UNSUPPORTED;
+    }
+
+    stat = cpaCyGetNumInstances(&numInstances);
+    CHECK_ERR_STATUS("cpaCyGetNumInstances", stat);
+    if (CPA_STATUS_SUCCESS == stat && 0 == numInstances)
+    {
+        PRINT_ERR("No instances found for 'PDCP'\n");
+        stat = CPA_STATUS_FAIL;
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        numInstances = (numInstances > MAX_INSTANCES) ? MAX_INSTANCES : numInstances;
+        stat = cpaCyGetInstances(numInstances, cyInstHandles);
+        CHECK_ERR_STATUS("cpaCyGetInstances", stat);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        cyInstHandle = getLocalInstance(cyInstHandles, numInstances);
+        bindThreadToInstance(cyInstHandle);
+        stat = cpaCyStartInstance(cyInstHandle);
+        CHECK_ERR_STATUS("cpaCyStartInstance", stat);
+        if (CPA_STATUS_SUCCESS != stat)
+        {
+            cyInstHandle = NULL;
+        }
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = cpaCySetAddressTranslation(cyInstHandle, (CpaVirtualToPhysical)qaeVirtToPhysNUMA);
+        CHECK_ERR_STATUS("cpaCySetAddressTranslation", stat);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = memAllocOs((void *)&output.data, testData->inSize);
+        CHECK_ERR_STATUS("memAllocOs", stat);
+    }
+
+    /*
+     * The stream builds the IV prefix itself, only the message is fed
+     */
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = streamOpen(cyInstHandle, testData, chunkSize, collectStreamOutput, &output, &streamCtx);
+        CHECK_ERR_STATUS("streamOpen", stat);
+        if (CPA_STATUS_SUCCESS == stat)
+        {
+            stat = streamUpdate(&streamCtx,
+                                testData->in + algoDesc->msgIvPrefixLen,
+                                testData->inSize - algoDesc->msgIvPrefixLen);
+            CHECK_ERR_STATUS("streamUpdate", stat);
+        }
+        if (CPA_STATUS_SUCCESS == stat)
+        {
+            stat = streamFinal(&streamCtx, digest);
+            CHECK_ERR_STATUS("streamFinal", stat);
+        }
+        streamClose(&streamCtx);
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT_DBG("Streamed %llu bytes in chunks of %u bytes\n", (unsigned long long)streamCtx.numBytes, chunkSize);
+        flatBuffer.pData = output.data;
+        flatBuffer.dataLenInBytes = output.length;
+        bufferList.numBuffers = 1;
+        bufferList.pBuffers = &flatBuffer;
+        opDescInit(&opDesc, testData);
+        stat = verifyOutput(algoDesc->completeOp(&opDesc, &bufferList, digest), testData);
+    }
+
+    if (NULL != cyInstHandle)
+    {
+        cpaCyStopInstance(cyInstHandle);
+    }
+    memFreeOs((void *)&output.data);
+
+    return stat;
+}
+
+/*
+ * Run a test set through the engine as a chained packet: a PDCP header segment followed by payload segments of
+ * segmentSize bytes. The engine skips the header and processes the segments in place.
+ */
+static CpaStatus execChain(const TestData *testData, Cpa32U segmentSize)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = getAlgoDesc(testData);
+    OpDesc opDesc;
+    PktBuf segments[ENGINE_MAX_SEGMENTS];
+    PktBuf *segment = NULL;
+    Cpa32U numSegments = 0;
+    Cpa32U length = 0;
+    Cpa32U sessionId = 0;
+    Cpa8U digest[ENGINE_MAX_DIGEST_SIZE] = {0};
+    Cpa8U *output = NULL;
+    CpaFlatBuffer flatBuffer = {0};
+    CpaBufferList bufferList = {0};
+
+    if (NULL == algoDesc)
+    {
+        PRINT_ERR("No op path for the algorithm of the test data\n");
+        return CPA_STATUS_UNSUPPORTED;
+    }
+    length = testData->inSize - algoDesc->msgIvPrefixLen;
+    if (0 == segmentSize || ENGINE_MAX_SEGMENTS - 1 < (length + segmentSize - 1) / segmentSize)
+    {
+        PRINT_ERR("Segments of %u bytes make a chain longer than %u segments\n", segmentSize, ENGINE_MAX_SEGMENTS);
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    stat = engineStart();
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+
+    /*
+     * Header segment, then the message cut into segments with a shorter last one
+     */
+    memset(segments, 0, sizeof(segments));
+    for (numSegments = 0; CPA_STATUS_SUCCESS == stat && (0 == numSegments || 0 < length); numSegments++)
+    {
+        segment = &segments[numSegments];
+        segment->length = (0 == numSegments) ? CHAIN_HEADER_SIZE : ((length < segmentSize) ? length : segmentSize);
+        stat = memAllocContig((void *)&segment->data, segment->length, BYTE_ALIGNMENT);
+        CHECK_ERR_STATUS("memAllocContig", stat);
+        if (CPA_STATUS_SUCCESS != stat)
+        {
+            break;
+        }
+        if (0 == numSegments)
+        {
+            memset(segment->data, 0x80, CHAIN_HEADER_SIZE);
+        }
+        else
+        {
+            memcpy(segment->data, testData->in + testData->inSize - length, segment->length);
+            length -= segment->length;
+            segments[numSegments - 1].next = segment;
+        }
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = engineCreateSession(algoDesc->name,
+                                   testData->key,
+                                   testData->keySize,
+                                   testData->bearer,
+                                   testData->dir,
+                                   (CPA_CY_SYM_OP_HASH == algoDesc->op) ? testData->outSize : 0,
+                                   CPA_FALSE,
+                                   ENGINE_CLASS_BULK,
+                                   NULL,
+                                   &sessionId);
+        CHECK_ERR_STATUS("engineCreateSession", stat);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = engineExecChainOp(sessionId, testData->count, testData->fresh, segments, CHAIN_HEADER_SIZE, digest);
+        CHECK_ERR_STATUS("engineExecChainOp", stat);
+        engineRetireSession(sessionId, NULL);
+    }
+
+    /*
+     * Linearize only to compare against the expected output
+     */
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT_DBG("Processed a chain of %u segments\n", numSegments);
+        stat = memAllocOs((void *)&output, chainLength(segments));
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        length = 0;
+        for (segment = segments[0].next; NULL != segment; segment = segment->next)
+        {
+            memcpy(output + length, segment->data, segment->length);
+            length += segment->length;
+        }
+        flatBuffer.pData = output;
+        flatBuffer.dataLenInBytes = length;
+        bufferList.numBuffers = 1;
+        bufferList.pBuffers = &flatBuffer;
+        opDescInit(&opDesc, testData);
+        stat = verifyOutput(algoDesc->completeOp(&opDesc, &bufferList, digest), testData);
+    }
+
+    engineStop();
+    while (0 < numSegments)
+    {
+        numSegments--;
+        memFreeContig((void *)&segments[numSegments].data);
+    }
+    memFreeOs((void *)&output);
+
+    return stat;
+}
+
+/*
+ * Verify a burst of uplink PDUs in the device: each PDU carries its MAC-I, every odd one with a flipped bit.
+ * The completions come back as a pass/fail bitmap, which has to be exactly the even PDUs.
+ */
+static CpaStatus execVerify(const TestData *testData, Cpa32U burstSize)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const AlgoDesc *algoDesc = getAlgoDesc(testData);
+    PdcpDesc descs[VERIFY_MAX_BURST_SIZE];
+    PdcpDesc swapDesc = {0};
+    Cpa64U passBitmap[VERIFY_MAX_BURST_SIZE / 64];
+    Cpa64U expectedBitmap = 0;
+    EnginePort *port = NULL;
+    Cpa8U *region = NULL;
+    Cpa32U slotSize = 0;
+    Cpa32U length = 0;
+    Cpa32U sessionId = 0;
+    Cpa32U numSubmitted = 0;
+    Cpa32U numCompleted = 0;
+    Cpa32U descIdx = 0;
+    Cpa32U wordIdx = 0;
+
+    if (NULL == algoDesc || CPA_CY_SYM_OP_HASH != algoDesc->op)
+    {
+        PRINT_ERR("MAC-I verification needs a NIA algorithm\n");
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    if (0 == burstSize || VERIFY_MAX_BURST_SIZE < burstSize)
+    {
+        PRINT_ERR("Burst size must be between 1 and %u\n", VERIFY_MAX_BURST_SIZE);
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    stat = engineStart();
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+
+    /*
+     * One slot per PDU: headroom for the IV prefix, then the message and its MAC-I
+     */
+    length = testData->inSize - algoDesc->msgIvPrefixLen + testData->outSize;
+    slotSize = (ENGINE_OP_HEADROOM + length + BYTE_ALIGNMENT - 1) & ~(BYTE_ALIGNMENT - 1);
+    stat = memAllocContig((void *)&region, burstSize * slotSize, BYTE_ALIGNMENT);
+    CHECK_ERR_STATUS("memAllocContig", stat);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        port = engineOpenPort(region, burstSize * slotSize, NULL, NULL);
+        stat = (NULL == port) ? CPA_STATUS_RESOURCE : CPA_STATUS_SUCCESS;
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = engineCreateSession(algoDesc->name,
+                                   testData->key,
+                                   testData->keySize,
+                                   testData->bearer,
+                                   testData->dir,
+                                   testData->outSize,
+                                   CPA_TRUE,
+                                   ENGINE_CLASS_BULK,
+                                   NULL,
+                                   &sessionId);
+        CHECK_ERR_STATUS("engineCreateSession", stat);
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        memset(descs, 0, sizeof(descs));
+        for (descIdx = 0; descIdx < burstSize; descIdx++)
+        {
+            descs[descIdx].userTag = descIdx;
+            descs[descIdx].sessionId = sessionId;
+            descs[descIdx].count = testData->count;
+            descs[descIdx].fresh = testData->fresh;
+            descs[descIdx].offset = descIdx * slotSize + ENGINE_OP_HEADROOM;
+            descs[descIdx].length = length;
+            memcpy(region + descs[descIdx].offset,
+                   testData->in + algoDesc->msgIvPrefixLen,
+                   testData->inSize - algoDesc->msgIvPrefixLen);
+            memcpy(region + descs[descIdx].offset + length - testData->outSize, testData->out, testData->outSize);
+            if (1 == descIdx % 2)
+            {
+                region[descs[descIdx].offset + length - 1] ^= 0x01;
+            }
+        }
+
+        while (numSubmitted < burstSize)
+        {
+            numSubmitted += engineSubmitBurst(port, descs + numSubmitted, burstSize - numSubmitted);
+            enginePoll();
+        }
+        while (numCompleted < burstSize)
+        {
+            numCompleted += enginePollBurst(port, descs + numCompleted, burstSize - numCompleted, NULL);
+        }
+        engineRetireSession(sessionId, NULL);
+
+        /* Completions may come back out of order, put them back in submission order for the bitmap */
+        for (descIdx = 0; descIdx < burstSize; descIdx++)
+        {
+            while (descs[descIdx].userTag != descIdx)
+            {
+                swapDesc = descs[descIdx];
+                descs[descIdx] = descs[swapDesc.userTag];
+                descs[swapDesc.userTag] = swapDesc;
+            }
+        }
+        ringPassBitmap(descs, burstSize, passBitmap);
+
+        for (wordIdx = 0; wordIdx < (burstSize + 63) / 64; wordIdx++)
+        {
+            expectedBitmap = 0x5555555555555555ULL;
+            if (burstSize - wordIdx * 64 < 64)
+            {
+                expectedBitmap &= (1ULL << (burstSize - wordIdx * 64)) - 1;
+            }
+            PRINT("Pass bitmap [%u..%u]: 0x%016llx\n",
+                  wordIdx * 64,
+                  (burstSize - wordIdx * 64 < 64) ? burstSize - 1 : wordIdx * 64 + 63,
+                  (unsigned long long)passBitmap[wordIdx]);
+            if (expectedBitmap != passBitmap[wordIdx])
+            {
+                stat = CPA_STATUS_FAIL;
+            }
+        }
+        if (CPA_STATUS_SUCCESS == stat)
+        {
+            PRINT_COLOR(ANSI_COLOR_GREEN, "Genuine PDUs passed, forged PDUs rejected\n");
+        }
+        else
+        {
+            PRINT_COLOR(ANSI_COLOR_RED, "Verification results do not match the forged PDUs\n");
+        }
+    }
+
+    if (NULL != port)
+    {
+        engineClosePort(port);
+    }
+    engineStop();
+    memFreeContig((void *)&region);
+
+    return stat;
 }
 
 static void symCallback(void *callbackTag,
@@ -35,17 +751,156 @@ static void symCallback(void *callbackTag,
                         CpaBoolean verifyResult)
 {
     PRINT_DBG("Callback called with status = %d.\n", status);
-    *(int *)callbackTag = 1;
+    *(Cpa8U *)callbackTag = (CPA_STATUS_SUCCESS == status) ? 1 : 2;
 }
 
 int main(int argc, const char **argv)
 {
     TestData testData = {0};
+    const AlgoDesc *algoDesc = NULL;
     int testSetId = 0;
     CpaStatus stat;
     char *processName = NULL;
+    const char *cmd = argv[0];
+    const char *socketPath = DAEMON_DEFAULT_SOCKET;
+    CpaBoolean remote = CPA_FALSE;
+    Cpa32U streamChunkSize = 0;
+    Cpa32U chainSegmentSize = 0;
+    Cpa32U verifyBurstSize = 0;
+
+    logInit();
+    if (argc >= 3 && 0 == strcmp(argv[1], "--trace-decode"))
+    {
+        return (int)traceDecode(argv[2], (argc > 3) ? argv[3] : "text");
+    }
+    if (NULL != getenv("PDCP_TRACE") && CPA_STATUS_SUCCESS == traceStart(getenv("PDCP_TRACE")))
+    {
+        atexit(traceStop);
+    }
+    if (NULL != getenv("PDCP_PMU") && CPA_STATUS_SUCCESS == pmuStart((Cpa32U)atoi(getenv("PDCP_PMU"))))
+    {
+        atexit(pmuStop);
+    }
 
-    gDebugParam = 1;
+    if (argc >= 2 && 0 == strcmp(argv[1], "--daemon"))
+    {
+        return (int)runDaemon((argc > 2) ? argv[2] : DAEMON_DEFAULT_SOCKET,
+                              (argc > 3) ? (Cpa32U)atoi(argv[3]) : 0);
+    }
+    else if (argc >= 2 && 0 == strcmp(argv[1], "--health"))
+    {
+        return (int)printHealth((argc > 2) ? argv[2] : DAEMON_DEFAULT_SOCKET);
+    }
+    else if (argc >= 2 && 0 == strcmp(argv[1], "--isolation"))
+    {
+        return (int)checkIsolation((argc > 2) ? argv[2] : DAEMON_DEFAULT_SOCKET);
+    }
+    else if (argc >= 3 && 0 == strcmp(argv[1], "--workers"))
+    {
+        return (int)runWorkers(argv[2],
+                               (argc > 3) ? (Cpa32U)atoi(argv[3]) : 0,
+                               (argc > 4) ? (Cpa32U)atoi(argv[4]) : WORKER_BENCH_PDU_SIZE,
+                               (argc > 5) ? (Cpa32U)atoi(argv[5]) : WORKER_BENCH_SECONDS);
+    }
+    else if (argc >= 3 && 0 == strcmp(argv[1], "--steal"))
+    {
+        return (int)runWorkerSteal(argv[2],
+                                   (argc > 3) ? (Cpa32U)atoi(argv[3]) : 0,
+                                   (argc > 4) ? (Cpa32U)atoi(argv[4]) : WORKER_BENCH_SKEW,
+                                   (argc > 5) ? (Cpa32U)atoi(argv[5]) : WORKER_BENCH_SECONDS);
+    }
+    else if (argc >= 3 && 0 == strcmp(argv[1], "--qos"))
+    {
+        return (int)runWorkerQos(argv[2], (argc > 3) ? (Cpa32U)atoi(argv[3]) : WORKER_BENCH_SECONDS);
+    }
+    else if (argc >= 3 && 0 == strcmp(argv[1], "--batching"))
+    {
+        return (int)runWorkerBatching(argv[2],
+                                      (argc > 3) ? (Cpa32U)atoi(argv[3]) : BATCH_DEFAULT_TARGET_US,
+                                      (argc > 4) ? (Cpa32U)atoi(argv[4]) : WORKER_BENCH_SECONDS);
+    }
+    else if (argc >= 2 && 0 == strcmp(argv[1], "--kdf"))
+    {
+        return (int)runKdfBench((argc > 2) ? (Cpa32U)atoi(argv[2]) : KDF_BENCH_UES);
+    }
+    else if (argc >= 3 && 0 == strcmp(argv[1], "--failover"))
+    {
+        return (int)runWorkerFailover(argv[2], (argc > 3) ? (Cpa32U)atoi(argv[3]) : WORKER_BENCH_SECONDS);
+    }
+    else if (argc >= 3 && 0 == strcmp(argv[1], "--churn"))
+    {
+        return (int)runWorkerChurn(argv[2],
+                                   (argc > 3) ? (Cpa32U)atoi(argv[3]) : WORKER_CHURN_RATE,
+                                   (argc > 4) ? (Cpa32U)atoi(argv[4]) : WORKER_BENCH_SECONDS);
+    }
+    else if (argc >= 3 && 0 == strcmp(argv[1], "--idle"))
+    {
+        return (int)runWorkerIdle(argv[2],
+                                  (argc > 3) ? (Cpa32U)atoi(argv[3]) : WORKER_IDLE_RATE,
+                                  (argc > 4) ? (Cpa32U)atoi(argv[4]) : WORKER_BENCH_SECONDS);
+    }
+    else if (argc >= 3 && 0 == strcmp(argv[1], "--reorder"))
+    {
+        return (int)runWorkerReorder(argv[2],
+                                     (argc > 3) ? (Cpa32U)atoi(argv[3]) : 0,
+                                     (argc > 4) ? (Cpa32U)atoi(argv[4]) : WORKER_BENCH_SECONDS);
+    }
+    else if (argc >= 2 && 0 == strcmp(argv[1], "--compare"))
+    {
+        return (int)runPerfCompare((argc > 2) ? argv[2] : NULL);
+    }
+    else if (argc >= 2 && 0 == strcmp(argv[1], "--perf"))
+    {
+        return (int)runPerfSuite((argc > 2) ? argv[2] : PERF_DEFAULT_RESULTS, (argc > 3) ? argv[3] : NULL);
+    }
+    else if (argc >= 3 && 0 == strcmp(argv[1], "--perf-baseline"))
+    {
+        return (int)runPerfBaseline(argv[2]);
+    }
+    else if (argc >= 4 && 0 == strcmp(argv[1], "--remote"))
+    {
+        remote = CPA_TRUE;
+        if (argc == 5)
+        {
+            socketPath = argv[4];
+            argc--;
+        }
+        argv++;
+        argc--;
+    }
+    else if (argc >= 4 && 0 == strcmp(argv[1], "--chain"))
+    {
+        chainSegmentSize = CHAIN_DEFAULT_SEGMENT_SIZE;
+        if (argc == 5)
+        {
+            chainSegmentSize = (Cpa32U)atoi(argv[4]);
+            argc--;
+        }
+        argv++;
+        argc--;
+    }
+    else if (argc >= 4 && 0 == strcmp(argv[1], "--verify"))
+    {
+        verifyBurstSize = VERIFY_DEFAULT_BURST_SIZE;
+        if (argc == 5)
+        {
+            verifyBurstSize = (Cpa32U)atoi(argv[4]);
+            argc--;
+        }
+        argv++;
+        argc--;
+    }
+    else if (argc >= 4 && 0 == strcmp(argv[1], "--stream"))
+    {
+        streamChunkSize = STREAM_DEFAULT_CHUNK_SIZE;
+        if (argc == 5)
+        {
+            streamChunkSize = (Cpa32U)atoi(argv[4]);
+            argc--;
+        }
+        argv++;
+        argc--;
+    }
 
     if (argc == 1)
     {
@@ -53,13 +908,13 @@ int main(int argc, const char **argv)
     }
     else if (argc == 2 && (0 == strcmp(argv[1], "-h") || 0 == strcmp(argv[1], "--help")))
     {
-        usage(argv[0]);
+        usage(cmd);
         exit(0);
     }
     else if (argc != 3)
     {
         PRINT("Invalid arguments\n");
-        usage(argv[0]);
+        usage(cmd);
         exit(1);
     }
     else
@@ -68,39 +923,17 @@ int main(int argc, const char **argv)
         if (testSetId > 5 || testSetId < 1)
         {
             PRINT("Invalid test set ID\n");
-            usage(argv[0]);
+            usage(cmd);
             exit(1);
         }
-        if (0 == strcmp(argv[1], "nea1"))
-        {
-            stat = genNea1TestData(testSetId, &testData);
-        }
-        else if (0 == strcmp(argv[1], "nea2"))
-        {
-            stat = genNea2TestData(testSetId, &testData);
-        }
-        else if (0 == strcmp(argv[1], "nea3"))
-        {
-            stat = genNea3TestData(testSetId, &testData);
-        }
-        else if (0 == strcmp(argv[1], "nia1"))
-        {
-            stat = genNia1TestData(testSetId, &testData);
-        }
-        else if (0 == strcmp(argv[1], "nia2"))
-        {
-            stat = genNia2TestData(testSetId, &testData);
-        }
-        else if (0 == strcmp(argv[1], "nia3"))
-        {
-            stat = genNia3TestData(testSetId, &testData);
-        }
-        else
+        algoDesc = findAlgoDesc(argv[1]);
+        if (NULL == algoDesc || NULL == algoDesc->genTestData)
         {
             PRINT("Unknow security algorithm\n");
-            usage(argv[0]);
+            usage(cmd);
             exit(1);
         }
+        stat = algoDesc->genTestData(testSetId, &testData);
     }
     if (CPA_STATUS_SUCCESS != stat)
     {
@@ -108,6 +941,20 @@ int main(int argc, const char **argv)
         exit(1);
     }
 
+    if (CPA_TRUE == remote)
+    {
+        stat = execRemote(socketPath, &testData);
+        freeTestData(&testData);
+        return (int)stat;
+    }
+    else if (0 < chainSegmentSize || 0 < verifyBurstSize)
+    {
+        /* The engine owns the memory driver and the endpoint */
+        stat = (0 < chainSegmentSize) ? execChain(&testData, chainSegmentSize) : execVerify(&testData, verifyBurstSize);
+        freeTestData(&testData);
+        return (int)stat;
+    }
+
     /*
      * Initialize memory driver usdm_drv for user space
      */
@@ -133,7 +980,14 @@ int main(int argc, const char **argv)
         return stat;
     }
 
-    stat = execQat(testData);
+    if (0 < streamChunkSize)
+    {
+        stat = execStream(&testData, streamChunkSize);
+    }
+    else
+    {
+        stat = execQat(&testData);
+    }
 
     /*
      * Close user space access to the QAT endpoint and memory driver
@@ -143,20 +997,21 @@ int main(int argc, const char **argv)
     qaeMemDestroy();
 
     freeTestData(&testData);
+    arenaDestroy();
 
     return (int)stat;
 }
 
-CpaStatus execQat(TestData testData)
+CpaStatus execQat(const TestData *testData)
 {
     CpaStatus stat = CPA_STATUS_SUCCESS;
     Cpa16U numInstances = 0;
     CpaInstanceHandle cyInstHandles[MAX_INSTANCES];
     CpaInstanceHandle cyInstHandle = NULL;
+    const AlgoDesc *algoDesc = NULL;
 
     /* Session Context Variables */
     CpaCySymSessionSetupData sessionSetupData = {0};
-    Cpa32U sessionCtxSize = 0;
     CpaCySymSessionCtx sessionCtx = NULL;
 
     Cpa32U numBuffers = 1;
@@ -168,14 +1023,27 @@ CpaStatus execQat(TestData testData)
     CpaFlatBuffer *flatBuffer = NULL;
     Cpa8U *ivBuffer = NULL;
     Cpa8U *digestBuffer = NULL;
-    CpaCySymOpData *opData = NULL;
+    OpDesc opDesc;
+    CpaCySymOpData opData = {0};
     Cpa8U *dstBuffer = NULL;
 
     Cpa8U callbackTag = 0;
-    Cpa32U byteLen = 0;
-    CpaBoolean sessionInUse = CPA_FALSE;
     CpaCySymStats64 symStats = {0};
-    Cpa32U listIdx = 0;
+    CpaBoolean submitted = CPA_FALSE;
+    CpaBoolean timedOut = CPA_FALSE;
+    Cpa32U pollMs = 0;
+    SwSession swSession;
+    CpaBoolean verifyResult = CPA_FALSE;
+
+    /*
+     * Pick the op path of the algorithm once, all ops below go through it
+     */
+    algoDesc = getAlgoDesc(testData);
+    if (NULL == algoDesc)
+    {
+        PRINT_ERR("No op path for the algorithm of the test data\n");
+        return CPA_STATUS_UNSUPPORTED;
+    }
 
     /*
      * Discover cryptographic service instance and check capabilities
@@ -215,8 +1083,9 @@ CpaStatus execQat(TestData testData)
      */
     if (CPA_STATUS_SUCCESS == stat)
     {
-        /* Fetch the first instance */
-        cyInstHandle = cyInstHandles[0];
+        /* Use an instance on our node and stay on its cores, buffers below are then allocated on that node */
+        cyInstHandle = getLocalInstance(cyInstHandles, numInstances);
+        bindThreadToInstance(cyInstHandle);
         PRINT_DBG("cpaCyStartInstance()\n");
         stat = cpaCyStartInstance(cyInstHandle);
         CHECK_ERR_STATUS("cpaCyStartInstance", stat);
@@ -243,56 +1112,12 @@ CpaStatus execQat(TestData testData)
     if (CPA_STATUS_SUCCESS == stat)
     {
         sessionSetupData.sessionPriority = CPA_CY_PRIORITY_NORMAL;
-        sessionSetupData.symOperation = testData.op;
-        if (CPA_CY_SYM_OP_CIPHER == testData.op)
-        {
-            sessionSetupData.cipherSetupData.cipherAlgorithm = testData.cipherAlgo;
-            sessionSetupData.cipherSetupData.pCipherKey = testData.key;
-            sessionSetupData.cipherSetupData.cipherKeyLenInBytes = testData.keySize;
-            sessionSetupData.cipherSetupData.cipherDirection = getCipherDirection(testData);
-        }
-        else if (CPA_CY_SYM_OP_HASH == testData.op)
-        {
-            sessionSetupData.hashSetupData.hashAlgorithm = testData.hashAlgo;
-            sessionSetupData.hashSetupData.hashMode = testData.hashMode;
-            sessionSetupData.hashSetupData.digestResultLenInBytes = testData.outSize;
-            sessionSetupData.hashSetupData.authModeSetupData.authKey = testData.key;
-            sessionSetupData.hashSetupData.authModeSetupData.authKeyLenInBytes = testData.keySize;
-            if (CPA_CY_SYM_HASH_SNOW3G_UIA2 == testData.hashAlgo || CPA_CY_SYM_HASH_ZUC_EIA3 == testData.hashAlgo)
-            {
-                sessionSetupData.hashSetupData.authModeSetupData.aadLenInBytes = testData.ivSize;
-            }
-            sessionSetupData.digestIsAppended = CPA_FALSE;
-            sessionSetupData.verifyDigest = CPA_FALSE;
-        }
+        algoDesc->setupSession(testData, &sessionSetupData);
 
-        PRINT_DBG("Key: ");
-        for (listIdx = 0; listIdx < testData.keySize; listIdx++)
-        {
-            PRINT("%02x ", testData.key[listIdx]);
-        }
-        PRINT("\n");
+        PRINT_DUMP("Key: ", testData->key, testData->keySize);
 
-        PRINT_DBG("cpaCySymSessionCtxGetSize()\n");
-        stat = cpaCySymSessionCtxGetSize(cyInstHandle, &sessionSetupData, &sessionCtxSize);
-        CHECK_ERR_STATUS("cpaCySymSessionCtxGetSize", stat);
-    }
-
-    if (CPA_STATUS_SUCCESS == stat)
-    {
-        stat = memAllocContig((void *)&sessionCtx, sessionCtxSize, BYTE_ALIGNMENT);
-        CHECK_ERR_STATUS("memAllocContig", stat);
-    }
-
-    if (CPA_STATUS_SUCCESS == stat)
-    {
-        PRINT_DBG("cpaCySymInitSession()\n");
-        stat = cpaCySymInitSession(cyInstHandle,
-                                   symCallback,
-                                   // NULL,
-                                   &sessionSetupData,
-                                   sessionCtx);
-        CHECK_ERR_STATUS("cpaCySymInitSession", stat);
+        stat = createSession(cyInstHandle, symCallback, &sessionSetupData, &sessionCtx);
+        CHECK_ERR_STATUS("createSession", stat);
     }
 
     /*
@@ -302,7 +1127,7 @@ CpaStatus execQat(TestData testData)
     {
         stat = createBuffers(cyInstHandle,
                              numBuffers,
-                             testData.inSize,
+                             &testData->inSize,
                              &srcBufferList,
                              &dstBufferList,
                              inPlaceOp);
@@ -311,71 +1136,46 @@ CpaStatus execQat(TestData testData)
 
     if (CPA_STATUS_SUCCESS == stat)
     {
-        stat = memAllocContig((void *)&ivBuffer, testData.ivSize, BYTE_ALIGNMENT);
+        stat = memAllocContig((void *)&ivBuffer, testData->ivSize, BYTE_ALIGNMENT);
         CHECK_ERR_STATUS("memAllocContig", stat);
     }
 
-    if (CPA_STATUS_SUCCESS == stat && CPA_CY_SYM_OP_HASH == testData.op)
+    if (CPA_STATUS_SUCCESS == stat && CPA_CY_SYM_OP_HASH == algoDesc->op)
     {
-        stat = memAllocContig((void *)&digestBuffer, testData.outSize, BYTE_ALIGNMENT);
+        stat = memAllocContig((void *)&digestBuffer, testData->outSize, BYTE_ALIGNMENT);
         CHECK_ERR_STATUS("memAllocContig", stat);
     }
 
-    if (CPA_STATUS_SUCCESS == stat)
-    {
-        stat = memAllocOs((void *)&opData, sizeof(CpaCySymOpData));
-        CHECK_ERR_STATUS("memAllocOs", stat);
-    }
-
     if (CPA_STATUS_SUCCESS == stat)
     {
         flatBuffer = (CpaFlatBuffer *)(srcBufferList + 1);
 
-        memcpy(flatBuffer->pData, testData.in, testData.inSize);
-        memcpy(ivBuffer, testData.iv, testData.ivSize);
+        memcpy(flatBuffer->pData, testData->in, testData->inSize);
+        memcpy(ivBuffer, testData->iv, testData->ivSize);
 
-        opData->sessionCtx = sessionCtx;
-        opData->packetType = CPA_CY_SYM_PACKET_TYPE_FULL;
-        if (CPA_CY_SYM_OP_CIPHER == testData.op)
-        {
-            opData->pIv = ivBuffer;
-            opData->ivLenInBytes = testData.ivSize;
-            opData->cryptoStartSrcOffsetInBytes = 0;
+        opDescInit(&opDesc, testData);
+        algoDesc->fillOpData(&opDesc, sessionCtx, ivBuffer, digestBuffer, &opData);
 
-            PRINT_DBG("IV: ");
-            for (listIdx = 0; listIdx < opData->ivLenInBytes; listIdx++)
-            {
-                PRINT("%02x ", opData->pIv[listIdx]);
-            }
-            PRINT("\n");
-            opData->messageLenToCipherInBytes = testData.inSize;
+        if (NULL != opData.pIv)
+        {
+            PRINT_DUMP("IV: ", opData.pIv, opData.ivLenInBytes);
         }
-        else if (CPA_CY_SYM_OP_HASH == testData.op)
+        if (NULL != opData.pAdditionalAuthData)
         {
-            opData->hashStartSrcOffsetInBytes = 0;
-            opData->pDigestResult = digestBuffer;
-            if (CPA_CY_SYM_HASH_SNOW3G_UIA2 == testData.hashAlgo || CPA_CY_SYM_HASH_ZUC_EIA3 == testData.hashAlgo)
-            {
-                opData->pAdditionalAuthData = ivBuffer;
-
-                PRINT_DBG("AAD: ");
-                for (listIdx = 0; listIdx < sessionSetupData.hashSetupData.authModeSetupData.aadLenInBytes; listIdx++)
-                {
-                    PRINT("%02x ", opData->pAdditionalAuthData[listIdx]);
-                }
-                PRINT("\n");
-            }
-            opData->messageLenToHashInBytes = testData.inSize;
+            PRINT_DUMP("AAD: ",
+                       opData.pAdditionalAuthData,
+                       sessionSetupData.hashSetupData.authModeSetupData.aadLenInBytes);
         }
 
         PRINT_DBG("cpaCySymPerformOp()\n");
         stat = cpaCySymPerformOp(cyInstHandle,
                                  (void *)&callbackTag,
-                                 opData,
+                                 &opData,
                                  srcBufferList,
                                  dstBufferList,
                                  NULL);
         CHECK_ERR_STATUS("cpaCySymPerformOp", stat);
+        submitted = CPA_TRUE;
     }
 
     // sleep(1);
@@ -387,99 +1187,51 @@ CpaStatus execQat(TestData testData)
     {
         do
         {
-            stat = icp_sal_CyPollInstance(cyInstHandle, 0);
+            stat = pollInstance(cyInstHandle);
             OS_SLEEP(10);
+            pollMs += 10;
         } while ((CPA_STATUS_SUCCESS == stat || CPA_STATUS_RETRY == stat) &&
-                callbackTag == 0);
+                callbackTag == 0 && EXEC_POLL_TIMEOUT_MS > pollMs);
         PRINT_DBG("callbackTag: %d\n", callbackTag);
+        timedOut = (0 == callbackTag && EXEC_POLL_TIMEOUT_MS <= pollMs) ? CPA_TRUE : CPA_FALSE;
     }
 
     /*
-     * Verify the result
+     * The accelerator failed the op, refused it or never answered: compute it on the CPU from the test data
      */
-    if (CPA_STATUS_SUCCESS == stat)
+    if (CPA_TRUE == submitted && (CPA_STATUS_SUCCESS != stat || 1 != callbackTag))
     {
-        if (CPA_CY_SYM_OP_CIPHER == testData.op)
-        {
-            flatBuffer = (CpaFlatBuffer *)(dstBufferList + 1);
-            dstBuffer = flatBuffer->pData;
-            byteLen = testData.bitLen / 8;
-            for (listIdx = byteLen + 1; listIdx < testData.outSize; listIdx++)
-            {
-                dstBuffer[listIdx] = 0x0;
-            }
-            if ((testData.bitLen & 0x7) != 0)
-            {
-                dstBuffer[byteLen] = dstBuffer[byteLen] & (0xff << (8 - (testData.bitLen % 8)));
-            }
-            if (0 == memcmp(dstBuffer, testData.out, testData.outSize))
-            {
-                PRINT_COLOR(ANSI_COLOR_GREEN, "Output matches expected output!\n");
-            }
-            else
-            {
-                PRINT_COLOR(ANSI_COLOR_RED, "Output does not match expected output\n");
-                for (listIdx = 0; listIdx < testData.outSize; listIdx++)
-                {
-                    if (0 == memcmp(dstBuffer + listIdx, testData.out + listIdx, 1))
-                    {
-                        PRINT("%02x ", dstBuffer[listIdx]);
-                    }
-                    else
-                    {
-                        PRINT_COLOR(ANSI_COLOR_RED, "%02x ", dstBuffer[listIdx]);
-                    }
-                    if (listIdx % 8 == 7)
-                    {
-                        PRINT("\n");
-                    }
-                }
-                PRINT("\n");
-                stat = CPA_STATUS_FAIL;
-            }
-        }
-        else if (CPA_CY_SYM_OP_HASH == testData.op)
+        PRINT_ERR("The op failed on the accelerator, computing it on the CPU\n");
+        memcpy(flatBuffer->pData, testData->in, testData->inSize);
+        stat = swInitSession(&swSession, &sessionSetupData);
+        if (CPA_STATUS_SUCCESS == stat)
         {
-            if (0 == memcmp(digestBuffer, testData.out, testData.outSize))
-            {
-                PRINT_COLOR(ANSI_COLOR_GREEN, "Output matches expected output!\n");
-            }
-            else
-            {
-                PRINT_COLOR(ANSI_COLOR_RED, "Output does not match expected output\n");
-                for (listIdx = 0; listIdx < testData.outSize; listIdx++)
-                {
-                    if (0 == memcmp(digestBuffer + listIdx, testData.out + listIdx, 1))
-                    {
-                        PRINT("%02x ", digestBuffer[listIdx]);
-                    }
-                    else
-                    {
-                        PRINT_COLOR(ANSI_COLOR_RED, "%02x ", digestBuffer[listIdx]);
-                    }
-                    if (listIdx % 8 == 7)
-                    {
-                        PRINT("\n");
-                    }
-                }
-                PRINT("\n");
-                stat = CPA_STATUS_FAIL;
-            }
+            stat = swProcessBufferList(&swSession, &sessionSetupData, &opData, srcBufferList, &verifyResult);
         }
+        CHECK_ERR_STATUS("swProcessBufferList", stat);
+    }
+
+    /*
+     * Verify the result
+     */
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        dstBuffer = algoDesc->completeOp(&opDesc, dstBufferList, digestBuffer);
+        stat = verifyOutput(dstBuffer, testData);
     }
 
     /*
-     * Tear down the session
+     * Tear down the session. Retirement never blocks; the session is removed by the poller once its outstanding
+     * requests have completed, and the instance is drained before it is stopped.
      */
     if (NULL != sessionCtx)
     {
-        PRINT_DBG("Wait for the completion of outstanding request\n");
-        do
-        {
-            cpaCySymSessionInUse(sessionCtx, &sessionInUse);
-        } while (sessionInUse);
-        PRINT_DBG("cpaCySymRemoveSession()\n");
-        cpaCySymRemoveSession(cyInstHandle, sessionCtx);
+        retireSession(cyInstHandle, sessionCtx);
+        sessionCtx = NULL;
+    }
+    if (NULL != cyInstHandle && CPA_TRUE != timedOut)
+    {
+        drainRetiredSessions(cyInstHandle);
     }
 
     /*
@@ -500,14 +1252,16 @@ CpaStatus execQat(TestData testData)
         cpaCyStopInstance(cyInstHandle);
     }
 
-    freeBuffers(numBuffers,
-                &srcBufferList,
-                &dstBufferList,
-                inPlaceOp);
-    memFreeOs((void *)&opData);
-    memFreeContig((void *)&ivBuffer);
-
-    memFreeContig((void *)&sessionCtx);
+    /* A request that never came back may still be written by the device, its buffers are left alone */
+    if (CPA_TRUE != timedOut)
+    {
+        freeBuffers(numBuffers,
+                    &srcBufferList,
+                    &dstBufferList,
+                    inPlaceOp);
+        memFreeContig((void *)&ivBuffer);
+        memFreeContig((void *)&digestBuffer);
+    }
 
     return stat;
 }
@@ -544,10 +1298,10 @@ CpaStatus checkCyInstanceCapabilities(void)
 }
 
 CpaStatus createBuffers(CpaInstanceHandle cyInstHandle,
-                        /* Assume source and destination buffer lists have equal number of buffers, and all flat
-                         * buffers have the same size */
+                        /* Source and destination buffer lists have equal number of buffers, flat buffer i of
+                         * either list holds bufferSizes[i] bytes */
                         Cpa32U numBuffers,
-                        Cpa32U bufferSize,
+                        const Cpa32U *bufferSizes,
                         CpaBufferList **srcBufferList,
                         CpaBufferList **dstBufferList,
                         CpaBoolean inPlaceOp)
@@ -619,7 +1373,7 @@ CpaStatus createBuffers(CpaInstanceHandle cyInstHandle,
     {
         if (CPA_STATUS_SUCCESS == stat)
         {
-            stat = memAllocContig((void *)&srcBuffer, bufferSize, BYTE_ALIGNMENT);
+            stat = memAllocContig((void *)&srcBuffer, bufferSizes[listIdx], BYTE_ALIGNMENT);
             CHECK_ERR_STATUS("memAllocContig", stat);
         }
 
@@ -628,13 +1382,13 @@ CpaStatus createBuffers(CpaInstanceHandle cyInstHandle,
             flatBuffer = (CpaFlatBuffer *)(*srcBufferList + 1);
             flatBuffer = flatBuffer + listIdx;
 
-            flatBuffer->dataLenInBytes = bufferSize;
+            flatBuffer->dataLenInBytes = bufferSizes[listIdx];
             flatBuffer->pData = srcBuffer;
         }
 
         if (CPA_STATUS_SUCCESS == stat && CPA_TRUE != inPlaceOp)
         {
-            stat = memAllocContig((void *)&dstBuffer, bufferSize, BYTE_ALIGNMENT);
+            stat = memAllocContig((void *)&dstBuffer, bufferSizes[listIdx], BYTE_ALIGNMENT);
             CHECK_ERR_STATUS("memAllocContig", stat);
         }
 
@@ -643,7 +1397,7 @@ CpaStatus createBuffers(CpaInstanceHandle cyInstHandle,
             flatBuffer = (CpaFlatBuffer *)(*dstBufferList + 1);
             flatBuffer = flatBuffer + listIdx;
 
-            flatBuffer->dataLenInBytes = bufferSize;
+            flatBuffer->dataLenInBytes = bufferSizes[listIdx];
             flatBuffer->pData = dstBuffer;
         }
 
@@ -695,6 +1449,44 @@ void freeBuffers(Cpa32U numBuffers,
     }
 }
 
+Cpa32U chainLength(const PktBuf *chain)
+{
+    Cpa32U length = 0;
+
+    for (; NULL != chain; chain = chain->next)
+    {
+        length += chain->length;
+    }
+    return length;
+}
+
+/*
+ * Describe a chained packet from byte offset on as flat buffers pointing into its segments, so that leading
+ * headers are skipped without copying. Returns the number of flat buffers used, 0 when the chain has fewer
+ * than offset bytes or more segments than maxBuffers.
+ */
+Cpa32U fillChainBuffers(const PktBuf *chain, Cpa32U offset, CpaFlatBuffer *flatBuffers, Cpa32U maxBuffers)
+{
+    Cpa32U numBuffers = 0;
+
+    for (; NULL != chain && offset >= chain->length; chain = chain->next)
+    {
+        offset -= chain->length;
+    }
+    for (; NULL != chain; chain = chain->next)
+    {
+        if (maxBuffers == numBuffers)
+        {
+            return 0;
+        }
+        flatBuffers[numBuffers].pData = chain->data + offset;
+        flatBuffers[numBuffers].dataLenInBytes = chain->length - offset;
+        numBuffers++;
+        offset = 0;
+    }
+    return numBuffers;
+}
+
 void freeInstanceMapping(void)
 {
     if (NULL != inst_g)
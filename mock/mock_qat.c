@@ -0,0 +1,704 @@
+/*
+ * Mock QAT backend.
+ *
+ * Stands in for libqat and libusdm_drv when the code is built with `make BACKEND=mock`, so that the engine and
+ * the daemon run on hosts without a QAT device; only the QAT headers are needed. Like on the device, requests
+ * are queued on submission and completed from icp_sal_CyPollInstance() through the session callback. The mock
+ * does not transform payloads: cipher output equals the input and digests are all zero, so a verifying session
+ * accepts exactly the PDUs whose appended MAC-I is zero. Each instance has a ring per session priority, and
+ * polling serves the high priority ring first.
+ *
+ * Built with `make BACKEND=sw` (MOCK_SW_CRYPTO) the mock runs every request through the software algorithms in
+ * sw/ instead, which makes it a functional CPU engine. Partial packets are then supported on the AES algorithms,
+ * with the state carried between partials as on the device.
+ *
+ * MOCK_QAT_INSTANCES sets the number of crypto instances (default 2), MOCK_QAT_NODES the number of NUMA nodes
+ * they are spread over (default 1).
+ *
+ * As on an instance configured for epoll mode, icp_sal_CyGetFileDescriptor() gives an eventfd that is readable
+ * while responses wait to be polled. The mock completes requests when polled, so the eventfd is signalled on
+ * submission and cleared by the poll that empties the rings. MOCK_QAT_EVENTS=0 makes instances polled only.
+ *
+ * MOCK_QAT_FAULT injects faults, as a comma separated list of KIND:INSTANCE:AFTER:MS. The fault goes off once
+ * the instance took AFTER requests and lasts MS milliseconds, 0 for good. KIND is one of
+ *     start   cpaCyStartInstance() fails (AFTER is ignored)
+ *     submit  cpaCySymPerformOp() fails
+ *     error   requests complete with CPA_STATUS_FAIL
+ *     poll    polling fails and completes nothing
+ *     wedge   requests are taken but not completed until the fault is over
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cpa.h"
+#include "cpa_cy_common.h"
+#include "cpa_cy_im.h"
+#include "cpa_cy_sym.h"
+#include "icp_sal_poll.h"
+#include "icp_sal_user.h"
+#include "qae_mem.h"
+
+#ifdef MOCK_SW_CRYPTO
+#include "sw_crypto.h"
+#endif
+
+#define MOCK_MAX_INSTANCES 32
+#define MOCK_DEFAULT_INSTANCES 2
+#define MOCK_RING_SIZE 512
+#define MOCK_META_SIZE 64
+#define MOCK_NUM_PRIORITIES 2 /* ring 0 for high priority sessions, 1 for normal ones */
+
+enum
+{
+    MOCK_FAULT_NONE = 0,
+    MOCK_FAULT_START,
+    MOCK_FAULT_SUBMIT,
+    MOCK_FAULT_ERROR,
+    MOCK_FAULT_POLL,
+    MOCK_FAULT_WEDGE,
+};
+
+typedef struct _MockSession {
+    CpaCySymCbFunc symCallback;
+    CpaCySymSessionSetupData setupData;
+    Cpa32U numInflight;
+#ifdef MOCK_SW_CRYPTO
+    SwSession sw;
+#endif
+} MockSession;
+
+typedef struct _MockRequest {
+    MockSession *session;
+    void *callbackTag;
+    const CpaCySymOpData *opData;
+    CpaBufferList *dstBuffer;
+} MockRequest;
+
+typedef struct _MockFault {
+    Cpa32U kind;
+    Cpa64U afterRequests;
+    Cpa64U durationNs; /* 0 for good */
+    Cpa64U sinceNs; /* when it went off, 0 before */
+} MockFault;
+
+typedef struct _MockInstance {
+    pthread_mutex_t lock;
+    MockFault fault;
+    MockRequest ring[MOCK_NUM_PRIORITIES][MOCK_RING_SIZE];
+    Cpa32U head[MOCK_NUM_PRIORITIES];
+    Cpa32U tail[MOCK_NUM_PRIORITIES];
+    CpaBoolean started;
+    int eventFd; /* -1 until asked for */
+    CpaBoolean eventSignaled; /* eventFd readable */
+    CpaCySymStats64 stats;
+} MockInstance;
+
+int gDebugParam = 1;
+
+static MockInstance instances_g[MOCK_MAX_INSTANCES];
+static Cpa16U numInstances_g = 0;
+
+void sampleSleep(Cpa32U ms)
+{
+    usleep(ms * 1000);
+}
+
+/*
+ *******************
+ * Memory driver
+ *******************
+ */
+int32_t qaeMemInit(void)
+{
+    return CPA_STATUS_SUCCESS;
+}
+
+void qaeMemDestroy(void)
+{
+}
+
+void *qaeMemAlloc(size_t memsize)
+{
+    return malloc(memsize);
+}
+
+void qaeMemFree(void **ptr)
+{
+    free(*ptr);
+    *ptr = NULL;
+}
+
+void *qaeMemAllocNUMA(size_t size, int node, size_t phys_alignment_byte)
+{
+    void *ptr = NULL;
+
+    if (0 != posix_memalign(&ptr, phys_alignment_byte, size))
+    {
+        return NULL;
+    }
+    return ptr;
+}
+
+void qaeMemFreeNUMA(void **ptr)
+{
+    free(*ptr);
+    *ptr = NULL;
+}
+
+uint64_t qaeVirtToPhysNUMA(void *pVirtAddr)
+{
+    return (uint64_t)(uintptr_t)pVirtAddr;
+}
+
+/*
+ *******************
+ * Fault injection
+ *******************
+ */
+static Cpa64U nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Cpa64U)ts.tv_sec * 1000000000ULL + (Cpa64U)ts.tv_nsec;
+}
+
+static void parseFaults(void)
+{
+    static const char *kindNames[] = {"", "start", "submit", "error", "poll", "wedge"};
+    const char *env = getenv("MOCK_QAT_FAULT");
+    char spec[256];
+    char kind[16];
+    char *entry = NULL;
+    char *save = NULL;
+    unsigned int instIdx = 0;
+    unsigned long long after = 0;
+    unsigned long long ms = 0;
+    Cpa32U kindIdx = 0;
+
+    if (NULL == env)
+    {
+        return;
+    }
+    strncpy(spec, env, sizeof(spec) - 1);
+    spec[sizeof(spec) - 1] = '\0';
+    for (entry = strtok_r(spec, ",", &save); NULL != entry; entry = strtok_r(NULL, ",", &save))
+    {
+        if (4 != sscanf(entry, "%15[a-z]:%u:%llu:%llu", kind, &instIdx, &after, &ms) || instIdx >= numInstances_g)
+        {
+            fprintf(stderr, "Ignoring mock fault '%s', KIND:INSTANCE:AFTER:MS\n", entry);
+            continue;
+        }
+        for (kindIdx = MOCK_FAULT_START; kindIdx <= MOCK_FAULT_WEDGE; kindIdx++)
+        {
+            if (0 == strcmp(kind, kindNames[kindIdx]))
+            {
+                instances_g[instIdx].fault.kind = kindIdx;
+                instances_g[instIdx].fault.afterRequests = (MOCK_FAULT_START == kindIdx) ? 0 : after;
+                instances_g[instIdx].fault.durationNs = ms * 1000000ULL;
+                instances_g[instIdx].fault.sinceNs = (MOCK_FAULT_START == kindIdx) ? nowNs() : 0;
+            }
+        }
+    }
+}
+
+/*
+ * Whether a fault of that kind is on for the instance, under the lock of the instance
+ */
+static CpaBoolean isFaulty(MockInstance *instance, Cpa32U kind)
+{
+    MockFault *fault = &instance->fault;
+    Cpa64U now = 0;
+
+    if (kind != fault->kind)
+    {
+        return CPA_FALSE;
+    }
+    now = nowNs();
+    if (0 == fault->sinceNs)
+    {
+        if (instance->stats.numSymOpRequests < fault->afterRequests)
+        {
+            return CPA_FALSE;
+        }
+        fault->sinceNs = now;
+    }
+    return (0 == fault->durationNs || now - fault->sinceNs < fault->durationNs) ? CPA_TRUE : CPA_FALSE;
+}
+
+/* Under the lock of the instance */
+static CpaBoolean hasRequests(const MockInstance *instance)
+{
+    Cpa32U prio = 0;
+
+    for (prio = 0; prio < MOCK_NUM_PRIORITIES; prio++)
+    {
+        if (instance->head[prio] != instance->tail[prio])
+        {
+            return CPA_TRUE;
+        }
+    }
+    return CPA_FALSE;
+}
+
+/* Responses wait to be polled, under the lock of the instance. Only the first request of a busy period writes. */
+static void signalEvent(MockInstance *instance)
+{
+    if (0 <= instance->eventFd && CPA_TRUE != instance->eventSignaled)
+    {
+        eventfd_write(instance->eventFd, 1);
+        instance->eventSignaled = CPA_TRUE;
+    }
+}
+
+/*
+ *******************
+ * Instances
+ *******************
+ */
+CpaStatus icp_sal_userStart(const char *pProcessName)
+{
+    const char *env = getenv("MOCK_QAT_INSTANCES");
+    Cpa16U instIdx = 0;
+
+    numInstances_g = MOCK_DEFAULT_INSTANCES;
+    if (NULL != env && 0 < atoi(env))
+    {
+        numInstances_g = (Cpa16U)atoi(env);
+    }
+    if (numInstances_g > MOCK_MAX_INSTANCES)
+    {
+        numInstances_g = MOCK_MAX_INSTANCES;
+    }
+    for (instIdx = 0; instIdx < numInstances_g; instIdx++)
+    {
+        memset(&instances_g[instIdx], 0, sizeof(MockInstance));
+        pthread_mutex_init(&instances_g[instIdx].lock, NULL);
+        instances_g[instIdx].eventFd = -1;
+    }
+    parseFaults();
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus icp_sal_userStartMultiProcess(const char *pProcessName, CpaBoolean limitDevAccess)
+{
+    return icp_sal_userStart(pProcessName);
+}
+
+CpaStatus icp_sal_userStop(void)
+{
+    Cpa16U instIdx = 0;
+
+    for (instIdx = 0; instIdx < numInstances_g; instIdx++)
+    {
+        if (0 <= instances_g[instIdx].eventFd)
+        {
+            close(instances_g[instIdx].eventFd);
+            instances_g[instIdx].eventFd = -1;
+        }
+    }
+    numInstances_g = 0;
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus cpaCyGetNumInstances(Cpa16U *pNumInstances)
+{
+    *pNumInstances = numInstances_g;
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus cpaCyGetInstances(Cpa16U numInstances, CpaInstanceHandle *cyInstances)
+{
+    Cpa16U instIdx = 0;
+
+    if (numInstances > numInstances_g)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    for (instIdx = 0; instIdx < numInstances; instIdx++)
+    {
+        cyInstances[instIdx] = &instances_g[instIdx];
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ * MOCK_QAT_NODES spreads the instances over that many nodes, each node owning every n-th core
+ */
+CpaStatus cpaCyInstanceGetInfo2(const CpaInstanceHandle instanceHandle, CpaInstanceInfo2 *pInstanceInfo2)
+{
+    const char *env = getenv("MOCK_QAT_NODES");
+    Cpa32U numNodes = (NULL != env && 0 < atoi(env)) ? (Cpa32U)atoi(env) : 1;
+    long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+    long core = 0;
+
+    memset(pInstanceInfo2, 0, sizeof(CpaInstanceInfo2));
+    pInstanceInfo2->accelerationServiceType = CPA_ACC_SVC_TYPE_CRYPTO;
+    pInstanceInfo2->nodeAffinity = ((MockInstance *)instanceHandle - instances_g) % numNodes;
+    pInstanceInfo2->operState = CPA_OPER_STATE_UP;
+    pInstanceInfo2->isPolled = CPA_TRUE;
+    for (core = 0; core < numCores && core < CPA_MAX_CORES; core++)
+    {
+        if (pInstanceInfo2->nodeAffinity == core % numNodes)
+        {
+            CPA_BITMAP_BIT_SET(pInstanceInfo2->coreAffinity, core);
+        }
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus cpaCyQueryCapabilities(const CpaInstanceHandle instanceHandle, CpaCyCapabilitiesInfo *pCapInfo)
+{
+    memset(pCapInfo, 0, sizeof(CpaCyCapabilitiesInfo));
+    pCapInfo->symSupported = CPA_TRUE;
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus cpaCySymQueryCapabilities(const CpaInstanceHandle instanceHandle, CpaCySymCapabilitiesInfo *pCapInfo)
+{
+    memset(pCapInfo, 0xff, sizeof(CpaCySymCapabilitiesInfo));
+    pCapInfo->partialPacketSupported = CPA_TRUE;
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus cpaCyStartInstance(CpaInstanceHandle instanceHandle)
+{
+    MockInstance *instance = (MockInstance *)instanceHandle;
+    CpaStatus status = CPA_STATUS_SUCCESS;
+
+    pthread_mutex_lock(&instance->lock);
+    if (CPA_TRUE == isFaulty(instance, MOCK_FAULT_START))
+    {
+        status = CPA_STATUS_FAIL;
+    }
+    else
+    {
+        instance->started = CPA_TRUE;
+    }
+    pthread_mutex_unlock(&instance->lock);
+    return status;
+}
+
+CpaStatus cpaCyStopInstance(CpaInstanceHandle instanceHandle)
+{
+    ((MockInstance *)instanceHandle)->started = CPA_FALSE;
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus cpaCySetAddressTranslation(const CpaInstanceHandle instanceHandle, CpaVirtualToPhysical virtual2Physical)
+{
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus cpaCyBufferListGetMetaSize(const CpaInstanceHandle instanceHandle, Cpa32U numBuffers, Cpa32U *pSizeInBytes)
+{
+    *pSizeInBytes = MOCK_META_SIZE;
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ *******************
+ * Symmetric crypto
+ *******************
+ */
+CpaStatus cpaCySymSessionCtxGetSize(const CpaInstanceHandle instanceHandle,
+                                    const CpaCySymSessionSetupData *pSessionSetupData,
+                                    Cpa32U *pSessionCtxSizeInBytes)
+{
+    *pSessionCtxSizeInBytes = sizeof(MockSession);
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus cpaCySymInitSession(const CpaInstanceHandle instanceHandle,
+                              const CpaCySymCbFunc pSymCb,
+                              const CpaCySymSessionSetupData *pSessionSetupData,
+                              CpaCySymSessionCtx sessionCtx)
+{
+    MockSession *session = (MockSession *)sessionCtx;
+    MockInstance *instance = (MockInstance *)instanceHandle;
+
+    memset(session, 0, sizeof(MockSession));
+#ifdef MOCK_SW_CRYPTO
+    if (CPA_STATUS_SUCCESS != swInitSession(&session->sw, pSessionSetupData))
+    {
+        return CPA_STATUS_UNSUPPORTED;
+    }
+#endif
+    session->symCallback = pSymCb;
+    session->setupData = *pSessionSetupData;
+    /* Keys are not kept past session init, as on the device */
+    session->setupData.cipherSetupData.pCipherKey = NULL;
+    session->setupData.hashSetupData.authModeSetupData.authKey = NULL;
+    instance->stats.numSessionsInitialized++;
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus cpaCySymRemoveSession(const CpaInstanceHandle instanceHandle, CpaCySymSessionCtx pSessionCtx)
+{
+    MockSession *session = (MockSession *)pSessionCtx;
+    MockInstance *instance = (MockInstance *)instanceHandle;
+
+    if (0 < __atomic_load_n(&session->numInflight, __ATOMIC_ACQUIRE))
+    {
+        return CPA_STATUS_RETRY;
+    }
+    instance->stats.numSessionsRemoved++;
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus cpaCySymSessionInUse(CpaCySymSessionCtx sessionCtx, CpaBoolean *pSessionInUse)
+{
+    MockSession *session = (MockSession *)sessionCtx;
+
+    *pSessionInUse = (0 < __atomic_load_n(&session->numInflight, __ATOMIC_ACQUIRE)) ? CPA_TRUE : CPA_FALSE;
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus cpaCySymPerformOp(const CpaInstanceHandle instanceHandle,
+                            void *pCallbackTag,
+                            const CpaCySymOpData *pOpData,
+                            const CpaBufferList *pSrcBuffer,
+                            CpaBufferList *pDstBuffer,
+                            CpaBoolean *pVerifyResult)
+{
+    MockInstance *instance = (MockInstance *)instanceHandle;
+    MockSession *session = (MockSession *)pOpData->sessionCtx;
+    MockRequest *request = NULL;
+    Cpa32U prio = (CPA_CY_PRIORITY_HIGH == session->setupData.sessionPriority) ? 0 : 1;
+
+    if (CPA_TRUE != instance->started)
+    {
+        return CPA_STATUS_FAIL;
+    }
+
+    pthread_mutex_lock(&instance->lock);
+    if (CPA_TRUE == isFaulty(instance, MOCK_FAULT_SUBMIT))
+    {
+        pthread_mutex_unlock(&instance->lock);
+        return CPA_STATUS_FAIL;
+    }
+    if (MOCK_RING_SIZE == instance->tail[prio] - instance->head[prio])
+    {
+        pthread_mutex_unlock(&instance->lock);
+        return CPA_STATUS_RETRY;
+    }
+    request = &instance->ring[prio][instance->tail[prio] % MOCK_RING_SIZE];
+    request->session = session;
+    request->callbackTag = pCallbackTag;
+    request->opData = pOpData;
+    request->dstBuffer = pDstBuffer;
+    instance->tail[prio]++;
+    instance->stats.numSymOpRequests++;
+    __atomic_add_fetch(&session->numInflight, 1, __ATOMIC_RELEASE);
+    signalEvent(instance);
+    pthread_mutex_unlock(&instance->lock);
+
+    /* Out of place requests still see their input in the output */
+    if (pSrcBuffer != pDstBuffer && NULL != pDstBuffer)
+    {
+        Cpa32U bufferIdx = 0;
+        for (bufferIdx = 0; bufferIdx < pSrcBuffer->numBuffers && bufferIdx < pDstBuffer->numBuffers; bufferIdx++)
+        {
+            memcpy(pDstBuffer->pBuffers[bufferIdx].pData,
+                   pSrcBuffer->pBuffers[bufferIdx].pData,
+                   pSrcBuffer->pBuffers[bufferIdx].dataLenInBytes);
+        }
+    }
+
+    return CPA_STATUS_SUCCESS;
+}
+
+#ifndef MOCK_SW_CRYPTO
+/*
+ * Clear length bytes at offset of a buffer list, or check them; returns CPA_TRUE when they are all zero
+ */
+static CpaBoolean accessListBytes(CpaBufferList *bufferList, Cpa32U offset, Cpa32U length, CpaBoolean clear)
+{
+    CpaBoolean isZero = CPA_TRUE;
+    Cpa32U bufferIdx = 0;
+    Cpa32U byteIdx = 0;
+
+    for (bufferIdx = 0; bufferIdx < bufferList->numBuffers && 0 < length; bufferIdx++)
+    {
+        for (byteIdx = offset; byteIdx < bufferList->pBuffers[bufferIdx].dataLenInBytes && 0 < length; byteIdx++)
+        {
+            if (CPA_TRUE == clear)
+            {
+                bufferList->pBuffers[bufferIdx].pData[byteIdx] = 0;
+            }
+            else if (0 != bufferList->pBuffers[bufferIdx].pData[byteIdx])
+            {
+                isZero = CPA_FALSE;
+            }
+            length--;
+        }
+        offset = (offset > bufferList->pBuffers[bufferIdx].dataLenInBytes)
+                     ? offset - bufferList->pBuffers[bufferIdx].dataLenInBytes
+                     : 0;
+    }
+    return isZero;
+}
+
+/*
+ * Payloads pass through unchanged, the digest is all zero
+ */
+static CpaStatus mockCompleteRequest(MockSession *session,
+                                     const CpaCySymOpData *opData,
+                                     CpaBufferList *bufferList,
+                                     CpaBoolean *pVerifyResult)
+{
+    Cpa32U digestOffset = 0;
+
+    *pVerifyResult = CPA_TRUE;
+    if (CPA_CY_SYM_OP_HASH == session->setupData.symOperation && CPA_TRUE == session->setupData.digestIsAppended)
+    {
+        /* The digest goes right after the hashed region, or is checked there */
+        digestOffset = opData->hashStartSrcOffsetInBytes + opData->messageLenToHashInBytes;
+        *pVerifyResult = accessListBytes(bufferList,
+                                         digestOffset,
+                                         session->setupData.hashSetupData.digestResultLenInBytes,
+                                         (CPA_TRUE == session->setupData.verifyDigest) ? CPA_FALSE : CPA_TRUE);
+    }
+    else if (CPA_CY_SYM_OP_HASH == session->setupData.symOperation && NULL != opData->pDigestResult)
+    {
+        memset(opData->pDigestResult, 0, session->setupData.hashSetupData.digestResultLenInBytes);
+    }
+    return CPA_STATUS_SUCCESS;
+}
+#endif
+
+CpaStatus icp_sal_CyPollInstance(CpaInstanceHandle instanceHandle, Cpa32U response_quota)
+{
+    MockInstance *instance = (MockInstance *)instanceHandle;
+    MockRequest requests[MOCK_NUM_PRIORITIES * MOCK_RING_SIZE];
+    MockSession *session = NULL;
+    const CpaCySymOpData *opData = NULL;
+    CpaBoolean verifyResult = CPA_TRUE;
+    CpaBoolean failRequests = CPA_FALSE;
+    CpaStatus status = CPA_STATUS_SUCCESS;
+    eventfd_t eventCount = 0;
+    Cpa32U numRequests = 0;
+    Cpa32U reqIdx = 0;
+    Cpa32U prio = 0;
+
+    pthread_mutex_lock(&instance->lock);
+    if (CPA_TRUE == isFaulty(instance, MOCK_FAULT_POLL) || CPA_TRUE == isFaulty(instance, MOCK_FAULT_WEDGE))
+    {
+        status = (MOCK_FAULT_POLL == instance->fault.kind) ? CPA_STATUS_FAIL : CPA_STATUS_RETRY;
+        pthread_mutex_unlock(&instance->lock);
+        return status;
+    }
+    failRequests = isFaulty(instance, MOCK_FAULT_ERROR);
+    for (prio = 0; prio < MOCK_NUM_PRIORITIES; prio++)
+    {
+        while (instance->head[prio] != instance->tail[prio] && (0 == response_quota || numRequests < response_quota))
+        {
+            requests[numRequests++] = instance->ring[prio][instance->head[prio] % MOCK_RING_SIZE];
+            instance->head[prio]++;
+        }
+    }
+    if (CPA_TRUE == instance->eventSignaled && CPA_TRUE != hasRequests(instance))
+    {
+        eventfd_read(instance->eventFd, &eventCount);
+        instance->eventSignaled = CPA_FALSE;
+    }
+    pthread_mutex_unlock(&instance->lock);
+
+    if (0 == numRequests)
+    {
+        return CPA_STATUS_RETRY;
+    }
+
+    for (reqIdx = 0; reqIdx < numRequests; reqIdx++)
+    {
+        session = requests[reqIdx].session;
+        opData = requests[reqIdx].opData;
+        if (CPA_TRUE == failRequests)
+        {
+            status = CPA_STATUS_FAIL;
+        }
+        else
+        {
+#ifdef MOCK_SW_CRYPTO
+            status = swProcessBufferList(
+                &session->sw, &session->setupData, opData, requests[reqIdx].dstBuffer, &verifyResult);
+#else
+            status = mockCompleteRequest(session, opData, requests[reqIdx].dstBuffer, &verifyResult);
+#endif
+        }
+        __atomic_add_fetch(&instance->stats.numSymOpCompleted, 1, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&session->numInflight, 1, __ATOMIC_RELEASE);
+        session->symCallback(requests[reqIdx].callbackTag,
+                             (CPA_STATUS_SUCCESS == status) ? CPA_STATUS_SUCCESS : CPA_STATUS_FAIL,
+                             session->setupData.symOperation,
+                             (void *)requests[reqIdx].opData,
+                             requests[reqIdx].dstBuffer,
+                             verifyResult);
+    }
+
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ *******************
+ * Event mode
+ *******************
+ */
+CpaStatus icp_sal_CyGetFileDescriptor(CpaInstanceHandle instanceHandle, int *fd)
+{
+    MockInstance *instance = (MockInstance *)instanceHandle;
+    const char *env = getenv("MOCK_QAT_EVENTS");
+    CpaStatus status = CPA_STATUS_SUCCESS;
+
+    if (NULL != env && 0 == atoi(env))
+    {
+        return CPA_STATUS_UNSUPPORTED;
+    }
+
+    pthread_mutex_lock(&instance->lock);
+    if (0 > instance->eventFd)
+    {
+        instance->eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (0 <= instance->eventFd && CPA_TRUE == hasRequests(instance))
+        {
+            signalEvent(instance);
+        }
+    }
+    if (0 > instance->eventFd)
+    {
+        fprintf(stderr, "Mock eventfd: %s\n", strerror(errno));
+        status = CPA_STATUS_RESOURCE;
+    }
+    *fd = instance->eventFd;
+    pthread_mutex_unlock(&instance->lock);
+    return status;
+}
+
+CpaStatus icp_sal_CyPutFileDescriptor(CpaInstanceHandle instanceHandle, int fd)
+{
+    MockInstance *instance = (MockInstance *)instanceHandle;
+
+    pthread_mutex_lock(&instance->lock);
+    if (fd == instance->eventFd)
+    {
+        close(instance->eventFd);
+        instance->eventFd = -1;
+        instance->eventSignaled = CPA_FALSE;
+    }
+    pthread_mutex_unlock(&instance->lock);
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus cpaCySymQueryStats64(const CpaInstanceHandle instanceHandle, CpaCySymStats64 *pSymStats)
+{
+    *pSymStats = ((MockInstance *)instanceHandle)->stats;
+    return CPA_STATUS_SUCCESS;
+}
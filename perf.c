@@ -0,0 +1,1074 @@
+/*
+ * Performance suite.
+ *
+ * Sweeps every NEA/NIA algorithm over PDU sizes from 40 bytes to 9 KB and over several in-flight depths
+ * through the engine burst API, on whatever backend the binary was built for. Each point keeps depth PDUs in
+ * flight for PERF_POINT_MS, and at least PERF_MIN_OPS ops, after a short warm-up and reports throughput, op rate
+ * and the median and 99th percentile submit-to-completion latency.
+ *
+ * Every point is the best of PERF_REPEATS runs. Results are written as JSON, one point per line, together with
+ * the tolerances they are to be judged by, so a results file can be checked in as the baseline of later runs.
+ * Against a baseline, a point regresses when its throughput or op rate drops, or its latency grows, by more
+ * than the tolerance of that metric; such a point is measured up to PERF_MAX_RETRIES more times first. A point
+ * the baseline has no entry for fails as well, the baseline is to be recorded again.
+ *
+ * A baseline is recorded from PERF_BASELINE_SWEEPS sweeps, each point the median of its sweeps. Where a sweep
+ * falls short of that median by more than the built-in tolerance of a metric, the tolerance the baseline is
+ * written with grows to match, so that the gate is as tight as the host the baseline comes from allows and no
+ * tighter: on a quiet host the built-in tolerances stay, on a noisy one the baseline says how much noise it
+ * makes room for.
+ *
+ * runPerfCompare() answers when offload pays off: for every PDU size it puts the engine, at depth 1 and at full
+ * depth, next to the same PDUs processed one by one on the software engine and on OpenSSL EVP (evp.c), each
+ * path first checked on the test vectors.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cpa.h"
+
+#include "algo.h"
+#include "engine.h"
+#include "evp.h"
+#include "perf.h"
+#include "sw_crypto.h"
+#include "utils.h"
+
+#define PERF_MAX_POINTS 256
+#define PERF_MAX_TEST_SETS 8
+#define PERF_MAX_VECTOR_SIZE 4096
+
+/* How the PDUs of a point are processed */
+enum
+{
+    PERF_PATH_ENGINE = 0, /* through the engine burst API, on the backend of the binary */
+    PERF_PATH_SW, /* one after the other on the software engine in sw/ */
+    PERF_PATH_EVP, /* one after the other on OpenSSL EVP */
+};
+
+static const Cpa32U perfPduSizes_g[] = {40, 128, 512, 1500, 4096, 9216};
+static const Cpa32U perfDepths_g[] = {1, 16, PERF_MAX_DEPTH};
+
+#define PERF_NUM_PDU_SIZES (sizeof(perfPduSizes_g) / sizeof(perfPduSizes_g[0]))
+#define PERF_NUM_DEPTHS (sizeof(perfDepths_g) / sizeof(perfDepths_g[0]))
+#define PERF_SLOT_SIZE ((ENGINE_OP_HEADROOM + ENGINE_MAX_PDU_SIZE + BYTE_ALIGNMENT - 1) & ~(BYTE_ALIGNMENT - 1))
+
+static double nowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static int compareSamples(const void *a, const void *b)
+{
+    double diff = *(const double *)a - *(const double *)b;
+
+    return (diff < 0) ? -1 : (diff > 0) ? 1 : 0;
+}
+
+static void fillResult(PerfResult *result,
+                       const AlgoDesc *algoDesc,
+                       Cpa32U pduSize,
+                       Cpa32U depth,
+                       Cpa64U numOps,
+                       double elapsedUs,
+                       double *samples,
+                       Cpa32U numSamples)
+{
+    qsort(samples, numSamples, sizeof(double), compareSamples);
+    memset(result, 0, sizeof(PerfResult));
+    strncpy(result->algo, algoDesc->name, sizeof(result->algo) - 1);
+    result->pduSize = pduSize;
+    result->depth = depth;
+    result->kops = (double)numOps * 1000.0 / elapsedUs;
+    result->mbps = (double)numOps * pduSize * 8 / elapsedUs;
+    result->p50Us = samples[numSamples / 2];
+    result->p99Us = samples[(Cpa32U)(numSamples * 0.99)];
+}
+
+/*
+ * Keep depth PDUs of pduSize bytes in flight on a fresh session and measure the completions within the window
+ */
+static CpaStatus runPoint(const AlgoDesc *algoDesc,
+                          Cpa32U pduSize,
+                          Cpa32U depth,
+                          EnginePort *port,
+                          double *samples,
+                          PerfResult *result)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    PdcpDesc descs[PERF_MAX_DEPTH];
+    PdcpDesc cpls[PERF_MAX_DEPTH];
+    double submitTimes[PERF_MAX_DEPTH];
+    Cpa32U freeSlots[PERF_MAX_DEPTH];
+    Cpa8U key[PERF_MAX_KEY_SIZE];
+    Cpa32U numFree = 0;
+    Cpa32U numDescs = 0;
+    Cpa32U numSubmitted = 0;
+    Cpa32U numCompleted = 0;
+    Cpa32U numSamples = 0;
+    Cpa32U sessionId = 0;
+    Cpa32U count = 0;
+    Cpa32U slot = 0;
+    Cpa32U descIdx = 0;
+    Cpa64U numOps = 0;
+    Cpa64U numErrors = 0;
+    double measureStart = 0;
+    double measureEnd = 0;
+    double lastCompletion = 0;
+    double now = 0;
+
+    for (descIdx = 0; descIdx < PERF_MAX_KEY_SIZE; descIdx++)
+    {
+        key[descIdx] = (Cpa8U)(0x2b + 7 * descIdx);
+    }
+    stat = engineCreateSession(algoDesc->name,
+                               key,
+                               algoDesc->keySize,
+                               1,
+                               0,
+                               (CPA_CY_SYM_OP_HASH == algoDesc->op) ? PERF_DIGEST_SIZE : 0,
+                               CPA_FALSE,
+                               ENGINE_CLASS_BULK,
+                               NULL,
+                               &sessionId);
+    CHECK_ERR_STATUS("engineCreateSession", stat);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+
+    for (slot = 0; slot < depth; slot++)
+    {
+        freeSlots[numFree++] = slot;
+    }
+    measureStart = nowUs() + PERF_WARMUP_MS * 1000.0;
+    measureEnd = measureStart + PERF_POINT_MS * 1000.0;
+
+    /* Slow points run past the window until enough ops completed */
+    for (now = nowUs(); now < measureEnd || PERF_MIN_OPS > numOps || numFree < depth; now = nowUs())
+    {
+        if ((now < measureEnd || PERF_MIN_OPS > numOps) && 0 < numFree)
+        {
+            for (numDescs = 0; 0 < numFree; numDescs++)
+            {
+                slot = freeSlots[--numFree];
+                memset(&descs[numDescs], 0, sizeof(PdcpDesc));
+                descs[numDescs].userTag = slot;
+                descs[numDescs].sessionId = sessionId;
+                descs[numDescs].count = count++;
+                descs[numDescs].offset = slot * PERF_SLOT_SIZE + ENGINE_OP_HEADROOM;
+                descs[numDescs].length = pduSize;
+                submitTimes[slot] = now;
+            }
+            numSubmitted = engineSubmitBurst(port, descs, numDescs);
+            for (descIdx = numSubmitted; descIdx < numDescs; descIdx++)
+            {
+                freeSlots[numFree++] = (Cpa32U)descs[descIdx].userTag;
+            }
+        }
+
+        numCompleted = enginePollBurst(port, cpls, PERF_MAX_DEPTH, NULL);
+        now = (0 < numCompleted) ? nowUs() : now;
+        for (descIdx = 0; descIdx < numCompleted; descIdx++)
+        {
+            slot = (Cpa32U)cpls[descIdx].userTag;
+            if (CPA_STATUS_SUCCESS != cpls[descIdx].status)
+            {
+                numErrors++;
+            }
+            else if (now >= measureStart)
+            {
+                numOps++;
+                lastCompletion = now;
+                if (numSamples < PERF_MAX_SAMPLES)
+                {
+                    samples[numSamples++] = now - submitTimes[slot];
+                }
+            }
+            freeSlots[numFree++] = slot;
+        }
+    }
+    engineRetireSession(sessionId, NULL);
+
+    if (0 < numErrors)
+    {
+        PRINT_ERR("%s, %u bytes, depth %u: %llu failed ops\n", algoDesc->name, pduSize, depth, (unsigned long long)numErrors);
+        return CPA_STATUS_FAIL;
+    }
+
+    fillResult(result, algoDesc, pduSize, depth, numOps, lastCompletion - measureStart, samples, numSamples);
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ * Session of the software engine or of OpenSSL on the key the engine points use
+ */
+static CpaStatus initCpuSession(const AlgoDesc *algoDesc,
+                                Cpa32U path,
+                                const TestData *params,
+                                SwSession *sw,
+                                EvpSession *evp)
+{
+    CpaCySymSessionSetupData setupData;
+
+    memset(&setupData, 0, sizeof(setupData));
+    algoDesc->setupSession(params, &setupData);
+    if (PERF_PATH_SW == path)
+    {
+        return swInitSession(sw, &setupData);
+    }
+    return evpInitSession(evp, &setupData);
+}
+
+static CpaStatus processCpu(Cpa32U path,
+                            SwSession *sw,
+                            EvpSession *evp,
+                            CpaCySymOpData *opData,
+                            Cpa8U *data,
+                            Cpa8U *digest)
+{
+    return (PERF_PATH_SW == path) ? swProcess(sw, opData, data, digest) : evpProcess(evp, opData, data, digest);
+}
+
+/*
+ * PDUs of pduSize bytes processed one after the other on the CPU, each prepared as the engine prepares an op:
+ * IV built from COUNT, BEARER and DIRECTION, the 128-NIA2 prefix in the headroom in front of the payload
+ */
+static CpaStatus runCpuPoint(const AlgoDesc *algoDesc,
+                             Cpa32U path,
+                             Cpa32U pduSize,
+                             Cpa8U *buffer,
+                             double *samples,
+                             PerfResult *result)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    CpaCySymOpData opData;
+    TestData params;
+    OpDesc opDesc;
+    SwSession sw;
+    EvpSession evp;
+    Cpa8U key[PERF_MAX_KEY_SIZE];
+    Cpa8U iv[MAX_IV_SIZE];
+    Cpa8U digest[ENGINE_MAX_DIGEST_SIZE];
+    Cpa8U *data = buffer + ENGINE_OP_HEADROOM - algoDesc->msgIvPrefixLen;
+    Cpa32U numSamples = 0;
+    Cpa32U keyIdx = 0;
+    Cpa64U numOps = 0;
+    double measureStart = 0;
+    double measureEnd = 0;
+    double lastCompletion = 0;
+    double now = 0;
+    double done = 0;
+
+    for (keyIdx = 0; keyIdx < PERF_MAX_KEY_SIZE; keyIdx++)
+    {
+        key[keyIdx] = (Cpa8U)(0x2b + 7 * keyIdx);
+    }
+    memset(&params, 0, sizeof(params));
+    params.op = algoDesc->op;
+    params.cipherAlgo = algoDesc->cipherAlgo;
+    params.hashAlgo = algoDesc->hashAlgo;
+    params.key = key;
+    params.keySize = algoDesc->keySize;
+    params.bearer = 1;
+    params.bitLen = pduSize * 8;
+    params.inSize = algoDesc->msgIvPrefixLen + pduSize;
+    params.outSize = (CPA_CY_SYM_OP_HASH == algoDesc->op) ? PERF_DIGEST_SIZE : pduSize;
+    stat = initCpuSession(algoDesc, path, &params, &sw, &evp);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+    opDescInit(&opDesc, &params);
+
+    measureStart = nowUs() + PERF_WARMUP_MS * 1000.0;
+    measureEnd = measureStart + PERF_POINT_MS * 1000.0;
+    for (now = nowUs(); CPA_STATUS_SUCCESS == stat && (now < measureEnd || PERF_MIN_OPS > numOps); now = done)
+    {
+        opDesc.count++;
+        opDesc.ivSize = (Cpa8U)buildIv(&opDesc, iv);
+        memcpy(data, iv, algoDesc->msgIvPrefixLen);
+        algoDesc->fillOpData(&opDesc, NULL, iv, digest, &opData);
+        stat = processCpu(path, &sw, &evp, &opData, data, digest);
+        done = nowUs();
+        if (now >= measureStart)
+        {
+            numOps++;
+            lastCompletion = done;
+            if (numSamples < PERF_MAX_SAMPLES)
+            {
+                samples[numSamples++] = done - now;
+            }
+        }
+    }
+    if (PERF_PATH_EVP == path)
+    {
+        evpFreeSession(&evp);
+    }
+
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        PRINT_ERR("%s, %u bytes on the CPU: failed op\n", algoDesc->name, pduSize);
+        return stat;
+    }
+    fillResult(result, algoDesc, pduSize, 1, numOps, lastCompletion - measureStart, samples, numSamples);
+    return CPA_STATUS_SUCCESS;
+}
+
+static const char *perfPathName(Cpa32U path)
+{
+    switch (path)
+    {
+        case PERF_PATH_ENGINE:
+            return "engine";
+        case PERF_PATH_SW:
+            return "sw";
+        default:
+            return "evp";
+    }
+}
+
+static CpaStatus writeResults(const char *path,
+                              const PerfResult *results,
+                              Cpa32U numResults,
+                              const PerfTolerance *tolerance)
+{
+    FILE *file = fopen(path, "w");
+    Cpa32U resultIdx = 0;
+
+    if (NULL == file)
+    {
+        PRINT_ERR("Cannot write %s\n", path);
+        return CPA_STATUS_FAIL;
+    }
+    fprintf(file, "{\n");
+    fprintf(file, "  \"backend\": \"%s\",\n", PDCP_BACKEND);
+    fprintf(file,
+            "  \"tolerance\": {\"mbps\": %.2f, \"kops\": %.2f, \"p50_us\": %.2f, \"p99_us\": %.2f},\n",
+            tolerance->mbps,
+            tolerance->kops,
+            tolerance->p50Us,
+            tolerance->p99Us);
+    fprintf(file, "  \"results\": [\n");
+    for (resultIdx = 0; resultIdx < numResults; resultIdx++)
+    {
+        fprintf(file,
+                "    {\"algo\": \"%s\", \"pdu\": %u, \"depth\": %u, \"mbps\": %.3f, \"kops\": %.3f, \"p50_us\": %.3f, "
+                "\"p99_us\": %.3f}%s\n",
+                results[resultIdx].algo,
+                results[resultIdx].pduSize,
+                results[resultIdx].depth,
+                results[resultIdx].mbps,
+                results[resultIdx].kops,
+                results[resultIdx].p50Us,
+                results[resultIdx].p99Us,
+                (resultIdx + 1 < numResults) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return CPA_STATUS_SUCCESS;
+}
+
+/* A tolerance wider than the built-in one comes from the noise measured when the baseline was recorded */
+static void takeTolerance(const char *path, const char *metric, double fileTolerance, double *tolerance)
+{
+    if (fileTolerance > *tolerance)
+    {
+        PRINT("%s widens the %s tolerance from %.0f%% to %.0f%% for the noise of the host it was recorded on\n",
+              path,
+              metric,
+              *tolerance * 100,
+              fileTolerance * 100);
+    }
+    *tolerance = fileTolerance;
+}
+
+/*
+ * Read back a file written by writeResults; the format is line based, one point per line
+ */
+static CpaStatus loadBaseline(const char *path, PerfResult *results, Cpa32U *numResults, PerfTolerance *tolerance)
+{
+    FILE *file = fopen(path, "r");
+    char line[512];
+    const char *field = NULL;
+    PerfResult *result = NULL;
+    PerfTolerance fileTolerance = *tolerance;
+
+    if (NULL == file)
+    {
+        return CPA_STATUS_FAIL;
+    }
+    *numResults = 0;
+    while (NULL != fgets(line, sizeof(line), file))
+    {
+        if (NULL != (field = strstr(line, "\"tolerance\":")))
+        {
+            sscanf(field,
+                   "\"tolerance\": {\"mbps\": %lf, \"kops\": %lf, \"p50_us\": %lf, \"p99_us\": %lf}",
+                   &fileTolerance.mbps,
+                   &fileTolerance.kops,
+                   &fileTolerance.p50Us,
+                   &fileTolerance.p99Us);
+        }
+        else if (NULL != (field = strstr(line, "{\"algo\":")) && PERF_MAX_POINTS > *numResults)
+        {
+            result = &results[*numResults];
+            memset(result, 0, sizeof(PerfResult));
+            if (7 == sscanf(field,
+                            "{\"algo\": \"%15[^\"]\", \"pdu\": %u, \"depth\": %u, \"mbps\": %lf, \"kops\": %lf, "
+                            "\"p50_us\": %lf, \"p99_us\": %lf}",
+                            result->algo,
+                            &result->pduSize,
+                            &result->depth,
+                            &result->mbps,
+                            &result->kops,
+                            &result->p50Us,
+                            &result->p99Us))
+            {
+                (*numResults)++;
+            }
+        }
+    }
+    fclose(file);
+
+    takeTolerance(path, "mbps", fileTolerance.mbps, &tolerance->mbps);
+    takeTolerance(path, "kops", fileTolerance.kops, &tolerance->kops);
+    takeTolerance(path, "p50_us", fileTolerance.p50Us, &tolerance->p50Us);
+    takeTolerance(path, "p99_us", fileTolerance.p99Us, &tolerance->p99Us);
+    return CPA_STATUS_SUCCESS;
+}
+
+static Cpa32U checkMetric(const PerfResult *result,
+                          const char *metric,
+                          double value,
+                          double baseline,
+                          double tolerance,
+                          CpaBoolean higherIsBetter,
+                          CpaBoolean report)
+{
+    CpaBoolean regressed = (CPA_TRUE == higherIsBetter) ? (value < baseline * (1.0 - tolerance))
+                                                        : (value > baseline * (1.0 + tolerance));
+
+    if (CPA_TRUE != regressed)
+    {
+        return 0;
+    }
+    if (CPA_TRUE == report)
+    {
+        PRINT_COLOR(ANSI_COLOR_RED,
+                    "Regression: %s, %u bytes, depth %u: %s %.3f, baseline %.3f (tolerance %.0f%%)\n",
+                    result->algo,
+                    result->pduSize,
+                    result->depth,
+                    metric,
+                    value,
+                    baseline,
+                    tolerance * 100);
+    }
+    return 1;
+}
+
+static Cpa32U checkResult(const PerfResult *result,
+                          const PerfResult *base,
+                          const PerfTolerance *tolerance,
+                          CpaBoolean report)
+{
+    Cpa32U numRegressions = 0;
+
+    numRegressions += checkMetric(result, "mbps", result->mbps, base->mbps, tolerance->mbps, CPA_TRUE, report);
+    numRegressions += checkMetric(result, "kops", result->kops, base->kops, tolerance->kops, CPA_TRUE, report);
+    numRegressions += checkMetric(result, "p50_us", result->p50Us, base->p50Us, tolerance->p50Us, CPA_FALSE, report);
+    numRegressions += checkMetric(result, "p99_us", result->p99Us, base->p99Us, tolerance->p99Us, CPA_FALSE, report);
+    return numRegressions;
+}
+
+static const PerfResult *findBaseline(const PerfResult *result, const PerfResult *baseline, Cpa32U numBaseline)
+{
+    Cpa32U baseIdx = 0;
+
+    for (baseIdx = 0; baseIdx < numBaseline; baseIdx++)
+    {
+        if (0 == strcmp(baseline[baseIdx].algo, result->algo) && baseline[baseIdx].pduSize == result->pduSize &&
+            baseline[baseIdx].depth == result->depth)
+        {
+            return &baseline[baseIdx];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Median of a metric over the sweeps of a point; the tolerance grows to the largest shortfall of a sweep
+ * against it, rounded up to the next percent
+ */
+static double mergeMetric(double *values, Cpa32U numValues, CpaBoolean higherIsBetter, double *tolerance)
+{
+    double median = 0;
+    double shortfall = 0;
+    Cpa32U valueIdx = 0;
+
+    qsort(values, numValues, sizeof(double), compareSamples);
+    median = values[numValues / 2];
+    for (valueIdx = 0; valueIdx < numValues && 0 < median; valueIdx++)
+    {
+        shortfall = (CPA_TRUE == higherIsBetter) ? 1.0 - values[valueIdx] / median : values[valueIdx] / median - 1.0;
+        if (shortfall > *tolerance)
+        {
+            *tolerance = (double)(Cpa32U)(shortfall * 100 + 1) / 100;
+        }
+    }
+    return median;
+}
+
+static void mergeSweeps(PerfResult (*sweeps)[PERF_MAX_POINTS],
+                        Cpa32U numSweeps,
+                        Cpa32U numResults,
+                        PerfResult *results,
+                        PerfTolerance *tolerance)
+{
+    double mbps[PERF_BASELINE_SWEEPS];
+    double kops[PERF_BASELINE_SWEEPS];
+    double p50Us[PERF_BASELINE_SWEEPS];
+    double p99Us[PERF_BASELINE_SWEEPS];
+    Cpa32U resultIdx = 0;
+    Cpa32U sweepIdx = 0;
+
+    for (resultIdx = 0; resultIdx < numResults; resultIdx++)
+    {
+        for (sweepIdx = 0; sweepIdx < numSweeps; sweepIdx++)
+        {
+            mbps[sweepIdx] = sweeps[sweepIdx][resultIdx].mbps;
+            kops[sweepIdx] = sweeps[sweepIdx][resultIdx].kops;
+            p50Us[sweepIdx] = sweeps[sweepIdx][resultIdx].p50Us;
+            p99Us[sweepIdx] = sweeps[sweepIdx][resultIdx].p99Us;
+        }
+        results[resultIdx] = sweeps[0][resultIdx];
+        results[resultIdx].mbps = mergeMetric(mbps, numSweeps, CPA_TRUE, &tolerance->mbps);
+        results[resultIdx].kops = mergeMetric(kops, numSweeps, CPA_TRUE, &tolerance->kops);
+        results[resultIdx].p50Us = mergeMetric(p50Us, numSweeps, CPA_FALSE, &tolerance->p50Us);
+        results[resultIdx].p99Us = mergeMetric(p99Us, numSweeps, CPA_FALSE, &tolerance->p99Us);
+    }
+}
+
+/*
+ * Best of PERF_REPEATS runs, metric by metric, which filters out most of the noise of a shared host
+ */
+static CpaStatus measurePoint(const AlgoDesc *algoDesc,
+                              Cpa32U path,
+                              Cpa32U pduSize,
+                              Cpa32U depth,
+                              EnginePort *port,
+                              double *samples,
+                              PerfResult *result,
+                              CpaBoolean merge)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    PerfResult run;
+    Cpa32U repeatIdx = 0;
+
+    for (repeatIdx = 0; repeatIdx < PERF_REPEATS && CPA_STATUS_SUCCESS == stat; repeatIdx++)
+    {
+        if (PERF_PATH_ENGINE == path)
+        {
+            stat = runPoint(algoDesc, pduSize, depth, port, samples, &run);
+        }
+        else
+        {
+            stat = runCpuPoint(algoDesc, path, pduSize, port->region, samples, &run);
+        }
+        if (CPA_STATUS_SUCCESS != stat)
+        {
+            break;
+        }
+        if (CPA_TRUE != merge && 0 == repeatIdx)
+        {
+            *result = run;
+            continue;
+        }
+        result->mbps = (run.mbps > result->mbps) ? run.mbps : result->mbps;
+        result->kops = (run.kops > result->kops) ? run.kops : result->kops;
+        result->p50Us = (run.p50Us < result->p50Us) ? run.p50Us : result->p50Us;
+        result->p99Us = (run.p99Us < result->p99Us) ? run.p99Us : result->p99Us;
+    }
+    return stat;
+}
+
+/*
+ * numSweeps sweeps of the suite merged into the results, a single one to be compared against baselinePath
+ */
+static CpaStatus runSuite(const char *resultsPath, const char *baselinePath, Cpa32U numSweeps)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    static PerfResult sweeps[PERF_BASELINE_SWEEPS][PERF_MAX_POINTS];
+    static PerfResult results[PERF_MAX_POINTS];
+    static PerfResult baseline[PERF_MAX_POINTS];
+    static const AlgoDesc *pointAlgos[PERF_MAX_POINTS];
+    PerfTolerance tolerance = {PERF_TOLERANCE_MBPS, PERF_TOLERANCE_KOPS, PERF_TOLERANCE_P50, PERF_TOLERANCE_P99};
+    const AlgoDesc *algoDescs = NULL;
+    const PerfResult *base = NULL;
+    EnginePort *port = NULL;
+    Cpa8U *region = NULL;
+    double *samples = NULL;
+    CpaBoolean haveBaseline = CPA_FALSE;
+    Cpa32U numAlgoDescs = 0;
+    Cpa32U numResults = 0;
+    Cpa32U numBaseline = 0;
+    Cpa32U numRegressions = 0;
+    Cpa32U numMissing = 0;
+    Cpa32U resultIdx = 0;
+    Cpa32U retryIdx = 0;
+    Cpa32U sweepIdx = 0;
+    Cpa32U algoIdx = 0;
+    Cpa32U sizeIdx = 0;
+    Cpa32U depthIdx = 0;
+
+    if (NULL != baselinePath && CPA_STATUS_SUCCESS == loadBaseline(baselinePath, baseline, &numBaseline, &tolerance))
+    {
+        haveBaseline = CPA_TRUE;
+    }
+    else if (NULL != baselinePath)
+    {
+        PRINT("No baseline at %s, results are not compared\n", baselinePath);
+    }
+
+    stat = engineStart();
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+    engineBindThread();
+
+    samples = malloc(PERF_MAX_SAMPLES * sizeof(double));
+    stat = (NULL == samples) ? CPA_STATUS_RESOURCE : CPA_STATUS_SUCCESS;
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = memAllocContig((void *)&region, PERF_MAX_DEPTH * PERF_SLOT_SIZE, BYTE_ALIGNMENT);
+        CHECK_ERR_STATUS("memAllocContig", stat);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        memset(region, 0x5a, PERF_MAX_DEPTH * PERF_SLOT_SIZE);
+        port = engineOpenPort(region, PERF_MAX_DEPTH * PERF_SLOT_SIZE, NULL, NULL);
+        stat = (NULL == port) ? CPA_STATUS_RESOURCE : CPA_STATUS_SUCCESS;
+    }
+
+    algoDescs = getAlgoDescs(&numAlgoDescs);
+    for (sweepIdx = 0; sweepIdx < numSweeps && CPA_STATUS_SUCCESS == stat; sweepIdx++)
+    {
+        if (1 < numSweeps)
+        {
+            PRINT("Sweep %u of %u\n", sweepIdx + 1, numSweeps);
+        }
+        numResults = 0;
+        for (algoIdx = 0; algoIdx < numAlgoDescs && CPA_STATUS_SUCCESS == stat; algoIdx++)
+        {
+            /* AES-CBC only serves the sample test data, experimental algorithms have no baseline to keep */
+            if (0 == strcmp(algoDescs[algoIdx].name, "sample") || CPA_TRUE == algoDescs[algoIdx].experimental)
+            {
+                continue;
+            }
+            for (sizeIdx = 0; sizeIdx < PERF_NUM_PDU_SIZES && CPA_STATUS_SUCCESS == stat; sizeIdx++)
+            {
+                for (depthIdx = 0; depthIdx < PERF_NUM_DEPTHS && CPA_STATUS_SUCCESS == stat; depthIdx++)
+                {
+                    pointAlgos[numResults] = &algoDescs[algoIdx];
+                    stat = measurePoint(&algoDescs[algoIdx],
+                                        PERF_PATH_ENGINE,
+                                        perfPduSizes_g[sizeIdx],
+                                        perfDepths_g[depthIdx],
+                                        port,
+                                        samples,
+                                        &sweeps[sweepIdx][numResults],
+                                        CPA_FALSE);
+                    numResults += (CPA_STATUS_SUCCESS == stat) ? 1 : 0;
+                }
+            }
+        }
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        mergeSweeps(sweeps, numSweeps, numResults, results, &tolerance);
+    }
+
+    /*
+     * A point that looks regressed is measured again before it counts, keeping the best of all its runs
+     */
+    for (resultIdx = 0; resultIdx < numResults && CPA_STATUS_SUCCESS == stat && CPA_TRUE == haveBaseline; resultIdx++)
+    {
+        base = findBaseline(&results[resultIdx], baseline, numBaseline);
+        for (retryIdx = 0; NULL != base && retryIdx < PERF_MAX_RETRIES && CPA_STATUS_SUCCESS == stat &&
+                           0 < checkResult(&results[resultIdx], base, &tolerance, CPA_FALSE);
+             retryIdx++)
+        {
+            stat = measurePoint(pointAlgos[resultIdx],
+                                PERF_PATH_ENGINE,
+                                results[resultIdx].pduSize,
+                                results[resultIdx].depth,
+                                port,
+                                samples,
+                                &results[resultIdx],
+                                CPA_TRUE);
+        }
+    }
+
+    if (NULL != port)
+    {
+        engineClosePort(port);
+    }
+    if (NULL != region)
+    {
+        memFreeContig((void *)&region);
+    }
+    free(samples);
+    engineStop();
+
+    PRINT("Performance suite on the %s backend\n", PDCP_BACKEND);
+    PRINT("%-8s %6s %6s %12s %12s %10s %10s\n", "algo", "pdu", "depth", "Mbps", "kops/s", "p50 us", "p99 us");
+    for (resultIdx = 0; resultIdx < numResults; resultIdx++)
+    {
+        PRINT("%-8s %6u %6u %12.1f %12.1f %10.2f %10.2f\n",
+              results[resultIdx].algo,
+              results[resultIdx].pduSize,
+              results[resultIdx].depth,
+              results[resultIdx].mbps,
+              results[resultIdx].kops,
+              results[resultIdx].p50Us,
+              results[resultIdx].p99Us);
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = writeResults(resultsPath, results, numResults, &tolerance);
+    }
+    if (CPA_STATUS_SUCCESS == stat && CPA_TRUE == haveBaseline)
+    {
+        for (resultIdx = 0; resultIdx < numResults; resultIdx++)
+        {
+            base = findBaseline(&results[resultIdx], baseline, numBaseline);
+            if (NULL == base)
+            {
+                /* A point the baseline does not know is not checked at all, which must not pass silently */
+                PRINT_COLOR(ANSI_COLOR_RED,
+                            "No baseline for %s, %u bytes, depth %u\n",
+                            results[resultIdx].algo,
+                            results[resultIdx].pduSize,
+                            results[resultIdx].depth);
+                numMissing++;
+                continue;
+            }
+            numRegressions += checkResult(&results[resultIdx], base, &tolerance, CPA_TRUE);
+        }
+        if (0 < numMissing)
+        {
+            PRINT_COLOR(ANSI_COLOR_RED,
+                        "%u points missing from %s, record it again with make perf-baseline\n",
+                        numMissing,
+                        baselinePath);
+            stat = CPA_STATUS_FAIL;
+        }
+        if (0 < numRegressions)
+        {
+            PRINT_COLOR(ANSI_COLOR_RED, "%u regressions against %s\n", numRegressions, baselinePath);
+            stat = CPA_STATUS_FAIL;
+        }
+        else if (0 < numMissing)
+        {
+            PRINT("No regressions on the points of %s\n", baselinePath);
+        }
+        else
+        {
+            PRINT_COLOR(ANSI_COLOR_GREEN, "No regressions against %s\n", baselinePath);
+        }
+    }
+    return stat;
+}
+
+CpaStatus runPerfSuite(const char *resultsPath, const char *baselinePath)
+{
+    return runSuite(resultsPath, baselinePath, 1);
+}
+
+CpaStatus runPerfBaseline(const char *baselinePath)
+{
+    return runSuite(baselinePath, NULL, PERF_BASELINE_SWEEPS);
+}
+
+/*
+ * Output of a test vector, for a cipher up to its bit length
+ */
+static CpaBoolean matchesVector(const TestData *testData, const Cpa8U *out)
+{
+    Cpa32U byteLen = testData->bitLen / 8;
+    Cpa8U mask = (Cpa8U)(0xff << (8 - testData->bitLen % 8));
+
+    if (CPA_CY_SYM_OP_HASH == testData->op)
+    {
+        return (0 == memcmp(out, testData->out, testData->outSize)) ? CPA_TRUE : CPA_FALSE;
+    }
+    if (0 != memcmp(out, testData->out, byteLen) ||
+        (0 != testData->bitLen % 8 && 0 != ((out[byteLen] ^ testData->out[byteLen]) & mask)))
+    {
+        return CPA_FALSE;
+    }
+    return CPA_TRUE;
+}
+
+/*
+ * Run a test vector down a path; CPA_STATUS_UNSUPPORTED for a MAC over a partial byte, which no path takes
+ */
+static CpaStatus checkVector(const AlgoDesc *algoDesc, Cpa32U path, const TestData *testData)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    CpaCySymOpData opData;
+    OpDesc opDesc;
+    SwSession sw;
+    EvpSession evp;
+    Cpa8U data[PERF_MAX_VECTOR_SIZE];
+    Cpa8U digest[ENGINE_MAX_DIGEST_SIZE];
+    Cpa32U prefixLen = algoDesc->msgIvPrefixLen;
+    Cpa32U sessionId = 0;
+
+    if ((CPA_CY_SYM_OP_HASH == testData->op && 0 != testData->bitLen % 8) ||
+        PERF_MAX_VECTOR_SIZE < testData->inSize)
+    {
+        return CPA_STATUS_UNSUPPORTED;
+    }
+    memcpy(data, testData->in, testData->inSize);
+
+    if (PERF_PATH_ENGINE == path)
+    {
+        stat = engineCreateSession(algoDesc->name,
+                                   testData->key,
+                                   testData->keySize,
+                                   testData->bearer,
+                                   testData->dir,
+                                   (CPA_CY_SYM_OP_HASH == testData->op) ? testData->outSize : 0,
+                                   CPA_FALSE,
+                                   ENGINE_CLASS_BULK,
+                                   NULL,
+                                   &sessionId);
+        if (CPA_STATUS_SUCCESS == stat)
+        {
+            /* The engine puts the 128-NIA2 prefix in front of the PDU itself */
+            stat = engineExecOp(sessionId,
+                                testData->count,
+                                testData->fresh,
+                                data + prefixLen,
+                                testData->inSize - prefixLen,
+                                digest,
+                                NULL);
+            engineRetireSession(sessionId, NULL);
+            memmove(data, data + prefixLen, testData->inSize - prefixLen);
+        }
+    }
+    else
+    {
+        stat = initCpuSession(algoDesc, path, testData, &sw, &evp);
+        if (CPA_STATUS_SUCCESS == stat)
+        {
+            opDescInit(&opDesc, testData);
+            algoDesc->fillOpData(&opDesc, NULL, testData->iv, digest, &opData);
+            stat = processCpu(path, &sw, &evp, &opData, data, digest);
+        }
+        if (PERF_PATH_EVP == path)
+        {
+            evpFreeSession(&evp);
+        }
+    }
+
+    if (CPA_STATUS_SUCCESS == stat &&
+        CPA_TRUE != matchesVector(testData, (CPA_CY_SYM_OP_HASH == testData->op) ? digest : data))
+    {
+        stat = CPA_STATUS_FAIL;
+    }
+    return stat;
+}
+
+/*
+ * Check every path on the test vectors of the algorithm before it is timed. The mock backend does not compute,
+ * its engine path is left out.
+ */
+static CpaStatus checkVectors(const AlgoDesc *algoDesc, const Cpa32U *paths, Cpa32U numPaths)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    TestData testData;
+    Cpa32U numChecked = 0;
+    Cpa32U numFailed = 0;
+    Cpa32U pathIdx = 0;
+    int testSetId = 0;
+
+    for (testSetId = 1; testSetId <= PERF_MAX_TEST_SETS; testSetId++)
+    {
+        memset(&testData, 0, sizeof(testData));
+        if (CPA_STATUS_SUCCESS != algoDesc->genTestData(testSetId, &testData))
+        {
+            continue;
+        }
+        for (pathIdx = 0; pathIdx < numPaths; pathIdx++)
+        {
+            if (PERF_PATH_ENGINE == paths[pathIdx] && 0 == strcmp(PDCP_BACKEND, "mock"))
+            {
+                continue;
+            }
+            stat = checkVector(algoDesc, paths[pathIdx], &testData);
+            if (CPA_STATUS_UNSUPPORTED == stat)
+            {
+                continue;
+            }
+            numChecked++;
+            if (CPA_STATUS_SUCCESS != stat)
+            {
+                PRINT_ERR("%s test set %d: wrong output on the %s path\n",
+                          algoDesc->name,
+                          testSetId,
+                          perfPathName(paths[pathIdx]));
+                numFailed++;
+            }
+        }
+        freeTestData(&testData);
+    }
+
+    PRINT("%s: %u test vector runs, %u failed\n", algoDesc->name, numChecked, numFailed);
+    return (0 < numFailed) ? CPA_STATUS_FAIL : CPA_STATUS_SUCCESS;
+}
+
+static CpaStatus compareAlgo(const AlgoDesc *algoDesc, EnginePort *port, double *samples)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Cpa32U paths[] = {PERF_PATH_ENGINE, PERF_PATH_ENGINE, PERF_PATH_SW, PERF_PATH_EVP};
+    Cpa32U depths[] = {1, PERF_MAX_DEPTH, 1, 1};
+    PerfResult results[sizeof(paths) / sizeof(paths[0])];
+    Cpa32U numPaths = sizeof(paths) / sizeof(paths[0]);
+    Cpa32U fastest = 0;
+    Cpa32U sizeIdx = 0;
+    Cpa32U pathIdx = 0;
+    double engineMbps = 0;
+
+    if (CPA_TRUE != evpAvailable())
+    {
+        numPaths--;
+    }
+    stat = checkVectors(algoDesc, paths + 1, numPaths - 1);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+
+    PRINT("%-6s %12s %12s %12s %12s %10s %10s %10s %8s %s\n",
+          "pdu",
+          "engine d1",
+          "engine d128",
+          "sw",
+          "evp",
+          "d1 p50 us",
+          "sw p50 us",
+          "evp p50 us",
+          "x evp",
+          "fastest");
+    for (sizeIdx = 0; sizeIdx < PERF_NUM_PDU_SIZES && CPA_STATUS_SUCCESS == stat; sizeIdx++)
+    {
+        memset(results, 0, sizeof(results));
+        fastest = 0;
+        for (pathIdx = 0; pathIdx < numPaths && CPA_STATUS_SUCCESS == stat; pathIdx++)
+        {
+            stat = measurePoint(algoDesc,
+                                paths[pathIdx],
+                                perfPduSizes_g[sizeIdx],
+                                depths[pathIdx],
+                                port,
+                                samples,
+                                &results[pathIdx],
+                                CPA_FALSE);
+            if (results[pathIdx].mbps > results[fastest].mbps)
+            {
+                fastest = pathIdx;
+            }
+        }
+        if (CPA_STATUS_SUCCESS != stat)
+        {
+            break;
+        }
+        engineMbps = (results[0].mbps > results[1].mbps) ? results[0].mbps : results[1].mbps;
+        PRINT("%-6u %12.1f %12.1f %12.1f %12.1f %10.2f %10.2f %10.2f %8.2f %s\n",
+              perfPduSizes_g[sizeIdx],
+              results[0].mbps,
+              results[1].mbps,
+              results[2].mbps,
+              results[3].mbps,
+              results[0].p50Us,
+              results[2].p50Us,
+              results[3].p50Us,
+              (0 < results[3].mbps) ? engineMbps / results[3].mbps : 0.0,
+              (1 >= fastest) ? "engine" : perfPathName(paths[fastest]));
+    }
+    return stat;
+}
+
+CpaStatus runPerfCompare(const char *algoName)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    const char *defaultAlgos[] = {"nea2", "nia2"};
+    const AlgoDesc *algoDesc = NULL;
+    EnginePort *port = NULL;
+    Cpa8U *region = NULL;
+    double *samples = NULL;
+    Cpa32U numAlgos = (NULL != algoName) ? 1 : sizeof(defaultAlgos) / sizeof(defaultAlgos[0]);
+    Cpa32U algoIdx = 0;
+
+    stat = engineStart();
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+    engineBindThread();
+
+    samples = malloc(PERF_MAX_SAMPLES * sizeof(double));
+    stat = (NULL == samples) ? CPA_STATUS_RESOURCE : CPA_STATUS_SUCCESS;
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = memAllocContig((void *)&region, PERF_MAX_DEPTH * PERF_SLOT_SIZE, BYTE_ALIGNMENT);
+        CHECK_ERR_STATUS("memAllocContig", stat);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        memset(region, 0x5a, PERF_MAX_DEPTH * PERF_SLOT_SIZE);
+        port = engineOpenPort(region, PERF_MAX_DEPTH * PERF_SLOT_SIZE, NULL, NULL);
+        stat = (NULL == port) ? CPA_STATUS_RESOURCE : CPA_STATUS_SUCCESS;
+    }
+
+    PRINT("Engine on the %s backend next to the software engine and %s, Mbps\n", PDCP_BACKEND, evpVersion());
+    if (CPA_TRUE != evpAvailable())
+    {
+        PRINT("Built without OpenSSL (OPENSSL=0), its columns stay at zero\n");
+    }
+    for (algoIdx = 0; algoIdx < numAlgos && CPA_STATUS_SUCCESS == stat; algoIdx++)
+    {
+        algoDesc = findAlgoDesc((NULL != algoName) ? algoName : defaultAlgos[algoIdx]);
+        if (NULL == algoDesc || (CPA_CY_SYM_CIPHER_AES_CTR != algoDesc->cipherAlgo &&
+                                 CPA_CY_SYM_HASH_AES_CMAC != algoDesc->hashAlgo))
+        {
+            PRINT_ERR("OpenSSL is only compared on nea2, nia2, nea2_256 and nia2_256\n");
+            stat = CPA_STATUS_INVALID_PARAM;
+            break;
+        }
+        stat = compareAlgo(algoDesc, port, samples);
+    }
+
+    if (NULL != port)
+    {
+        engineClosePort(port);
+    }
+    if (NULL != region)
+    {
+        memFreeContig((void *)&region);
+    }
+    free(samples);
+    engineStop();
+    return stat;
+}
@@ -0,0 +1,67 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include "cpa.h"
+
+#define PERF_DEFAULT_RESULTS "perf_results.json"
+#define PERF_POINT_MS 20
+#define PERF_WARMUP_MS 2
+#define PERF_MIN_OPS 256
+#define PERF_REPEATS 3
+#define PERF_MAX_RETRIES 3
+#define PERF_BASELINE_SWEEPS 5 /* sweeps a baseline is recorded from */
+#define PERF_MAX_DEPTH 128
+#define PERF_MAX_SAMPLES (64 * 1024)
+#define PERF_MAX_KEY_SIZE 32
+#define PERF_DIGEST_SIZE 4
+
+#ifndef PDCP_BACKEND
+#define PDCP_BACKEND "qat"
+#endif
+
+/*
+ * Tolerances, relative to the baseline. Throughput may drop and latency may grow by this much before a point
+ * counts as a regression. A baseline file replaces them with its own: tighter ones as written, wider ones as
+ * recorded by runPerfBaseline() from the noise of its host, which every run reports.
+ */
+#define PERF_TOLERANCE_MBPS 0.10
+#define PERF_TOLERANCE_KOPS 0.10
+#define PERF_TOLERANCE_P50 0.25
+#define PERF_TOLERANCE_P99 0.50
+
+typedef struct _PerfResult {
+    char algo[16];
+    Cpa32U pduSize;
+    Cpa32U depth;
+    double mbps;
+    double kops;
+    double p50Us;
+    double p99Us;
+} PerfResult;
+
+typedef struct _PerfTolerance {
+    double mbps;
+    double kops;
+    double p50Us;
+    double p99Us;
+} PerfTolerance;
+
+/*
+ * Run every NEA/NIA algorithm over every PDU size and in-flight depth through the engine burst API, write the
+ * results as JSON and, given a baseline from an earlier run, fail on any metric outside its tolerance
+ */
+CpaStatus runPerfSuite(const char *resultsPath, const char *baselinePath);
+
+/*
+ * Record a baseline from PERF_BASELINE_SWEEPS sweeps of the suite, with the tolerances widened to the noise
+ * measured across them
+ */
+CpaStatus runPerfBaseline(const char *baselinePath);
+
+/*
+ * Sweep the PDU sizes of the suite for an AES algorithm (nea2 and nia2 when NULL) through the engine, the
+ * software engine and OpenSSL EVP, and report the three side by side
+ */
+CpaStatus runPerfCompare(const char *algoName);
+
+#endif
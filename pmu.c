@@ -0,0 +1,434 @@
+/*
+ * Hot path cycle accounting on the PMU.
+ *
+ * Every thread measuring a stage opens its own perf_event_open() counters on its first run: cycles,
+ * instructions, last level cache misses and branch misses, user space only. They are read with rdpmc through
+ * the mapped counter page, a few tens of cycles each, or with read() where the kernel does not allow it. A
+ * measured run reads the counters when it starts and when it ends and adds the difference, less what stages
+ * inside it counted, to its stage and algorithm. Totals live with the thread, so measuring takes no lock.
+ *
+ * Only one in sampleRate runs of every stage is measured, stages inside a measured one always are. With a rate
+ * of a few dozen the counters cost less than the polling around them, so soak tests can keep them on. Without
+ * a PMU (virtual machines, perf_event_paranoid) cycles fall back to the time stamp counter and the other
+ * counters stay empty.
+ */
+
+#define _GNU_SOURCE
+
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include "cpa.h"
+#include "cpa_sample_utils.h"
+
+#include "pmu.h"
+#include "utils.h"
+
+/* Runs of the stages shared by all algorithms go after the algorithms */
+#define PMU_ALL_ALGOS PMU_MAX_ALGOS
+
+typedef struct _PmuStats {
+    Cpa64U numRuns;
+    Cpa64U numOps;
+    Cpa64U counts[PMU_NUM_COUNTERS];
+} PmuStats;
+
+/*
+ * Counters and totals of one thread, written by that thread only
+ */
+typedef struct _PmuThread {
+    int fds[PMU_NUM_COUNTERS];
+    struct perf_event_mmap_page *pages[PMU_NUM_COUNTERS];
+    Cpa32U depth; /* measured runs in progress */
+    Cpa32U countdown[PMU_NUM_STAGES];
+    Cpa64U nested[PMU_NUM_COUNTERS]; /* ever counted to a stage, for the stages around it */
+    PmuStats stats[PMU_MAX_ALGOS + 1][PMU_NUM_STAGES];
+} PmuThread;
+
+int pmuEnabled_g = 0;
+static __thread PmuThread *pmuThread_t = NULL;
+
+static PmuThread *threads_g[PMU_MAX_THREADS] = {NULL};
+static Cpa32U numThreads_g = 0;
+static Cpa32U sampleRate_g = 1;
+static Cpa32U openCounters_g = 0; /* bit per PmuCounter opened by any thread */
+
+static const Cpa64U counterConfigs_g[PMU_NUM_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+static const char *stageName(Cpa32U stage)
+{
+    switch (stage)
+    {
+        case PMU_STAGE_DESC:
+            return "desc";
+        case PMU_STAGE_IV:
+            return "iv";
+        case PMU_STAGE_SUBMIT:
+            return "submit";
+        case PMU_STAGE_POLL:
+            return "poll";
+        case PMU_STAGE_CALLBACK:
+            return "callback";
+        default:
+            return "unknown";
+    }
+}
+
+static Cpa64U readTsc(void)
+{
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Cpa64U)ts.tv_sec * 1000000000ULL + (Cpa64U)ts.tv_nsec;
+#endif
+}
+
+static void openCounter(PmuThread *thread, Cpa32U counter)
+{
+    struct perf_event_attr attr;
+    void *page = NULL;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = counterConfigs_g[counter];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    thread->fds[counter] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (0 > thread->fds[counter])
+    {
+        return;
+    }
+    page = mmap(NULL, (size_t)sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, thread->fds[counter], 0);
+    thread->pages[counter] = (MAP_FAILED != page) ? (struct perf_event_mmap_page *)page : NULL;
+    __atomic_fetch_or(&openCounters_g, 1U << counter, __ATOMIC_RELAXED);
+}
+
+/*
+ * Called on the first measured run of a thread; threads beyond PMU_MAX_THREADS are not measured
+ */
+static PmuThread *attachThread(void)
+{
+    PmuThread *thread = NULL;
+    Cpa32U threadIdx = 0;
+    Cpa32U counter = 0;
+    Cpa32U stage = 0;
+
+    threadIdx = __atomic_fetch_add(&numThreads_g, 1, __ATOMIC_RELAXED);
+    if (PMU_MAX_THREADS <= threadIdx)
+    {
+        __atomic_store_n(&numThreads_g, PMU_MAX_THREADS, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    thread = calloc(1, sizeof(PmuThread));
+    if (NULL == thread)
+    {
+        return NULL;
+    }
+    for (counter = 0; counter < PMU_NUM_COUNTERS; counter++)
+    {
+        openCounter(thread, counter);
+    }
+    /* The first run of every stage is measured */
+    for (stage = 0; stage < PMU_NUM_STAGES; stage++)
+    {
+        thread->countdown[stage] = 1;
+    }
+    __atomic_store_n(&threads_g[threadIdx], thread, __ATOMIC_RELEASE);
+    pmuThread_t = thread;
+
+    return thread;
+}
+
+#if defined(__x86_64__)
+static inline Cpa64U rdpmc(Cpa32U index)
+{
+    Cpa32U low = 0;
+    Cpa32U high = 0;
+
+    __asm__ __volatile__("rdpmc" : "=a"(low), "=d"(high) : "c"(index));
+    return ((Cpa64U)high << 32) | low;
+}
+
+/*
+ * The user space read of perf_event_mmap_page, retried while the kernel updates the page. CPA_FALSE when the
+ * counter cannot be read this way right now.
+ */
+static CpaBoolean readMapped(const volatile struct perf_event_mmap_page *page, Cpa64U *count)
+{
+    Cpa64S pmc = 0;
+    Cpa32U seq = 0;
+    Cpa32U index = 0;
+    Cpa32U width = 0;
+
+    do
+    {
+        seq = page->lock;
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        index = page->index;
+        if (0 == page->cap_user_rdpmc || 0 == index)
+        {
+            return CPA_FALSE;
+        }
+        width = page->pmc_width;
+        if (0 == width)
+        {
+            return CPA_FALSE;
+        }
+        *count = (Cpa64U)page->offset;
+        pmc = (Cpa64S)rdpmc(index - 1);
+        /* Sign extend the pmc_width bits of the hardware counter */
+        pmc = (Cpa64S)((Cpa64U)pmc << (64 - width)) >> (64 - width);
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    } while (page->lock != seq);
+
+    *count += (Cpa64U)pmc;
+    return CPA_TRUE;
+}
+#endif
+
+static void readCounters(const PmuThread *thread, Cpa64U *counts)
+{
+    Cpa32U counter = 0;
+
+    for (counter = 0; counter < PMU_NUM_COUNTERS; counter++)
+    {
+        counts[counter] = 0;
+        if (0 > thread->fds[counter])
+        {
+            counts[counter] = (PMU_CYCLES == counter) ? readTsc() : 0;
+            continue;
+        }
+#if defined(__x86_64__)
+        if (NULL != thread->pages[counter] && CPA_TRUE == readMapped(thread->pages[counter], &counts[counter]))
+        {
+            continue;
+        }
+#endif
+        if (sizeof(counts[counter]) != read(thread->fds[counter], &counts[counter], sizeof(counts[counter])))
+        {
+            counts[counter] = 0;
+        }
+    }
+}
+
+void pmuBegin(PmuSample *sample, PmuStage stage)
+{
+    PmuThread *thread = pmuThread_t;
+
+    if (NULL == thread)
+    {
+        thread = attachThread();
+        if (NULL == thread)
+        {
+            return;
+        }
+    }
+    if (0 == thread->depth)
+    {
+        if (0 != --thread->countdown[stage])
+        {
+            return;
+        }
+        thread->countdown[stage] = sampleRate_g;
+    }
+    thread->depth++;
+    sample->active = CPA_TRUE;
+    memcpy(sample->nested, thread->nested, sizeof(sample->nested));
+    /* Last, so that little of the measuring is measured */
+    readCounters(thread, sample->start);
+}
+
+void pmuEnd(PmuSample *sample, PmuStage stage, const AlgoDesc *algoDesc, Cpa32U numOps)
+{
+    PmuThread *thread = pmuThread_t;
+    PmuStats *stats = NULL;
+    Cpa64U counts[PMU_NUM_COUNTERS];
+    Cpa64U own = 0;
+    Cpa32U numAlgos = 0;
+    const AlgoDesc *algoDescs = getAlgoDescs(&numAlgos);
+    Cpa32U algoIdx = PMU_ALL_ALGOS;
+    Cpa32U counter = 0;
+
+    readCounters(thread, counts);
+    if (NULL != algoDesc && algoDesc >= algoDescs && algoDesc < algoDescs + numAlgos &&
+        PMU_MAX_ALGOS > (Cpa32U)(algoDesc - algoDescs))
+    {
+        algoIdx = (Cpa32U)(algoDesc - algoDescs);
+    }
+    stats = &thread->stats[algoIdx][stage];
+    for (counter = 0; counter < PMU_NUM_COUNTERS; counter++)
+    {
+        own = (counts[counter] - sample->start[counter]) - (thread->nested[counter] - sample->nested[counter]);
+        stats->counts[counter] += own;
+        thread->nested[counter] += own;
+    }
+    stats->numRuns++;
+    stats->numOps += numOps;
+    thread->depth--;
+    sample->active = CPA_FALSE;
+}
+
+CpaStatus pmuStart(Cpa32U sampleRate)
+{
+    if (!PMU_COMPILED)
+    {
+        PRINT_ERR("Built with PMU=0, the stages are not measured\n");
+        return CPA_STATUS_UNSUPPORTED;
+    }
+    sampleRate_g = (0 < sampleRate) ? sampleRate : 1;
+    __atomic_store_n(&pmuEnabled_g, 1, __ATOMIC_RELEASE);
+    PRINT_DBG("Measuring one in %u runs of every data path stage on the PMU\n", sampleRate_g);
+
+    return CPA_STATUS_SUCCESS;
+}
+
+/* value per op, "-" when the counter was not available */
+static void formatPerOp(char *buf, size_t size, Cpa64U value, Cpa64U numOps, Cpa32U counter)
+{
+    if (0 == (openCounters_g & (1U << counter)) || 0 == numOps)
+    {
+        snprintf(buf, size, "-");
+        return;
+    }
+    snprintf(buf, size, "%.1f", (double)value / (double)numOps);
+}
+
+static void printStats(const char *algoName, Cpa32U stage, const PmuStats *stats)
+{
+    char instructions[24];
+    char llcMisses[24];
+    char branchMisses[24];
+    char ipc[24];
+    Cpa64U numOps = (0 < stats->numOps) ? stats->numOps : stats->numRuns;
+
+    formatPerOp(instructions, sizeof(instructions), stats->counts[PMU_INSTRUCTIONS], numOps, PMU_INSTRUCTIONS);
+    formatPerOp(llcMisses, sizeof(llcMisses), stats->counts[PMU_LLC_MISSES], numOps, PMU_LLC_MISSES);
+    formatPerOp(branchMisses, sizeof(branchMisses), stats->counts[PMU_BRANCH_MISSES], numOps, PMU_BRANCH_MISSES);
+    if (0 != (openCounters_g & (1U << PMU_CYCLES)) && 0 != (openCounters_g & (1U << PMU_INSTRUCTIONS)) &&
+        0 < stats->counts[PMU_CYCLES])
+    {
+        snprintf(ipc, sizeof(ipc), "%.2f", (double)stats->counts[PMU_INSTRUCTIONS] / stats->counts[PMU_CYCLES]);
+    }
+    else
+    {
+        snprintf(ipc, sizeof(ipc), "-");
+    }
+    PRINT("%-12s %-9s %10llu %10llu %12.1f %12.1f %10s %6s %10s %10s\n",
+          algoName,
+          stageName(stage),
+          (unsigned long long)stats->numRuns,
+          (unsigned long long)stats->numOps,
+          (double)stats->counts[PMU_CYCLES] / stats->numRuns,
+          (double)stats->counts[PMU_CYCLES] / numOps,
+          instructions,
+          ipc,
+          llcMisses,
+          branchMisses);
+}
+
+void pmuStop(void)
+{
+    PmuStats totals[PMU_MAX_ALGOS + 1][PMU_NUM_STAGES];
+    const PmuThread *thread = NULL;
+    const PmuStats *stats = NULL;
+    Cpa32U numAlgos = 0;
+    const AlgoDesc *algoDescs = getAlgoDescs(&numAlgos);
+    const char *algoName = NULL;
+    double cyclesPerOp = 0;
+    Cpa32U numThreads = 0;
+    Cpa32U threadIdx = 0;
+    Cpa32U algoIdx = 0;
+    Cpa32U stage = 0;
+    Cpa32U counter = 0;
+    CpaBoolean hasRuns = CPA_FALSE;
+
+    if (0 == pmuEnabled_g)
+    {
+        return;
+    }
+    __atomic_store_n(&pmuEnabled_g, 0, __ATOMIC_RELEASE);
+
+    memset(totals, 0, sizeof(totals));
+    numThreads = __atomic_load_n(&numThreads_g, __ATOMIC_RELAXED);
+    for (threadIdx = 0; threadIdx < numThreads; threadIdx++)
+    {
+        thread = __atomic_load_n(&threads_g[threadIdx], __ATOMIC_ACQUIRE);
+        if (NULL == thread)
+        {
+            continue;
+        }
+        for (algoIdx = 0; algoIdx <= PMU_MAX_ALGOS; algoIdx++)
+        {
+            for (stage = 0; stage < PMU_NUM_STAGES; stage++)
+            {
+                stats = &thread->stats[algoIdx][stage];
+                totals[algoIdx][stage].numRuns += stats->numRuns;
+                totals[algoIdx][stage].numOps += stats->numOps;
+                for (counter = 0; counter < PMU_NUM_COUNTERS; counter++)
+                {
+                    totals[algoIdx][stage].counts[counter] += stats->counts[counter];
+                }
+            }
+        }
+    }
+
+    PRINT("PMU stage accounting on %u threads, one in %u runs of every stage measured\n", numThreads, sampleRate_g);
+    if (0 == (openCounters_g & (1U << PMU_CYCLES)))
+    {
+        PRINT("No PMU counters could be opened (no PMU or perf_event_paranoid), cycles are time stamp counter "
+              "ticks\n");
+    }
+    PRINT("%-12s %-9s %10s %10s %12s %12s %10s %6s %10s %10s\n",
+          "algo",
+          "stage",
+          "runs",
+          "ops",
+          "cycles/run",
+          "cycles/op",
+          "instr/op",
+          "IPC",
+          "LLC/op",
+          "brmiss/op");
+    for (algoIdx = 0; algoIdx <= PMU_MAX_ALGOS; algoIdx++)
+    {
+        algoName = (PMU_ALL_ALGOS == algoIdx) ? "all" : (algoIdx < numAlgos) ? algoDescs[algoIdx].name : NULL;
+        cyclesPerOp = 0;
+        hasRuns = CPA_FALSE;
+        for (stage = 0; stage < PMU_NUM_STAGES && NULL != algoName; stage++)
+        {
+            stats = &totals[algoIdx][stage];
+            if (0 == stats->numRuns)
+            {
+                continue;
+            }
+            printStats(algoName, stage, stats);
+            cyclesPerOp += (double)stats->counts[PMU_CYCLES] / ((0 < stats->numOps) ? stats->numOps : stats->numRuns);
+            hasRuns = CPA_TRUE;
+        }
+        /* Polling is shared by all algorithms and left out of their totals */
+        if (CPA_TRUE == hasRuns && PMU_ALL_ALGOS != algoIdx)
+        {
+            PRINT("%-12s %-9s %10s %10s %12s %12.1f\n", algoName, "total", "", "", "", cyclesPerOp);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef PMU_H
+#define PMU_H
+
+#include "cpa.h"
+
+#include "algo.h"
+
+/* PMU_COMPILED=0 compiles every measuring point out */
+#ifndef PMU_COMPILED
+#define PMU_COMPILED 1
+#endif
+
+#define PMU_MAX_THREADS 64
+#define PMU_MAX_ALGOS 16
+
+typedef enum _PmuCounter {
+    PMU_CYCLES = 0,
+    PMU_INSTRUCTIONS,
+    PMU_LLC_MISSES,
+    PMU_BRANCH_MISSES,
+    PMU_NUM_COUNTERS
+} PmuCounter;
+
+/*
+ * Stages of the data path. A stage running inside another one (IV generation while a descriptor is built, the
+ * callbacks of a poll) is only counted to the inner stage.
+ */
+typedef enum _PmuStage {
+    PMU_STAGE_DESC = 0, /* op and buffer list of a request */
+    PMU_STAGE_IV,
+    PMU_STAGE_SUBMIT, /* cpaCySymPerformOp() */
+    PMU_STAGE_POLL,
+    PMU_STAGE_CALLBACK,
+    PMU_NUM_STAGES
+} PmuStage;
+
+/*
+ * One measured run of a stage, on the stack of the measuring thread
+ */
+typedef struct _PmuSample {
+    CpaBoolean active; /* CPA_FALSE when this run is not measured */
+    Cpa64U start[PMU_NUM_COUNTERS];
+    Cpa64U nested[PMU_NUM_COUNTERS]; /* counted to stages inside it before it started */
+} PmuSample;
+
+extern int pmuEnabled_g;
+
+void pmuBegin(PmuSample *sample, PmuStage stage);
+
+/*
+ * algoDesc is NULL for stages shared by all algorithms (polling). numOps is the number of ops the run worked
+ * for: the IVs of a burst, the completions of a poll.
+ */
+void pmuEnd(PmuSample *sample, PmuStage stage, const AlgoDesc *algoDesc, Cpa32U numOps);
+
+#define PMU_BEGIN(sample, stage)                   \
+    do                                             \
+    {                                              \
+        (sample)->active = CPA_FALSE;              \
+        if (PMU_COMPILED && pmuEnabled_g)          \
+        {                                          \
+            pmuBegin((sample), (stage));           \
+        }                                          \
+    } while (0)
+
+#define PMU_END(sample, stage, algoDesc, numOps)                  \
+    do                                                            \
+    {                                                             \
+        if (PMU_COMPILED && CPA_TRUE == (sample)->active)         \
+        {                                                         \
+            pmuEnd((sample), (stage), (algoDesc), (numOps));      \
+        }                                                         \
+    } while (0)
+
+/*
+ * Measure one in sampleRate runs of every stage from now on; pmuStop() prints cycles per op, IPC and misses per
+ * stage and algorithm and should run once the data path stopped
+ */
+CpaStatus pmuStart(Cpa32U sampleRate);
+void pmuStop(void);
+
+#endif
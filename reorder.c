@@ -0,0 +1,272 @@
+/*
+ * Per-bearer reordering of completions.
+ *
+ * With the PDUs of one bearer in flight on several instances, completions come back out of COUNT order while
+ * RLC and SDAP expect them in order. Each bearer has a window of slots indexed by COUNT modulo the window size;
+ * a completion is stored in its slot by whichever thread got it, and the releasing thread delivers the run of
+ * consecutive COUNTs from the next one expected.
+ *
+ * Slots take no lock. The state of a slot tags the COUNT the slot is at: DONE(c) once COUNT c was released or
+ * given up on, which frees the slot for c + window; FILLING(c) while a completion of c is copied in; FULL(c)
+ * once it can be released. An insert of c moves the slot from DONE(c - window) to FILLING(c) with a single
+ * compare-and-swap, and giving up on a missing c moves it from DONE(c - window) to DONE(c) the same way, so a
+ * completion arriving around the timeout is either released in order or turned away, never both.
+ *
+ * A bearer stopped at a missing COUNT holds back its own completions only: its later COUNTs wait until the
+ * missing one arrives or until they waited for the timeout, then the gap is skipped.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cpa.h"
+#include "cpa_sample_utils.h"
+
+#include "reorder.h"
+#include "utils.h"
+
+#define REORDER_DONE 0
+#define REORDER_FILLING 1
+#define REORDER_FULL 2
+
+#define REORDER_STATE(count, kind) (((Cpa64U)(Cpa32U)(count) << 2) | (kind))
+#define REORDER_STATE_COUNT(state) ((Cpa32U)((state) >> 2))
+
+static Cpa64U nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Cpa64U)ts.tv_sec * 1000000000ULL + (Cpa64U)ts.tv_nsec;
+}
+
+void reorderResetBearer(ReorderStage *stage, Cpa32U bearerIdx, Cpa32U firstCount)
+{
+    ReorderBearer *bearer = &stage->bearers[bearerIdx];
+    Cpa32U count = 0;
+
+    for (count = firstCount; count != firstCount + stage->window; count++)
+    {
+        bearer->states[count & (stage->window - 1)] = REORDER_STATE(count - stage->window, REORDER_DONE);
+    }
+    bearer->nextCount = firstCount;
+    bearer->gapSinceNs = 0;
+    __atomic_store_n(&bearer->numBuffered, 0, __ATOMIC_RELEASE);
+}
+
+CpaStatus reorderInit(ReorderStage *stage,
+                      Cpa32U numBearers,
+                      Cpa32U window,
+                      Cpa32U timeoutUs,
+                      ReorderDeliverFn deliver,
+                      void *arg)
+{
+    Cpa32U bearerIdx = 0;
+
+    if (0 == numBearers || REORDER_MAX_BEARERS < numBearers || 2 > window || REORDER_MAX_WINDOW < window ||
+        0 != (window & (window - 1)) || NULL == deliver)
+    {
+        PRINT_ERR("Invalid reorder parameters\n");
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    memset(stage, 0, sizeof(ReorderStage));
+    stage->bearers = aligned_alloc(RING_CACHE_LINE, numBearers * sizeof(ReorderBearer));
+    if (NULL == stage->bearers)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+    memset(stage->bearers, 0, numBearers * sizeof(ReorderBearer));
+    stage->numBearers = numBearers;
+    stage->window = window;
+    stage->timeoutNs = (Cpa64U)timeoutUs * 1000;
+    stage->deliver = deliver;
+    stage->arg = arg;
+
+    for (bearerIdx = 0; bearerIdx < numBearers; bearerIdx++)
+    {
+        stage->bearers[bearerIdx].states = malloc(window * sizeof(Cpa64U));
+        stage->bearers[bearerIdx].descs = malloc(window * sizeof(PdcpDesc));
+        if (NULL == stage->bearers[bearerIdx].states || NULL == stage->bearers[bearerIdx].descs)
+        {
+            reorderFree(stage);
+            return CPA_STATUS_RESOURCE;
+        }
+        reorderResetBearer(stage, bearerIdx, 0);
+    }
+
+    return CPA_STATUS_SUCCESS;
+}
+
+void reorderFree(ReorderStage *stage)
+{
+    Cpa32U bearerIdx = 0;
+
+    if (NULL == stage->bearers)
+    {
+        return;
+    }
+    for (bearerIdx = 0; bearerIdx < stage->numBearers; bearerIdx++)
+    {
+        free(stage->bearers[bearerIdx].states);
+        free(stage->bearers[bearerIdx].descs);
+    }
+    free(stage->bearers);
+    stage->bearers = NULL;
+}
+
+CpaStatus reorderInsert(ReorderStage *stage, Cpa32U bearerIdx, const PdcpDesc *desc)
+{
+    ReorderBearer *bearer = &stage->bearers[bearerIdx];
+    Cpa32U slot = desc->count & (stage->window - 1);
+    Cpa64U state = REORDER_STATE(desc->count - stage->window, REORDER_DONE);
+
+    if (!__atomic_compare_exchange_n(&bearer->states[slot],
+                                     &state,
+                                     REORDER_STATE(desc->count, REORDER_FILLING),
+                                     CPA_FALSE,
+                                     __ATOMIC_ACQUIRE,
+                                     __ATOMIC_ACQUIRE))
+    {
+        /* The slot is at an older COUNT still, or this COUNT came already or was given up on */
+        if (0 > (Cpa32S)(REORDER_STATE_COUNT(state) - desc->count))
+        {
+            return CPA_STATUS_RETRY;
+        }
+        __atomic_fetch_add(&bearer->numLate, 1, __ATOMIC_RELAXED);
+        return CPA_STATUS_FAIL;
+    }
+
+    memcpy(&bearer->descs[slot], desc, sizeof(PdcpDesc));
+    __atomic_fetch_add(&bearer->numBuffered, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&bearer->states[slot], REORDER_STATE(desc->count, REORDER_FULL), __ATOMIC_RELEASE);
+    __atomic_fetch_or(&stage->ready[bearerIdx / 64], 1ULL << (bearerIdx % 64), __ATOMIC_RELEASE);
+
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ * Deliver the in-order run of a bearer, skipping a gap that was waited on for the timeout. Returns CPA_TRUE
+ * when the bearer stopped at a gap with later COUNTs buffered, to be looked at again on the next release.
+ */
+static CpaBoolean releaseBearer(ReorderStage *stage, Cpa32U bearerIdx, Cpa64U *now, Cpa32U *numReleased)
+{
+    ReorderBearer *bearer = &stage->bearers[bearerIdx];
+    PdcpDesc descs[REORDER_BURST_SIZE];
+    Cpa32U mask = stage->window - 1;
+    Cpa32U numDescs = 0;
+    Cpa32U slot = 0;
+    Cpa64U state = 0;
+
+    for (;;)
+    {
+        numDescs = 0;
+        while (REORDER_BURST_SIZE > numDescs)
+        {
+            slot = bearer->nextCount & mask;
+            if (REORDER_STATE(bearer->nextCount, REORDER_FULL) !=
+                __atomic_load_n(&bearer->states[slot], __ATOMIC_ACQUIRE))
+            {
+                break;
+            }
+            memcpy(&descs[numDescs++], &bearer->descs[slot], sizeof(PdcpDesc));
+            __atomic_store_n(&bearer->states[slot], REORDER_STATE(bearer->nextCount, REORDER_DONE), __ATOMIC_RELEASE);
+            bearer->nextCount++;
+        }
+        if (0 < numDescs)
+        {
+            __atomic_fetch_sub(&bearer->numBuffered, numDescs, __ATOMIC_RELAXED);
+            bearer->numDelivered += numDescs;
+            bearer->gapSinceNs = 0;
+            *numReleased += numDescs;
+            stage->deliver(bearerIdx, descs, numDescs, stage->arg);
+            if (REORDER_BURST_SIZE == numDescs)
+            {
+                continue;
+            }
+        }
+
+        if (0 == __atomic_load_n(&bearer->numBuffered, __ATOMIC_ACQUIRE))
+        {
+            bearer->gapSinceNs = 0;
+            return CPA_FALSE;
+        }
+
+        /* Later COUNTs wait behind nextCount: missing, or being copied in */
+        slot = bearer->nextCount & mask;
+        state = REORDER_STATE(bearer->nextCount - stage->window, REORDER_DONE);
+        if (state != __atomic_load_n(&bearer->states[slot], __ATOMIC_ACQUIRE))
+        {
+            return CPA_TRUE;
+        }
+        if (0 == *now)
+        {
+            *now = nowNs();
+        }
+        if (0 == bearer->gapSinceNs)
+        {
+            bearer->gapSinceNs = *now;
+        }
+        if (*now - bearer->gapSinceNs < stage->timeoutNs)
+        {
+            return CPA_TRUE;
+        }
+        if (__atomic_compare_exchange_n(&bearer->states[slot],
+                                        &state,
+                                        REORDER_STATE(bearer->nextCount, REORDER_DONE),
+                                        CPA_FALSE,
+                                        __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE))
+        {
+            bearer->numSkipped++;
+            bearer->nextCount++;
+        }
+    }
+}
+
+Cpa32U reorderRelease(ReorderStage *stage)
+{
+    Cpa64U now = 0;
+    Cpa64U bits = 0;
+    Cpa32U numReleased = 0;
+    Cpa32U wordIdx = 0;
+    Cpa32U bearerIdx = 0;
+
+    for (wordIdx = 0; wordIdx < (stage->numBearers + 63) / 64; wordIdx++)
+    {
+        bits = stage->waiting[wordIdx];
+        if (0 != __atomic_load_n(&stage->ready[wordIdx], __ATOMIC_RELAXED))
+        {
+            bits |= __atomic_exchange_n(&stage->ready[wordIdx], 0, __ATOMIC_ACQUIRE);
+        }
+        stage->waiting[wordIdx] = 0;
+        while (0 != bits)
+        {
+            bearerIdx = wordIdx * 64 + (Cpa32U)__builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (CPA_TRUE == releaseBearer(stage, bearerIdx, &now, &numReleased))
+            {
+                stage->waiting[wordIdx] |= 1ULL << (bearerIdx % 64);
+            }
+        }
+    }
+
+    return numReleased;
+}
+
+void reorderGetStats(const ReorderStage *stage, ReorderStats *stats)
+{
+    const ReorderBearer *bearer = NULL;
+    Cpa32U bearerIdx = 0;
+
+    memset(stats, 0, sizeof(ReorderStats));
+    for (bearerIdx = 0; bearerIdx < stage->numBearers; bearerIdx++)
+    {
+        bearer = &stage->bearers[bearerIdx];
+        stats->numDelivered += bearer->numDelivered;
+        stats->numSkipped += bearer->numSkipped;
+        stats->numLate += __atomic_load_n(&bearer->numLate, __ATOMIC_RELAXED);
+        stats->numBuffered += __atomic_load_n(&bearer->numBuffered, __ATOMIC_RELAXED);
+    }
+}
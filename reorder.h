@@ -0,0 +1,81 @@
+#ifndef REORDER_H
+#define REORDER_H
+
+#include "cpa.h"
+
+#include "ring.h"
+
+#define REORDER_MAX_BEARERS 1024
+#define REORDER_MAX_WINDOW 4096
+#define REORDER_DEFAULT_WINDOW 256
+#define REORDER_DEFAULT_TIMEOUT_US 20000
+#define REORDER_BURST_SIZE 32
+
+/*
+ * Called with completed PDUs of one bearer in COUNT order, from the thread calling reorderRelease()
+ */
+typedef void (*ReorderDeliverFn)(Cpa32U bearerIdx, const PdcpDesc *descs, Cpa32U numDescs, void *arg);
+
+/*
+ * Window of one bearer. Slot i holds a COUNT equal to i modulo the window and its state tags that COUNT, see
+ * reorder.c. The fields up to numBuffered belong to the releasing thread.
+ */
+typedef struct _ReorderBearer {
+    Cpa64U *states;
+    PdcpDesc *descs;
+    Cpa32U nextCount;
+    Cpa64U gapSinceNs; /* when the release stopped at the missing nextCount, 0 when it did not */
+    Cpa64U numDelivered;
+    Cpa64U numSkipped; /* COUNTs given up on after the timeout */
+    Cpa32U numBuffered __attribute__((aligned(RING_CACHE_LINE))); /* inserted and not released */
+    Cpa64U numLate; /* inserted after their COUNT was given up on */
+} __attribute__((aligned(RING_CACHE_LINE))) ReorderBearer;
+
+typedef struct _ReorderStage {
+    ReorderBearer *bearers;
+    Cpa32U numBearers;
+    Cpa32U window;
+    Cpa64U timeoutNs;
+    ReorderDeliverFn deliver;
+    void *arg;
+    Cpa64U ready[REORDER_MAX_BEARERS / 64]; /* bearers with new insertions, set by any thread */
+    Cpa64U waiting[REORDER_MAX_BEARERS / 64]; /* bearers stopped at a gap, only seen by the releasing thread */
+} ReorderStage;
+
+typedef struct _ReorderStats {
+    Cpa64U numDelivered;
+    Cpa64U numSkipped;
+    Cpa64U numLate;
+    Cpa32U numBuffered;
+} ReorderStats;
+
+/*
+ * Bearers are numbered from 0 to numBearers - 1 and start at COUNT 0. window is a power of two and bounds how
+ * far ahead of the next COUNT to release a completion may be; a missing COUNT is given up on once later ones
+ * waited for timeoutUs.
+ */
+CpaStatus reorderInit(ReorderStage *stage,
+                      Cpa32U numBearers,
+                      Cpa32U window,
+                      Cpa32U timeoutUs,
+                      ReorderDeliverFn deliver,
+                      void *arg);
+void reorderFree(ReorderStage *stage);
+/* Restart a bearer at firstCount, while no completion of it comes in */
+void reorderResetBearer(ReorderStage *stage, Cpa32U bearerIdx, Cpa32U firstCount);
+
+/*
+ * From any thread, never blocks. CPA_STATUS_RETRY when the COUNT of desc is a window or more ahead, try again
+ * after a release; CPA_STATUS_FAIL when it was released or given up on already, the PDU stays with the caller.
+ */
+CpaStatus reorderInsert(ReorderStage *stage, Cpa32U bearerIdx, const PdcpDesc *desc);
+
+/*
+ * From one thread at a time: deliver what is in order on every bearer and skip gaps older than the timeout.
+ * A gap on one bearer holds back no other. Returns the number of PDUs delivered.
+ */
+Cpa32U reorderRelease(ReorderStage *stage);
+
+void reorderGetStats(const ReorderStage *stage, ReorderStats *stats);
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef RING_H
+#define RING_H
+
+#include <string.h>
+
+#include "cpa.h"
+
+#define RING_CACHE_LINE 64
+#define RING_MAX_DIGEST_SIZE 16
+
+/*
+ * Descriptor of one PDU. The payload lives in a buffer region shared by the submitter and the engine; offset
+ * and length locate it there, so that only the descriptor moves between the two.
+ */
+typedef struct _PdcpDesc {
+    Cpa64U userTag;
+    Cpa32U sessionId;
+    Cpa32U count;
+    Cpa32U fresh;
+    Cpa32U offset;
+    Cpa32U length;
+    Cpa32S status;
+    Cpa32U flags;
+    Cpa8U digest[RING_MAX_DIGEST_SIZE];
+} PdcpDesc;
+
+/* Set on completion when the MAC-I appended to the PDU did not verify */
+#define RING_DESC_VERIFY_FAILED 0x1
+
+/*
+ * Bit i of passBitmap (64 descriptors per word) tells whether descs[i] completed successfully and, for a
+ * verifying session, carried a valid MAC-I
+ */
+static inline void ringPassBitmap(const PdcpDesc *descs, Cpa32U numDescs, Cpa64U *passBitmap)
+{
+    Cpa32U descIdx = 0;
+
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        if (0 == descIdx % 64)
+        {
+            passBitmap[descIdx / 64] = 0;
+        }
+        if (CPA_STATUS_SUCCESS == descs[descIdx].status && 0 == (descs[descIdx].flags & RING_DESC_VERIFY_FAILED))
+        {
+            passBitmap[descIdx / 64] |= 1ULL << (descIdx % 64);
+        }
+    }
+}
+
+/*
+ * Single producer, single consumer ring of descriptors. Head and tail are free running and live on their own
+ * cache lines; the ring may be placed in memory shared between processes.
+ */
+typedef struct _DescRing {
+    Cpa32U head __attribute__((aligned(RING_CACHE_LINE)));
+    Cpa32U tail __attribute__((aligned(RING_CACHE_LINE)));
+    Cpa32U size __attribute__((aligned(RING_CACHE_LINE)));
+    Cpa32U mask;
+    PdcpDesc descs[] __attribute__((aligned(RING_CACHE_LINE)));
+} DescRing;
+
+#define RING_MEM_SIZE(size) (sizeof(DescRing) + (size) * sizeof(PdcpDesc))
+
+/* size must be a power of two */
+static inline void ringInit(DescRing *ring, Cpa32U size)
+{
+    memset(ring, 0, RING_MEM_SIZE(size));
+    ring->size = size;
+    ring->mask = size - 1;
+}
+
+static inline Cpa32U ringCount(const DescRing *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+static inline Cpa32U ringEnqueueBurst(DescRing *ring, const PdcpDesc *descs, Cpa32U numDescs)
+{
+    Cpa32U head = ring->head;
+    Cpa32U tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    Cpa32U numFree = ring->size - (head - tail);
+    Cpa32U descIdx = 0;
+
+    if (numDescs > numFree)
+    {
+        numDescs = numFree;
+    }
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        ring->descs[(head + descIdx) & ring->mask] = descs[descIdx];
+    }
+    __atomic_store_n(&ring->head, head + numDescs, __ATOMIC_RELEASE);
+
+    return numDescs;
+}
+
+static inline Cpa32U ringDequeueBurst(DescRing *ring, PdcpDesc *descs, Cpa32U maxDescs)
+{
+    Cpa32U tail = ring->tail;
+    Cpa32U head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    Cpa32U numDescs = head - tail;
+    Cpa32U descIdx = 0;
+
+    if (numDescs > maxDescs)
+    {
+        numDescs = maxDescs;
+    }
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        descs[descIdx] = ring->descs[(tail + descIdx) & ring->mask];
+    }
+    __atomic_store_n(&ring->tail, tail + numDescs, __ATOMIC_RELEASE);
+
+    return numDescs;
+}
+
+/* Look at the oldest descriptors without consuming them, ringConsume() then releases what was taken */
+static inline Cpa32U ringPeekBurst(DescRing *ring, PdcpDesc *descs, Cpa32U maxDescs)
+{
+    Cpa32U tail = ring->tail;
+    Cpa32U head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    Cpa32U numDescs = head - tail;
+    Cpa32U descIdx = 0;
+
+    if (numDescs > maxDescs)
+    {
+        numDescs = maxDescs;
+    }
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        descs[descIdx] = ring->descs[(tail + descIdx) & ring->mask];
+    }
+
+    return numDescs;
+}
+
+static inline void ringConsume(DescRing *ring, Cpa32U numDescs)
+{
+    __atomic_store_n(&ring->tail, ring->tail + numDescs, __ATOMIC_RELEASE);
+}
+
+#endif
@@ -0,0 +1,410 @@
+/*
+ * Session lifecycle with deferred retirement.
+ *
+ * Removing a session requires that no request is in flight on it. Rather than spinning on
+ * cpaCySymSessionInUse() in the thread that drops the session, retireSession() only pushes the session onto a
+ * lock-free list of its instance and returns. The thread that polls the instance calls reclaimRetiredSessions()
+ * (through pollInstance()) and removes every retired session of that instance whose outstanding requests have
+ * completed, so a session is only ever removed by a poller of its own instance.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+#include "cpa_sample_utils.h"
+#include "icp_sal_poll.h"
+
+#include "session.h"
+#include "utils.h"
+
+typedef struct _RetiredSession {
+    CpaInstanceHandle cyInstHandle;
+    CpaCySymSessionCtx sessionCtx;
+    struct _RetiredSession *next;
+} RetiredSession;
+
+/*
+ * Sessions of one instance waiting for their in-flight requests to complete, pushed by any thread. A slot is
+ * claimed by the first session retired on the instance and keeps it for good.
+ */
+typedef struct _RetiredList {
+    CpaInstanceHandle cyInstHandle;
+    RetiredSession *head;
+    Cpa32U numRetired;
+} RetiredList;
+
+static RetiredList retired_g[MAX_INSTANCES];
+
+/*
+ * Pre-allocated session contexts, one slab per NUMA node so that a session lives next to its instance. Free
+ * entries are linked through their first word.
+ */
+typedef struct _CtxSlab {
+    Cpa8U *slab;
+    Cpa32U slabSize;
+    Cpa32U ctxSize;
+    void *freeCtxs;
+} CtxSlab;
+
+static CtxSlab ctxSlabs_g[MAX_NODES];
+static pthread_mutex_t ctxLock_g = PTHREAD_MUTEX_INITIALIZER;
+
+static CpaStatus allocSessionCtx(CpaCySymSessionCtx *sessionCtx, Cpa32U sessionCtxSize, Cpa32U node)
+{
+    CtxSlab *ctxSlab = &ctxSlabs_g[node];
+
+    *sessionCtx = NULL;
+    if (sessionCtxSize <= ctxSlab->ctxSize)
+    {
+        pthread_mutex_lock(&ctxLock_g);
+        if (NULL != ctxSlab->freeCtxs)
+        {
+            *sessionCtx = ctxSlab->freeCtxs;
+            ctxSlab->freeCtxs = *(void **)ctxSlab->freeCtxs;
+        }
+        pthread_mutex_unlock(&ctxLock_g);
+    }
+    if (NULL == *sessionCtx)
+    {
+        return memAllocContigNode((void *)sessionCtx, sessionCtxSize, BYTE_ALIGNMENT, node);
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+static void freeSessionCtx(CpaCySymSessionCtx *sessionCtx)
+{
+    Cpa8U *ctx = (Cpa8U *)*sessionCtx;
+    CtxSlab *ctxSlab = NULL;
+    Cpa32U node = 0;
+
+    for (node = 0; node < MAX_NODES; node++)
+    {
+        ctxSlab = &ctxSlabs_g[node];
+        if (NULL != ctxSlab->slab && ctx >= ctxSlab->slab && ctx < ctxSlab->slab + ctxSlab->slabSize)
+        {
+            pthread_mutex_lock(&ctxLock_g);
+            *(void **)ctx = ctxSlab->freeCtxs;
+            ctxSlab->freeCtxs = ctx;
+            pthread_mutex_unlock(&ctxLock_g);
+            *sessionCtx = NULL;
+            return;
+        }
+    }
+    memFreeContig((void *)sessionCtx);
+}
+
+/*
+ * The retired list of the instance, claiming a free slot for it when create is set. NULL when there is none.
+ */
+static RetiredList *findRetiredList(CpaInstanceHandle cyInstHandle, CpaBoolean create)
+{
+    CpaInstanceHandle slotHandle = NULL;
+    Cpa32U listIdx = 0;
+
+    for (listIdx = 0; listIdx < MAX_INSTANCES; listIdx++)
+    {
+        slotHandle = __atomic_load_n(&retired_g[listIdx].cyInstHandle, __ATOMIC_ACQUIRE);
+        if (NULL == slotHandle && CPA_TRUE == create)
+        {
+            __atomic_compare_exchange_n(&retired_g[listIdx].cyInstHandle,
+                                        &slotHandle,
+                                        cyInstHandle,
+                                        CPA_FALSE,
+                                        __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE);
+            /* Claimed here or by another thread, possibly for this very instance */
+            slotHandle = __atomic_load_n(&retired_g[listIdx].cyInstHandle, __ATOMIC_ACQUIRE);
+        }
+        if (NULL == slotHandle)
+        {
+            return NULL;
+        }
+        if (cyInstHandle == slotHandle)
+        {
+            return &retired_g[listIdx];
+        }
+    }
+    return NULL;
+}
+
+static void pushRetired(RetiredList *list, RetiredSession *first, RetiredSession *last)
+{
+    RetiredSession *head = __atomic_load_n(&list->head, __ATOMIC_RELAXED);
+
+    do
+    {
+        last->next = head;
+    } while (!__atomic_compare_exchange_n(&list->head, &head, first, CPA_TRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static void removeSession(CpaInstanceHandle cyInstHandle, CpaCySymSessionCtx *sessionCtx)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+
+    stat = cpaCySymRemoveSession(cyInstHandle, *sessionCtx);
+    CHECK_ERR_STATUS("cpaCySymRemoveSession", stat);
+    freeSessionCtx(sessionCtx);
+}
+
+/*
+ * Remove the session in the calling thread, polling its instance until no request is left on it. Only for
+ * when it cannot be retired.
+ */
+static void removeSessionBlocking(CpaInstanceHandle cyInstHandle, CpaCySymSessionCtx sessionCtx)
+{
+    CpaBoolean sessionInUse = CPA_FALSE;
+    Cpa32U waitMs = 0;
+
+    for (waitMs = 0; SESSION_DRAIN_TIMEOUT_MS > waitMs; waitMs++)
+    {
+        if (CPA_STATUS_SUCCESS != cpaCySymSessionInUse(sessionCtx, &sessionInUse) || CPA_TRUE != sessionInUse)
+        {
+            break;
+        }
+        icp_sal_CyPollInstance(cyInstHandle, 0);
+        OS_SLEEP(1);
+    }
+    if (SESSION_DRAIN_TIMEOUT_MS <= waitMs)
+    {
+        PRINT_ERR("Session %p still in use after %u ms, removed anyway\n", sessionCtx, SESSION_DRAIN_TIMEOUT_MS);
+    }
+    removeSession(cyInstHandle, &sessionCtx);
+}
+
+CpaStatus createSession(CpaInstanceHandle cyInstHandle,
+                        CpaCySymCbFunc symCallback,
+                        CpaCySymSessionSetupData *sessionSetupData,
+                        CpaCySymSessionCtx *sessionCtx)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Cpa32U sessionCtxSize = 0;
+
+    PRINT_DBG("cpaCySymSessionCtxGetSize()\n");
+    stat = cpaCySymSessionCtxGetSize(cyInstHandle, sessionSetupData, &sessionCtxSize);
+    CHECK_ERR_STATUS("cpaCySymSessionCtxGetSize", stat);
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = allocSessionCtx(sessionCtx, sessionCtxSize, getInstanceNode(cyInstHandle));
+        CHECK_ERR_STATUS("allocSessionCtx", stat);
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        PRINT_DBG("cpaCySymInitSession()\n");
+        stat = cpaCySymInitSession(cyInstHandle, symCallback, sessionSetupData, *sessionCtx);
+        CHECK_ERR_STATUS("cpaCySymInitSession", stat);
+        if (CPA_STATUS_SUCCESS != stat)
+        {
+            freeSessionCtx(sessionCtx);
+        }
+    }
+
+    return stat;
+}
+
+CpaStatus prewarmSessionCtxs(Cpa32U node, Cpa32U numSessions, Cpa32U sessionCtxSize)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    CtxSlab *ctxSlab = &ctxSlabs_g[node];
+    Cpa32U ctxIdx = 0;
+
+    if (NULL != ctxSlab->slab)
+    {
+        return CPA_STATUS_SUCCESS;
+    }
+
+    /* Keep every context on its own cache lines */
+    sessionCtxSize = (sessionCtxSize + BYTE_ALIGNMENT - 1) & ~(BYTE_ALIGNMENT - 1);
+
+    stat = memAllocContigNode((void *)&ctxSlab->slab, numSessions * sessionCtxSize, BYTE_ALIGNMENT, node);
+    CHECK_ERR_STATUS("memAllocContigNode", stat);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+
+    ctxSlab->slabSize = numSessions * sessionCtxSize;
+    ctxSlab->ctxSize = sessionCtxSize;
+    for (ctxIdx = numSessions; ctxIdx > 0; ctxIdx--)
+    {
+        *(void **)(ctxSlab->slab + (ctxIdx - 1) * sessionCtxSize) = ctxSlab->freeCtxs;
+        ctxSlab->freeCtxs = ctxSlab->slab + (ctxIdx - 1) * sessionCtxSize;
+    }
+    PRINT_DBG("Pre-allocated %u session contexts of %u bytes on node %u\n", numSessions, sessionCtxSize, node);
+
+    return CPA_STATUS_SUCCESS;
+}
+
+void freeSessionCtxs(void)
+{
+    Cpa32U node = 0;
+
+    for (node = 0; node < MAX_NODES; node++)
+    {
+        ctxSlabs_g[node].freeCtxs = NULL;
+        ctxSlabs_g[node].ctxSize = 0;
+        ctxSlabs_g[node].slabSize = 0;
+        memFreeContig((void *)&ctxSlabs_g[node].slab);
+    }
+}
+
+CpaStatus rekeySession(CpaInstanceHandle cyInstHandle,
+                       CpaCySymCbFunc symCallback,
+                       CpaCySymSessionSetupData *sessionSetupData,
+                       CpaCySymSessionCtx *sessionCtx)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    CpaCySymSessionCtx newSessionCtx = NULL;
+    CpaCySymSessionCtx oldSessionCtx = NULL;
+
+    stat = createSession(cyInstHandle, symCallback, sessionSetupData, &newSessionCtx);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        /* New requests pick up the new session at once, the old one drains in the background */
+        oldSessionCtx = __atomic_exchange_n(sessionCtx, newSessionCtx, __ATOMIC_ACQ_REL);
+        if (NULL != oldSessionCtx)
+        {
+            retireSession(cyInstHandle, oldSessionCtx);
+        }
+    }
+
+    return stat;
+}
+
+void retireSession(CpaInstanceHandle cyInstHandle, CpaCySymSessionCtx sessionCtx)
+{
+    RetiredSession *retired = NULL;
+    RetiredList *list = findRetiredList(cyInstHandle, CPA_TRUE);
+
+    if (NULL == list || CPA_STATUS_SUCCESS != memAllocOs((void *)&retired, sizeof(RetiredSession)))
+    {
+        PRINT_ERR("Failed to retire session %p, removing it now\n", sessionCtx);
+        removeSessionBlocking(cyInstHandle, sessionCtx);
+        return;
+    }
+    retired->cyInstHandle = cyInstHandle;
+    retired->sessionCtx = sessionCtx;
+
+    __atomic_add_fetch(&list->numRetired, 1, __ATOMIC_RELAXED);
+    pushRetired(list, retired, retired);
+}
+
+Cpa32U reclaimRetiredSessions(CpaInstanceHandle cyInstHandle)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    RetiredList *list = findRetiredList(cyInstHandle, CPA_FALSE);
+    RetiredSession *retired = NULL;
+    RetiredSession *next = NULL;
+    RetiredSession *busyFirst = NULL;
+    RetiredSession *busyLast = NULL;
+    CpaBoolean sessionInUse = CPA_FALSE;
+    Cpa32U numReclaimed = 0;
+
+    if (NULL == list || NULL == __atomic_load_n(&list->head, __ATOMIC_RELAXED))
+    {
+        return 0;
+    }
+
+    /* Take the whole list so that concurrent pollers of the instance never see the same entry */
+    retired = __atomic_exchange_n(&list->head, NULL, __ATOMIC_ACQUIRE);
+    for (; NULL != retired; retired = next)
+    {
+        next = retired->next;
+
+        sessionInUse = CPA_FALSE;
+        stat = cpaCySymSessionInUse(retired->sessionCtx, &sessionInUse);
+        if (CPA_STATUS_SUCCESS != stat)
+        {
+            /* The driver cannot tell, keeping the session would park it for good */
+            PRINT_ERR("cpaCySymSessionInUse() failed on session %p (status %d), removing it\n",
+                      retired->sessionCtx,
+                      stat);
+        }
+        else if (CPA_TRUE == sessionInUse)
+        {
+            retired->next = busyFirst;
+            busyFirst = retired;
+            if (NULL == busyLast)
+            {
+                busyLast = retired;
+            }
+            continue;
+        }
+
+        removeSession(retired->cyInstHandle, &retired->sessionCtx);
+        memFreeOs((void *)&retired);
+        numReclaimed++;
+    }
+
+    if (NULL != busyFirst)
+    {
+        pushRetired(list, busyFirst, busyLast);
+    }
+    if (0 < numReclaimed)
+    {
+        __atomic_sub_fetch(&list->numRetired, numReclaimed, __ATOMIC_RELAXED);
+    }
+
+    return numReclaimed;
+}
+
+Cpa32U numRetiredSessions(CpaInstanceHandle cyInstHandle)
+{
+    RetiredList *list = NULL;
+    Cpa32U numRetired = 0;
+    Cpa32U listIdx = 0;
+
+    if (NULL != cyInstHandle)
+    {
+        list = findRetiredList(cyInstHandle, CPA_FALSE);
+        return (NULL != list) ? __atomic_load_n(&list->numRetired, __ATOMIC_RELAXED) : 0;
+    }
+    for (listIdx = 0; listIdx < MAX_INSTANCES; listIdx++)
+    {
+        numRetired += __atomic_load_n(&retired_g[listIdx].numRetired, __ATOMIC_RELAXED);
+    }
+    return numRetired;
+}
+
+CpaStatus drainRetiredSessions(CpaInstanceHandle cyInstHandle)
+{
+    Cpa32U waitMs = 0;
+
+    PRINT_DBG("Wait for the completion of outstanding requests on %u retired sessions\n",
+              numRetiredSessions(cyInstHandle));
+    for (waitMs = 0; 0 < numRetiredSessions(cyInstHandle) && SESSION_DRAIN_TIMEOUT_MS > waitMs; waitMs++)
+    {
+        pollInstance(cyInstHandle);
+        if (0 < numRetiredSessions(cyInstHandle))
+        {
+            OS_SLEEP(1);
+        }
+    }
+    if (0 < numRetiredSessions(cyInstHandle))
+    {
+        PRINT_ERR("%u retired sessions still have requests in flight after %u ms\n",
+                  numRetiredSessions(cyInstHandle),
+                  SESSION_DRAIN_TIMEOUT_MS);
+        return CPA_STATUS_RETRY;
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus pollInstance(CpaInstanceHandle cyInstHandle)
+{
+    return pollInstanceQuota(cyInstHandle, 0);
+}
+
+CpaStatus pollInstanceQuota(CpaInstanceHandle cyInstHandle, Cpa32U quota)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+
+    stat = icp_sal_CyPollInstance(cyInstHandle, quota);
+    reclaimRetiredSessions(cyInstHandle);
+
+    return stat;
+}
@@ -0,0 +1,39 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+
+/*
+ ********************
+ * Session lifecycle
+ ********************
+ */
+CpaStatus createSession(CpaInstanceHandle cyInstHandle,
+                        CpaCySymCbFunc symCallback,
+                        CpaCySymSessionSetupData *sessionSetupData,
+                        CpaCySymSessionCtx *sessionCtx);
+CpaStatus prewarmSessionCtxs(Cpa32U node, Cpa32U numSessions, Cpa32U sessionCtxSize);
+void freeSessionCtxs(void);
+
+CpaStatus rekeySession(CpaInstanceHandle cyInstHandle,
+                       CpaCySymCbFunc symCallback,
+                       CpaCySymSessionSetupData *sessionSetupData,
+                       CpaCySymSessionCtx *sessionCtx);
+
+/* Longest drainRetiredSessions() waits for the requests of the retired sessions of an instance */
+#define SESSION_DRAIN_TIMEOUT_MS 1000
+
+void retireSession(CpaInstanceHandle cyInstHandle, CpaCySymSessionCtx sessionCtx);
+/* Remove the retired sessions of the instance that have no request in flight any more */
+Cpa32U reclaimRetiredSessions(CpaInstanceHandle cyInstHandle);
+/* Retired sessions of the instance not removed yet, of all instances for NULL */
+Cpa32U numRetiredSessions(CpaInstanceHandle cyInstHandle);
+/* Poll the instance until its retired sessions are removed, CPA_STATUS_RETRY on timeout */
+CpaStatus drainRetiredSessions(CpaInstanceHandle cyInstHandle);
+
+CpaStatus pollInstance(CpaInstanceHandle cyInstHandle);
+/* Handle up to quota responses, 0 for all */
+CpaStatus pollInstanceQuota(CpaInstanceHandle cyInstHandle, Cpa32U quota);
+
+#endif
@@ -0,0 +1,323 @@
+/*
+ * Sampled shadow verification.
+ *
+ * A configurable fraction of the ops going through the engine is recomputed on the software engine (sw/) and
+ * compared with what the device returned. The data path only copies a sampled request into a free slot before
+ * submission and its result into the same slot on completion; the slot is then handed to a background thread
+ * running at idle priority, which does the actual work. Slots change hands through an atomic state and a
+ * semaphore, so the data path takes no lock: when no slot is free or the request does not fit, the sample is
+ * dropped and counted. The cost is thus bounded by the sample rate and the SHADOW_NUM_SLOTS copies in flight,
+ * whatever the checker keeps up with.
+ *
+ * A mismatch bumps a counter reported with the engine stats and raises an alarm on the log.
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+#include "cpa_sample_utils.h"
+
+#include "shadow.h"
+#include "sw_crypto.h"
+#include "utils.h"
+
+enum
+{
+    SLOT_FREE = 0,
+    SLOT_CAPTURED, /* owned by an op in flight */
+    SLOT_PENDING,  /* completed, waiting for the checker */
+};
+
+static ShadowSlot *slots_g = NULL;
+static Cpa32U nextSlot_g = 0;
+static sem_t pendingSem_g;
+static pthread_t thread_g;
+static volatile CpaBoolean running_g = CPA_FALSE;
+static Cpa32U sampleRate_g = 0;
+static ShadowStats stats_g = {0};
+/* Ops the calling thread completes before its next sample, so that ops not sampled write nothing shared */
+static __thread Cpa32U untilSample_t = 0;
+
+/*
+ * Gather a buffer list into one contiguous copy, 0 when it does not fit
+ */
+static Cpa32U gatherBuffers(const CpaBufferList *bufferList, Cpa8U *dst)
+{
+    Cpa32U length = 0;
+    Cpa32U bufferIdx = 0;
+
+    for (bufferIdx = 0; bufferIdx < bufferList->numBuffers; bufferIdx++)
+    {
+        if (SHADOW_MAX_DATA_SIZE - length < bufferList->pBuffers[bufferIdx].dataLenInBytes)
+        {
+            return 0;
+        }
+        memcpy(dst + length, bufferList->pBuffers[bufferIdx].pData, bufferList->pBuffers[bufferIdx].dataLenInBytes);
+        length += bufferList->pBuffers[bufferIdx].dataLenInBytes;
+    }
+    return length;
+}
+
+/*
+ * Claim a free slot, looking at every slot at most once from where the last search ended
+ */
+static ShadowSlot *claimSlot(void)
+{
+    Cpa32U start = __atomic_fetch_add(&nextSlot_g, 1, __ATOMIC_RELAXED);
+    Cpa32U expected = SLOT_FREE;
+    Cpa32U slotIdx = 0;
+    ShadowSlot *slot = NULL;
+
+    for (slotIdx = 0; slotIdx < SHADOW_NUM_SLOTS; slotIdx++)
+    {
+        slot = &slots_g[(start + slotIdx) % SHADOW_NUM_SLOTS];
+        expected = SLOT_FREE;
+        if (__atomic_compare_exchange_n(
+                &slot->state, &expected, SLOT_CAPTURED, CPA_FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+static void raiseAlarm(const ShadowSlot *slot, const char *what)
+{
+    Cpa64U numMismatches = __atomic_add_fetch(&stats_g.numMismatches, 1, __ATOMIC_RELAXED);
+
+    if (SHADOW_ALARM_BURST >= numMismatches || 0 == numMismatches % SHADOW_ALARM_INTERVAL)
+    {
+        PRINT_ERR("Shadow check: %s mismatch on %s, COUNT 0x%08x bearer %u dir %u length %u (%llu so far)\n",
+                  what,
+                  slot->algoDesc->name,
+                  slot->opDesc.count,
+                  slot->opDesc.bearer,
+                  slot->opDesc.dir,
+                  slot->opDesc.bitLen / 8,
+                  (unsigned long long)numMismatches);
+    }
+}
+
+/*
+ * Recompute the request on a copy of its input and compare with the device output: the transformed message
+ * for a cipher, the MAC for a hash, or the MAC-I verdict for a verifying session
+ */
+static void checkSlot(ShadowSlot *slot)
+{
+    CpaCySymSessionSetupData sessionSetupData = {0};
+    CpaCySymOpData opData = {0};
+    SwSession swSession;
+    Cpa8U iv[32] = {0};
+    Cpa8U mac[SW_MAX_DIGEST_SIZE] = {0};
+    Cpa32U macOffset = 0;
+    CpaBoolean expectedResult = CPA_FALSE;
+
+    slot->params.key = slot->key;
+    slot->algoDesc->setupSession(&slot->params, &sessionSetupData);
+    if (CPA_STATUS_SUCCESS != swInitSession(&swSession, &sessionSetupData))
+    {
+        /* Not an algorithm the software engine knows, nothing to compare with */
+        __atomic_add_fetch(&stats_g.numSkipped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    slot->opDesc.ivSize = (Cpa8U)buildIv(&slot->opDesc, iv);
+    slot->algoDesc->fillOpData(&slot->opDesc, NULL, iv, mac, &opData);
+    if (CPA_STATUS_SUCCESS != swProcess(&swSession, &opData, slot->input, mac))
+    {
+        __atomic_add_fetch(&stats_g.numSkipped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    __atomic_add_fetch(&stats_g.numChecked, 1, __ATOMIC_RELAXED);
+
+    if (CPA_CY_SYM_OP_CIPHER == sessionSetupData.symOperation)
+    {
+        if (0 != memcmp(slot->input + opData.cryptoStartSrcOffsetInBytes,
+                        slot->output + opData.cryptoStartSrcOffsetInBytes,
+                        opData.messageLenToCipherInBytes))
+        {
+            raiseAlarm(slot, "cipher");
+        }
+        return;
+    }
+
+    if (CPA_TRUE == slot->verifyDigest)
+    {
+        macOffset = opData.hashStartSrcOffsetInBytes + opData.messageLenToHashInBytes;
+        expectedResult = (slot->length >= macOffset + slot->params.outSize &&
+                          0 == memcmp(mac, slot->input + macOffset, slot->params.outSize))
+                             ? CPA_TRUE
+                             : CPA_FALSE;
+        if (expectedResult != slot->verifyResult)
+        {
+            raiseAlarm(slot, "MAC-I verify");
+        }
+    }
+    else if (0 != memcmp(mac, slot->digest, slot->params.outSize))
+    {
+        raiseAlarm(slot, "MAC");
+    }
+}
+
+static void *shadowThread(void *arg)
+{
+    struct sched_param schedParam = {0};
+    Cpa32U slotIdx = 0;
+
+    /* Only run on otherwise idle cycles */
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &schedParam);
+
+    while (CPA_TRUE == running_g)
+    {
+        sem_wait(&pendingSem_g);
+        for (slotIdx = 0; slotIdx < SHADOW_NUM_SLOTS; slotIdx++)
+        {
+            if (SLOT_PENDING == __atomic_load_n(&slots_g[slotIdx].state, __ATOMIC_ACQUIRE))
+            {
+                checkSlot(&slots_g[slotIdx]);
+                __atomic_store_n(&slots_g[slotIdx].state, SLOT_FREE, __ATOMIC_RELEASE);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+CpaStatus shadowStart(Cpa32U sampleRate)
+{
+    if (0 == sampleRate || CPA_TRUE == running_g)
+    {
+        return CPA_STATUS_SUCCESS;
+    }
+
+    slots_g = calloc(SHADOW_NUM_SLOTS, sizeof(ShadowSlot));
+    if (NULL == slots_g)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+    sem_init(&pendingSem_g, 0, 0);
+    memset(&stats_g, 0, sizeof(stats_g));
+
+    running_g = CPA_TRUE;
+    if (0 != pthread_create(&thread_g, NULL, shadowThread, NULL))
+    {
+        running_g = CPA_FALSE;
+        sem_destroy(&pendingSem_g);
+        free(slots_g);
+        slots_g = NULL;
+        return CPA_STATUS_FAIL;
+    }
+    __atomic_store_n(&sampleRate_g, sampleRate, __ATOMIC_RELEASE);
+    PRINT("Shadow checking 1 in %u ops on the software engine\n", sampleRate);
+
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ * Called once no completion can come in any more, samples still pending are not checked
+ */
+void shadowStop(void)
+{
+    if (CPA_TRUE != running_g)
+    {
+        return;
+    }
+
+    __atomic_store_n(&sampleRate_g, 0, __ATOMIC_RELEASE);
+    running_g = CPA_FALSE;
+    sem_post(&pendingSem_g);
+    pthread_join(thread_g, NULL);
+    sem_destroy(&pendingSem_g);
+
+    PRINT("Shadow checked %llu ops, %llu mismatches, %llu skipped\n",
+          (unsigned long long)stats_g.numChecked,
+          (unsigned long long)stats_g.numMismatches,
+          (unsigned long long)stats_g.numSkipped);
+    free(slots_g);
+    slots_g = NULL;
+}
+
+void shadowGetStats(ShadowStats *stats)
+{
+    stats->numChecked = __atomic_load_n(&stats_g.numChecked, __ATOMIC_RELAXED);
+    stats->numMismatches = __atomic_load_n(&stats_g.numMismatches, __ATOMIC_RELAXED);
+    stats->numSkipped = __atomic_load_n(&stats_g.numSkipped, __ATOMIC_RELAXED);
+}
+
+ShadowSlot *shadowCapture(const AlgoDesc *algoDesc,
+                          const TestData *params,
+                          const OpDesc *opDesc,
+                          CpaBoolean verifyDigest,
+                          const CpaBufferList *bufferList)
+{
+    Cpa32U sampleRate = __atomic_load_n(&sampleRate_g, __ATOMIC_ACQUIRE);
+    ShadowSlot *slot = NULL;
+
+    if (0 == sampleRate)
+    {
+        return NULL;
+    }
+    /* Restarts on every sample, and on a lower rate than the one it was counting down from */
+    if (0 == untilSample_t || sampleRate < untilSample_t)
+    {
+        untilSample_t = sampleRate;
+    }
+    if (0 != --untilSample_t)
+    {
+        return NULL;
+    }
+
+    slot = claimSlot();
+    if (NULL == slot)
+    {
+        __atomic_add_fetch(&stats_g.numSkipped, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    slot->length = gatherBuffers(bufferList, slot->input);
+    if (0 == slot->length || SHADOW_MAX_KEY_SIZE < params->keySize || SHADOW_MAX_DIGEST_SIZE < params->outSize)
+    {
+        __atomic_store_n(&slot->state, SLOT_FREE, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&stats_g.numSkipped, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    slot->algoDesc = algoDesc;
+    slot->params = *params;
+    slot->opDesc = *opDesc;
+    memcpy(slot->key, params->key, params->keySize);
+    slot->verifyDigest = verifyDigest;
+
+    return slot;
+}
+
+void shadowComplete(ShadowSlot *slot,
+                    CpaStatus status,
+                    const CpaBufferList *bufferList,
+                    const Cpa8U *digest,
+                    CpaBoolean verifyResult)
+{
+    if (CPA_STATUS_SUCCESS != status)
+    {
+        __atomic_store_n(&slot->state, SLOT_FREE, __ATOMIC_RELEASE);
+        return;
+    }
+
+    if (CPA_CY_SYM_OP_CIPHER == slot->opDesc.op)
+    {
+        gatherBuffers(bufferList, slot->output);
+    }
+    else if (CPA_TRUE != slot->verifyDigest)
+    {
+        memcpy(slot->digest, digest, slot->params.outSize);
+    }
+    slot->verifyResult = verifyResult;
+
+    __atomic_store_n(&slot->state, SLOT_PENDING, __ATOMIC_RELEASE);
+    sem_post(&pendingSem_g);
+}
@@ -0,0 +1,65 @@
+#ifndef SHADOW_H
+#define SHADOW_H
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+
+#include "algo.h"
+#include "utils.h"
+
+#define SHADOW_NUM_SLOTS 64
+#define SHADOW_MAX_KEY_SIZE 32
+#define SHADOW_MAX_DIGEST_SIZE 16
+#define SHADOW_MAX_DATA_SIZE (64 + 9216 + SHADOW_MAX_DIGEST_SIZE)
+/* Mismatches logged one by one before only every SHADOW_ALARM_INTERVAL-th is */
+#define SHADOW_ALARM_BURST 16
+#define SHADOW_ALARM_INTERVAL 1024
+
+/*
+ * Copy of one sampled op: the request as submitted and what the device made of it. Slots are pre-allocated,
+ * the data path only ever copies into them.
+ */
+typedef struct _ShadowSlot {
+    const AlgoDesc *algoDesc;
+    TestData params; /* of the session */
+    OpDesc opDesc;
+    Cpa8U key[SHADOW_MAX_KEY_SIZE];
+    CpaBoolean verifyDigest;
+    Cpa32U length;
+    Cpa8U input[SHADOW_MAX_DATA_SIZE];
+    Cpa8U output[SHADOW_MAX_DATA_SIZE];
+    Cpa8U digest[SHADOW_MAX_DIGEST_SIZE];
+    CpaBoolean verifyResult;
+    Cpa32U state;
+} ShadowSlot;
+
+typedef struct _ShadowStats {
+    Cpa64U numChecked;
+    Cpa64U numMismatches;
+    Cpa64U numSkipped; /* sampled but dropped, no free slot or too long */
+} ShadowStats;
+
+/*
+ * Recompute 1 in sampleRate completed ops on the software engine in a background thread, 0 turns checking off
+ */
+CpaStatus shadowStart(Cpa32U sampleRate);
+void shadowStop(void);
+void shadowGetStats(ShadowStats *stats);
+
+/*
+ * Data path side, never blocks. shadowCapture() returns a slot holding the input of the request when the op
+ * is sampled, NULL otherwise; every slot goes back through shadowComplete() once the op completed or failed
+ * to submit.
+ */
+ShadowSlot *shadowCapture(const AlgoDesc *algoDesc,
+                          const TestData *params,
+                          const OpDesc *opDesc,
+                          CpaBoolean verifyDigest,
+                          const CpaBufferList *bufferList);
+void shadowComplete(ShadowSlot *slot,
+                    CpaStatus status,
+                    const CpaBufferList *bufferList,
+                    const Cpa8U *digest,
+                    CpaBoolean verifyResult);
+
+#endif
@@ -0,0 +1,292 @@
+/*
+ * Streaming mode for messages larger than a single request.
+ *
+ * A message is fed through any number of streamUpdate() calls and cut into chunks of a fixed size, each sent
+ * as a CPA_CY_SYM_PACKET_TYPE_PARTIAL request on one session; streamFinal() sends the remainder as
+ * CPA_CY_SYM_PACKET_TYPE_LAST_PARTIAL and returns the digest. QAT carries the cipher and hash state from one
+ * partial to the next, so the partials of a stream are processed one at a time. Chunks go through two pinned
+ * windows: one is filled while the other is in flight, and cipher output is handed to the sink as each window
+ * completes. Memory use is two chunks whatever the size of the message.
+ */
+
+#include <string.h>
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+#include "cpa_sample_utils.h"
+
+#include "session.h"
+#include "stream.h"
+#include "utils.h"
+
+/* Partials other than the last one must hold whole cipher and MAC blocks */
+#define STREAM_BLOCK_SIZE 16
+
+static void streamCallback(void *callbackTag,
+                           CpaStatus status,
+                           const CpaCySymOp operationType,
+                           void *opData,
+                           CpaBufferList *dstBuffer,
+                           CpaBoolean verifyResult)
+{
+    StreamWindow *window = (StreamWindow *)callbackTag;
+
+    window->status = status;
+    __atomic_store_n(&window->done, 1, __ATOMIC_RELEASE);
+}
+
+static CpaBoolean isPartialSupported(CpaInstanceHandle cyInstHandle, const AlgoDesc *algoDesc)
+{
+    CpaCySymCapabilitiesInfo capInfo = {0};
+
+    if (CPA_STATUS_SUCCESS != cpaCySymQueryCapabilities(cyInstHandle, &capInfo) ||
+        CPA_TRUE != capInfo.partialPacketSupported)
+    {
+        return CPA_FALSE;
+    }
+
+    /* The wireless algorithms keep no state across requests, only the AES based paths can stream */
+    if (CPA_CY_SYM_OP_CIPHER == algoDesc->op)
+    {
+        return (CPA_CY_SYM_CIPHER_AES_CTR == algoDesc->cipherAlgo || CPA_CY_SYM_CIPHER_AES_CBC == algoDesc->cipherAlgo)
+                   ? CPA_TRUE
+                   : CPA_FALSE;
+    }
+    return (CPA_CY_SYM_HASH_AES_CMAC == algoDesc->hashAlgo) ? CPA_TRUE : CPA_FALSE;
+}
+
+/*
+ * Wait for a window to come back and pass its output on
+ */
+static CpaStatus completeWindow(StreamCtx *ctx, StreamWindow *window)
+{
+    if (CPA_TRUE != window->inflight)
+    {
+        return CPA_STATUS_SUCCESS;
+    }
+
+    while (0 == __atomic_load_n(&window->done, __ATOMIC_ACQUIRE))
+    {
+        pollInstance(ctx->cyInstHandle);
+    }
+    window->inflight = CPA_FALSE;
+
+    if (CPA_STATUS_SUCCESS == window->status && CPA_CY_SYM_OP_CIPHER == ctx->params.op && NULL != ctx->sink)
+    {
+        ctx->sink(ctx->sinkArg, window->data, window->fill);
+    }
+    window->fill = 0;
+
+    return window->status;
+}
+
+/*
+ * Send the current window and switch to the other one, which is free again once this returns
+ */
+static CpaStatus submitWindow(StreamCtx *ctx, CpaCySymPacketType packetType)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    StreamWindow *window = &ctx->windows[ctx->current];
+    StreamWindow *previous = &ctx->windows[ctx->current ^ 1];
+
+    /* State flows from one partial to the next, the previous one has to be done first */
+    stat = completeWindow(ctx, previous);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+
+    ctx->opDesc.inSize = window->fill;
+    window->flatBuffer.pData = window->data;
+    window->flatBuffer.dataLenInBytes = window->fill;
+    ctx->algoDesc->fillOpData(&ctx->opDesc, ctx->sessionCtx, ctx->ivBuffer, ctx->digestBuffer, &window->opData);
+    window->opData.packetType = packetType;
+
+    window->done = 0;
+    window->inflight = CPA_TRUE;
+    do
+    {
+        stat = cpaCySymPerformOp(ctx->cyInstHandle,
+                                 (void *)window,
+                                 &window->opData,
+                                 &window->bufferList,
+                                 &window->bufferList,
+                                 NULL);
+        if (CPA_STATUS_RETRY == stat)
+        {
+            pollInstance(ctx->cyInstHandle);
+        }
+    } while (CPA_STATUS_RETRY == stat);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        PRINT_ERR_STATUS("cpaCySymPerformOp", stat);
+        window->inflight = CPA_FALSE;
+        return stat;
+    }
+
+    ctx->current ^= 1;
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus streamOpen(CpaInstanceHandle cyInstHandle,
+                     const TestData *params,
+                     Cpa32U chunkSize,
+                     StreamSink sink,
+                     void *sinkArg,
+                     StreamCtx *ctx)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    CpaCySymSessionSetupData sessionSetupData = {0};
+    StreamWindow *window = NULL;
+    Cpa32U bufferMetaSize = 0;
+    Cpa32U windowIdx = 0;
+
+    memset(ctx, 0, sizeof(StreamCtx));
+    ctx->cyInstHandle = cyInstHandle;
+    ctx->params = *params;
+    ctx->sink = sink;
+    ctx->sinkArg = sinkArg;
+    ctx->chunkSize = chunkSize;
+
+    ctx->algoDesc = getAlgoDesc(params);
+    if (NULL == ctx->algoDesc)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    if (0 == chunkSize || 0 != chunkSize % STREAM_BLOCK_SIZE)
+    {
+        PRINT_ERR("The chunk size must be a non-zero multiple of %u bytes, not %u\n", STREAM_BLOCK_SIZE, chunkSize);
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    if (CPA_TRUE != isPartialSupported(cyInstHandle, ctx->algoDesc))
+    {
+        PRINT_ERR("Partial packets are not supported for '%s'\n", ctx->algoDesc->name);
+        return CPA_STATUS_UNSUPPORTED;
+    }
+
+    stat = cpaCyBufferListGetMetaSize(cyInstHandle, 1, &bufferMetaSize);
+    CHECK_ERR_STATUS("cpaCyBufferListGetMetaSize", stat);
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = memAllocContig((void *)&ctx->ivBuffer, MAX_IV_SIZE, BYTE_ALIGNMENT);
+        CHECK_ERR_STATUS("memAllocContig", stat);
+    }
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = memAllocContig((void *)&ctx->digestBuffer, BYTE_ALIGNMENT, BYTE_ALIGNMENT);
+        CHECK_ERR_STATUS("memAllocContig", stat);
+    }
+    for (windowIdx = 0; CPA_STATUS_SUCCESS == stat && windowIdx < STREAM_NUM_WINDOWS; windowIdx++)
+    {
+        window = &ctx->windows[windowIdx];
+        stat = memAllocContig((void *)&window->data, ctx->chunkSize, BYTE_ALIGNMENT);
+        CHECK_ERR_STATUS("memAllocContig", stat);
+        if (CPA_STATUS_SUCCESS == stat && 0 < bufferMetaSize)
+        {
+            stat = memAllocContig((void *)&window->bufferMeta, bufferMetaSize, BYTE_ALIGNMENT);
+            CHECK_ERR_STATUS("memAllocContig", stat);
+        }
+        window->bufferList.numBuffers = 1;
+        window->bufferList.pBuffers = &window->flatBuffer;
+        window->bufferList.pPrivateMetaData = window->bufferMeta;
+    }
+
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        sessionSetupData.sessionPriority = CPA_CY_PRIORITY_NORMAL;
+        ctx->algoDesc->setupSession(&ctx->params, &sessionSetupData);
+        stat = createSession(cyInstHandle, streamCallback, &sessionSetupData, &ctx->sessionCtx);
+    }
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        streamClose(ctx);
+        return stat;
+    }
+
+    /* The IV is set once, QAT updates it between partials. 128-NIA2 takes it in front of the message. */
+    opDescInit(&ctx->opDesc, &ctx->params);
+    ctx->opDesc.ivSize = (Cpa8U)buildIv(&ctx->opDesc, ctx->ivBuffer);
+    if (0 < ctx->algoDesc->msgIvPrefixLen)
+    {
+        memcpy(ctx->windows[0].data, ctx->ivBuffer, ctx->algoDesc->msgIvPrefixLen);
+        ctx->windows[0].fill = ctx->algoDesc->msgIvPrefixLen;
+    }
+
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus streamUpdate(StreamCtx *ctx, const Cpa8U *data, Cpa32U length)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    StreamWindow *window = NULL;
+    Cpa32U copyLen = 0;
+
+    while (0 < length)
+    {
+        /* A full window is only sent once more data shows up, so that the last chunk can be marked as such */
+        window = &ctx->windows[ctx->current];
+        if (ctx->chunkSize == window->fill)
+        {
+            stat = submitWindow(ctx, CPA_CY_SYM_PACKET_TYPE_PARTIAL);
+            if (CPA_STATUS_SUCCESS != stat)
+            {
+                return stat;
+            }
+            window = &ctx->windows[ctx->current];
+        }
+
+        copyLen = ctx->chunkSize - window->fill;
+        if (copyLen > length)
+        {
+            copyLen = length;
+        }
+        memcpy(window->data + window->fill, data, copyLen);
+        window->fill += copyLen;
+        ctx->numBytes += copyLen;
+        data += copyLen;
+        length -= copyLen;
+    }
+
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus streamFinal(StreamCtx *ctx, Cpa8U *digest)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+
+    stat = submitWindow(ctx, CPA_CY_SYM_PACKET_TYPE_LAST_PARTIAL);
+    if (CPA_STATUS_SUCCESS == stat)
+    {
+        stat = completeWindow(ctx, &ctx->windows[ctx->current ^ 1]);
+    }
+    if (CPA_STATUS_SUCCESS == stat && CPA_CY_SYM_OP_HASH == ctx->params.op && NULL != digest)
+    {
+        memcpy(digest, ctx->digestBuffer, ctx->params.outSize);
+    }
+
+    return stat;
+}
+
+void streamClose(StreamCtx *ctx)
+{
+    Cpa32U windowIdx = 0;
+
+    for (windowIdx = 0; windowIdx < STREAM_NUM_WINDOWS; windowIdx++)
+    {
+        completeWindow(ctx, &ctx->windows[windowIdx]);
+    }
+    if (NULL != ctx->sessionCtx)
+    {
+        retireSession(ctx->cyInstHandle, ctx->sessionCtx);
+        drainRetiredSessions(ctx->cyInstHandle);
+        ctx->sessionCtx = NULL;
+    }
+    for (windowIdx = 0; windowIdx < STREAM_NUM_WINDOWS; windowIdx++)
+    {
+        memFreeContig((void *)&ctx->windows[windowIdx].data);
+        memFreeContig((void *)&ctx->windows[windowIdx].bufferMeta);
+    }
+    memFreeContig((void *)&ctx->ivBuffer);
+    memFreeContig((void *)&ctx->digestBuffer);
+}
@@ -0,0 +1,61 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+
+#include "algo.h"
+#include "utils.h"
+
+#define STREAM_DEFAULT_CHUNK_SIZE (64 * 1024)
+#define STREAM_NUM_WINDOWS 2
+
+/*
+ * Receives the output of every completed chunk in message order; only ciphers produce output
+ */
+typedef void (*StreamSink)(void *sinkArg, const Cpa8U *data, Cpa32U length);
+
+typedef struct _StreamWindow {
+    Cpa8U *data;
+    Cpa8U *bufferMeta;
+    CpaFlatBuffer flatBuffer;
+    CpaBufferList bufferList;
+    CpaCySymOpData opData;
+    Cpa32U fill;
+    CpaBoolean inflight;
+    Cpa8U done;
+    CpaStatus status;
+} StreamWindow;
+
+typedef struct _StreamCtx {
+    CpaInstanceHandle cyInstHandle;
+    const AlgoDesc *algoDesc;
+    CpaCySymSessionCtx sessionCtx;
+    TestData params;
+    OpDesc opDesc;
+    Cpa32U chunkSize;
+    Cpa8U *ivBuffer;
+    Cpa8U *digestBuffer;
+    StreamSink sink;
+    void *sinkArg;
+    StreamWindow windows[STREAM_NUM_WINDOWS];
+    Cpa32U current; /* window being filled */
+    Cpa64U numBytes;
+} StreamCtx;
+
+/*
+ *************
+ * Stream API
+ *************
+ */
+CpaStatus streamOpen(CpaInstanceHandle cyInstHandle,
+                     const TestData *params,
+                     Cpa32U chunkSize,
+                     StreamSink sink,
+                     void *sinkArg,
+                     StreamCtx *ctx);
+CpaStatus streamUpdate(StreamCtx *ctx, const Cpa8U *data, Cpa32U length);
+CpaStatus streamFinal(StreamCtx *ctx, Cpa8U *digest);
+void streamClose(StreamCtx *ctx);
+
+#endif
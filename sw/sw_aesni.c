@@ -0,0 +1,153 @@
+/*
+ * AES-CTR and AES-CMAC on the AES instructions, for 128 and 256 bit keys alike.
+ *
+ * The table-based AES of sw_crypto.c spends most of a NEA2/NIA2 request in lookups. With AES-NI a round is one
+ * instruction, and counter mode has no dependency between blocks, so eight blocks go through the rounds side by
+ * side and the latency of the instruction is hidden. CMAC chains every block on the previous one and cannot be
+ * interleaved, but still gains the instruction. swAesCtr() and swAesCmac() take this path when the CPU has it.
+ */
+
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "cpa.h"
+
+#include "sw_crypto.h"
+
+#define AESNI_CTR_LANES 8
+
+#if defined(__x86_64__)
+
+__attribute__((target("aes,sse4.1"))) static inline __m128i aesNiEncrypt(const __m128i *rk,
+                                                                         Cpa32U numRounds,
+                                                                         __m128i block)
+{
+    Cpa32U round = 0;
+
+    block = _mm_xor_si128(block, rk[0]);
+    for (round = 1; round < numRounds; round++)
+    {
+        block = _mm_aesenc_si128(block, rk[round]);
+    }
+    return _mm_aesenclast_si128(block, rk[numRounds]);
+}
+
+/* The 128-bit big-endian counter block, kept as two native halves */
+__attribute__((target("aes,sse4.1"))) static inline __m128i aesNiCounter(Cpa64U high, Cpa64U low)
+{
+    return _mm_set_epi64x((long long)__builtin_bswap64(low), (long long)__builtin_bswap64(high));
+}
+
+__attribute__((target("aes,sse4.1"))) static void aesNiCtr(const SwAesKey *aesKey,
+                                                           const Cpa8U *iv,
+                                                           Cpa8U *data,
+                                                           Cpa32U length)
+{
+    __m128i rk[SW_AES_MAX_ROUNDS + 1];
+    __m128i blocks[AESNI_CTR_LANES];
+    __m128i *out = NULL;
+    Cpa8U keystream[SW_AES_BLOCK_SIZE];
+    Cpa32U numRounds = aesKey->numRounds;
+    Cpa64U high = 0;
+    Cpa64U low = 0;
+    Cpa32U offset = 0;
+    Cpa32U lane = 0;
+    Cpa32U round = 0;
+    Cpa32U byteIdx = 0;
+
+    for (round = 0; round <= numRounds; round++)
+    {
+        rk[round] = _mm_loadu_si128((const __m128i *)(aesKey->roundKeyBytes + SW_AES_BLOCK_SIZE * round));
+    }
+    memcpy(&high, iv, sizeof(high));
+    memcpy(&low, iv + sizeof(high), sizeof(low));
+    high = __builtin_bswap64(high);
+    low = __builtin_bswap64(low);
+
+    /* The lane loops are unrolled, 8 being AESNI_CTR_LANES, so that the blocks stay in registers */
+    for (; offset + AESNI_CTR_LANES * SW_AES_BLOCK_SIZE <= length; offset += AESNI_CTR_LANES * SW_AES_BLOCK_SIZE)
+    {
+#pragma GCC unroll 8
+        for (lane = 0; lane < AESNI_CTR_LANES; lane++)
+        {
+            blocks[lane] = _mm_xor_si128(aesNiCounter(high, low), rk[0]);
+            high += (0 == ++low);
+        }
+        for (round = 1; round < numRounds; round++)
+        {
+#pragma GCC unroll 8
+            for (lane = 0; lane < AESNI_CTR_LANES; lane++)
+            {
+                blocks[lane] = _mm_aesenc_si128(blocks[lane], rk[round]);
+            }
+        }
+#pragma GCC unroll 8
+        for (lane = 0; lane < AESNI_CTR_LANES; lane++)
+        {
+            out = (__m128i *)(data + offset + SW_AES_BLOCK_SIZE * lane);
+            blocks[lane] = _mm_aesenclast_si128(blocks[lane], rk[numRounds]);
+            _mm_storeu_si128(out, _mm_xor_si128(_mm_loadu_si128(out), blocks[lane]));
+        }
+    }
+
+    for (; offset < length; offset += SW_AES_BLOCK_SIZE)
+    {
+        _mm_storeu_si128((__m128i *)keystream, aesNiEncrypt(rk, numRounds, aesNiCounter(high, low)));
+        high += (0 == ++low);
+        for (byteIdx = 0; byteIdx < SW_AES_BLOCK_SIZE && offset + byteIdx < length; byteIdx++)
+        {
+            data[offset + byteIdx] ^= keystream[byteIdx];
+        }
+    }
+}
+
+__attribute__((target("aes,sse4.1"))) static void aesNiCbcMac(const SwAesKey *aesKey,
+                                                              Cpa8U *state,
+                                                              const Cpa8U *data,
+                                                              Cpa32U numBlocks)
+{
+    __m128i rk[SW_AES_MAX_ROUNDS + 1];
+    __m128i chain = _mm_loadu_si128((const __m128i *)state);
+    Cpa32U numRounds = aesKey->numRounds;
+    Cpa32U round = 0;
+    Cpa32U blockIdx = 0;
+
+    for (round = 0; round <= numRounds; round++)
+    {
+        rk[round] = _mm_loadu_si128((const __m128i *)(aesKey->roundKeyBytes + SW_AES_BLOCK_SIZE * round));
+    }
+    for (blockIdx = 0; blockIdx < numBlocks; blockIdx++)
+    {
+        chain = _mm_xor_si128(chain, _mm_loadu_si128((const __m128i *)(data + SW_AES_BLOCK_SIZE * blockIdx)));
+        chain = aesNiEncrypt(rk, numRounds, chain);
+    }
+    _mm_storeu_si128((__m128i *)state, chain);
+}
+
+#endif
+
+CpaBoolean swAesNiSupported(void)
+{
+#if defined(__x86_64__)
+    return (__builtin_cpu_supports("aes") && __builtin_cpu_supports("sse4.1")) ? CPA_TRUE : CPA_FALSE;
+#else
+    return CPA_FALSE;
+#endif
+}
+
+void swAesNiCtr(const SwAesKey *aesKey, const Cpa8U *iv, Cpa8U *data, Cpa32U length)
+{
+#if defined(__x86_64__)
+    aesNiCtr(aesKey, iv, data, length);
+#endif
+}
+
+void swAesNiCbcMac(const SwAesKey *aesKey, Cpa8U *state, const Cpa8U *data, Cpa32U numBlocks)
+{
+#if defined(__x86_64__)
+    aesNiCbcMac(aesKey, state, data, numBlocks);
+#endif
+}
@@ -0,0 +1,1328 @@
+/*
+ * Software implementations of the 5G NR security algorithms.
+ *
+ * 128-NEA1/NIA1 (SNOW 3G UEA2/UIA2), 128-NEA2/NIA2 (AES-CTR/CMAC), 128-NEA3/NIA3 (ZUC EEA3/EIA3), their
+ * 256-bit variants on AES-256 and ZUC-256 and the AES-CBC sample cipher, written after the 3GPP, NIST and ZUC-256
+ * specifications. They back the sw build of the mock device, which gives a CPU reference point for the QAT
+ * numbers. Lookup tables are generated on first use. AES takes the AES instructions when the CPU has them, see
+ * sw_aesni.c; SHA-256 for the key derivation lives in sw_sha256.c.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+
+#include "sw_crypto.h"
+
+#define ROL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define ROR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static pthread_once_t tablesOnce_g = PTHREAD_ONCE_INIT;
+static Cpa8U aesSbox_g[256];
+static Cpa8U aesInvSbox_g[256];
+static Cpa32U aesTe_g[256];
+static Cpa8U snow3gSq_g[256];
+static Cpa32U snow3gS1_g[256];
+static Cpa32U snow3gS2_g[256];
+static Cpa32U snow3gMulAlpha_g[256];
+static Cpa32U snow3gDivAlpha_g[256];
+
+static inline Cpa32U loadBe32(const Cpa8U *p)
+{
+    return ((Cpa32U)p[0] << 24) | ((Cpa32U)p[1] << 16) | ((Cpa32U)p[2] << 8) | p[3];
+}
+
+static inline void storeBe32(Cpa8U *p, Cpa32U v)
+{
+    p[0] = (Cpa8U)(v >> 24);
+    p[1] = (Cpa8U)(v >> 16);
+    p[2] = (Cpa8U)(v >> 8);
+    p[3] = (Cpa8U)v;
+}
+
+/*
+ * Multiply by x in GF(2^8) reduced by poly
+ */
+static inline Cpa8U mulX(Cpa8U v, Cpa8U poly)
+{
+    return (v & 0x80) ? (Cpa8U)((v << 1) ^ poly) : (Cpa8U)(v << 1);
+}
+
+static Cpa8U gfMul(Cpa8U a, Cpa8U b, Cpa8U poly)
+{
+    Cpa8U result = 0;
+
+    while (0 != b)
+    {
+        if (b & 1)
+        {
+            result ^= a;
+        }
+        a = mulX(a, poly);
+        b >>= 1;
+    }
+    return result;
+}
+
+static Cpa8U gfPow(Cpa8U a, Cpa32U exp, Cpa8U poly)
+{
+    Cpa8U result = 1;
+
+    while (0 != exp)
+    {
+        if (exp & 1)
+        {
+            result = gfMul(result, a, poly);
+        }
+        a = gfMul(a, a, poly);
+        exp >>= 1;
+    }
+    return result;
+}
+
+static Cpa8U mulXPow(Cpa8U v, Cpa32U i, Cpa8U poly)
+{
+    while (0 < i--)
+    {
+        v = mulX(v, poly);
+    }
+    return v;
+}
+
+/*
+ * Column of the AES MixColumn matrix applied to the first byte of a word, the other bytes are rotations of it
+ */
+static Cpa32U mixColumnWord(Cpa8U s, Cpa8U poly)
+{
+    return ((Cpa32U)mulX(s, poly) << 24) | ((Cpa32U)(mulX(s, poly) ^ s) << 16) | ((Cpa32U)s << 8) | s;
+}
+
+static void initTables(void)
+{
+    Cpa32U x = 0;
+    Cpa8U inv = 0;
+    Cpa8U s = 0;
+
+    for (x = 0; x < 256; x++)
+    {
+        /* AES S-box: affine transform of the inverse in GF(2^8) mod x^8+x^4+x^3+x+1 */
+        inv = (0 == x) ? 0 : gfPow((Cpa8U)x, 254, 0x1b);
+        s = inv ^ (Cpa8U)((inv << 1) | (inv >> 7)) ^ (Cpa8U)((inv << 2) | (inv >> 6)) ^
+            (Cpa8U)((inv << 3) | (inv >> 5)) ^ (Cpa8U)((inv << 4) | (inv >> 4)) ^ 0x63;
+        aesSbox_g[x] = s;
+        aesInvSbox_g[s] = (Cpa8U)x;
+        aesTe_g[x] = ((Cpa32U)mulX(s, 0x1b) << 24) | ((Cpa32U)s << 16) | ((Cpa32U)s << 8) |
+                     (Cpa32U)(mulX(s, 0x1b) ^ s);
+
+        /* SNOW 3G SQ: Dickson polynomial g49 in GF(2^8) mod x^8+x^6+x^5+x^3+1, plus 0x25 */
+        snow3gSq_g[x] = gfPow((Cpa8U)x, 1, 0x69) ^ gfPow((Cpa8U)x, 9, 0x69) ^ gfPow((Cpa8U)x, 13, 0x69) ^
+                        gfPow((Cpa8U)x, 15, 0x69) ^ gfPow((Cpa8U)x, 33, 0x69) ^ gfPow((Cpa8U)x, 41, 0x69) ^
+                        gfPow((Cpa8U)x, 45, 0x69) ^ gfPow((Cpa8U)x, 47, 0x69) ^ gfPow((Cpa8U)x, 49, 0x69) ^ 0x25;
+
+        /* SNOW 3G LFSR feedback multipliers in GF(2^32), byte-wise in GF(2^8) mod x^8+x^7+x^5+x^3+1 */
+        snow3gMulAlpha_g[x] = ((Cpa32U)mulXPow((Cpa8U)x, 23, 0xa9) << 24) | ((Cpa32U)mulXPow((Cpa8U)x, 245, 0xa9) << 16) |
+                              ((Cpa32U)mulXPow((Cpa8U)x, 48, 0xa9) << 8) | mulXPow((Cpa8U)x, 239, 0xa9);
+        snow3gDivAlpha_g[x] = ((Cpa32U)mulXPow((Cpa8U)x, 16, 0xa9) << 24) | ((Cpa32U)mulXPow((Cpa8U)x, 39, 0xa9) << 16) |
+                              ((Cpa32U)mulXPow((Cpa8U)x, 6, 0xa9) << 8) | mulXPow((Cpa8U)x, 64, 0xa9);
+    }
+    for (x = 0; x < 256; x++)
+    {
+        snow3gS1_g[x] = mixColumnWord(aesSbox_g[x], 0x1b);
+        snow3gS2_g[x] = mixColumnWord(snow3gSq_g[x], 0x69);
+    }
+}
+
+/*
+ *******************
+ * AES
+ *******************
+ */
+void swAesExpandKey(const Cpa8U *key, Cpa32U keySize, SwAesKey *aesKey)
+{
+    Cpa32U numKeyWords = keySize / 4;
+    Cpa32U numWords = 0;
+    Cpa32U rcon = 0x01;
+    Cpa32U wordIdx = 0;
+    Cpa32U temp = 0;
+
+    pthread_once(&tablesOnce_g, initTables);
+
+    aesKey->numRounds = numKeyWords + 6;
+    numWords = 4 * (aesKey->numRounds + 1);
+    for (wordIdx = 0; wordIdx < numKeyWords; wordIdx++)
+    {
+        aesKey->roundKeys[wordIdx] = loadBe32(key + 4 * wordIdx);
+    }
+    for (wordIdx = numKeyWords; wordIdx < numWords; wordIdx++)
+    {
+        temp = aesKey->roundKeys[wordIdx - 1];
+        if (0 == wordIdx % numKeyWords)
+        {
+            temp = ((Cpa32U)aesSbox_g[(temp >> 16) & 0xff] << 24) | ((Cpa32U)aesSbox_g[(temp >> 8) & 0xff] << 16) |
+                   ((Cpa32U)aesSbox_g[temp & 0xff] << 8) | aesSbox_g[temp >> 24];
+            temp ^= rcon << 24;
+            rcon = mulX((Cpa8U)rcon, 0x1b);
+        }
+        else if (6 < numKeyWords && 4 == wordIdx % numKeyWords)
+        {
+            temp = ((Cpa32U)aesSbox_g[temp >> 24] << 24) | ((Cpa32U)aesSbox_g[(temp >> 16) & 0xff] << 16) |
+                   ((Cpa32U)aesSbox_g[(temp >> 8) & 0xff] << 8) | aesSbox_g[temp & 0xff];
+        }
+        aesKey->roundKeys[wordIdx] = aesKey->roundKeys[wordIdx - numKeyWords] ^ temp;
+    }
+    for (wordIdx = 0; wordIdx < numWords; wordIdx++)
+    {
+        storeBe32(aesKey->roundKeyBytes + 4 * wordIdx, aesKey->roundKeys[wordIdx]);
+    }
+}
+
+void swAesEncryptBlock(const SwAesKey *aesKey, const Cpa8U *in, Cpa8U *out)
+{
+    const Cpa32U *rk = aesKey->roundKeys;
+    Cpa32U s0 = loadBe32(in) ^ rk[0];
+    Cpa32U s1 = loadBe32(in + 4) ^ rk[1];
+    Cpa32U s2 = loadBe32(in + 8) ^ rk[2];
+    Cpa32U s3 = loadBe32(in + 12) ^ rk[3];
+    Cpa32U t0 = 0, t1 = 0, t2 = 0, t3 = 0;
+    Cpa32U round = 0;
+
+    for (round = 1; round < aesKey->numRounds; round++)
+    {
+        rk += 4;
+        t0 = aesTe_g[s0 >> 24] ^ ROR32(aesTe_g[(s1 >> 16) & 0xff], 8) ^ ROR32(aesTe_g[(s2 >> 8) & 0xff], 16) ^
+             ROR32(aesTe_g[s3 & 0xff], 24) ^ rk[0];
+        t1 = aesTe_g[s1 >> 24] ^ ROR32(aesTe_g[(s2 >> 16) & 0xff], 8) ^ ROR32(aesTe_g[(s3 >> 8) & 0xff], 16) ^
+             ROR32(aesTe_g[s0 & 0xff], 24) ^ rk[1];
+        t2 = aesTe_g[s2 >> 24] ^ ROR32(aesTe_g[(s3 >> 16) & 0xff], 8) ^ ROR32(aesTe_g[(s0 >> 8) & 0xff], 16) ^
+             ROR32(aesTe_g[s1 & 0xff], 24) ^ rk[2];
+        t3 = aesTe_g[s3 >> 24] ^ ROR32(aesTe_g[(s0 >> 16) & 0xff], 8) ^ ROR32(aesTe_g[(s1 >> 8) & 0xff], 16) ^
+             ROR32(aesTe_g[s2 & 0xff], 24) ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+
+    /* The last round has no MixColumns */
+    rk += 4;
+    t0 = ((Cpa32U)aesSbox_g[s0 >> 24] << 24) | ((Cpa32U)aesSbox_g[(s1 >> 16) & 0xff] << 16) |
+         ((Cpa32U)aesSbox_g[(s2 >> 8) & 0xff] << 8) | aesSbox_g[s3 & 0xff];
+    t1 = ((Cpa32U)aesSbox_g[s1 >> 24] << 24) | ((Cpa32U)aesSbox_g[(s2 >> 16) & 0xff] << 16) |
+         ((Cpa32U)aesSbox_g[(s3 >> 8) & 0xff] << 8) | aesSbox_g[s0 & 0xff];
+    t2 = ((Cpa32U)aesSbox_g[s2 >> 24] << 24) | ((Cpa32U)aesSbox_g[(s3 >> 16) & 0xff] << 16) |
+         ((Cpa32U)aesSbox_g[(s0 >> 8) & 0xff] << 8) | aesSbox_g[s1 & 0xff];
+    t3 = ((Cpa32U)aesSbox_g[s3 >> 24] << 24) | ((Cpa32U)aesSbox_g[(s0 >> 16) & 0xff] << 16) |
+         ((Cpa32U)aesSbox_g[(s1 >> 8) & 0xff] << 8) | aesSbox_g[s2 & 0xff];
+    storeBe32(out, t0 ^ rk[0]);
+    storeBe32(out + 4, t1 ^ rk[1]);
+    storeBe32(out + 8, t2 ^ rk[2]);
+    storeBe32(out + 12, t3 ^ rk[3]);
+}
+
+/*
+ * Byte-wise inverse cipher, only AES-CBC decryption needs it
+ */
+void swAesDecryptBlock(const SwAesKey *aesKey, const Cpa8U *in, Cpa8U *out)
+{
+    Cpa8U state[SW_AES_BLOCK_SIZE];
+    Cpa8U temp[SW_AES_BLOCK_SIZE];
+    Cpa32U round = aesKey->numRounds;
+    Cpa32U byteIdx = 0;
+    Cpa32U col = 0;
+    Cpa8U a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+
+    for (byteIdx = 0; byteIdx < SW_AES_BLOCK_SIZE; byteIdx++)
+    {
+        state[byteIdx] = in[byteIdx] ^ (Cpa8U)(aesKey->roundKeys[4 * round + byteIdx / 4] >> (24 - 8 * (byteIdx % 4)));
+    }
+
+    while (0 < round--)
+    {
+        /* InvShiftRows and InvSubBytes, state is column-major */
+        for (byteIdx = 0; byteIdx < SW_AES_BLOCK_SIZE; byteIdx++)
+        {
+            temp[byteIdx] = aesInvSbox_g[state[((byteIdx / 4 + 4 - byteIdx % 4) % 4) * 4 + byteIdx % 4]];
+        }
+        for (byteIdx = 0; byteIdx < SW_AES_BLOCK_SIZE; byteIdx++)
+        {
+            state[byteIdx] = temp[byteIdx] ^ (Cpa8U)(aesKey->roundKeys[4 * round + byteIdx / 4] >> (24 - 8 * (byteIdx % 4)));
+        }
+        if (0 == round)
+        {
+            break;
+        }
+        for (col = 0; col < 4; col++)
+        {
+            a0 = state[4 * col];
+            a1 = state[4 * col + 1];
+            a2 = state[4 * col + 2];
+            a3 = state[4 * col + 3];
+            state[4 * col] = gfMul(a0, 14, 0x1b) ^ gfMul(a1, 11, 0x1b) ^ gfMul(a2, 13, 0x1b) ^ gfMul(a3, 9, 0x1b);
+            state[4 * col + 1] = gfMul(a0, 9, 0x1b) ^ gfMul(a1, 14, 0x1b) ^ gfMul(a2, 11, 0x1b) ^ gfMul(a3, 13, 0x1b);
+            state[4 * col + 2] = gfMul(a0, 13, 0x1b) ^ gfMul(a1, 9, 0x1b) ^ gfMul(a2, 14, 0x1b) ^ gfMul(a3, 11, 0x1b);
+            state[4 * col + 3] = gfMul(a0, 11, 0x1b) ^ gfMul(a1, 13, 0x1b) ^ gfMul(a2, 9, 0x1b) ^ gfMul(a3, 14, 0x1b);
+        }
+    }
+    memcpy(out, state, SW_AES_BLOCK_SIZE);
+}
+
+void swAesCtr(const SwAesKey *aesKey, const Cpa8U *iv, Cpa8U *data, Cpa32U length)
+{
+    Cpa8U counter[SW_AES_BLOCK_SIZE];
+    Cpa8U keystream[SW_AES_BLOCK_SIZE];
+    Cpa32U offset = 0;
+    Cpa32U byteIdx = 0;
+    int carryIdx = 0;
+
+    if (CPA_TRUE == swAesNiSupported())
+    {
+        swAesNiCtr(aesKey, iv, data, length);
+        return;
+    }
+    memcpy(counter, iv, SW_AES_BLOCK_SIZE);
+    for (offset = 0; offset < length; offset += SW_AES_BLOCK_SIZE)
+    {
+        swAesEncryptBlock(aesKey, counter, keystream);
+        for (byteIdx = 0; byteIdx < SW_AES_BLOCK_SIZE && offset + byteIdx < length; byteIdx++)
+        {
+            data[offset + byteIdx] ^= keystream[byteIdx];
+        }
+        for (carryIdx = SW_AES_BLOCK_SIZE - 1; 0 <= carryIdx && 0 == ++counter[carryIdx]; carryIdx--)
+        {
+        }
+    }
+}
+
+/*
+ * The length must be a multiple of the block size, as for AES-CBC on the device
+ */
+void swAesCbc(const SwAesKey *aesKey, const Cpa8U *iv, Cpa8U *data, Cpa32U length, CpaBoolean encrypt)
+{
+    Cpa8U chain[SW_AES_BLOCK_SIZE];
+    Cpa8U block[SW_AES_BLOCK_SIZE];
+    Cpa32U offset = 0;
+    Cpa32U byteIdx = 0;
+
+    memcpy(chain, iv, SW_AES_BLOCK_SIZE);
+    for (offset = 0; offset + SW_AES_BLOCK_SIZE <= length; offset += SW_AES_BLOCK_SIZE)
+    {
+        if (CPA_TRUE == encrypt)
+        {
+            for (byteIdx = 0; byteIdx < SW_AES_BLOCK_SIZE; byteIdx++)
+            {
+                data[offset + byteIdx] ^= chain[byteIdx];
+            }
+            swAesEncryptBlock(aesKey, data + offset, data + offset);
+            memcpy(chain, data + offset, SW_AES_BLOCK_SIZE);
+        }
+        else
+        {
+            memcpy(block, data + offset, SW_AES_BLOCK_SIZE);
+            swAesDecryptBlock(aesKey, data + offset, data + offset);
+            for (byteIdx = 0; byteIdx < SW_AES_BLOCK_SIZE; byteIdx++)
+            {
+                data[offset + byteIdx] ^= chain[byteIdx];
+            }
+            memcpy(chain, block, SW_AES_BLOCK_SIZE);
+        }
+    }
+}
+
+static void cmacShiftSubkey(const Cpa8U *in, Cpa8U *out)
+{
+    Cpa8U msb = in[0] & 0x80;
+    Cpa32U byteIdx = 0;
+
+    for (byteIdx = 0; byteIdx < SW_AES_BLOCK_SIZE - 1; byteIdx++)
+    {
+        out[byteIdx] = (Cpa8U)((in[byteIdx] << 1) | (in[byteIdx + 1] >> 7));
+    }
+    out[SW_AES_BLOCK_SIZE - 1] = (Cpa8U)(in[SW_AES_BLOCK_SIZE - 1] << 1);
+    if (0 != msb)
+    {
+        out[SW_AES_BLOCK_SIZE - 1] ^= 0x87;
+    }
+}
+
+/*
+ * CBC-MAC chain of whole blocks onto state
+ */
+static void cbcMacBlocks(const SwAesKey *aesKey, Cpa8U *state, const Cpa8U *data, Cpa32U numBlocks)
+{
+    Cpa32U blockIdx = 0;
+    Cpa32U byteIdx = 0;
+
+    if (CPA_TRUE == swAesNiSupported())
+    {
+        swAesNiCbcMac(aesKey, state, data, numBlocks);
+        return;
+    }
+    for (blockIdx = 0; blockIdx < numBlocks; blockIdx++)
+    {
+        for (byteIdx = 0; byteIdx < SW_AES_BLOCK_SIZE; byteIdx++)
+        {
+            state[byteIdx] ^= data[SW_AES_BLOCK_SIZE * blockIdx + byteIdx];
+        }
+        swAesEncryptBlock(aesKey, state, state);
+    }
+}
+
+/*
+ * CMAC of the blocks chained into state so far followed by data, the last block of which may be partial or
+ * missing
+ */
+static void cmacFinish(const SwAesKey *aesKey,
+                       const Cpa8U *k1,
+                       const Cpa8U *k2,
+                       Cpa8U *state,
+                       const Cpa8U *data,
+                       Cpa32U length,
+                       Cpa8U *mac)
+{
+    Cpa8U block[SW_AES_BLOCK_SIZE];
+    Cpa32U offset = 0;
+    Cpa32U byteIdx = 0;
+    Cpa32U lastLen = 0;
+
+    /* All but the last block, which is the only one that may be partial */
+    if (SW_AES_BLOCK_SIZE < length)
+    {
+        offset = ((length - 1) / SW_AES_BLOCK_SIZE) * SW_AES_BLOCK_SIZE;
+        cbcMacBlocks(aesKey, state, data, offset / SW_AES_BLOCK_SIZE);
+    }
+
+    lastLen = length - offset;
+    for (byteIdx = 0; byteIdx < SW_AES_BLOCK_SIZE; byteIdx++)
+    {
+        if (SW_AES_BLOCK_SIZE == lastLen)
+        {
+            state[byteIdx] ^= data[offset + byteIdx] ^ k1[byteIdx];
+        }
+        else if (byteIdx < lastLen)
+        {
+            state[byteIdx] ^= data[offset + byteIdx] ^ k2[byteIdx];
+        }
+        else
+        {
+            state[byteIdx] ^= ((byteIdx == lastLen) ? 0x80 : 0x00) ^ k2[byteIdx];
+        }
+    }
+    memcpy(block, state, SW_AES_BLOCK_SIZE);
+    memset(state, 0, SW_AES_BLOCK_SIZE);
+    cbcMacBlocks(aesKey, state, block, 1);
+    memcpy(mac, state, SW_AES_BLOCK_SIZE);
+}
+
+void swAesCmac(const SwAesKey *aesKey,
+               const Cpa8U *k1,
+               const Cpa8U *k2,
+               const Cpa8U *data,
+               Cpa32U length,
+               Cpa8U *mac)
+{
+    Cpa8U state[SW_AES_BLOCK_SIZE] = {0};
+
+    cmacFinish(aesKey, k1, k2, state, data, length, mac);
+}
+
+/*
+ *******************
+ * SNOW 3G
+ *******************
+ */
+typedef struct _Snow3gState {
+    Cpa32U s[16];
+    Cpa32U r1;
+    Cpa32U r2;
+    Cpa32U r3;
+} Snow3gState;
+
+/*
+ * S1 and S2: a byte S-box followed by the AES MixColumn, over SR with 0x1b and over SQ with 0x69
+ */
+static inline Cpa32U snow3gS(Cpa32U w, const Cpa32U *table)
+{
+    return table[w >> 24] ^ ROR32(table[(w >> 16) & 0xff], 8) ^ ROR32(table[(w >> 8) & 0xff], 16) ^
+           ROR32(table[w & 0xff], 24);
+}
+
+static Cpa32U snow3gClockFsm(Snow3gState *state)
+{
+    Cpa32U f = (state->s[15] + state->r1) ^ state->r2;
+    Cpa32U r = state->r2 + (state->r3 ^ state->s[5]);
+
+    state->r3 = snow3gS(state->r2, snow3gS2_g);
+    state->r2 = snow3gS(state->r1, snow3gS1_g);
+    state->r1 = r;
+    return f;
+}
+
+static void snow3gClockLfsr(Snow3gState *state, Cpa32U f)
+{
+    Cpa32U v = (state->s[0] << 8) ^ snow3gMulAlpha_g[state->s[0] >> 24] ^ state->s[2] ^ (state->s[11] >> 8) ^
+               snow3gDivAlpha_g[state->s[11] & 0xff] ^ f;
+
+    memmove(state->s, state->s + 1, 15 * sizeof(Cpa32U));
+    state->s[15] = v;
+}
+
+/*
+ * Key and IV bytes are taken as big-endian words, k3/IV3 first
+ */
+static void snow3gInit(Snow3gState *state, const Cpa8U *key, const Cpa8U *iv)
+{
+    Cpa32U k0 = loadBe32(key + 12), k1 = loadBe32(key + 8), k2 = loadBe32(key + 4), k3 = loadBe32(key);
+    Cpa32U iv0 = loadBe32(iv + 12), iv1 = loadBe32(iv + 8), iv2 = loadBe32(iv + 4), iv3 = loadBe32(iv);
+    Cpa32U round = 0;
+
+    pthread_once(&tablesOnce_g, initTables);
+
+    state->s[15] = k3 ^ iv0;
+    state->s[14] = k2;
+    state->s[13] = k1;
+    state->s[12] = k0 ^ iv1;
+    state->s[11] = k3 ^ 0xffffffff;
+    state->s[10] = k2 ^ 0xffffffff ^ iv2;
+    state->s[9] = k1 ^ 0xffffffff ^ iv3;
+    state->s[8] = k0 ^ 0xffffffff;
+    state->s[7] = k3;
+    state->s[6] = k2;
+    state->s[5] = k1;
+    state->s[4] = k0;
+    state->s[3] = k3 ^ 0xffffffff;
+    state->s[2] = k2 ^ 0xffffffff;
+    state->s[1] = k1 ^ 0xffffffff;
+    state->s[0] = k0 ^ 0xffffffff;
+    state->r1 = 0;
+    state->r2 = 0;
+    state->r3 = 0;
+
+    for (round = 0; round < 32; round++)
+    {
+        snow3gClockLfsr(state, snow3gClockFsm(state));
+    }
+    /* The first keystream clock discards its output */
+    snow3gClockFsm(state);
+    snow3gClockLfsr(state, 0);
+}
+
+static Cpa32U snow3gNextWord(Snow3gState *state)
+{
+    Cpa32U z = snow3gClockFsm(state) ^ state->s[0];
+
+    snow3gClockLfsr(state, 0);
+    return z;
+}
+
+void swSnow3gF8(const Cpa8U *key, const Cpa8U *iv, Cpa8U *data, Cpa32U length)
+{
+    Snow3gState state;
+    Cpa8U keystream[4];
+    Cpa32U offset = 0;
+    Cpa32U byteIdx = 0;
+
+    snow3gInit(&state, key, iv);
+    for (offset = 0; offset < length; offset += 4)
+    {
+        storeBe32(keystream, snow3gNextWord(&state));
+        for (byteIdx = 0; byteIdx < 4 && offset + byteIdx < length; byteIdx++)
+        {
+            data[offset + byteIdx] ^= keystream[byteIdx];
+        }
+    }
+}
+
+/*
+ * V * P in GF(2^64) mod x^64+x^4+x^3+x+1
+ */
+static Cpa64U snow3gMul64(Cpa64U v, Cpa64U p)
+{
+    Cpa64U result = 0;
+
+    while (0 != p)
+    {
+        if (p & 1)
+        {
+            result ^= v;
+        }
+        v = (v & 0x8000000000000000ULL) ? ((v << 1) ^ 0x1b) : (v << 1);
+        p >>= 1;
+    }
+    return result;
+}
+
+void swSnow3gF9(const Cpa8U *key, const Cpa8U *iv, const Cpa8U *data, Cpa64U bitLen, Cpa8U *mac)
+{
+    Snow3gState state;
+    Cpa32U z[5];
+    Cpa64U p = 0;
+    Cpa64U q = 0;
+    Cpa64U eval = 0;
+    Cpa64U block = 0;
+    Cpa64U numBlocks = (bitLen + 63) / 64;
+    Cpa64U blockIdx = 0;
+    Cpa32U byteIdx = 0;
+    Cpa32U wordIdx = 0;
+
+    snow3gInit(&state, key, iv);
+    for (wordIdx = 0; wordIdx < 5; wordIdx++)
+    {
+        z[wordIdx] = snow3gNextWord(&state);
+    }
+    p = ((Cpa64U)z[0] << 32) | z[1];
+    q = ((Cpa64U)z[2] << 32) | z[3];
+
+    for (blockIdx = 0; blockIdx < numBlocks; blockIdx++)
+    {
+        block = 0;
+        for (byteIdx = 0; byteIdx < 8; byteIdx++)
+        {
+            block <<= 8;
+            if (blockIdx * 64 + byteIdx * 8 < bitLen)
+            {
+                block |= data[blockIdx * 8 + byteIdx];
+            }
+        }
+        /* Bits past the message length are zero padding */
+        if (blockIdx == numBlocks - 1 && 0 != bitLen % 64)
+        {
+            block &= ~0ULL << (64 - bitLen % 64);
+        }
+        eval = snow3gMul64(eval ^ block, p);
+    }
+    eval ^= bitLen;
+    eval = snow3gMul64(eval, q);
+    storeBe32(mac, (Cpa32U)(eval >> 32) ^ z[4]);
+}
+
+/*
+ *******************
+ * ZUC
+ *******************
+ */
+static const Cpa8U zucS0_g[256] = {
+    0x3e, 0x72, 0x5b, 0x47, 0xca, 0xe0, 0x00, 0x33, 0x04, 0xd1, 0x54, 0x98, 0x09, 0xb9, 0x6d, 0xcb,
+    0x7b, 0x1b, 0xf9, 0x32, 0xaf, 0x9d, 0x6a, 0xa5, 0xb8, 0x2d, 0xfc, 0x1d, 0x08, 0x53, 0x03, 0x90,
+    0x4d, 0x4e, 0x84, 0x99, 0xe4, 0xce, 0xd9, 0x91, 0xdd, 0xb6, 0x85, 0x48, 0x8b, 0x29, 0x6e, 0xac,
+    0xcd, 0xc1, 0xf8, 0x1e, 0x73, 0x43, 0x69, 0xc6, 0xb5, 0xbd, 0xfd, 0x39, 0x63, 0x20, 0xd4, 0x38,
+    0x76, 0x7d, 0xb2, 0xa7, 0xcf, 0xed, 0x57, 0xc5, 0xf3, 0x2c, 0xbb, 0x14, 0x21, 0x06, 0x55, 0x9b,
+    0xe3, 0xef, 0x5e, 0x31, 0x4f, 0x7f, 0x5a, 0xa4, 0x0d, 0x82, 0x51, 0x49, 0x5f, 0xba, 0x58, 0x1c,
+    0x4a, 0x16, 0xd5, 0x17, 0xa8, 0x92, 0x24, 0x1f, 0x8c, 0xff, 0xd8, 0xae, 0x2e, 0x01, 0xd3, 0xad,
+    0x3b, 0x4b, 0xda, 0x46, 0xeb, 0xc9, 0xde, 0x9a, 0x8f, 0x87, 0xd7, 0x3a, 0x80, 0x6f, 0x2f, 0xc8,
+    0xb1, 0xb4, 0x37, 0xf7, 0x0a, 0x22, 0x13, 0x28, 0x7c, 0xcc, 0x3c, 0x89, 0xc7, 0xc3, 0x96, 0x56,
+    0x07, 0xbf, 0x7e, 0xf0, 0x0b, 0x2b, 0x97, 0x52, 0x35, 0x41, 0x79, 0x61, 0xa6, 0x4c, 0x10, 0xfe,
+    0xbc, 0x26, 0x95, 0x88, 0x8a, 0xb0, 0xa3, 0xfb, 0xc0, 0x18, 0x94, 0xf2, 0xe1, 0xe5, 0xe9, 0x5d,
+    0xd0, 0xdc, 0x11, 0x66, 0x64, 0x5c, 0xec, 0x59, 0x42, 0x75, 0x12, 0xf5, 0x74, 0x9c, 0xaa, 0x23,
+    0x0e, 0x86, 0xab, 0xbe, 0x2a, 0x02, 0xe7, 0x67, 0xe6, 0x44, 0xa2, 0x6c, 0xc2, 0x93, 0x9f, 0xf1,
+    0xf6, 0xfa, 0x36, 0xd2, 0x50, 0x68, 0x9e, 0x62, 0x71, 0x15, 0x3d, 0xd6, 0x40, 0xc4, 0xe2, 0x0f,
+    0x8e, 0x83, 0x77, 0x6b, 0x25, 0x05, 0x3f, 0x0c, 0x30, 0xea, 0x70, 0xb7, 0xa1, 0xe8, 0xa9, 0x65,
+    0x8d, 0x27, 0x1a, 0xdb, 0x81, 0xb3, 0xa0, 0xf4, 0x45, 0x7a, 0x19, 0xdf, 0xee, 0x78, 0x34, 0x60,
+};
+
+static const Cpa8U zucS1_g[256] = {
+    0x55, 0xc2, 0x63, 0x71, 0x3b, 0xc8, 0x47, 0x86, 0x9f, 0x3c, 0xda, 0x5b, 0x29, 0xaa, 0xfd, 0x77,
+    0x8c, 0xc5, 0x94, 0x0c, 0xa6, 0x1a, 0x13, 0x00, 0xe3, 0xa8, 0x16, 0x72, 0x40, 0xf9, 0xf8, 0x42,
+    0x44, 0x26, 0x68, 0x96, 0x81, 0xd9, 0x45, 0x3e, 0x10, 0x76, 0xc6, 0xa7, 0x8b, 0x39, 0x43, 0xe1,
+    0x3a, 0xb5, 0x56, 0x2a, 0xc0, 0x6d, 0xb3, 0x05, 0x22, 0x66, 0xbf, 0xdc, 0x0b, 0xfa, 0x62, 0x48,
+    0xdd, 0x20, 0x11, 0x06, 0x36, 0xc9, 0xc1, 0xcf, 0xf6, 0x27, 0x52, 0xbb, 0x69, 0xf5, 0xd4, 0x87,
+    0x7f, 0x84, 0x4c, 0xd2, 0x9c, 0x57, 0xa4, 0xbc, 0x4f, 0x9a, 0xdf, 0xfe, 0xd6, 0x8d, 0x7a, 0xeb,
+    0x2b, 0x53, 0xd8, 0x5c, 0xa1, 0x14, 0x17, 0xfb, 0x23, 0xd5, 0x7d, 0x30, 0x67, 0x73, 0x08, 0x09,
+    0xee, 0xb7, 0x70, 0x3f, 0x61, 0xb2, 0x19, 0x8e, 0x4e, 0xe5, 0x4b, 0x93, 0x8f, 0x5d, 0xdb, 0xa9,
+    0xad, 0xf1, 0xae, 0x2e, 0xcb, 0x0d, 0xfc, 0xf4, 0x2d, 0x46, 0x6e, 0x1d, 0x97, 0xe8, 0xd1, 0xe9,
+    0x4d, 0x37, 0xa5, 0x75, 0x5e, 0x83, 0x9e, 0xab, 0x82, 0x9d, 0xb9, 0x1c, 0xe0, 0xcd, 0x49, 0x89,
+    0x01, 0xb6, 0xbd, 0x58, 0x24, 0xa2, 0x5f, 0x38, 0x78, 0x99, 0x15, 0x90, 0x50, 0xb8, 0x95, 0xe4,
+    0xd0, 0x91, 0xc7, 0xce, 0xed, 0x0f, 0xb4, 0x6f, 0xa0, 0xcc, 0xf0, 0x02, 0x4a, 0x79, 0xc3, 0xde,
+    0xa3, 0xef, 0xea, 0x51, 0xe6, 0x6b, 0x18, 0xec, 0x1b, 0x2c, 0x80, 0xf7, 0x74, 0xe7, 0xff, 0x21,
+    0x5a, 0x6a, 0x54, 0x1e, 0x41, 0x31, 0x92, 0x35, 0xc4, 0x33, 0x07, 0x0a, 0xba, 0x7e, 0x0e, 0x34,
+    0x88, 0xb1, 0x98, 0x7c, 0xf3, 0x3d, 0x60, 0x6c, 0x7b, 0xca, 0xd3, 0x1f, 0x32, 0x65, 0x04, 0x28,
+    0x64, 0xbe, 0x85, 0x9b, 0x2f, 0x59, 0x8a, 0xd7, 0xb0, 0x25, 0xac, 0xaf, 0x12, 0x03, 0xe2, 0xf2,
+};
+
+static const Cpa16U zucEkd_g[16] = {
+    0x44d7, 0x26bc, 0x626b, 0x135e, 0x5789, 0x35e2, 0x7135, 0x09af,
+    0x4d78, 0x2f13, 0x6bc4, 0x1af1, 0x5e26, 0x3c4d, 0x789a, 0x47ac,
+};
+
+/*
+ * ZUC-256 constants d0..d15 of the key loading, for the keystream and for MACs of 32, 64 and 128 bits
+ */
+static const Cpa8U zuc256D_g[4][16] = {
+    {0x22, 0x2f, 0x24, 0x2a, 0x6d, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x52, 0x10, 0x30},
+    {0x22, 0x2f, 0x25, 0x2a, 0x6d, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x52, 0x10, 0x30},
+    {0x23, 0x2f, 0x24, 0x2a, 0x6d, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x52, 0x10, 0x30},
+    {0x23, 0x2f, 0x25, 0x2a, 0x6d, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x52, 0x10, 0x30},
+};
+
+/*
+ * The LFSR is a ring: cell i of the register is s[(head + i) % 16], so a clock overwrites the cell that drops
+ * out instead of shifting the other fifteen
+ */
+typedef struct _ZucState {
+    Cpa32U s[16];
+    Cpa32U head;
+    Cpa32U r1;
+    Cpa32U r2;
+    Cpa32U x[4];
+} ZucState;
+
+#define ZUC_S(state, i) ((state)->s[((state)->head + (i)) & 15])
+
+static inline Cpa32U zucAddM(Cpa32U a, Cpa32U b)
+{
+    Cpa32U c = a + b;
+
+    return (c & 0x7fffffff) + (c >> 31);
+}
+
+#define ZUC_MUL_POW2(x, k) ((((x) << (k)) | ((x) >> (31 - (k)))) & 0x7fffffff)
+
+static inline void zucClockLfsr(ZucState *state, Cpa32U u)
+{
+    Cpa32U f = ZUC_S(state, 0);
+
+    f = zucAddM(f, ZUC_MUL_POW2(ZUC_S(state, 0), 8));
+    f = zucAddM(f, ZUC_MUL_POW2(ZUC_S(state, 4), 20));
+    f = zucAddM(f, ZUC_MUL_POW2(ZUC_S(state, 10), 21));
+    f = zucAddM(f, ZUC_MUL_POW2(ZUC_S(state, 13), 17));
+    f = zucAddM(f, ZUC_MUL_POW2(ZUC_S(state, 15), 15));
+    if (0 != u)
+    {
+        f = zucAddM(f, u);
+    }
+    if (0 == f)
+    {
+        f = 0x7fffffff;
+    }
+    /* s0 drops out and f becomes s15 in its cell */
+    state->s[state->head] = f;
+    state->head = (state->head + 1) & 15;
+}
+
+static inline void zucBitReorganization(ZucState *state)
+{
+    state->x[0] = ((ZUC_S(state, 15) & 0x7fff8000) << 1) | (ZUC_S(state, 14) & 0xffff);
+    state->x[1] = ((ZUC_S(state, 11) & 0xffff) << 16) | (ZUC_S(state, 9) >> 15);
+    state->x[2] = ((ZUC_S(state, 7) & 0xffff) << 16) | (ZUC_S(state, 5) >> 15);
+    state->x[3] = ((ZUC_S(state, 2) & 0xffff) << 16) | (ZUC_S(state, 0) >> 15);
+}
+
+static inline Cpa32U zucL1(Cpa32U x)
+{
+    return x ^ ROL32(x, 2) ^ ROL32(x, 10) ^ ROL32(x, 18) ^ ROL32(x, 24);
+}
+
+static inline Cpa32U zucL2(Cpa32U x)
+{
+    return x ^ ROL32(x, 8) ^ ROL32(x, 14) ^ ROL32(x, 22) ^ ROL32(x, 30);
+}
+
+static inline Cpa32U zucSbox(Cpa32U x)
+{
+    return ((Cpa32U)zucS0_g[x >> 24] << 24) | ((Cpa32U)zucS1_g[(x >> 16) & 0xff] << 16) |
+           ((Cpa32U)zucS0_g[(x >> 8) & 0xff] << 8) | zucS1_g[x & 0xff];
+}
+
+static inline Cpa32U zucF(ZucState *state)
+{
+    Cpa32U w = (state->x[0] ^ state->r1) + state->r2;
+    Cpa32U w1 = state->r1 + state->x[1];
+    Cpa32U w2 = state->r2 ^ state->x[2];
+
+    state->r1 = zucSbox(zucL1((w1 << 16) | (w2 >> 16)));
+    state->r2 = zucSbox(zucL2((w2 << 16) | (w1 >> 16)));
+    return w;
+}
+
+/*
+ * The initialization rounds on a loaded register, the same for ZUC-128 and ZUC-256
+ */
+static void zucStart(ZucState *state)
+{
+    Cpa32U round = 0;
+
+    state->head = 0;
+    state->r1 = 0;
+    state->r2 = 0;
+    for (round = 0; round < 32; round++)
+    {
+        zucBitReorganization(state);
+        zucClockLfsr(state, zucF(state) >> 1);
+    }
+    /* The first keystream clock discards its output */
+    zucBitReorganization(state);
+    zucF(state);
+    zucClockLfsr(state, 0);
+}
+
+static void zucInit(ZucState *state, const Cpa8U *key, const Cpa8U *iv)
+{
+    Cpa32U wordIdx = 0;
+
+    for (wordIdx = 0; wordIdx < 16; wordIdx++)
+    {
+        state->s[wordIdx] = ((Cpa32U)key[wordIdx] << 23) | ((Cpa32U)zucEkd_g[wordIdx] << 8) | iv[wordIdx];
+    }
+    zucStart(state);
+}
+
+/* A cell of the ZUC-256 register: 8 bits, 7 bits of d (with IV or key bits or'ed in), 8 bits, 8 bits */
+#define ZUC256_CELL(a, d, b, c) (((Cpa32U)(a) << 23) | ((Cpa32U)(d) << 16) | ((Cpa32U)(b) << 8) | (Cpa32U)(c))
+
+/*
+ * Key loading of ZUC-256: a 32 byte key and a 25 byte IV, whose last 8 bytes carry 6 bits each
+ */
+static void zuc256Init(ZucState *state, const Cpa8U *key, const Cpa8U *iv, const Cpa8U *d)
+{
+    state->s[0] = ZUC256_CELL(key[0], d[0], key[21], key[16]);
+    state->s[1] = ZUC256_CELL(key[1], d[1], key[22], key[17]);
+    state->s[2] = ZUC256_CELL(key[2], d[2], key[23], key[18]);
+    state->s[3] = ZUC256_CELL(key[3], d[3], key[24], key[19]);
+    state->s[4] = ZUC256_CELL(key[4], d[4], key[25], key[20]);
+    state->s[5] = ZUC256_CELL(iv[0], d[5] | (iv[17] & 0x3f), key[5], key[26]);
+    state->s[6] = ZUC256_CELL(iv[1], d[6] | (iv[18] & 0x3f), key[6], key[27]);
+    state->s[7] = ZUC256_CELL(iv[10], d[7] | (iv[19] & 0x3f), key[7], iv[2]);
+    state->s[8] = ZUC256_CELL(key[8], d[8] | (iv[20] & 0x3f), iv[3], iv[11]);
+    state->s[9] = ZUC256_CELL(key[9], d[9] | (iv[21] & 0x3f), iv[12], iv[4]);
+    state->s[10] = ZUC256_CELL(iv[5], d[10] | (iv[22] & 0x3f), key[10], key[28]);
+    state->s[11] = ZUC256_CELL(key[11], d[11] | (iv[23] & 0x3f), iv[6], iv[13]);
+    state->s[12] = ZUC256_CELL(key[12], d[12] | (iv[24] & 0x3f), iv[7], iv[14]);
+    state->s[13] = ZUC256_CELL(key[13], d[13], iv[15], iv[8]);
+    state->s[14] = ZUC256_CELL(key[14], d[14] | (key[31] >> 4), iv[16], iv[9]);
+    state->s[15] = ZUC256_CELL(key[15], d[15] | (key[31] & 0x0f), key[30], key[29]);
+    zucStart(state);
+}
+
+static inline Cpa32U zucNextWord(ZucState *state)
+{
+    Cpa32U z = 0;
+
+    zucBitReorganization(state);
+    z = zucF(state) ^ state->x[3];
+    zucClockLfsr(state, 0);
+    return z;
+}
+
+static void zucXorKeystream(ZucState *state, Cpa8U *data, Cpa32U length)
+{
+    Cpa8U keystream[4];
+    Cpa32U offset = 0;
+    Cpa32U byteIdx = 0;
+
+    for (offset = 0; offset + 4 <= length; offset += 4)
+    {
+        storeBe32(data + offset, loadBe32(data + offset) ^ zucNextWord(state));
+    }
+    if (offset < length)
+    {
+        storeBe32(keystream, zucNextWord(state));
+        for (byteIdx = 0; offset + byteIdx < length; byteIdx++)
+        {
+            data[offset + byteIdx] ^= keystream[byteIdx];
+        }
+    }
+}
+
+void swZucEea3(const Cpa8U *key, const Cpa8U *iv, Cpa8U *data, Cpa32U length)
+{
+    ZucState state;
+
+    zucInit(&state, key, iv);
+    zucXorKeystream(&state, data, length);
+}
+
+void swZucEia3(const Cpa8U *key, const Cpa8U *iv, const Cpa8U *data, Cpa64U bitLen, Cpa8U *mac)
+{
+    ZucState state;
+    Cpa64U bitIdx = 0;
+    Cpa32U t = 0;
+    Cpa32U zHigh = 0;
+    Cpa32U zLow = 0;
+    Cpa32U bitInWord = 0;
+
+    zucInit(&state, key, iv);
+    zHigh = zucNextWord(&state);
+    zLow = zucNextWord(&state);
+
+    /* Slide a 64-bit keystream window over the message, z_i is the 32-bit word starting at bit i */
+    for (bitIdx = 0; bitIdx < bitLen; bitIdx++)
+    {
+        bitInWord = bitIdx % 32;
+        if (data[bitIdx / 8] & (0x80 >> (bitIdx % 8)))
+        {
+            t ^= (0 == bitInWord) ? zHigh : (zHigh << bitInWord) | (zLow >> (32 - bitInWord));
+        }
+        if (31 == bitInWord)
+        {
+            zHigh = zLow;
+            zLow = zucNextWord(&state);
+        }
+    }
+    bitInWord = bitLen % 32;
+    t ^= (0 == bitInWord) ? zHigh : (zHigh << bitInWord) | (zLow >> (32 - bitInWord));
+
+    /* The last keystream word, z_{32(L-1)} with L = ceil(bitLen/32) + 2 */
+    storeBe32(mac, t ^ ((0 == bitInWord) ? zLow : zucNextWord(&state)));
+}
+
+void swZuc256Eea(const Cpa8U *key, const Cpa8U *iv, Cpa8U *data, Cpa32U length)
+{
+    ZucState state;
+
+    zuc256Init(&state, key, iv, zuc256D_g[0]);
+    zucXorKeystream(&state, data, length);
+}
+
+/*
+ * The ZUC-256 MAC of t = 8 * macSize bits: the tag starts out as the first t bits of the keystream, and every set
+ * message bit i adds the t bits of keystream starting at bit t + i, as does the end of the message
+ */
+CpaStatus swZuc256Mac(const Cpa8U *key,
+                      const Cpa8U *iv,
+                      const Cpa8U *data,
+                      Cpa64U bitLen,
+                      Cpa8U *mac,
+                      Cpa32U macSize)
+{
+    ZucState state;
+    Cpa32U tag[4];
+    Cpa32U window[5];
+    Cpa32U numWords = macSize / 4;
+    Cpa32U bitInWord = 0;
+    Cpa32U wordIdx = 0;
+    Cpa64U bitIdx = 0;
+
+    if (4 != macSize && 8 != macSize && 16 != macSize)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    zuc256Init(&state, key, iv, zuc256D_g[(16 == macSize) ? 3 : numWords]);
+    for (wordIdx = 0; wordIdx < numWords; wordIdx++)
+    {
+        tag[wordIdx] = zucNextWord(&state);
+    }
+    for (wordIdx = 0; wordIdx <= numWords; wordIdx++)
+    {
+        window[wordIdx] = zucNextWord(&state);
+    }
+
+    /* window holds the keystream from bit t of the word of bit i on */
+    for (bitIdx = 0; bitIdx <= bitLen; bitIdx++)
+    {
+        bitInWord = bitIdx % 32;
+        if (bitIdx == bitLen || (data[bitIdx / 8] & (0x80 >> (bitIdx % 8))))
+        {
+            for (wordIdx = 0; wordIdx < numWords; wordIdx++)
+            {
+                tag[wordIdx] ^= (0 == bitInWord) ? window[wordIdx]
+                                                 : (window[wordIdx] << bitInWord) |
+                                                       (window[wordIdx + 1] >> (32 - bitInWord));
+            }
+        }
+        if (31 == bitInWord && bitIdx < bitLen)
+        {
+            memmove(window, window + 1, numWords * sizeof(Cpa32U));
+            window[numWords] = zucNextWord(&state);
+        }
+    }
+
+    for (wordIdx = 0; wordIdx < numWords; wordIdx++)
+    {
+        storeBe32(mac + 4 * wordIdx, tag[wordIdx]);
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ *******************
+ * Sessions
+ *******************
+ */
+CpaStatus swInitSession(SwSession *session, const CpaCySymSessionSetupData *setupData)
+{
+    const Cpa8U *key = NULL;
+    Cpa8U zero[SW_AES_BLOCK_SIZE] = {0};
+    Cpa8U l[SW_AES_BLOCK_SIZE];
+
+    memset(session, 0, sizeof(SwSession));
+    session->symOperation = setupData->symOperation;
+    if (CPA_CY_SYM_OP_CIPHER == setupData->symOperation)
+    {
+        session->cipherAlgorithm = setupData->cipherSetupData.cipherAlgorithm;
+        session->cipherDirection = setupData->cipherSetupData.cipherDirection;
+        key = setupData->cipherSetupData.pCipherKey;
+        session->keySize = setupData->cipherSetupData.cipherKeyLenInBytes;
+        switch (session->cipherAlgorithm)
+        {
+            case CPA_CY_SYM_CIPHER_SNOW3G_UEA2:
+            case CPA_CY_SYM_CIPHER_ZUC_EEA3:
+            case CPA_CY_SYM_CIPHER_AES_CTR:
+            case CPA_CY_SYM_CIPHER_AES_CBC:
+                break;
+            default:
+                return CPA_STATUS_UNSUPPORTED;
+        }
+    }
+    else if (CPA_CY_SYM_OP_HASH == setupData->symOperation)
+    {
+        session->hashAlgorithm = setupData->hashSetupData.hashAlgorithm;
+        session->hashMode = setupData->hashSetupData.hashMode;
+        session->digestSize = setupData->hashSetupData.digestResultLenInBytes;
+        key = setupData->hashSetupData.authModeSetupData.authKey;
+        session->keySize = setupData->hashSetupData.authModeSetupData.authKeyLenInBytes;
+        switch (session->hashAlgorithm)
+        {
+            case CPA_CY_SYM_HASH_SNOW3G_UIA2:
+            case CPA_CY_SYM_HASH_ZUC_EIA3:
+            case CPA_CY_SYM_HASH_AES_CMAC:
+                break;
+            case CPA_CY_SYM_HASH_SHA256:
+                /* A plain hash has no key */
+                if (CPA_CY_SYM_HASH_MODE_PLAIN == session->hashMode)
+                {
+                    key = session->key;
+                    session->keySize = 0;
+                }
+                break;
+            default:
+                return CPA_STATUS_UNSUPPORTED;
+        }
+        if (session->digestSize > SW_MAX_DIGEST_SIZE)
+        {
+            return CPA_STATUS_INVALID_PARAM;
+        }
+    }
+    else
+    {
+        return CPA_STATUS_UNSUPPORTED;
+    }
+
+    if (NULL == key || SW_MAX_KEY_SIZE < session->keySize)
+    {
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    memcpy(session->key, key, session->keySize);
+
+    if (CPA_CY_SYM_CIPHER_SNOW3G_UEA2 == session->cipherAlgorithm ||
+        CPA_CY_SYM_HASH_SNOW3G_UIA2 == session->hashAlgorithm)
+    {
+        if (16 != session->keySize)
+        {
+            return CPA_STATUS_INVALID_PARAM;
+        }
+    }
+    if (CPA_CY_SYM_CIPHER_ZUC_EEA3 == session->cipherAlgorithm || CPA_CY_SYM_HASH_ZUC_EIA3 == session->hashAlgorithm)
+    {
+        if (16 != session->keySize && SW_ZUC256_KEY_SIZE != session->keySize)
+        {
+            return CPA_STATUS_INVALID_PARAM;
+        }
+        if (CPA_CY_SYM_HASH_ZUC_EIA3 == session->hashAlgorithm && SW_ZUC256_KEY_SIZE == session->keySize &&
+            4 != session->digestSize && 8 != session->digestSize && 16 != session->digestSize)
+        {
+            return CPA_STATUS_INVALID_PARAM;
+        }
+    }
+    if (CPA_CY_SYM_CIPHER_AES_CTR == session->cipherAlgorithm || CPA_CY_SYM_CIPHER_AES_CBC == session->cipherAlgorithm ||
+        CPA_CY_SYM_HASH_AES_CMAC == session->hashAlgorithm)
+    {
+        if (16 != session->keySize && 24 != session->keySize && 32 != session->keySize)
+        {
+            return CPA_STATUS_INVALID_PARAM;
+        }
+        swAesExpandKey(session->key, session->keySize, &session->aesKey);
+    }
+    if (CPA_CY_SYM_HASH_AES_CMAC == session->hashAlgorithm)
+    {
+        swAesEncryptBlock(&session->aesKey, zero, l);
+        cmacShiftSubkey(l, session->cmacK1);
+        cmacShiftSubkey(session->cmacK1, session->cmacK2);
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ * Add numBlocks to a 128-bit big-endian counter block
+ */
+static void addCounter(Cpa8U *counter, Cpa32U numBlocks)
+{
+    Cpa32U carry = numBlocks;
+    Cpa32U sum = 0;
+    int byteIdx = 0;
+
+    for (byteIdx = SW_AES_BLOCK_SIZE - 1; 0 <= byteIdx && 0 != carry; byteIdx--)
+    {
+        sum = counter[byteIdx] + (carry & 0xff);
+        counter[byteIdx] = (Cpa8U)sum;
+        carry = (carry >> 8) + (sum >> 8);
+    }
+}
+
+/*
+ * One partial of a stream on AES. As on the device, cipher state goes back into the IV buffer for the next
+ * partial, and the CMAC state stays in the session. Every partial but the last holds whole blocks; the last
+ * block seen is held back until the next partial shows whether it ends the message.
+ */
+static CpaStatus processPartial(SwSession *session, const CpaCySymOpData *opData, Cpa8U *data, Cpa8U *mac)
+{
+    Cpa8U *cipherData = data + opData->cryptoStartSrcOffsetInBytes;
+    const Cpa8U *hashData = data + opData->hashStartSrcOffsetInBytes;
+    Cpa8U fullMac[SW_AES_BLOCK_SIZE];
+    Cpa8U chain[SW_AES_BLOCK_SIZE];
+    CpaBoolean last = (CPA_CY_SYM_PACKET_TYPE_LAST_PARTIAL == opData->packetType) ? CPA_TRUE : CPA_FALSE;
+    CpaBoolean encrypt = (CPA_CY_SYM_CIPHER_DIRECTION_ENCRYPT == session->cipherDirection) ? CPA_TRUE : CPA_FALSE;
+    Cpa32U length = 0;
+
+    if (CPA_CY_SYM_OP_CIPHER == session->symOperation)
+    {
+        length = opData->messageLenToCipherInBytes;
+        if (NULL == opData->pIv || SW_AES_BLOCK_SIZE != opData->ivLenInBytes ||
+            (CPA_TRUE != last && 0 != length % SW_AES_BLOCK_SIZE))
+        {
+            return CPA_STATUS_INVALID_PARAM;
+        }
+        switch (session->cipherAlgorithm)
+        {
+            case CPA_CY_SYM_CIPHER_AES_CTR:
+                swAesCtr(&session->aesKey, opData->pIv, cipherData, length);
+                addCounter(opData->pIv, length / SW_AES_BLOCK_SIZE);
+                break;
+            case CPA_CY_SYM_CIPHER_AES_CBC:
+                if (0 != length % SW_AES_BLOCK_SIZE)
+                {
+                    return CPA_STATUS_INVALID_PARAM;
+                }
+                if (0 == length)
+                {
+                    break;
+                }
+                /* The next partial chains on the last ciphertext block */
+                memcpy(chain, cipherData + length - SW_AES_BLOCK_SIZE, SW_AES_BLOCK_SIZE);
+                swAesCbc(&session->aesKey, opData->pIv, cipherData, length, encrypt);
+                memcpy(opData->pIv,
+                       (CPA_TRUE == encrypt) ? cipherData + length - SW_AES_BLOCK_SIZE : chain,
+                       SW_AES_BLOCK_SIZE);
+                break;
+            default:
+                return CPA_STATUS_UNSUPPORTED;
+        }
+        return CPA_STATUS_SUCCESS;
+    }
+
+    if (CPA_CY_SYM_HASH_AES_CMAC != session->hashAlgorithm)
+    {
+        return CPA_STATUS_UNSUPPORTED;
+    }
+    length = opData->messageLenToHashInBytes;
+    if (CPA_TRUE != last)
+    {
+        if (0 == length || 0 != length % SW_AES_BLOCK_SIZE)
+        {
+            return CPA_STATUS_INVALID_PARAM;
+        }
+        if (CPA_TRUE == session->cmacHeld)
+        {
+            cbcMacBlocks(&session->aesKey, session->cmacState, session->cmacLast, 1);
+        }
+        cbcMacBlocks(&session->aesKey, session->cmacState, hashData, length / SW_AES_BLOCK_SIZE - 1);
+        memcpy(session->cmacLast, hashData + length - SW_AES_BLOCK_SIZE, SW_AES_BLOCK_SIZE);
+        session->cmacHeld = CPA_TRUE;
+        return CPA_STATUS_SUCCESS;
+    }
+
+    if (CPA_TRUE == session->cmacHeld && 0 == length)
+    {
+        hashData = session->cmacLast;
+        length = SW_AES_BLOCK_SIZE;
+    }
+    else if (CPA_TRUE == session->cmacHeld)
+    {
+        cbcMacBlocks(&session->aesKey, session->cmacState, session->cmacLast, 1);
+    }
+    cmacFinish(&session->aesKey, session->cmacK1, session->cmacK2, session->cmacState, hashData, length, fullMac);
+    memcpy(mac, fullMac, session->digestSize);
+    memset(session->cmacState, 0, SW_AES_BLOCK_SIZE);
+    session->cmacHeld = CPA_FALSE;
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus swProcess(SwSession *session, const CpaCySymOpData *opData, Cpa8U *data, Cpa8U *mac)
+{
+    Cpa8U *cipherData = data + opData->cryptoStartSrcOffsetInBytes;
+    const Cpa8U *hashData = data + opData->hashStartSrcOffsetInBytes;
+    Cpa8U fullMac[SW_MAX_DIGEST_SIZE];
+    CpaBoolean isZuc256 = CPA_FALSE;
+
+    if (CPA_CY_SYM_PACKET_TYPE_FULL != opData->packetType)
+    {
+        return processPartial(session, opData, data, mac);
+    }
+
+    if (CPA_CY_SYM_OP_CIPHER == session->symOperation)
+    {
+        isZuc256 = (CPA_CY_SYM_CIPHER_ZUC_EEA3 == session->cipherAlgorithm && SW_ZUC256_KEY_SIZE == session->keySize)
+                       ? CPA_TRUE
+                       : CPA_FALSE;
+        if (NULL == opData->pIv ||
+            ((CPA_TRUE == isZuc256) ? SW_ZUC256_IV_SIZE : SW_AES_BLOCK_SIZE) != opData->ivLenInBytes)
+        {
+            return CPA_STATUS_INVALID_PARAM;
+        }
+        switch (session->cipherAlgorithm)
+        {
+            case CPA_CY_SYM_CIPHER_SNOW3G_UEA2:
+                swSnow3gF8(session->key, opData->pIv, cipherData, opData->messageLenToCipherInBytes);
+                break;
+            case CPA_CY_SYM_CIPHER_ZUC_EEA3:
+                if (CPA_TRUE == isZuc256)
+                {
+                    swZuc256Eea(session->key, opData->pIv, cipherData, opData->messageLenToCipherInBytes);
+                    break;
+                }
+                swZucEea3(session->key, opData->pIv, cipherData, opData->messageLenToCipherInBytes);
+                break;
+            case CPA_CY_SYM_CIPHER_AES_CTR:
+                swAesCtr(&session->aesKey, opData->pIv, cipherData, opData->messageLenToCipherInBytes);
+                break;
+            case CPA_CY_SYM_CIPHER_AES_CBC:
+                swAesCbc(&session->aesKey,
+                         opData->pIv,
+                         cipherData,
+                         opData->messageLenToCipherInBytes,
+                         (CPA_CY_SYM_CIPHER_DIRECTION_ENCRYPT == session->cipherDirection) ? CPA_TRUE : CPA_FALSE);
+                break;
+            default:
+                return CPA_STATUS_UNSUPPORTED;
+        }
+        return CPA_STATUS_SUCCESS;
+    }
+
+    switch (session->hashAlgorithm)
+    {
+        case CPA_CY_SYM_HASH_SNOW3G_UIA2:
+            if (NULL == opData->pAdditionalAuthData)
+            {
+                return CPA_STATUS_INVALID_PARAM;
+            }
+            swSnow3gF9(session->key, opData->pAdditionalAuthData, hashData, (Cpa64U)opData->messageLenToHashInBytes * 8, fullMac);
+            break;
+        case CPA_CY_SYM_HASH_ZUC_EIA3:
+            if (NULL == opData->pAdditionalAuthData)
+            {
+                return CPA_STATUS_INVALID_PARAM;
+            }
+            if (SW_ZUC256_KEY_SIZE == session->keySize)
+            {
+                return swZuc256Mac(session->key,
+                                   opData->pAdditionalAuthData,
+                                   hashData,
+                                   (Cpa64U)opData->messageLenToHashInBytes * 8,
+                                   mac,
+                                   session->digestSize);
+            }
+            swZucEia3(session->key, opData->pAdditionalAuthData, hashData, (Cpa64U)opData->messageLenToHashInBytes * 8, fullMac);
+            break;
+        case CPA_CY_SYM_HASH_AES_CMAC:
+            swAesCmac(&session->aesKey, session->cmacK1, session->cmacK2, hashData, opData->messageLenToHashInBytes, fullMac);
+            break;
+        case CPA_CY_SYM_HASH_SHA256:
+            if (CPA_CY_SYM_HASH_MODE_PLAIN == session->hashMode)
+            {
+                swSha256(hashData, opData->messageLenToHashInBytes, fullMac);
+            }
+            else
+            {
+                swHmacSha256(session->key, session->keySize, hashData, opData->messageLenToHashInBytes, fullMac);
+            }
+            break;
+        default:
+            return CPA_STATUS_UNSUPPORTED;
+    }
+    memcpy(mac, fullMac, session->digestSize);
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus swProcessBufferList(SwSession *session,
+                              const CpaCySymSessionSetupData *setupData,
+                              const CpaCySymOpData *opData,
+                              CpaBufferList *bufferList,
+                              CpaBoolean *pVerifyResult)
+{
+    Cpa8U mac[SW_MAX_DIGEST_SIZE];
+    Cpa8U *data = NULL;
+    Cpa8U *digest = NULL;
+    Cpa32U digestSize = setupData->hashSetupData.digestResultLenInBytes;
+    Cpa32U totalLength = 0;
+    Cpa32U offset = 0;
+    Cpa32U bufferIdx = 0;
+    CpaStatus status = CPA_STATUS_SUCCESS;
+
+    *pVerifyResult = CPA_TRUE;
+    for (bufferIdx = 0; bufferIdx < bufferList->numBuffers; bufferIdx++)
+    {
+        totalLength += bufferList->pBuffers[bufferIdx].dataLenInBytes;
+    }
+    if (1 == bufferList->numBuffers)
+    {
+        data = bufferList->pBuffers[0].pData;
+    }
+    else
+    {
+        data = malloc(totalLength);
+        if (NULL == data)
+        {
+            return CPA_STATUS_RESOURCE;
+        }
+        for (bufferIdx = 0, offset = 0; bufferIdx < bufferList->numBuffers; bufferIdx++)
+        {
+            memcpy(data + offset,
+                   bufferList->pBuffers[bufferIdx].pData,
+                   bufferList->pBuffers[bufferIdx].dataLenInBytes);
+            offset += bufferList->pBuffers[bufferIdx].dataLenInBytes;
+        }
+    }
+
+    status = swProcess(session, opData, data, mac);
+    /* Only the last partial of a stream has a digest */
+    if (CPA_STATUS_SUCCESS == status && CPA_CY_SYM_OP_HASH == setupData->symOperation &&
+        CPA_CY_SYM_PACKET_TYPE_PARTIAL != opData->packetType)
+    {
+        if (CPA_TRUE == setupData->digestIsAppended)
+        {
+            /* The digest goes right after the hashed region, or is checked there */
+            offset = opData->hashStartSrcOffsetInBytes + opData->messageLenToHashInBytes;
+            digest = data + offset;
+            if (offset + digestSize > totalLength)
+            {
+                status = CPA_STATUS_INVALID_PARAM;
+            }
+            else if (CPA_TRUE == setupData->verifyDigest)
+            {
+                *pVerifyResult = (0 == memcmp(digest, mac, digestSize)) ? CPA_TRUE : CPA_FALSE;
+            }
+            else
+            {
+                memcpy(digest, mac, digestSize);
+            }
+        }
+        else if (NULL != opData->pDigestResult)
+        {
+            memcpy(opData->pDigestResult, mac, digestSize);
+        }
+    }
+
+    if (1 != bufferList->numBuffers)
+    {
+        for (bufferIdx = 0, offset = 0; bufferIdx < bufferList->numBuffers; bufferIdx++)
+        {
+            memcpy(bufferList->pBuffers[bufferIdx].pData,
+                   data + offset,
+                   bufferList->pBuffers[bufferIdx].dataLenInBytes);
+            offset += bufferList->pBuffers[bufferIdx].dataLenInBytes;
+        }
+        free(data);
+    }
+    return status;
+}
@@ -0,0 +1,137 @@
+#ifndef SW_CRYPTO_H
+#define SW_CRYPTO_H
+
+#include "cpa.h"
+#include "cpa_cy_sym.h"
+
+#define SW_MAX_KEY_SIZE 32
+#define SW_AES_BLOCK_SIZE 16
+#define SW_AES_MAX_ROUNDS 14
+#define SW_MAX_DIGEST_SIZE 32
+#define SW_ZUC256_KEY_SIZE 32
+#define SW_ZUC256_IV_SIZE 25 /* the last 8 bytes carry 6 bits each */
+#define SW_SHA256_BLOCK_SIZE 64
+#define SW_SHA256_DIGEST_SIZE 32
+#define SW_SHA256_LANES 8 /* messages the AVX2 implementation hashes side by side */
+
+/*
+ * Implementations of SHA-256, see sw_sha256.c
+ */
+typedef enum _SwSha256Impl {
+    SW_SHA256_AUTO = 0, /* the fastest one the CPU has */
+    SW_SHA256_SCALAR,
+    SW_SHA256_SHANI, /* SHA extensions, one message at a time */
+    SW_SHA256_AVX2, /* SW_SHA256_LANES messages at a time */
+} SwSha256Impl;
+
+/*
+ * One message of a batch of HMAC-SHA-256, with its own key
+ */
+typedef struct _SwHmacMsg {
+    const Cpa8U *key;
+    Cpa32U keySize;
+    const Cpa8U *data;
+    Cpa32U length;
+    Cpa8U *mac; /* SW_SHA256_DIGEST_SIZE bytes */
+} SwHmacMsg;
+
+/*
+ * Expanded AES key, encryption round keys as big-endian words and as the bytes the AES instructions take
+ */
+typedef struct _SwAesKey {
+    Cpa32U roundKeys[4 * (SW_AES_MAX_ROUNDS + 1)];
+    Cpa8U roundKeyBytes[SW_AES_BLOCK_SIZE * (SW_AES_MAX_ROUNDS + 1)];
+    Cpa32U numRounds;
+} SwAesKey;
+
+/*
+ * Software counterpart of a QAT session: the algorithm choice and the key material, expanded once at init
+ */
+typedef struct _SwSession {
+    CpaCySymOp symOperation;
+    CpaCySymCipherAlgorithm cipherAlgorithm;
+    CpaCySymCipherDirection cipherDirection;
+    CpaCySymHashAlgorithm hashAlgorithm;
+    CpaCySymHashMode hashMode;
+    Cpa32U digestSize;
+    Cpa8U key[SW_MAX_KEY_SIZE];
+    Cpa32U keySize;
+    SwAesKey aesKey;
+    Cpa8U cmacK1[SW_AES_BLOCK_SIZE];
+    Cpa8U cmacK2[SW_AES_BLOCK_SIZE];
+    /* CMAC of a stream of partials: the chain so far, and the last block seen until it is known not to be last */
+    Cpa8U cmacState[SW_AES_BLOCK_SIZE];
+    Cpa8U cmacLast[SW_AES_BLOCK_SIZE];
+    CpaBoolean cmacHeld;
+} SwSession;
+
+/*
+ *******************
+ * Primitives
+ *******************
+ */
+void swAesExpandKey(const Cpa8U *key, Cpa32U keySize, SwAesKey *aesKey);
+void swAesEncryptBlock(const SwAesKey *aesKey, const Cpa8U *in, Cpa8U *out);
+void swAesDecryptBlock(const SwAesKey *aesKey, const Cpa8U *in, Cpa8U *out);
+void swAesCtr(const SwAesKey *aesKey, const Cpa8U *iv, Cpa8U *data, Cpa32U length);
+void swAesCbc(const SwAesKey *aesKey, const Cpa8U *iv, Cpa8U *data, Cpa32U length, CpaBoolean encrypt);
+void swAesCmac(const SwAesKey *aesKey,
+               const Cpa8U *k1,
+               const Cpa8U *k2,
+               const Cpa8U *data,
+               Cpa32U length,
+               Cpa8U *mac);
+/* AES-CTR and the CBC-MAC chain of AES-CMAC over whole blocks on AES-NI, see sw_aesni.c */
+CpaBoolean swAesNiSupported(void);
+void swAesNiCtr(const SwAesKey *aesKey, const Cpa8U *iv, Cpa8U *data, Cpa32U length);
+void swAesNiCbcMac(const SwAesKey *aesKey, Cpa8U *state, const Cpa8U *data, Cpa32U numBlocks);
+void swSnow3gF8(const Cpa8U *key, const Cpa8U *iv, Cpa8U *data, Cpa32U length);
+void swSnow3gF9(const Cpa8U *key, const Cpa8U *iv, const Cpa8U *data, Cpa64U bitLen, Cpa8U *mac);
+void swZucEea3(const Cpa8U *key, const Cpa8U *iv, Cpa8U *data, Cpa32U length);
+void swZucEia3(const Cpa8U *key, const Cpa8U *iv, const Cpa8U *data, Cpa64U bitLen, Cpa8U *mac);
+/* ZUC-256 on a 32 byte key and a 25 byte IV, the MAC of 4, 8 or 16 bytes */
+void swZuc256Eea(const Cpa8U *key, const Cpa8U *iv, Cpa8U *data, Cpa32U length);
+CpaStatus swZuc256Mac(const Cpa8U *key,
+                      const Cpa8U *iv,
+                      const Cpa8U *data,
+                      Cpa64U bitLen,
+                      Cpa8U *mac,
+                      Cpa32U macSize);
+CpaBoolean swSha256Supported(Cpa32U impl);
+const char *swSha256ImplName(Cpa32U impl);
+void swSha256(const Cpa8U *data, Cpa32U length, Cpa8U *digest);
+void swHmacSha256(const Cpa8U *key, Cpa32U keySize, const Cpa8U *data, Cpa32U length, Cpa8U *mac);
+/* Messages up to 55 bytes under keys up to a block batch in lockstep on the AVX2 implementation */
+void swHmacSha256Batch(Cpa32U impl, const SwHmacMsg *msgs, Cpa32U numMsgs);
+
+/*
+ *******************
+ * Sessions
+ *******************
+ */
+
+/*
+ * The NEA/NIA algorithms, AES-CBC and SHA-256 (plain or HMAC, for the key derivation) are supported; lengths are
+ * in bytes as in the QAT op data. A 32 byte ZUC key selects ZUC-256, with a SW_ZUC256_IV_SIZE IV and a MAC of 4,
+ * 8 or 16 bytes. Partial packets are supported on AES-CTR, AES-CBC and AES-CMAC only, one stream per session.
+ */
+CpaStatus swInitSession(SwSession *session, const CpaCySymSessionSetupData *setupData);
+
+/*
+ * Process the request on the contiguous data its offsets refer to. Ciphers work in place, hashes put the digest
+ * in mac. A partial packet updates the IV of a cipher, or the CMAC state of the session, for the next one.
+ */
+CpaStatus swProcess(SwSession *session, const CpaCySymOpData *opData, Cpa8U *data, Cpa8U *mac);
+
+/*
+ * Process the request in place on a buffer list as the device would, for the session set up with setupData. A
+ * list of several buffers is gathered into a contiguous copy and scattered back afterwards. A digest to append
+ * goes right after the hashed region, or is compared with what is there into pVerifyResult.
+ */
+CpaStatus swProcessBufferList(SwSession *session,
+                              const CpaCySymSessionSetupData *setupData,
+                              const CpaCySymOpData *opData,
+                              CpaBufferList *bufferList,
+                              CpaBoolean *pVerifyResult);
+
+#endif
@@ -0,0 +1,483 @@
+/*
+ * SHA-256 and HMAC-SHA-256 (FIPS 180-4, RFC 2104) for the TS 33.220 key derivation function.
+ *
+ * Three implementations of the compression function: portable C, the SHA extensions (one message at a time, a
+ * few cycles per byte) and AVX2, which runs SW_SHA256_LANES messages side by side in the lanes of the vector
+ * registers. Key derivations hash short messages of equal length, so a batch of them stays in lockstep: the
+ * AVX2 path takes eight at a time, each lane with its own key and message. The fastest implementation the CPU
+ * has is picked at run time.
+ */
+
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "cpa.h"
+
+#include "sw_crypto.h"
+
+#define ROR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/* Messages up to this length hash in two blocks behind the key block, and batch in lockstep */
+#define SHA256_MAX_ONE_BLOCK_MSG (SW_SHA256_BLOCK_SIZE - 9)
+
+static const Cpa32U sha256K_g[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const Cpa32U sha256Iv_g[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static inline Cpa32U loadBe32(const Cpa8U *p)
+{
+    return ((Cpa32U)p[0] << 24) | ((Cpa32U)p[1] << 16) | ((Cpa32U)p[2] << 8) | p[3];
+}
+
+static inline void storeBe32(Cpa8U *p, Cpa32U v)
+{
+    p[0] = (Cpa8U)(v >> 24);
+    p[1] = (Cpa8U)(v >> 16);
+    p[2] = (Cpa8U)(v >> 8);
+    p[3] = (Cpa8U)v;
+}
+
+static void sha256BlocksScalar(Cpa32U state[8], const Cpa8U *data, Cpa32U numBlocks)
+{
+    Cpa32U w[64];
+    Cpa32U a, b, c, d, e, f, g, h;
+    Cpa32U t1 = 0;
+    Cpa32U t2 = 0;
+    Cpa32U i = 0;
+
+    for (; 0 < numBlocks; numBlocks--, data += SW_SHA256_BLOCK_SIZE)
+    {
+        for (i = 0; i < 16; i++)
+        {
+            w[i] = loadBe32(data + 4 * i);
+        }
+        for (i = 16; i < 64; i++)
+        {
+            w[i] = w[i - 16] + (ROR32(w[i - 15], 7) ^ ROR32(w[i - 15], 18) ^ (w[i - 15] >> 3)) + w[i - 7] +
+                   (ROR32(w[i - 2], 17) ^ ROR32(w[i - 2], 19) ^ (w[i - 2] >> 10));
+        }
+
+        a = state[0];
+        b = state[1];
+        c = state[2];
+        d = state[3];
+        e = state[4];
+        f = state[5];
+        g = state[6];
+        h = state[7];
+        for (i = 0; i < 64; i++)
+        {
+            t1 = h + (ROR32(e, 6) ^ ROR32(e, 11) ^ ROR32(e, 25)) + ((e & f) ^ (~e & g)) + sha256K_g[i] + w[i];
+            t2 = (ROR32(a, 2) ^ ROR32(a, 13) ^ ROR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(__x86_64__)
+
+/*
+ * The SHA extensions keep the state as ABEF and CDGH and do two rounds per instruction, four message words
+ * of the schedule per vector
+ */
+__attribute__((target("sha,sse4.1"))) static void sha256BlocksShaNi(Cpa32U state[8],
+                                                                    const Cpa8U *data,
+                                                                    Cpa32U numBlocks)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i msgs[4];
+    __m128i state0, state1, msg, tmp, abefSave, cdghSave;
+    Cpa32U group = 0;
+
+    tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xb1);
+    state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1b);
+    state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+    for (; 0 < numBlocks; numBlocks--, data += SW_SHA256_BLOCK_SIZE)
+    {
+        abefSave = state0;
+        cdghSave = state1;
+        for (group = 0; group < 16; group++)
+        {
+            if (4 > group)
+            {
+                msgs[group] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * group)), byteSwap);
+            }
+            else
+            {
+                /* W[t] = W[t-16] + s0(W[t-15]) + W[t-7] + s1(W[t-2]), msgs[group % 4] holds W[t-16] */
+                tmp = _mm_sha256msg1_epu32(msgs[group % 4], msgs[(group + 1) % 4]);
+                tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(msgs[(group + 3) % 4], msgs[(group + 2) % 4], 4));
+                msgs[group % 4] = _mm_sha256msg2_epu32(tmp, msgs[(group + 3) % 4]);
+            }
+            msg = _mm_add_epi32(msgs[group % 4], _mm_loadu_si128((const __m128i *)&sha256K_g[4 * group]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0e));
+        }
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    _mm_storeu_si128((__m128i *)&state[0], _mm_blend_epi16(tmp, state1, 0xf0));
+    _mm_storeu_si128((__m128i *)&state[4], _mm_alignr_epi8(state1, tmp, 8));
+}
+
+#define ROR256(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+/*
+ * One block of each of SW_SHA256_LANES messages, lane i of every vector belongs to message i. states[i] is
+ * the state of message i.
+ */
+__attribute__((target("avx2"))) static void sha256BlockX8Avx2(Cpa32U states[][8],
+                                                              const Cpa8U *const blocks[SW_SHA256_LANES])
+{
+    __m256i w[16];
+    __m256i v[8];
+    __m256i saved[8];
+    __m256i t1, t2, s0, s1;
+    Cpa32U lanes[SW_SHA256_LANES] __attribute__((aligned(32)));
+    Cpa32U i = 0;
+    Cpa32U lane = 0;
+
+    /* Transpose the states into one vector per state word */
+    for (i = 0; i < 8; i++)
+    {
+        for (lane = 0; lane < SW_SHA256_LANES; lane++)
+        {
+            lanes[lane] = states[lane][i];
+        }
+        v[i] = _mm256_load_si256((const __m256i *)lanes);
+        saved[i] = v[i];
+    }
+
+    for (i = 0; i < 64; i++)
+    {
+        if (16 > i)
+        {
+            for (lane = 0; lane < SW_SHA256_LANES; lane++)
+            {
+                lanes[lane] = loadBe32(blocks[lane] + 4 * i);
+            }
+            w[i] = _mm256_load_si256((const __m256i *)lanes);
+        }
+        else
+        {
+            s0 = _mm256_xor_si256(_mm256_xor_si256(ROR256(w[(i + 1) % 16], 7), ROR256(w[(i + 1) % 16], 18)),
+                                  _mm256_srli_epi32(w[(i + 1) % 16], 3));
+            s1 = _mm256_xor_si256(_mm256_xor_si256(ROR256(w[(i + 14) % 16], 17), ROR256(w[(i + 14) % 16], 19)),
+                                  _mm256_srli_epi32(w[(i + 14) % 16], 10));
+            w[i % 16] = _mm256_add_epi32(_mm256_add_epi32(w[i % 16], s0), _mm256_add_epi32(w[(i + 9) % 16], s1));
+        }
+
+        s1 = _mm256_xor_si256(_mm256_xor_si256(ROR256(v[4], 6), ROR256(v[4], 11)), ROR256(v[4], 25));
+        t1 = _mm256_xor_si256(_mm256_and_si256(v[4], v[5]), _mm256_andnot_si256(v[4], v[6]));
+        t1 = _mm256_add_epi32(_mm256_add_epi32(v[7], s1), t1);
+        t1 = _mm256_add_epi32(_mm256_add_epi32(t1, _mm256_set1_epi32((int)sha256K_g[i])), w[i % 16]);
+        s0 = _mm256_xor_si256(_mm256_xor_si256(ROR256(v[0], 2), ROR256(v[0], 13)), ROR256(v[0], 22));
+        t2 = _mm256_xor_si256(_mm256_and_si256(v[0], _mm256_xor_si256(v[1], v[2])), _mm256_and_si256(v[1], v[2]));
+        t2 = _mm256_add_epi32(s0, t2);
+        v[7] = v[6];
+        v[6] = v[5];
+        v[5] = v[4];
+        v[4] = _mm256_add_epi32(v[3], t1);
+        v[3] = v[2];
+        v[2] = v[1];
+        v[1] = v[0];
+        v[0] = _mm256_add_epi32(t1, t2);
+    }
+
+    for (i = 0; i < 8; i++)
+    {
+        _mm256_store_si256((__m256i *)lanes, _mm256_add_epi32(v[i], saved[i]));
+        for (lane = 0; lane < SW_SHA256_LANES; lane++)
+        {
+            states[lane][i] = lanes[lane];
+        }
+    }
+}
+
+#endif
+
+CpaBoolean swSha256Supported(Cpa32U impl)
+{
+    switch (impl)
+    {
+        case SW_SHA256_AUTO:
+        case SW_SHA256_SCALAR:
+            return CPA_TRUE;
+#if defined(__x86_64__)
+        case SW_SHA256_SHANI:
+            return (__builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1")) ? CPA_TRUE : CPA_FALSE;
+        case SW_SHA256_AVX2:
+            return __builtin_cpu_supports("avx2") ? CPA_TRUE : CPA_FALSE;
+#endif
+        default:
+            return CPA_FALSE;
+    }
+}
+
+const char *swSha256ImplName(Cpa32U impl)
+{
+    switch (impl)
+    {
+        case SW_SHA256_AUTO:
+            return "auto";
+        case SW_SHA256_SCALAR:
+            return "scalar";
+        case SW_SHA256_SHANI:
+            return "sha-ni";
+        case SW_SHA256_AVX2:
+            return "avx2 x8";
+        default:
+            return "?";
+    }
+}
+
+/*
+ * SHA-NI for single messages when the CPU has it, the batch then also runs one message at a time: on CPUs with
+ * the extensions they beat eight AVX2 lanes
+ */
+static Cpa32U resolveImpl(Cpa32U impl)
+{
+    if (SW_SHA256_AUTO != impl && CPA_TRUE == swSha256Supported(impl))
+    {
+        return impl;
+    }
+    if (CPA_TRUE == swSha256Supported(SW_SHA256_SHANI))
+    {
+        return SW_SHA256_SHANI;
+    }
+    return (CPA_TRUE == swSha256Supported(SW_SHA256_AVX2)) ? SW_SHA256_AVX2 : SW_SHA256_SCALAR;
+}
+
+static void sha256Blocks(Cpa32U impl, Cpa32U state[8], const Cpa8U *data, Cpa32U numBlocks)
+{
+#if defined(__x86_64__)
+    if (SW_SHA256_SHANI == impl)
+    {
+        sha256BlocksShaNi(state, data, numBlocks);
+        return;
+    }
+#endif
+    sha256BlocksScalar(state, data, numBlocks);
+}
+
+/* Hash of a message behind prefixLen bytes already hashed into state */
+static void sha256Finish(Cpa32U impl,
+                         Cpa32U state[8],
+                         Cpa64U prefixLen,
+                         const Cpa8U *data,
+                         Cpa32U length,
+                         Cpa8U *digest)
+{
+    Cpa8U tail[2 * SW_SHA256_BLOCK_SIZE] = {0};
+    Cpa64U bitLen = (prefixLen + length) * 8;
+    Cpa32U numBlocks = length / SW_SHA256_BLOCK_SIZE;
+    Cpa32U tailLen = length % SW_SHA256_BLOCK_SIZE;
+    Cpa32U tailBlocks = (tailLen <= SHA256_MAX_ONE_BLOCK_MSG) ? 1 : 2;
+    Cpa32U i = 0;
+
+    sha256Blocks(impl, state, data, numBlocks);
+    memcpy(tail, data + numBlocks * SW_SHA256_BLOCK_SIZE, tailLen);
+    tail[tailLen] = 0x80;
+    for (i = 0; i < 8; i++)
+    {
+        tail[tailBlocks * SW_SHA256_BLOCK_SIZE - 1 - i] = (Cpa8U)(bitLen >> (8 * i));
+    }
+    sha256Blocks(impl, state, tail, tailBlocks);
+    for (i = 0; i < 8; i++)
+    {
+        storeBe32(digest + 4 * i, state[i]);
+    }
+}
+
+void swSha256(const Cpa8U *data, Cpa32U length, Cpa8U *digest)
+{
+    Cpa32U state[8];
+
+    memcpy(state, sha256Iv_g, sizeof(state));
+    sha256Finish(resolveImpl(SW_SHA256_AUTO), state, 0, data, length, digest);
+}
+
+/* Key padded to a block and XORed with pad, keys over a block long are hashed first */
+static void hmacKeyBlock(const Cpa8U *key, Cpa32U keySize, Cpa8U pad, Cpa8U *block)
+{
+    Cpa8U keyDigest[SW_SHA256_DIGEST_SIZE];
+    Cpa32U i = 0;
+
+    if (SW_SHA256_BLOCK_SIZE < keySize)
+    {
+        swSha256(key, keySize, keyDigest);
+        key = keyDigest;
+        keySize = SW_SHA256_DIGEST_SIZE;
+    }
+    memset(block, pad, SW_SHA256_BLOCK_SIZE);
+    for (i = 0; i < keySize; i++)
+    {
+        block[i] ^= key[i];
+    }
+}
+
+static void hmacOne(Cpa32U impl, const SwHmacMsg *msg)
+{
+    Cpa8U block[SW_SHA256_BLOCK_SIZE];
+    Cpa8U inner[SW_SHA256_DIGEST_SIZE];
+    Cpa32U state[8];
+
+    memcpy(state, sha256Iv_g, sizeof(state));
+    hmacKeyBlock(msg->key, msg->keySize, 0x36, block);
+    sha256Blocks(impl, state, block, 1);
+    sha256Finish(impl, state, SW_SHA256_BLOCK_SIZE, msg->data, msg->length, inner);
+
+    memcpy(state, sha256Iv_g, sizeof(state));
+    hmacKeyBlock(msg->key, msg->keySize, 0x5c, block);
+    sha256Blocks(impl, state, block, 1);
+    sha256Finish(impl, state, SW_SHA256_BLOCK_SIZE, inner, SW_SHA256_DIGEST_SIZE, msg->mac);
+}
+
+void swHmacSha256(const Cpa8U *key, Cpa32U keySize, const Cpa8U *data, Cpa32U length, Cpa8U *mac)
+{
+    SwHmacMsg msg = {key, keySize, data, length, mac};
+
+    hmacOne(resolveImpl(SW_SHA256_AUTO), &msg);
+}
+
+#if defined(__x86_64__)
+
+/* Last block of a message of length bytes behind one block, which must fit in it with the padding */
+static void padOneBlock(const Cpa8U *data, Cpa32U length, Cpa8U *block)
+{
+    Cpa64U bitLen = ((Cpa64U)SW_SHA256_BLOCK_SIZE + length) * 8;
+    Cpa32U i = 0;
+
+    memset(block, 0, SW_SHA256_BLOCK_SIZE);
+    memcpy(block, data, length);
+    block[length] = 0x80;
+    for (i = 0; i < 8; i++)
+    {
+        block[SW_SHA256_BLOCK_SIZE - 1 - i] = (Cpa8U)(bitLen >> (8 * i));
+    }
+}
+
+/*
+ * Up to SW_SHA256_LANES messages of at most SHA256_MAX_ONE_BLOCK_MSG bytes under keys of at most a block, four
+ * blocks per lane: inner key, message, outer key, inner digest. Unused lanes hash the blocks of lane 0.
+ */
+static void hmacX8(const SwHmacMsg *msgs, Cpa32U numMsgs)
+{
+    Cpa8U keyBlocks[SW_SHA256_LANES][SW_SHA256_BLOCK_SIZE];
+    Cpa8U msgBlocks[SW_SHA256_LANES][SW_SHA256_BLOCK_SIZE];
+    Cpa8U inner[SW_SHA256_DIGEST_SIZE];
+    const Cpa8U *keyLanes[SW_SHA256_LANES];
+    const Cpa8U *msgLanes[SW_SHA256_LANES];
+    Cpa32U states[SW_SHA256_LANES][8];
+    Cpa32U lane = 0;
+    Cpa32U i = 0;
+
+    for (lane = 0; lane < SW_SHA256_LANES; lane++)
+    {
+        memcpy(states[lane], sha256Iv_g, sizeof(sha256Iv_g));
+        keyLanes[lane] = keyBlocks[(lane < numMsgs) ? lane : 0];
+        msgLanes[lane] = msgBlocks[(lane < numMsgs) ? lane : 0];
+    }
+    for (lane = 0; lane < numMsgs; lane++)
+    {
+        hmacKeyBlock(msgs[lane].key, msgs[lane].keySize, 0x36, keyBlocks[lane]);
+        padOneBlock(msgs[lane].data, msgs[lane].length, msgBlocks[lane]);
+    }
+    sha256BlockX8Avx2(states, keyLanes);
+    sha256BlockX8Avx2(states, msgLanes);
+
+    for (lane = 0; lane < SW_SHA256_LANES; lane++)
+    {
+        if (lane < numMsgs)
+        {
+            for (i = 0; i < 8; i++)
+            {
+                storeBe32(inner + 4 * i, states[lane][i]);
+            }
+            hmacKeyBlock(msgs[lane].key, msgs[lane].keySize, 0x5c, keyBlocks[lane]);
+            padOneBlock(inner, SW_SHA256_DIGEST_SIZE, msgBlocks[lane]);
+        }
+        memcpy(states[lane], sha256Iv_g, sizeof(sha256Iv_g));
+    }
+    sha256BlockX8Avx2(states, keyLanes);
+    sha256BlockX8Avx2(states, msgLanes);
+
+    for (lane = 0; lane < numMsgs; lane++)
+    {
+        for (i = 0; i < 8; i++)
+        {
+            storeBe32(msgs[lane].mac + 4 * i, states[lane][i]);
+        }
+    }
+}
+
+#endif
+
+void swHmacSha256Batch(Cpa32U impl, const SwHmacMsg *msgs, Cpa32U numMsgs)
+{
+    Cpa32U msgIdx = 0;
+#if defined(__x86_64__)
+    SwHmacMsg lanes[SW_SHA256_LANES];
+    Cpa32U numLanes = 0;
+#endif
+
+    impl = resolveImpl(impl);
+    for (msgIdx = 0; msgIdx < numMsgs; msgIdx++)
+    {
+#if defined(__x86_64__)
+        /* Longer keys or messages take more blocks than their lanes would, they go one at a time */
+        if (SW_SHA256_AVX2 == impl && SW_SHA256_BLOCK_SIZE >= msgs[msgIdx].keySize &&
+            SHA256_MAX_ONE_BLOCK_MSG >= msgs[msgIdx].length)
+        {
+            lanes[numLanes++] = msgs[msgIdx];
+            if (SW_SHA256_LANES == numLanes)
+            {
+                hmacX8(lanes, numLanes);
+                numLanes = 0;
+            }
+            continue;
+        }
+#endif
+        hmacOne((SW_SHA256_AVX2 == impl) ? SW_SHA256_SCALAR : impl, &msgs[msgIdx]);
+    }
+#if defined(__x86_64__)
+    if (0 < numLanes)
+    {
+        hmacX8(lanes, numLanes);
+    }
+#endif
+}
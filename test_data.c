@@ -12,6 +12,12 @@
  * 3. ETSI/SAGE Specification of the 3GPP Confidentiality and Integrity Algorithms 128-EEA3 & 128-EIA3.
  *    Document 3: Implementor’s Test Data. Version: 1.1 Data: 4th January 2011.
  *    https://www.gsma.com/security/wp-content/uploads/2019/05/eea3eia3testdatav11.pdf
+ *
+ * 4. The ZUC-256 Stream Cipher. Design Team of ZUC-256. Version 1.1, 2018.
+ *    http://www.is.cas.cn/ztzl2016/zouchongzhi/201801/W020180416526664982687.pdf
+ *
+ * The 256-bit NEA2/NIA2 sets take the parameters of the 128-bit sets under a 256-bit key, with the expected
+ * output computed with OpenSSL. The 256-bit NEA3/NIA3 sets are the all-zero key and IV vectors of document 4.
  */
 
 #include <stdio.h>
@@ -21,6 +27,7 @@
 #include "cpa_types.h"
 #include "cpa_cy_sym.h"
 
+#include "arena.h"
 #include "utils.h"
 
 CpaStatus genNea1TestData(int testSetId, TestData *ret)
@@ -52,14 +59,14 @@ CpaStatus genNea1TestData(int testSetId, TestData *ret)
             0xDD, 0xC1, 0xB6, 0x5F, 0x0A, 0xA0, 0xD9, 0x7A, 0x05, 0x3D, 0xB5, 0x5A, 0x88, 0xC4, 0xC4, 0xF9,
             0x60, 0x5E, 0x41, 0x40};
         ret->bitLen = 798;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count = 0x72A4F20F;
         ret->bearer = 0x0C;
         ret->dir = 1;
-        ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
         memcpy(ret->in, testIn, sizeof(testIn));
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn);
@@ -83,14 +90,14 @@ CpaStatus genNea1TestData(int testSetId, TestData *ret)
             0x89, 0x86, 0x4C, 0x41, 0x0F, 0x24, 0xF9, 0x19, 0xE6, 0x1E, 0x3D, 0xFD, 0xFA, 0xD7, 0x7E, 0x56,
             0x0D, 0xB0, 0xA9, 0xCD, 0x36, 0xC3, 0x4A, 0xE4, 0x18, 0x14, 0x90, 0xB2, 0x9F, 0x5F, 0xA2, 0xFC};
         ret->bitLen = 510;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count = 0xE28BCF7B;
         ret->bearer = 0x18;
         ret->dir = 0;
-        ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
         memcpy(ret->in, testIn, sizeof(testIn));
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn);
@@ -108,14 +115,14 @@ CpaStatus genNea1TestData(int testSetId, TestData *ret)
         Cpa8U testOut[] = {
             0xBA, 0x0F, 0x31, 0x30, 0x03, 0x34, 0xC5, 0x6B, 0x52, 0xA7, 0x49, 0x7C, 0xBA, 0xC0, 0x46};
         ret->bitLen = 120;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count = 0xFA556B26;
         ret->bearer = 0x03;
         ret->dir = 1;
-        ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
         memcpy(ret->in, testIn, sizeof(testIn));
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn);
@@ -150,14 +157,14 @@ CpaStatus genNea2TestData(int testSetId, TestData *ret)
             0xe9, 0xfe, 0xd8, 0xa6, 0x3d, 0x15, 0x53, 0x04, 0xd7, 0x1d, 0xf2, 0x0b, 0xf3, 0xe8, 0x22, 0x14,
             0xb2, 0x0e, 0xd7, 0xda, 0xd2, 0xf2, 0x33, 0xdc, 0x3c, 0x22, 0xd7, 0xbd, 0xee, 0xed, 0x8e, 0x78};
         ret->bitLen = 253;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count = 0x398a59b4;
         ret->bearer = 0x15;
         ret->dir = 1;
-        ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
         memcpy(ret->in, testIn, sizeof(testIn));
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn);
@@ -187,14 +194,14 @@ CpaStatus genNea2TestData(int testSetId, TestData *ret)
             0x95, 0x60, 0x86, 0xbc, 0xab, 0x18, 0x83, 0x60, 0x42, 0xe2, 0xe6, 0xce, 0x42, 0x43, 0x2a, 0x17,
             0x10, 0x5c, 0x53, 0xd0};
         ret->bitLen = 798;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count = 0xc675a64b;
         ret->bearer = 0x0c;
         ret->dir = 1;
-        ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
         memcpy(ret->in, testIn, sizeof(testIn));
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn);
@@ -216,14 +223,14 @@ CpaStatus genNea2TestData(int testSetId, TestData *ret)
             0x45, 0xac, 0xda, 0xac, 0xa4, 0x81, 0x38, 0xa3, 0xb0, 0xc4, 0x71, 0xe2, 0xa7, 0x04, 0x1a, 0x57,
             0x64, 0x23, 0xd2, 0x92, 0x72, 0x87, 0xf0, 0x00};
         ret->bitLen = 310;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count = 0x544d49cd;
         ret->bearer = 0x04;
         ret->dir = 0;
-        ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
         memcpy(ret->in, testIn, sizeof(testIn));
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn);
@@ -258,14 +265,14 @@ CpaStatus genNea3TestData(int testSetId, TestData *ret)
             0xa6, 0xc8, 0x5f, 0xc6, 0x6a, 0xfb, 0x85, 0x33, 0xaa, 0xfc, 0x25, 0x18, 0xdf, 0xe7, 0x84, 0x94,
             0x0e, 0xe1, 0xe4, 0xb0, 0x30, 0x23, 0x8c, 0xc8, 0x00, 0x00, 0x00, 0x00};
         ret->bitLen = 193;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count = 0x66035492;
         ret->bearer = 0x0f;
         ret->dir = 0;
-        ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
         memcpy(ret->in, testIn, sizeof(testIn));
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn);
@@ -295,14 +302,14 @@ CpaStatus genNea3TestData(int testSetId, TestData *ret)
             0xdf, 0x5a, 0x47, 0x3a, 0x57, 0xa4, 0xa0, 0x0d, 0x98, 0x5e, 0xba, 0xd8, 0x80, 0xd6, 0xf2, 0x38,
             0x64, 0xa0, 0x7b, 0x01};
         ret->bitLen = 800;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count = 0x00056823;
         ret->bearer = 0x18;
         ret->dir = 1;
-        ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
         memcpy(ret->in, testIn, sizeof(testIn));
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn);
@@ -344,14 +351,135 @@ CpaStatus genNea3TestData(int testSetId, TestData *ret)
             0xfc, 0x09, 0xbc, 0xd9, 0x65, 0x70, 0xcb, 0x0c, 0x0c, 0x39, 0xdf, 0x5e, 0x29, 0x29, 0x4e, 0x82,
             0x70, 0x3a, 0x63, 0x7f, 0x80, 0x00, 0x00, 0x00};
         ret->bitLen = 1570;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count = 0x76452ec1;
         ret->bearer = 0x02;
         ret->dir = 1;
-        ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
         memcpy(ret->in, testIn, sizeof(testIn));
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
+        memcpy(ret->out, testOut, sizeof(testOut));
+        ret->keySize = sizeof(testKey);
+        ret->inSize = sizeof(testIn);
+        ret->outSize = sizeof(testOut);
+    }
+    else
+    {
+        return CPA_STATUS_FAIL;
+    }
+
+    genIv(ret);
+
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus genNea2_256TestData(int testSetId, TestData *ret)
+{
+    ret->op = CPA_CY_SYM_OP_CIPHER;
+    ret->cipherAlgo = CPA_CY_SYM_CIPHER_AES_CTR;
+
+    if (testSetId == 1)
+    {
+        /*
+         * NEA2 test set 1 under a 256-bit key
+         */
+        Cpa8U testKey[] = {
+            0xd3, 0xc5, 0xd5, 0x92, 0x32, 0x7f, 0xb1, 0x1c, 0x40, 0x35, 0xc6, 0x68, 0x0a, 0xf8, 0xc6, 0xd1,
+            0xa9, 0xcf, 0x8e, 0xc5, 0xb1, 0xa4, 0xf2, 0xe0, 0xc9, 0xd6, 0xe2, 0x1e, 0x7c, 0x3b, 0x5a, 0x48};
+        Cpa8U testIn[] = {
+            0x98, 0x1b, 0xa6, 0x82, 0x4c, 0x1b, 0xfb, 0x1a, 0xb4, 0x85, 0x47, 0x20, 0x29, 0xb7, 0x1d, 0x80,
+            0x8c, 0xe3, 0x3e, 0x2c, 0xc3, 0xc0, 0xb5, 0xfc, 0x1f, 0x3d, 0xe8, 0xa6, 0xdc, 0x66, 0xb1, 0xf0};
+        Cpa8U testOut[] = {
+            0x46, 0x05, 0xa8, 0xe2, 0x62, 0xa9, 0x0e, 0xce, 0xcc, 0x07, 0xe0, 0xda, 0xda, 0x8c, 0xe8, 0xe2,
+            0xea, 0x61, 0x4e, 0x69, 0xcb, 0x93, 0x7d, 0xf0, 0xf8, 0x76, 0xcb, 0xe5, 0xce, 0x7a, 0xc5, 0x88};
+        ret->bitLen = 253;
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
+        memcpy(ret->key, testKey, sizeof(testKey));
+        ret->count = 0x398a59b4;
+        ret->bearer = 0x15;
+        ret->dir = 1;
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
+        memcpy(ret->in, testIn, sizeof(testIn));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
+        memcpy(ret->out, testOut, sizeof(testOut));
+        ret->keySize = sizeof(testKey);
+        ret->inSize = sizeof(testIn);
+        ret->outSize = sizeof(testOut);
+    }
+    else if (testSetId == 2)
+    {
+        /*
+         * NEA2 test set 2 under a 256-bit key
+         */
+        Cpa8U testKey[] = {
+            0x2b, 0xd6, 0x45, 0x9f, 0x82, 0xc4, 0x40, 0xe0, 0x95, 0x2c, 0x49, 0x10, 0x48, 0x05, 0xff, 0x48,
+            0xc3, 0xa1, 0xe6, 0x7d, 0x0f, 0x5b, 0x7a, 0x2c, 0x9e, 0x8d, 0x4f, 0x16, 0x3b, 0x7e, 0x5a, 0x91};
+        Cpa8U testIn[] = {
+            0x7e, 0xc6, 0x12, 0x72, 0x74, 0x3b, 0xf1, 0x61, 0x47, 0x26, 0x44, 0x6a, 0x6c, 0x38, 0xce, 0xd1,
+            0x66, 0xf6, 0xca, 0x76, 0xeb, 0x54, 0x30, 0x04, 0x42, 0x86, 0x34, 0x6c, 0xef, 0x13, 0x0f, 0x92,
+            0x92, 0x2b, 0x03, 0x45, 0x0d, 0x3a, 0x99, 0x75, 0xe5, 0xbd, 0x2e, 0xa0, 0xeb, 0x55, 0xad, 0x8e,
+            0x1b, 0x19, 0x9e, 0x3e, 0xc4, 0x31, 0x60, 0x20, 0xe9, 0xa1, 0xb2, 0x85, 0xe7, 0x62, 0x79, 0x53,
+            0x59, 0xb7, 0xbd, 0xfd, 0x39, 0xbe, 0xf4, 0xb2, 0x48, 0x45, 0x83, 0xd5, 0xaf, 0xe0, 0x82, 0xae,
+            0xe6, 0x38, 0xbf, 0x5f, 0xd5, 0xa6, 0x06, 0x19, 0x39, 0x01, 0xa0, 0x8f, 0x4a, 0xb4, 0x1a, 0xab,
+            0x9b, 0x13, 0x48, 0x80};
+        Cpa8U testOut[] = {
+            0x30, 0x2d, 0xbd, 0xa6, 0x39, 0x75, 0x37, 0xd6, 0xf6, 0x76, 0xdb, 0xfc, 0xb2, 0x74, 0x02, 0xed,
+            0xc5, 0xb6, 0xeb, 0xce, 0x17, 0xbd, 0xf1, 0xf0, 0xd1, 0x36, 0x3c, 0x39, 0x47, 0x7b, 0x1c, 0xe5,
+            0xb1, 0x2b, 0xb3, 0x7f, 0x63, 0x5f, 0xc0, 0xcc, 0x65, 0xc7, 0x7b, 0x86, 0x28, 0xde, 0x11, 0x36,
+            0xfe, 0x9c, 0x29, 0x11, 0x10, 0x1f, 0x11, 0xcf, 0xe6, 0x21, 0x21, 0x92, 0x5a, 0x48, 0x93, 0xe0,
+            0x18, 0x17, 0x30, 0xc3, 0x5b, 0x6d, 0xc0, 0xdf, 0x14, 0x92, 0x4f, 0x58, 0x9b, 0x67, 0xbf, 0x2f,
+            0x69, 0x9a, 0xc3, 0xd6, 0x28, 0x8d, 0xe0, 0x6a, 0x0e, 0x46, 0x71, 0xfe, 0x1a, 0x57, 0xa6, 0x72,
+            0x44, 0xf3, 0x5e, 0xfc};
+        ret->bitLen = 798;
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
+        memcpy(ret->key, testKey, sizeof(testKey));
+        ret->count = 0xc675a64b;
+        ret->bearer = 0x0c;
+        ret->dir = 1;
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
+        memcpy(ret->in, testIn, sizeof(testIn));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
+        memcpy(ret->out, testOut, sizeof(testOut));
+        ret->keySize = sizeof(testKey);
+        ret->inSize = sizeof(testIn);
+        ret->outSize = sizeof(testOut);
+    }
+    else
+    {
+        return CPA_STATUS_FAIL;
+    }
+
+    genIv(ret);
+
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus genNea3_256TestData(int testSetId, TestData *ret)
+{
+    ret->op = CPA_CY_SYM_OP_CIPHER;
+    ret->cipherAlgo = CPA_CY_SYM_CIPHER_ZUC_EEA3;
+
+    if (testSetId == 1)
+    {
+        /*
+         * ZUC-256 keystream of the all-zero key and IV, COUNT, BEARER and DIRECTION of 0 give an all-zero IV
+         */
+        Cpa8U testKey[32] = {0};
+        Cpa8U testIn[40] = {0};
+        Cpa8U testOut[] = {
+            0x58, 0xd0, 0x3a, 0xd6, 0x2e, 0x03, 0x2c, 0xe2, 0xda, 0xfc, 0x68, 0x3a, 0x39, 0xbd, 0xcb, 0x03,
+            0x52, 0xa2, 0xbc, 0x67, 0xf1, 0xb7, 0xde, 0x74, 0x16, 0x3c, 0xe3, 0xa1, 0x01, 0xef, 0x55, 0x58,
+            0x96, 0x39, 0xd7, 0x5b, 0x95, 0xfa, 0x68, 0x1b};
+        ret->bitLen = 320;
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
+        memcpy(ret->key, testKey, sizeof(testKey));
+        ret->count = 0;
+        ret->bearer = 0;
+        ret->dir = 0;
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
+        memcpy(ret->in, testIn, sizeof(testIn));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn);
@@ -386,14 +514,14 @@ CpaStatus genNia1TestData(int testSetId, TestData *ret)
         Cpa8U testOut[] = {
             0x2B, 0xCE, 0x18, 0x20};
         ret->bitLen = 189;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count =  0x38A6F056;
         ret->fresh = 0x05D2EC49;
         ret->dir = 0;
-        ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
         memcpy(ret->in, testIn, sizeof(testIn));
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn);
@@ -413,14 +541,14 @@ CpaStatus genNia1TestData(int testSetId, TestData *ret)
         Cpa8U testOut[] = {
             0x38, 0xB5, 0x54, 0xC0};
         ret->bitLen = 384;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count =  0x14793E41;
         ret->fresh = 0x0397E8FD;
         ret->dir = 1;
-        ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
         memcpy(ret->in, testIn, sizeof(testIn));
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn);
@@ -454,18 +582,18 @@ CpaStatus genNia2TestData(int testSetId, TestData *ret)
         Cpa8U testOut[] = {
             0xb9, 0x37, 0x87, 0xe6};
         ret->bitLen = 64;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count =  0x398a59b4;
         ret->bearer = 0x1a;
         ret->dir = 1;
 
         genIv(ret);
-        ret->in = malloc(sizeof(Cpa8U) * (sizeof(testIn) + ret->ivSize));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * (sizeof(testIn) + ret->ivSize));
         memcpy(ret->in, ret->iv, ret->ivSize);
         memcpy(ret->in + ret->ivSize, testIn, sizeof(testIn));
 
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn) + ret->ivSize;
@@ -497,14 +625,14 @@ CpaStatus genNia3TestData(int testSetId, TestData *ret)
         Cpa8U testOut[] = {
             0x89, 0xa5, 0x8b, 0x47};
         ret->bitLen = 96;
-        ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
         memcpy(ret->key, testKey, sizeof(testKey));
         ret->count =  0x561eb2dd;
         ret->bearer = 0x14;
         ret->dir = 0;
-        ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+        ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
         memcpy(ret->in, testIn, sizeof(testIn));
-        ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
         memcpy(ret->out, testOut, sizeof(testOut));
         ret->keySize = sizeof(testKey);
         ret->inSize = sizeof(testIn);
@@ -520,6 +648,107 @@ CpaStatus genNia3TestData(int testSetId, TestData *ret)
     return CPA_STATUS_SUCCESS;
 }
 
+CpaStatus genNia2_256TestData(int testSetId, TestData *ret)
+{
+    ret->op = CPA_CY_SYM_OP_HASH;
+    ret->hashAlgo = CPA_CY_SYM_HASH_AES_CMAC;
+    ret->hashMode = CPA_CY_SYM_HASH_MODE_AUTH;
+
+    if (testSetId == 2)
+    {
+        /*
+         * NIA2 test set 2 under a 256-bit key
+         */
+        Cpa8U testKey[] = {
+            0xd3, 0xc5, 0xd5, 0x92, 0x32, 0x7f, 0xb1, 0x1c, 0x40, 0x35, 0xc6, 0x68, 0x0a, 0xf8, 0xc6, 0xd1,
+            0xa9, 0xcf, 0x8e, 0xc5, 0xb1, 0xa4, 0xf2, 0xe0, 0xc9, 0xd6, 0xe2, 0x1e, 0x7c, 0x3b, 0x5a, 0x48};
+        Cpa8U testIn[] = {
+            0x48, 0x45, 0x83, 0xd5, 0xaf, 0xe0, 0x82, 0xae};
+        Cpa8U testOut[] = {
+            0xd9, 0x9c, 0xc9, 0xd4};
+        ret->bitLen = 64;
+        ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
+        memcpy(ret->key, testKey, sizeof(testKey));
+        ret->keySize = sizeof(testKey);
+        ret->count = 0x398a59b4;
+        ret->bearer = 0x1a;
+        ret->dir = 1;
+
+        genIv(ret);
+        ret->in = arenaAlloc(sizeof(Cpa8U) * (sizeof(testIn) + ret->ivSize));
+        memcpy(ret->in, ret->iv, ret->ivSize);
+        memcpy(ret->in + ret->ivSize, testIn, sizeof(testIn));
+
+        ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
+        memcpy(ret->out, testOut, sizeof(testOut));
+        ret->inSize = sizeof(testIn) + ret->ivSize;
+        ret->outSize = sizeof(testOut);
+    }
+    else
+    {
+        return CPA_STATUS_FAIL;
+    }
+
+    return CPA_STATUS_SUCCESS;
+}
+
+CpaStatus genNia3_256TestData(int testSetId, TestData *ret)
+{
+    Cpa8U testKey[32] = {0};
+    Cpa8U testIn[500];
+    Cpa8U testOut[4];
+
+    ret->op = CPA_CY_SYM_OP_HASH;
+    ret->hashAlgo = CPA_CY_SYM_HASH_ZUC_EIA3;
+    ret->hashMode = CPA_CY_SYM_HASH_MODE_AUTH;
+
+    if (testSetId == 1)
+    {
+        /*
+         * ZUC-256 32-bit MAC of 400 zero bits under the all-zero key and IV
+         */
+        memset(testIn, 0x00, sizeof(testIn));
+        testOut[0] = 0x9b;
+        testOut[1] = 0x97;
+        testOut[2] = 0x2a;
+        testOut[3] = 0x74;
+        ret->bitLen = 400;
+    }
+    else if (testSetId == 2)
+    {
+        /*
+         * ZUC-256 32-bit MAC of 4000 bits of 0x11 bytes under the all-zero key and IV
+         */
+        memset(testIn, 0x11, sizeof(testIn));
+        testOut[0] = 0x87;
+        testOut[1] = 0x54;
+        testOut[2] = 0xf5;
+        testOut[3] = 0xcf;
+        ret->bitLen = 4000;
+    }
+    else
+    {
+        return CPA_STATUS_FAIL;
+    }
+
+    ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
+    memcpy(ret->key, testKey, sizeof(testKey));
+    ret->count = 0;
+    ret->bearer = 0;
+    ret->dir = 0;
+    ret->in = arenaAlloc(sizeof(Cpa8U) * (ret->bitLen / 8));
+    memcpy(ret->in, testIn, ret->bitLen / 8);
+    ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
+    memcpy(ret->out, testOut, sizeof(testOut));
+    ret->keySize = sizeof(testKey);
+    ret->inSize = ret->bitLen / 8;
+    ret->outSize = sizeof(testOut);
+
+    genIv(ret);
+
+    return CPA_STATUS_SUCCESS;
+}
+
 CpaStatus genSampleTestData(TestData *ret)
 {
     ret->op = CPA_CY_SYM_OP_CIPHER;
@@ -550,14 +779,14 @@ CpaStatus genSampleTestData(TestData *ret)
         0x01, 0x19, 0x2B, 0xEB, 0x04, 0x35, 0xAA, 0xA9, 0xA7, 0x95, 0x69, 0x77,
         0x40, 0xD9, 0x1D, 0xE4, 0xE7, 0x1A, 0xF9, 0x35, 0x06, 0x61, 0x3F, 0xAF};
     ret->bitLen = sizeof(testOut) * 8;
-    ret->key = malloc(sizeof(Cpa8U) * sizeof(testKey));
+    ret->key = arenaAlloc(sizeof(Cpa8U) * sizeof(testKey));
     memcpy(ret->key, testKey, sizeof(testKey));
-    ret->iv = malloc(sizeof(Cpa8U) * sizeof(testIv));
+    ret->iv = arenaAlloc(sizeof(Cpa8U) * sizeof(testIv));
     memcpy(ret->iv, testIv, sizeof(testIv));
     ret->dir = 1;
-    ret->in = malloc(sizeof(Cpa8U) * sizeof(testIn));
+    ret->in = arenaAlloc(sizeof(Cpa8U) * sizeof(testIn));
     memcpy(ret->in, testIn, sizeof(testIn));
-    ret->out = malloc(sizeof(Cpa8U) * sizeof(testOut));
+    ret->out = arenaAlloc(sizeof(Cpa8U) * sizeof(testOut));
     memcpy(ret->out, testOut, sizeof(testOut));
     ret->keySize = sizeof(testKey);
     ret->ivSize = sizeof(testIv);
@@ -567,9 +796,9 @@ CpaStatus genSampleTestData(TestData *ret)
     return CPA_STATUS_SUCCESS;
 }
 
-CpaCySymCipherDirection getCipherDirection(TestData testData)
+CpaCySymCipherDirection getCipherDirection(const TestData *testData)
 {
-    if (testData.dir == 0)
+    if (testData->dir == 0)
     {
         /* uplink */
         return CPA_CY_SYM_CIPHER_DIRECTION_DECRYPT;
@@ -585,108 +814,163 @@ void freeTestData(TestData *testData)
 {
     if (testData->key != NULL)
     {
-        free(testData->key);
+        arenaFree(testData->key);
         testData->key = NULL;
     }
     if (testData->iv != NULL)
     {
-        free(testData->iv);
+        arenaFree(testData->iv);
         testData->iv = NULL;
     }
     if (testData->in != NULL)
     {
-        free(testData->in);
+        arenaFree(testData->in);
         testData->in = NULL;
     }
     if (testData->out != NULL)
     {
-        free(testData->out);
+        arenaFree(testData->out);
         testData->out = NULL;
     }
 }
 
-void genIv(TestData *testData)
+void opDescInit(OpDesc *opDesc, const TestData *testData)
+{
+    memset(opDesc, 0, sizeof(OpDesc));
+    opDesc->count = testData->count;
+    opDesc->fresh = testData->fresh;
+    opDesc->bitLen = testData->bitLen;
+    opDesc->inSize = testData->inSize;
+    opDesc->outSize = testData->outSize;
+    opDesc->op = (Cpa8U)testData->op;
+    opDesc->cipherAlgo = (Cpa8U)testData->cipherAlgo;
+    opDesc->hashAlgo = (Cpa8U)testData->hashAlgo;
+    opDesc->bearer = testData->bearer;
+    opDesc->dir = testData->dir;
+    opDesc->ivSize = (Cpa8U)testData->ivSize;
+    opDesc->keySize = (Cpa8U)testData->keySize;
+}
+
+Cpa32U buildIv(const OpDesc *opDesc, Cpa8U *iv)
 {
-    Cpa32U ivLen;
+    Cpa32U ivLen = 0;
     Cpa32U listIdx = 0;
 
-    if (testData->op == CPA_CY_SYM_OP_CIPHER)
+    if (opDesc->op == CPA_CY_SYM_OP_CIPHER)
     {
         ivLen = 16;
-        testData->iv = malloc(sizeof(Cpa8U) * ivLen);
-        testData->iv[0] = (Cpa8U)((testData->count >> 24) & 0xff);
-        testData->iv[1] = (Cpa8U)((testData->count >> 16) & 0xff);
-        testData->iv[2] = (Cpa8U)((testData->count >> 8) & 0xff);
-        testData->iv[3] = (Cpa8U)(testData->count & 0xff);
-        testData->iv[4] = (testData->bearer << 3) | ((testData->dir & 0x01) << 2);
-        testData->iv[5] = 0x00;
-        testData->iv[6] = 0x00;
-        testData->iv[7] = 0x00;
-
-        if (testData->cipherAlgo == CPA_CY_SYM_CIPHER_SNOW3G_UEA2 || testData->cipherAlgo == CPA_CY_SYM_CIPHER_ZUC_EEA3)
+        iv[0] = (Cpa8U)((opDesc->count >> 24) & 0xff);
+        iv[1] = (Cpa8U)((opDesc->count >> 16) & 0xff);
+        iv[2] = (Cpa8U)((opDesc->count >> 8) & 0xff);
+        iv[3] = (Cpa8U)(opDesc->count & 0xff);
+        iv[4] = (opDesc->bearer << 3) | ((opDesc->dir & 0x01) << 2);
+        iv[5] = 0x00;
+        iv[6] = 0x00;
+        iv[7] = 0x00;
+
+        if (opDesc->cipherAlgo == CPA_CY_SYM_CIPHER_SNOW3G_UEA2 || opDesc->cipherAlgo == CPA_CY_SYM_CIPHER_ZUC_EEA3)
         {
             for (listIdx = 0; listIdx < ivLen/2; listIdx++)
             {
-                testData->iv[ivLen/2+listIdx] = testData->iv[listIdx];
+                iv[ivLen/2+listIdx] = iv[listIdx];
+            }
+            if (opDesc->cipherAlgo == CPA_CY_SYM_CIPHER_ZUC_EEA3 && opDesc->keySize == ZUC256_KEY_SIZE)
+            {
+                /* 256-NEA3: the 128-NEA3 IV in the first 16 bytes of the 25 byte ZUC-256 IV */
+                memset(iv + ivLen, 0, ZUC256_IV_SIZE - ivLen);
+                ivLen = ZUC256_IV_SIZE;
             }
         }
+        else
+        {
+            /* 128-NEA2 counter block, the lower 64 bits start at zero */
+            memset(iv + ivLen/2, 0, ivLen/2);
+        }
     }
-    else if (testData->op == CPA_CY_SYM_OP_HASH)
+    else if (opDesc->op == CPA_CY_SYM_OP_HASH)
     {
-        if (testData->hashAlgo == CPA_CY_SYM_HASH_SNOW3G_UIA2)
+        if (opDesc->hashAlgo == CPA_CY_SYM_HASH_SNOW3G_UIA2)
         {
             ivLen = 16;
-            testData->iv = malloc(sizeof(Cpa8U) * ivLen);
-            testData->iv[0] = (Cpa8U)((testData->count >> 24) & 0xff);
-            testData->iv[1] = (Cpa8U)((testData->count >> 16) & 0xff);
-            testData->iv[2] = (Cpa8U)((testData->count >> 8) & 0xff);
-            testData->iv[3] = (Cpa8U)(testData->count & 0xff);
-            testData->iv[4] = (Cpa8U)((testData->fresh >> 24) & 0xff);
-            testData->iv[5] = (Cpa8U)((testData->fresh >> 16) & 0xff);
-            testData->iv[6] = (Cpa8U)((testData->fresh >> 8) & 0xff);
-            testData->iv[7] = (Cpa8U)(testData->fresh & 0xff);
+            iv[0] = (Cpa8U)((opDesc->count >> 24) & 0xff);
+            iv[1] = (Cpa8U)((opDesc->count >> 16) & 0xff);
+            iv[2] = (Cpa8U)((opDesc->count >> 8) & 0xff);
+            iv[3] = (Cpa8U)(opDesc->count & 0xff);
+            iv[4] = (Cpa8U)((opDesc->fresh >> 24) & 0xff);
+            iv[5] = (Cpa8U)((opDesc->fresh >> 16) & 0xff);
+            iv[6] = (Cpa8U)((opDesc->fresh >> 8) & 0xff);
+            iv[7] = (Cpa8U)(opDesc->fresh & 0xff);
 
             for (listIdx = 0; listIdx < ivLen/2; listIdx++)
             {
-                testData->iv[ivLen/2+listIdx] = testData->iv[listIdx];
+                iv[ivLen/2+listIdx] = iv[listIdx];
             }
-            testData->iv[8] ^= testData->dir << 7;
-            testData->iv[14] ^= testData->dir << 7;
+            iv[8] ^= opDesc->dir << 7;
+            iv[14] ^= opDesc->dir << 7;
         }
-        else if (testData->hashAlgo == CPA_CY_SYM_HASH_AES_CMAC)
+        else if (opDesc->hashAlgo == CPA_CY_SYM_HASH_AES_CMAC)
         {
             ivLen = 8;
-            testData->iv = malloc(sizeof(Cpa8U) * ivLen);
-            testData->iv[0] = (Cpa8U)((testData->count >> 24) & 0xff);
-            testData->iv[1] = (Cpa8U)((testData->count >> 16) & 0xff);
-            testData->iv[2] = (Cpa8U)((testData->count >> 8) & 0xff);
-            testData->iv[3] = (Cpa8U)(testData->count & 0xff);
-            testData->iv[4] = (testData->bearer << 3) | ((testData->dir & 0x01) << 2);
-            testData->iv[5] = 0x00;
-            testData->iv[6] = 0x00;
-            testData->iv[7] = 0x00;
+            iv[0] = (Cpa8U)((opDesc->count >> 24) & 0xff);
+            iv[1] = (Cpa8U)((opDesc->count >> 16) & 0xff);
+            iv[2] = (Cpa8U)((opDesc->count >> 8) & 0xff);
+            iv[3] = (Cpa8U)(opDesc->count & 0xff);
+            iv[4] = (opDesc->bearer << 3) | ((opDesc->dir & 0x01) << 2);
+            iv[5] = 0x00;
+            iv[6] = 0x00;
+            iv[7] = 0x00;
         }
-        else if (testData->hashAlgo == CPA_CY_SYM_HASH_ZUC_EIA3)
+        else if (opDesc->hashAlgo == CPA_CY_SYM_HASH_ZUC_EIA3)
         {
             ivLen = 16;
-            testData->iv = malloc(sizeof(Cpa8U) * ivLen);
-            testData->iv[0] = (Cpa8U)((testData->count >> 24) & 0xff);
-            testData->iv[1] = (Cpa8U)((testData->count >> 16) & 0xff);
-            testData->iv[2] = (Cpa8U)((testData->count >> 8) & 0xff);
-            testData->iv[3] = (Cpa8U)(testData->count & 0xff);
-            testData->iv[4] = testData->bearer << 3;
-            testData->iv[5] = 0x00;
-            testData->iv[6] = 0x00;
-            testData->iv[7] = 0x00;
+            iv[0] = (Cpa8U)((opDesc->count >> 24) & 0xff);
+            iv[1] = (Cpa8U)((opDesc->count >> 16) & 0xff);
+            iv[2] = (Cpa8U)((opDesc->count >> 8) & 0xff);
+            iv[3] = (Cpa8U)(opDesc->count & 0xff);
+            iv[4] = opDesc->bearer << 3;
+            iv[5] = 0x00;
+            iv[6] = 0x00;
+            iv[7] = 0x00;
 
             for (listIdx = 0; listIdx < ivLen/2; listIdx++)
             {
-                testData->iv[ivLen/2+listIdx] = testData->iv[listIdx];
+                iv[ivLen/2+listIdx] = iv[listIdx];
+            }
+            iv[8] ^= opDesc->dir << 7;
+            iv[14] ^= opDesc->dir << 7;
+            if (opDesc->keySize == ZUC256_KEY_SIZE)
+            {
+                /* 256-NIA3, as 256-NEA3 */
+                memset(iv + ivLen, 0, ZUC256_IV_SIZE - ivLen);
+                ivLen = ZUC256_IV_SIZE;
             }
-            testData->iv[8] ^= testData->dir << 7;
-            testData->iv[14] ^= testData->dir << 7;
         }
     }
 
-    testData->ivSize = ivLen;
+    return ivLen;
+}
+
+Cpa32U buildIvBurst(const OpDesc *opDesc, OpBurst *burst)
+{
+    OpDesc opOfBurst = *opDesc;
+    Cpa32U ivLen = 0;
+    Cpa32U opIdx = 0;
+
+    for (opIdx = 0; opIdx < burst->numOps; opIdx++)
+    {
+        opOfBurst.count = burst->counts[opIdx];
+        opOfBurst.fresh = burst->freshes[opIdx];
+        ivLen = buildIv(&opOfBurst, burst->ivs[opIdx]);
+    }
+
+    return ivLen;
+}
+
+void genIv(TestData *testData)
+{
+    OpDesc opDesc;
+
+    opDescInit(&opDesc, testData);
+    testData->iv = arenaAlloc(sizeof(Cpa8U) * MAX_IV_SIZE);
+    testData->ivSize = buildIv(&opDesc, testData->iv);
 }
@@ -0,0 +1,326 @@
+/*
+ * Binary op trace.
+ *
+ * Every thread recording an event gets its own ring of TRACE_RING_SIZE fixed-size events, allocated on its
+ * first event and registered in a global table through an atomic index. Only the owning thread writes its ring,
+ * so recording takes no lock and no atomic read-modify-write: a timestamp, six stores and a release store of
+ * the head. The ring keeps the latest events, older ones are overwritten.
+ *
+ * traceStop() writes the rings as they are to a file, which traceDecode() turns into text or into Chrome trace
+ * JSON (chrome://tracing, Perfetto), where every op shows as an async slice from submit to completion.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "cpa.h"
+#include "cpa_sample_utils.h"
+
+#include "trace.h"
+#include "utils.h"
+
+int traceEnabled_g = 0;
+__thread TraceRing *traceRing_t = NULL;
+
+static TraceRing *rings_g[TRACE_MAX_THREADS] = {NULL};
+static Cpa32U numRings_g = 0;
+static char *path_g = NULL;
+
+/* An event of a decoded trace together with the thread recording it */
+typedef struct _TraceRecord {
+    TraceEvent event;
+    Cpa32U threadId;
+} TraceRecord;
+
+static const char *eventName(Cpa32U type)
+{
+    switch (type)
+    {
+        case TRACE_SUBMIT:
+            return "submit";
+        case TRACE_COMPLETE:
+            return "complete";
+        case TRACE_RETRY:
+            return "retry";
+        case TRACE_ERROR:
+            return "error";
+        default:
+            return "unknown";
+    }
+}
+
+/*
+ * Called on the first event of a thread; threads beyond TRACE_MAX_THREADS are not traced
+ */
+TraceRing *traceAttachThread(void)
+{
+    TraceRing *ring = NULL;
+    Cpa32U ringIdx = 0;
+
+    ringIdx = __atomic_fetch_add(&numRings_g, 1, __ATOMIC_RELAXED);
+    if (TRACE_MAX_THREADS <= ringIdx)
+    {
+        __atomic_store_n(&numRings_g, TRACE_MAX_THREADS, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    ring = calloc(1, sizeof(TraceRing));
+    if (NULL == ring)
+    {
+        return NULL;
+    }
+    ring->threadId = (Cpa32U)syscall(SYS_gettid);
+    __atomic_store_n(&rings_g[ringIdx], ring, __ATOMIC_RELEASE);
+    traceRing_t = ring;
+
+    return ring;
+}
+
+CpaStatus traceStart(const char *path)
+{
+    path_g = strdup(path);
+    if (NULL == path_g)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+    __atomic_store_n(&traceEnabled_g, 1, __ATOMIC_RELEASE);
+    PRINT_DBG("Tracing op events to %s\n", path);
+
+    return CPA_STATUS_SUCCESS;
+}
+
+void traceStop(void)
+{
+    TraceFileHeader header = {0};
+    TraceFileRing fileRing = {0};
+    TraceRing *ring = NULL;
+    FILE *file = NULL;
+    Cpa64U head = 0;
+    Cpa64U first = 0;
+    Cpa64U eventIdx = 0;
+    Cpa32U ringIdx = 0;
+
+    if (NULL == path_g)
+    {
+        return;
+    }
+    __atomic_store_n(&traceEnabled_g, 0, __ATOMIC_RELEASE);
+
+    file = fopen(path_g, "wb");
+    if (NULL == file)
+    {
+        PRINT_ERR("Could not write trace to %s\n", path_g);
+        free(path_g);
+        path_g = NULL;
+        return;
+    }
+
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.eventSize = sizeof(TraceEvent);
+    for (ringIdx = 0; ringIdx < __atomic_load_n(&numRings_g, __ATOMIC_ACQUIRE); ringIdx++)
+    {
+        if (NULL != __atomic_load_n(&rings_g[ringIdx], __ATOMIC_ACQUIRE))
+        {
+            header.numRings++;
+        }
+    }
+    fwrite(&header, sizeof(header), 1, file);
+
+    for (ringIdx = 0; ringIdx < TRACE_MAX_THREADS; ringIdx++)
+    {
+        ring = __atomic_load_n(&rings_g[ringIdx], __ATOMIC_ACQUIRE);
+        if (NULL == ring)
+        {
+            continue;
+        }
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        first = TRACE_RING_SIZE < head ? head - TRACE_RING_SIZE : 0;
+        fileRing.threadId = ring->threadId;
+        fileRing.numEvents = (Cpa32U)(head - first);
+        fileRing.numLost = first;
+        fwrite(&fileRing, sizeof(fileRing), 1, file);
+        for (eventIdx = first; eventIdx < head; eventIdx++)
+        {
+            fwrite(&ring->events[eventIdx & (TRACE_RING_SIZE - 1)], sizeof(TraceEvent), 1, file);
+        }
+    }
+    fclose(file);
+
+    PRINT("Trace of %u threads written to %s\n", header.numRings, path_g);
+    free(path_g);
+    path_g = NULL;
+}
+
+static int compareRecords(const void *a, const void *b)
+{
+    const TraceRecord *recordA = a;
+    const TraceRecord *recordB = b;
+
+    if (recordA->event.timestampNs != recordB->event.timestampNs)
+    {
+        return recordA->event.timestampNs < recordB->event.timestampNs ? -1 : 1;
+    }
+    return 0;
+}
+
+static void printText(const TraceRecord *records, Cpa32U numRecords)
+{
+    Cpa64U start = 0 < numRecords ? records[0].event.timestampNs : 0;
+    Cpa32U recordIdx = 0;
+
+    for (recordIdx = 0; recordIdx < numRecords; recordIdx++)
+    {
+        printf("%14.3f us  tid %-7u %-8s op 0x%016llx session %-4u length %-5u status %d\n",
+               (records[recordIdx].event.timestampNs - start) / 1000.0,
+               records[recordIdx].threadId,
+               eventName(records[recordIdx].event.type),
+               (unsigned long long)records[recordIdx].event.tag,
+               records[recordIdx].event.session,
+               records[recordIdx].event.length,
+               records[recordIdx].event.status);
+    }
+}
+
+/*
+ * An op is an async slice from its submit ("b") to its completion ("e"), matched on the op tag. A submission
+ * turned down ends its slice right away and is marked with an instant event.
+ */
+static void printChrome(const TraceRecord *records, Cpa32U numRecords)
+{
+    Cpa64U start = 0 < numRecords ? records[0].event.timestampNs : 0;
+    const TraceEvent *event = NULL;
+    const char *phase = NULL;
+    Cpa32U recordIdx = 0;
+
+    printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (recordIdx = 0; recordIdx < numRecords; recordIdx++)
+    {
+        event = &records[recordIdx].event;
+        switch (event->type)
+        {
+            case TRACE_SUBMIT:
+                phase = "b";
+                break;
+            case TRACE_COMPLETE:
+                phase = "e";
+                break;
+            default:
+                printf("%s{\"name\":\"op\",\"cat\":\"op\",\"ph\":\"e\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,"
+                       "\"id\":\"0x%llx\"}",
+                       0 == recordIdx ? "" : ",\n",
+                       (event->timestampNs - start) / 1000.0,
+                       records[recordIdx].threadId,
+                       (unsigned long long)event->tag);
+                phase = "i";
+                break;
+        }
+        printf("%s{\"name\":\"%s\",\"cat\":\"op\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,",
+               0 == recordIdx && 'i' != phase[0] ? "" : ",\n",
+               'i' == phase[0] ? eventName(event->type) : "op",
+               phase,
+               (event->timestampNs - start) / 1000.0,
+               records[recordIdx].threadId);
+        if ('i' == phase[0])
+        {
+            printf("\"s\":\"t\",");
+        }
+        else
+        {
+            printf("\"id\":\"0x%llx\",", (unsigned long long)event->tag);
+        }
+        printf("\"args\":{\"session\":%u,\"length\":%u,\"status\":%d}}",
+               event->session,
+               event->length,
+               event->status);
+    }
+    printf("\n]}\n");
+}
+
+CpaStatus traceDecode(const char *path, const char *format)
+{
+    TraceFileHeader header = {0};
+    TraceFileRing fileRing = {0};
+    TraceRecord *records = NULL;
+    TraceRecord *grown = NULL;
+    FILE *file = NULL;
+    Cpa32U numRecords = 0;
+    Cpa32U ringIdx = 0;
+    Cpa32U eventIdx = 0;
+    Cpa64U numLost = 0;
+    CpaStatus status = CPA_STATUS_SUCCESS;
+
+    if (0 != strcmp(format, "text") && 0 != strcmp(format, "chrome"))
+    {
+        PRINT_ERR("Unknown trace format %s, text or chrome\n", format);
+        return CPA_STATUS_INVALID_PARAM;
+    }
+    file = fopen(path, "rb");
+    if (NULL == file)
+    {
+        PRINT_ERR("Could not open trace %s\n", path);
+        return CPA_STATUS_FAIL;
+    }
+    if (1 != fread(&header, sizeof(header), 1, file) || TRACE_MAGIC != header.magic ||
+        TRACE_VERSION != header.version || sizeof(TraceEvent) != header.eventSize)
+    {
+        PRINT_ERR("%s is not a trace file of this build\n", path);
+        fclose(file);
+        return CPA_STATUS_INVALID_PARAM;
+    }
+
+    for (ringIdx = 0; ringIdx < header.numRings && CPA_STATUS_SUCCESS == status; ringIdx++)
+    {
+        if (1 != fread(&fileRing, sizeof(fileRing), 1, file))
+        {
+            status = CPA_STATUS_FAIL;
+            break;
+        }
+        numLost += fileRing.numLost;
+        grown = realloc(records, (numRecords + fileRing.numEvents) * sizeof(TraceRecord));
+        if (NULL == grown && 0 != fileRing.numEvents)
+        {
+            status = CPA_STATUS_RESOURCE;
+            break;
+        }
+        records = grown;
+        for (eventIdx = 0; eventIdx < fileRing.numEvents; eventIdx++)
+        {
+            if (1 != fread(&records[numRecords].event, sizeof(TraceEvent), 1, file))
+            {
+                status = CPA_STATUS_FAIL;
+                break;
+            }
+            records[numRecords++].threadId = fileRing.threadId;
+        }
+    }
+    fclose(file);
+    if (CPA_STATUS_SUCCESS != status)
+    {
+        PRINT_ERR("Trace %s is truncated\n", path);
+        free(records);
+        return status;
+    }
+
+    qsort(records, numRecords, sizeof(TraceRecord), compareRecords);
+    if (0 == strcmp(format, "text"))
+    {
+        printText(records, numRecords);
+    }
+    else
+    {
+        printChrome(records, numRecords);
+    }
+    if (0 != numLost)
+    {
+        /* On stderr, not to break the JSON */
+        fprintf(stderr, "%llu older events were overwritten before the dump\n", (unsigned long long)numLost);
+    }
+    free(records);
+
+    return CPA_STATUS_SUCCESS;
+}
@@ -0,0 +1,113 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <time.h>
+
+#include "cpa.h"
+
+/* TRACE_COMPILED=0 compiles every trace point out */
+#ifndef TRACE_COMPILED
+#define TRACE_COMPILED 1
+#endif
+
+#define TRACE_RING_SIZE (64 * 1024)
+#define TRACE_MAX_THREADS 64
+#define TRACE_MAGIC 0x43525450 /* "PTRC" */
+#define TRACE_VERSION 1
+
+typedef enum _TraceEventType {
+    TRACE_SUBMIT = 1,
+    TRACE_COMPLETE,
+    TRACE_RETRY,
+    TRACE_ERROR,
+} TraceEventType;
+
+/*
+ * One op event. tag identifies the op across its events, session is the engine session index.
+ */
+typedef struct _TraceEvent {
+    Cpa64U timestampNs;
+    Cpa64U tag;
+    Cpa32U type;
+    Cpa32U session;
+    Cpa32U length;
+    Cpa32S status;
+} TraceEvent;
+
+/*
+ * Flight recorder of one thread, written by that thread only: the last TRACE_RING_SIZE events are kept
+ */
+typedef struct _TraceRing {
+    Cpa32U threadId;
+    Cpa64U head; /* events ever recorded */
+    TraceEvent events[TRACE_RING_SIZE];
+} TraceRing;
+
+/*
+ * Layout of a trace file: the header, then for every thread a TraceFileRing followed by its events, oldest
+ * first
+ */
+typedef struct _TraceFileHeader {
+    Cpa32U magic;
+    Cpa32U version;
+    Cpa32U numRings;
+    Cpa32U eventSize;
+} TraceFileHeader;
+
+typedef struct _TraceFileRing {
+    Cpa32U threadId;
+    Cpa32U numEvents;
+    Cpa64U numLost; /* overwritten before the dump */
+} TraceFileRing;
+
+extern int traceEnabled_g;
+extern __thread TraceRing *traceRing_t;
+
+TraceRing *traceAttachThread(void);
+
+static inline void traceRecord(Cpa32U type, Cpa64U tag, Cpa32U session, Cpa32U length, Cpa32S status)
+{
+    TraceRing *ring = traceRing_t;
+    TraceEvent *event = NULL;
+    struct timespec ts;
+
+    if (NULL == ring)
+    {
+        ring = traceAttachThread();
+        if (NULL == ring)
+        {
+            return;
+        }
+    }
+    event = &ring->events[ring->head & (TRACE_RING_SIZE - 1)];
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    event->timestampNs = (Cpa64U)ts.tv_sec * 1000000000ULL + (Cpa64U)ts.tv_nsec;
+    event->tag = tag;
+    event->type = type;
+    event->session = session;
+    event->length = length;
+    event->status = status;
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+#define TRACE_EVENT(type, tag, session, length, status)                    \
+    do                                                                     \
+    {                                                                      \
+        if (TRACE_COMPILED && traceEnabled_g)                              \
+        {                                                                  \
+            traceRecord((type), (Cpa64U)(tag), (session), (length), (status)); \
+        }                                                                  \
+    } while (0)
+
+/*
+ * Record op events from now on; traceStop() writes them to path and should run once the data path stopped
+ */
+CpaStatus traceStart(const char *path);
+void traceStop(void);
+
+/*
+ * Decode a trace file to stdout, as one line per event ("text") or as Chrome trace JSON ("chrome")
+ */
+CpaStatus traceDecode(const char *path, const char *format);
+
+#endif
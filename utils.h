@@ -1,11 +1,18 @@
+#ifndef UTILS_H
+#define UTILS_H
+
 #include <stdio.h>
 
 #include "cpa.h"
 #include "cpa_cy_sym.h"
 
 #define MAX_INSTANCES 32
+#define MAX_NODES 8
 #define BYTE_ALIGNMENT 64
 #define MAX_TEST_DATA 16
+#define MAX_IV_SIZE 32
+#define ZUC256_KEY_SIZE 32
+#define ZUC256_IV_SIZE 25 /* as the device takes it, the last 8 bytes carry 6 bits each */
 
 #define ANSI_COLOR_RED "\x1b[31m"
 #define ANSI_COLOR_GREEN "\x1b[32m"
@@ -32,11 +39,42 @@
     PRINT_COLOR(ANSI_COLOR_RED, "%s() failed with status %d\n", func, stat)
 #endif
 
-#ifndef PRINT_DBG
-#define PRINT_DBG(msg, arg...) \
-    PRINT("%s:%d %s() " msg, __FILE__, __LINE__, __func__, ##arg)
+/*
+ * Log levels: LOG_MAX_LEVEL is the highest one compiled in, logLevel_g the highest one printed, picked at run
+ * time by logInit(). Messages above LOG_MAX_LEVEL fold away at compile time, those above logLevel_g cost one
+ * branch.
+ */
+#define LOG_LEVEL_ERR 0
+#define LOG_LEVEL_DBG 1
+#define LOG_LEVEL_DUMP 2 /* byte dumps of keys, IVs and data */
+
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL LOG_LEVEL_DUMP
 #endif
 
+#define LOG_ENABLED(level) \
+    ((level) <= LOG_MAX_LEVEL && __builtin_expect((level) <= logLevel_g, 0))
+
+/* Replaces the unconditional one of cpa_sample_utils.h */
+#undef PRINT_DBG
+#define PRINT_DBG(msg, arg...)                                                  \
+    do                                                                          \
+    {                                                                           \
+        if (LOG_ENABLED(LOG_LEVEL_DBG))                                         \
+        {                                                                       \
+            PRINT("%s:%d %s() " msg, __FILE__, __LINE__, __func__, ##arg);      \
+        }                                                                       \
+    } while (0)
+
+#define PRINT_DUMP(label, data, length)                 \
+    do                                                  \
+    {                                                   \
+        if (LOG_ENABLED(LOG_LEVEL_DUMP))                \
+        {                                               \
+            printHex(label, data, length);              \
+        }                                               \
+    } while (0)
+
 #define PRINT_CAPABILITY(cap, sup)     \
     if (CPA_TRUE == sup)               \
         printf(cap ": Supported\n");   \
@@ -67,15 +105,61 @@ typedef struct _TestData {
     Cpa32U outSize;
 } TestData;
 
-int gDebugParam;
+/*
+ * What an op needs beyond its session and its buffers: the scalar part of TestData, packed on one cache line so
+ * that ops in flight cost a line each. The algorithm's fillOpData maps it onto CpaCySymOpData, which lives
+ * with the op, so an op takes no allocation.
+ */
+typedef struct _OpDesc {
+    Cpa32U count;
+    Cpa32U fresh;
+    Cpa32U bitLen;
+    Cpa32U inSize; /* bytes handed to QAT, an IV prefix included */
+    Cpa32U outSize; /* digest for hash */
+    Cpa8U op; /* CpaCySymOp */
+    Cpa8U cipherAlgo; /* CpaCySymCipherAlgorithm */
+    Cpa8U hashAlgo; /* CpaCySymHashAlgorithm */
+    Cpa8U bearer;
+    Cpa8U dir;
+    Cpa8U ivSize;
+    Cpa8U keySize; /* a 256-bit key changes the IV of NEA3/NIA3 */
+} __attribute__((packed, aligned(BYTE_ALIGNMENT))) OpDesc;
+
+#define OP_BURST_SIZE 32
+
+/*
+ * Per-op fields of a burst on one session as arrays, each starting on a cache line, for loops over the whole
+ * burst such as building every IV at once
+ */
+typedef struct _OpBurst {
+    Cpa32U numOps;
+    Cpa32U counts[OP_BURST_SIZE] __attribute__((aligned(BYTE_ALIGNMENT)));
+    Cpa32U freshes[OP_BURST_SIZE] __attribute__((aligned(BYTE_ALIGNMENT)));
+    Cpa32U offsets[OP_BURST_SIZE] __attribute__((aligned(BYTE_ALIGNMENT)));
+    Cpa32U lengths[OP_BURST_SIZE] __attribute__((aligned(BYTE_ALIGNMENT)));
+    Cpa8U ivs[OP_BURST_SIZE][MAX_IV_SIZE] __attribute__((aligned(BYTE_ALIGNMENT)));
+} OpBurst;
+
+/*
+ * Segment of a chained packet buffer (mbuf style), a packet is its first segment and every segment linked
+ * through next. Segment data handed to QAT must be DMA-able.
+ */
+typedef struct _PktBuf {
+    Cpa8U *data;
+    Cpa32U length;
+    struct _PktBuf *next;
+} PktBuf;
 
-CpaStatus execQat(TestData cipherTestData);
+extern int gDebugParam;
+extern int logLevel_g;
+
+CpaStatus execQat(const TestData *testData);
 
 CpaStatus checkCyInstanceCapabilities(void);
 
 CpaStatus createBuffers(CpaInstanceHandle cyInstHandle,
                         Cpa32U numBuffers,
-                        Cpa32U bufferSize,
+                        const Cpa32U *bufferSizes,
                         CpaBufferList **srcBufferList,
                         CpaBufferList **dstBufferList,
                         CpaBoolean inPlaceOp);
@@ -84,19 +168,42 @@ void freeBuffers(Cpa32U numBuffers,
                  CpaBufferList **dstBufferList,
                  CpaBoolean inPlaceOp);
 
+Cpa32U chainLength(const PktBuf *chain);
+Cpa32U fillChainBuffers(const PktBuf *chain, Cpa32U offset, CpaFlatBuffer *flatBuffers, Cpa32U maxBuffers);
+
 void freeInstanceMapping(void);
 
+/*
+ ************
+ * Logging
+ ************
+ */
+/* Level from PDCP_LOG_LEVEL (err, debug or dump), debug by default */
+void logInit(void);
+void printHex(const char *label, const Cpa8U *data, Cpa32U length);
+
 /*
  ********************
  * Wrapper functions
  ********************
  */
 CpaStatus memAllocContig(void **memAddr, Cpa32U sizeBytes, Cpa32U alignment);
+CpaStatus memAllocContigNode(void **memAddr, Cpa32U sizeBytes, Cpa32U alignment, Cpa32U node);
 CpaStatus memAllocOs(void **memAddr, Cpa32U sizeBytes);
 
 void memFreeContig(void **memAddr);
 void memFreeOs(void **memAddr);
 
+/*
+ *****************
+ * NUMA functions
+ *****************
+ */
+Cpa32U getCurrentNode(void);
+Cpa32U getInstanceNode(CpaInstanceHandle cyInstHandle);
+CpaInstanceHandle getLocalInstance(const CpaInstanceHandle *cyInstHandles, Cpa16U numInstances);
+CpaStatus bindThreadToInstance(CpaInstanceHandle cyInstHandle);
+
 /*
  *********************
  * Test set functions
@@ -108,10 +215,20 @@ CpaStatus genNea3TestData(int testSetId, TestData *ret);
 CpaStatus genNia1TestData(int testSetId, TestData *ret);
 CpaStatus genNia2TestData(int testSetId, TestData *ret);
 CpaStatus genNia3TestData(int testSetId, TestData *ret);
+CpaStatus genNea2_256TestData(int testSetId, TestData *ret);
+CpaStatus genNea3_256TestData(int testSetId, TestData *ret);
+CpaStatus genNia2_256TestData(int testSetId, TestData *ret);
+CpaStatus genNia3_256TestData(int testSetId, TestData *ret);
 CpaStatus genSampleTestData(TestData *ret);
 
-CpaCySymCipherDirection getCipherDirection(TestData testData);
+CpaCySymCipherDirection getCipherDirection(const TestData *testData);
 
 void freeTestData(TestData *testData);
 
+void opDescInit(OpDesc *opDesc, const TestData *testData);
+Cpa32U buildIv(const OpDesc *opDesc, Cpa8U *iv);
+/* IVs of every op of the burst, all of the session of opDesc; returns the IV size */
+Cpa32U buildIvBurst(const OpDesc *opDesc, OpBurst *burst);
 void genIv(TestData *testData);
+
+#endif
@@ -0,0 +1,761 @@
+/*
+ * Run-to-completion per-core workers.
+ *
+ * Each worker thread is bound to the cores of one instance (one core per instance in the usual driver
+ * configuration) and owns everything its PDUs touch: the instance with its op buffers, a buffer pool and a
+ * completion ring allocated from the worker's own node, and the sessions created for it. A single loop
+ * receives new PDUs, submits them, polls the instance (icp_sal_CyPollInstance() through the instance port) and
+ * hands completions back, so no PDU ever moves between cores and the data path takes no lock.
+ *
+ * Spinning on the instance takes a whole core even when the cell is quiet. In event mode a worker that runs out
+ * of work sleeps in epoll_wait() on the event fd of its instance, which the device signals when responses are
+ * waiting, and on a wake fd producers signal when they hand it PDUs; once woken it polls in bursts again. The
+ * adaptive mode only sleeps after WORKER_SPIN_US without work, so that a loaded worker never leaves the loop.
+ *
+ * A static split of bearers over workers leaves workers idle while a few heavy bearers saturate others. In a
+ * worker group, PDUs are queued per bearer (flow) instead, and a worker that runs out of work takes a flow
+ * from a worker with a backlog. Each flow has a session on the instance of every worker, and ownership of a
+ * flow only changes hands once nothing of it is in flight, so the PDUs of a bearer are never processed by two
+ * workers at once and complete in order.
+ *
+ * Flows of signalling and low latency bearers have high priority sessions, and workers take their PDUs ahead
+ * of those of bulk flows, up to a weighted share of each burst, so that a backlog of bulk PDUs delays them
+ * neither in the host queues nor on the instance.
+ *
+ * The benches driving the workers with synthetic traffic are in bench.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cpa.h"
+#include "cpa_sample_utils.h"
+
+#include "algo.h"
+#include "batch.h"
+#include "engine.h"
+#include "utils.h"
+#include "worker.h"
+
+static Cpa64U nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Cpa64U)ts.tv_sec * 1000000000ULL + (Cpa64U)ts.tv_nsec;
+}
+
+Cpa8U *workerAllocBuffer(Worker *worker, Cpa32U *offset)
+{
+    Cpa32U buffer = 0;
+
+    if (CPA_TRUE != worker->ownRegion || 0 == worker->numFreeBuffers)
+    {
+        return NULL;
+    }
+    buffer = worker->freeBuffers[--worker->numFreeBuffers];
+    *offset = buffer * WORKER_BUFFER_SIZE + ENGINE_OP_HEADROOM;
+    return worker->region + *offset;
+}
+
+static void completeDescs(Worker *worker, const PdcpDesc *descs, Cpa32U numDescs)
+{
+    Cpa32U descIdx = 0;
+
+    worker->tx(worker, descs, numDescs, worker->arg);
+    for (descIdx = 0; CPA_TRUE == worker->ownRegion && descIdx < numDescs; descIdx++)
+    {
+        worker->freeBuffers[worker->numFreeBuffers++] = descs[descIdx].offset / WORKER_BUFFER_SIZE;
+    }
+    worker->numTx += numDescs;
+}
+
+/*
+ * Sleep until the instance has responses, a producer wakes the worker or the timeout. Not while requests are in
+ * flight on an instance without event fd, whose completions would not wake the worker.
+ */
+static void waitEvents(Worker *worker)
+{
+    struct epoll_event events[2];
+    struct epoll_event event;
+    eventfd_t count = 0;
+    int eventFd = enginePortEventFd(worker->port);
+    int numEvents = 0;
+    int eventIdx = 0;
+
+    if (eventFd != worker->eventFd)
+    {
+        if (0 <= worker->eventFd)
+        {
+            epoll_ctl(worker->epollFd, EPOLL_CTL_DEL, worker->eventFd, NULL);
+        }
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = eventFd;
+        worker->eventFd = -1;
+        if (0 <= eventFd && 0 == epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, eventFd, &event))
+        {
+            worker->eventFd = eventFd;
+        }
+    }
+    if (0 > worker->eventFd && 0 < worker->port->numInflight)
+    {
+        return;
+    }
+
+    numEvents = epoll_wait(worker->epollFd, events, 2, ENGINE_EVENT_TIMEOUT_MS);
+    worker->numSleeps++;
+    if (0 < numEvents)
+    {
+        worker->numWakeups++;
+    }
+    for (eventIdx = 0; eventIdx < numEvents; eventIdx++)
+    {
+        /* The instance clears its event fd itself once polled */
+        if (worker->wakeFd == events[eventIdx].data.fd)
+        {
+            eventfd_read(worker->wakeFd, &count);
+        }
+    }
+}
+
+/*
+ * After a round of the loop in event or adaptive mode. The worker announces that it sleeps and goes round once
+ * more before it does, so that PDUs handed over before a producer could see the announcement are taken.
+ */
+static void endRound(Worker *worker, CpaBoolean busy)
+{
+    Cpa64U now = 0;
+
+    if (CPA_TRUE == busy || 0 < worker->numPending)
+    {
+        worker->idleSinceNs = 0;
+        if (0 != worker->sleeping)
+        {
+            __atomic_store_n(&worker->sleeping, 0, __ATOMIC_RELAXED);
+        }
+        return;
+    }
+
+    now = nowNs();
+    if (0 == worker->idleSinceNs)
+    {
+        worker->idleSinceNs = now;
+    }
+    if (WORKER_POLL_ADAPTIVE == worker->pollMode && now - worker->idleSinceNs < WORKER_SPIN_US * 1000ULL)
+    {
+        return;
+    }
+    if (0 == worker->sleeping)
+    {
+        __atomic_store_n(&worker->sleeping, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        return;
+    }
+    waitEvents(worker);
+}
+
+static void runLoop(Worker *worker)
+{
+    BatchCtl *batch = &worker->batch;
+    PdcpDesc cpls[WORKER_BURST_SIZE];
+    Cpa64U now = 0;
+    Cpa32U numReceived = 0;
+    Cpa32U numSubmitted = 0;
+    Cpa32U numCompleted = 0;
+    CpaBoolean full = CPA_FALSE;
+
+    while (CPA_TRUE != worker->stop)
+    {
+        worker->numLoops++;
+        numReceived = 0;
+        numCompleted = 0;
+        full = CPA_FALSE;
+        if (BATCH_IMMEDIATE != batch->mode)
+        {
+            now = nowNs();
+        }
+        batchTick(batch, now, worker->port->numInflight);
+
+        if (batch->batchSize > worker->numPending && (CPA_TRUE != worker->ownRegion || 0 < worker->numFreeBuffers))
+        {
+            numReceived = worker->rx(
+                worker, worker->pending + worker->numPending, batch->batchSize - worker->numPending, worker->arg);
+            if (0 == worker->numPending)
+            {
+                worker->pendingSinceNs = now;
+            }
+            worker->numPending += numReceived;
+            worker->numRx += numReceived;
+            batchOnArrivals(batch, numReceived);
+        }
+        if (0 < worker->numPending &&
+            CPA_TRUE == batchShouldSubmit(batch, worker->numPending, worker->pendingSinceNs, now))
+        {
+            /* What the instance cannot take now is retried on the next round, after polling */
+            numSubmitted = engineSubmitBurst(worker->port, worker->pending, worker->numPending);
+            worker->numPending -= numSubmitted;
+            memmove(worker->pending, worker->pending + numSubmitted, worker->numPending * sizeof(PdcpDesc));
+            if (0 < numSubmitted)
+            {
+                worker->numBatches++;
+            }
+            full = (0 < worker->numPending) ? CPA_TRUE : CPA_FALSE;
+        }
+
+        /* An instance refusing part of a batch is full: poll it whatever the cadence, or the next submit fails too */
+        if (CPA_TRUE == full || CPA_TRUE == batchShouldPoll(batch, now))
+        {
+            numCompleted = enginePollBurst(worker->port, cpls, WORKER_BURST_SIZE, NULL);
+            batchOnPoll(batch, numCompleted, now);
+            worker->numPolls++;
+        }
+        if (0 < numCompleted)
+        {
+            completeDescs(worker, cpls, numCompleted);
+        }
+        else if (0 == worker->numPending && 0 == worker->port->numInflight)
+        {
+            worker->numIdleLoops++;
+        }
+        if (WORKER_POLL_BUSY != worker->pollMode)
+        {
+            endRound(worker, (0 < numReceived || 0 < numCompleted) ? CPA_TRUE : CPA_FALSE);
+        }
+    }
+}
+
+/*
+ * Flush a batch still held back, complete what is in flight and report PDUs the instance did not take with
+ * CPA_STATUS_RETRY
+ */
+static void drainWorker(Worker *worker)
+{
+    PdcpDesc cpls[WORKER_BURST_SIZE];
+    Cpa32U numSubmitted = 0;
+    Cpa32U numCompleted = 0;
+    Cpa32U descIdx = 0;
+
+    numSubmitted = engineSubmitBurst(worker->port, worker->pending, worker->numPending);
+    worker->numPending -= numSubmitted;
+    memmove(worker->pending, worker->pending + numSubmitted, worker->numPending * sizeof(PdcpDesc));
+    for (descIdx = 0; descIdx < worker->numPending; descIdx++)
+    {
+        worker->pending[descIdx].status = CPA_STATUS_RETRY;
+    }
+    if (0 < worker->numPending)
+    {
+        completeDescs(worker, worker->pending, worker->numPending);
+        worker->numPending = 0;
+    }
+
+    while (0 < worker->port->numInflight)
+    {
+        numCompleted = enginePollBurst(worker->port, cpls, WORKER_BURST_SIZE, NULL);
+        if (0 < numCompleted)
+        {
+            completeDescs(worker, cpls, numCompleted);
+        }
+    }
+    numCompleted = enginePollBurst(worker->port, cpls, WORKER_BURST_SIZE, NULL);
+    if (0 < numCompleted)
+    {
+        completeDescs(worker, cpls, numCompleted);
+    }
+}
+
+static CpaStatus openEvents(Worker *worker)
+{
+    struct epoll_event event;
+
+    worker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    worker->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = worker->wakeFd;
+    if (0 > worker->epollFd || 0 > worker->wakeFd ||
+        0 != epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, worker->wakeFd, &event))
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+static void closeEvents(Worker *worker)
+{
+    __atomic_store_n(&worker->sleeping, 0, __ATOMIC_SEQ_CST);
+    if (0 <= worker->epollFd)
+    {
+        close(worker->epollFd);
+    }
+    if (0 <= worker->wakeFd)
+    {
+        close(worker->wakeFd);
+    }
+    worker->epollFd = -1;
+    worker->wakeFd = -1;
+    worker->eventFd = -1;
+}
+
+static void *workerThread(void *arg)
+{
+    Worker *worker = (Worker *)arg;
+    struct timespec cpuStart;
+    struct timespec cpuEnd;
+    Cpa32U buffer = 0;
+
+    /* Bind first so that the buffer pool and the completion ring come from the node of the instance */
+    engineBindThreadToInstance(worker->instanceIdx);
+    if (CPA_TRUE == worker->ownRegion &&
+        CPA_STATUS_SUCCESS != memAllocContig((void *)&worker->region, WORKER_REGION_SIZE, BYTE_ALIGNMENT))
+    {
+        __atomic_store_n(&worker->state, WORKER_STATE_FAILED, __ATOMIC_RELEASE);
+        return NULL;
+    }
+    worker->port = engineOpenInstancePort(worker->instanceIdx, worker->region, worker->regionSize, NULL, worker);
+    if (NULL == worker->port)
+    {
+        if (CPA_TRUE == worker->ownRegion)
+        {
+            memFreeContig((void *)&worker->region);
+        }
+        __atomic_store_n(&worker->state, WORKER_STATE_FAILED, __ATOMIC_RELEASE);
+        return NULL;
+    }
+    for (buffer = 0; CPA_TRUE == worker->ownRegion && buffer < WORKER_NUM_BUFFERS; buffer++)
+    {
+        worker->freeBuffers[worker->numFreeBuffers++] = WORKER_NUM_BUFFERS - 1 - buffer;
+    }
+    if (WORKER_POLL_BUSY != worker->pollMode && CPA_STATUS_SUCCESS != openEvents(worker))
+    {
+        PRINT_ERR("Worker %u cannot sleep on events, spinning\n", worker->instanceIdx);
+        worker->pollMode = WORKER_POLL_BUSY;
+    }
+    __atomic_store_n(&worker->state, WORKER_STATE_RUNNING, __ATOMIC_RELEASE);
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuStart);
+    runLoop(worker);
+    drainWorker(worker);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuEnd);
+    worker->cpuNs = (Cpa64U)(cpuEnd.tv_sec - cpuStart.tv_sec) * 1000000000ULL + (Cpa64U)cpuEnd.tv_nsec -
+                    (Cpa64U)cpuStart.tv_nsec;
+    closeEvents(worker);
+
+    engineClosePort(worker->port);
+    worker->port = NULL;
+    if (CPA_TRUE == worker->ownRegion)
+    {
+        memFreeContig((void *)&worker->region);
+    }
+
+    return NULL;
+}
+
+void workerInit(Worker *worker, Cpa32U instanceIdx)
+{
+    memset(worker, 0, sizeof(Worker));
+    worker->instanceIdx = instanceIdx;
+    worker->regionSize = WORKER_REGION_SIZE;
+    worker->ownRegion = CPA_TRUE;
+    worker->state = WORKER_STATE_IDLE;
+    worker->stealing = WORKER_NO_WORKER;
+    worker->epollFd = -1;
+    worker->wakeFd = -1;
+    worker->eventFd = -1;
+    batchInit(&worker->batch, BATCH_IMMEDIATE, WORKER_BURST_SIZE, 0);
+}
+
+void workerSetLatencyTarget(Worker *worker, Cpa32U targetUs)
+{
+    batchInit(&worker->batch, (0 < targetUs) ? BATCH_ADAPTIVE : BATCH_IMMEDIATE, WORKER_BURST_SIZE, targetUs);
+}
+
+void workerSetPollMode(Worker *worker, Cpa32U pollMode)
+{
+    worker->pollMode = pollMode;
+}
+
+void workerWake(Worker *worker)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (0 != __atomic_load_n(&worker->sleeping, __ATOMIC_SEQ_CST))
+    {
+        eventfd_write(worker->wakeFd, 1);
+    }
+}
+
+void workerSetRegion(Worker *worker, Cpa8U *region, Cpa32U regionSize)
+{
+    worker->region = region;
+    worker->regionSize = regionSize;
+    worker->ownRegion = CPA_FALSE;
+}
+
+CpaStatus workerCreateSession(Worker *worker,
+                              const char *algoName,
+                              const Cpa8U *key,
+                              Cpa32U keySize,
+                              Cpa8U bearer,
+                              Cpa8U dir,
+                              Cpa32U digestSize,
+                              CpaBoolean verifyDigest,
+                              Cpa32U trafficClass,
+                              Cpa32U *sessionId)
+{
+    return engineCreateInstanceSession(worker->instanceIdx,
+                                       algoName,
+                                       key,
+                                       keySize,
+                                       bearer,
+                                       dir,
+                                       digestSize,
+                                       verifyDigest,
+                                       trafficClass,
+                                       worker,
+                                       sessionId);
+}
+
+CpaStatus workerStart(Worker *worker, WorkerRxFn rx, WorkerTxFn tx, void *arg)
+{
+    worker->rx = rx;
+    worker->tx = tx;
+    worker->arg = arg;
+    worker->stop = CPA_FALSE;
+    worker->state = WORKER_STATE_STARTING;
+    if (0 != pthread_create(&worker->thread, NULL, workerThread, worker))
+    {
+        worker->state = WORKER_STATE_IDLE;
+        return CPA_STATUS_FAIL;
+    }
+
+    while (WORKER_STATE_STARTING == __atomic_load_n(&worker->state, __ATOMIC_ACQUIRE))
+    {
+        OS_SLEEP(1);
+    }
+    if (WORKER_STATE_RUNNING != worker->state)
+    {
+        pthread_join(worker->thread, NULL);
+        worker->state = WORKER_STATE_IDLE;
+        return CPA_STATUS_RESOURCE;
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+void workerStop(Worker *worker)
+{
+    if (WORKER_STATE_RUNNING == worker->state)
+    {
+        worker->stop = CPA_TRUE;
+        workerWake(worker);
+        pthread_join(worker->thread, NULL);
+        worker->state = WORKER_STATE_IDLE;
+    }
+    engineRetireSessionsOf(worker);
+}
+
+/*
+ *******************
+ * Work stealing
+ *******************
+ */
+
+/*
+ * Ask for the largest queue of the worker with the largest backlog, provided that worker has more than one
+ * flow with work so that it is not merely moved elsewhere. One request is pending per worker at most.
+ */
+static void stealFlow(WorkerGroup *group, Worker *worker, Cpa32U self)
+{
+    Cpa32U backlog[MAX_INSTANCES] = {0};
+    Cpa32U numBusy[MAX_INSTANCES] = {0};
+    Cpa32U numQueued = 0;
+    Cpa32U maxQueued = 0;
+    Cpa32U owner = 0;
+    Cpa32U victim = WORKER_NO_WORKER;
+    Cpa32U target = WORKER_NO_WORKER;
+    Cpa32U expected = WORKER_NO_WORKER;
+    Cpa32U flowIdx = 0;
+
+    if (WORKER_NO_WORKER != worker->stealing)
+    {
+        if (self == __atomic_load_n(&group->flows[worker->stealing].owner, __ATOMIC_ACQUIRE))
+        {
+            worker->stealing = WORKER_NO_WORKER;
+            worker->numSteals++;
+        }
+        return;
+    }
+
+    for (flowIdx = 0; flowIdx < group->numFlows; flowIdx++)
+    {
+        numQueued = ringCount(group->flows[flowIdx].queue);
+        if (0 < numQueued)
+        {
+            owner = __atomic_load_n(&group->flows[flowIdx].owner, __ATOMIC_RELAXED);
+            backlog[owner] += numQueued;
+            numBusy[owner]++;
+        }
+    }
+    for (owner = 0; owner < group->numWorkers; owner++)
+    {
+        if (self != owner && 1 < numBusy[owner] && WORKER_STEAL_MIN_BACKLOG <= backlog[owner] &&
+            (WORKER_NO_WORKER == victim || backlog[owner] > backlog[victim]))
+        {
+            victim = owner;
+        }
+    }
+    if (WORKER_NO_WORKER == victim)
+    {
+        return;
+    }
+
+    for (flowIdx = 0; flowIdx < group->numFlows; flowIdx++)
+    {
+        numQueued = ringCount(group->flows[flowIdx].queue);
+        if (victim == __atomic_load_n(&group->flows[flowIdx].owner, __ATOMIC_RELAXED) && numQueued > maxQueued &&
+            WORKER_NO_WORKER == __atomic_load_n(&group->flows[flowIdx].thief, __ATOMIC_RELAXED))
+        {
+            target = flowIdx;
+            maxQueued = numQueued;
+        }
+    }
+    if (WORKER_NO_WORKER != target &&
+        __atomic_compare_exchange_n(
+            &group->flows[target].thief, &expected, self, CPA_FALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        worker->stealing = target;
+    }
+}
+
+/*
+ * Take PDUs off the flows of one priority this worker owns until descs holds maxDescs, a few per flow in turn so
+ * that a heavy flow does not starve the others, and hand over the flows other workers asked for once none of
+ * their PDUs is in flight
+ */
+static Cpa32U takeFlows(WorkerGroup *group,
+                        Worker *worker,
+                        PdcpDesc *descs,
+                        Cpa32U numDescs,
+                        Cpa32U maxDescs,
+                        CpaBoolean highPriority)
+{
+    Cpa32U self = (Cpa32U)(worker - group->workers);
+    WorkerFlow *flow = NULL;
+    Cpa32U numTaken = 0;
+    Cpa32U thief = WORKER_NO_WORKER;
+    Cpa32U flowIdx = 0;
+    Cpa32U descIdx = 0;
+    Cpa32U round = 0;
+
+    for (round = 0; round < group->numFlows && numDescs < maxDescs; round++)
+    {
+        flowIdx = (worker->nextFlow + round) % group->numFlows;
+        flow = &group->flows[flowIdx];
+        if (self != __atomic_load_n(&flow->owner, __ATOMIC_ACQUIRE) ||
+            highPriority != (ENGINE_IS_HIGH_PRIORITY(flow->trafficClass) ? CPA_TRUE : CPA_FALSE))
+        {
+            continue;
+        }
+
+        thief = __atomic_load_n(&flow->thief, __ATOMIC_RELAXED);
+        if (WORKER_NO_WORKER != thief)
+        {
+            if (0 == flow->numInflight)
+            {
+                __atomic_store_n(&flow->thief, WORKER_NO_WORKER, __ATOMIC_RELAXED);
+                __atomic_store_n(&flow->owner, thief, __ATOMIC_RELEASE);
+                worker->numHandoffs++;
+            }
+            continue;
+        }
+
+        numTaken = (WORKER_FLOW_BATCH < maxDescs - numDescs) ? WORKER_FLOW_BATCH : maxDescs - numDescs;
+        numTaken = ringDequeueBurst(flow->queue, descs + numDescs, numTaken);
+        for (descIdx = numDescs; descIdx < numDescs + numTaken; descIdx++)
+        {
+            descs[descIdx].sessionId = flow->sessionIds[self];
+        }
+        flow->numInflight += numTaken;
+        numDescs += numTaken;
+    }
+
+    return numDescs;
+}
+
+/*
+ * High priority flows first, bulk flows keep their share of the burst, and what is left over goes to either
+ */
+static Cpa32U groupRx(Worker *worker, PdcpDesc *descs, Cpa32U maxDescs, void *arg)
+{
+    WorkerGroup *group = (WorkerGroup *)arg;
+    Cpa32U highShare = maxDescs * ENGINE_HIGH_PRIORITY_WEIGHT / (ENGINE_HIGH_PRIORITY_WEIGHT + 1);
+    Cpa32U numDescs = 0;
+
+    numDescs = takeFlows(group, worker, descs, numDescs, highShare, CPA_TRUE);
+    numDescs = takeFlows(group, worker, descs, numDescs, maxDescs, CPA_FALSE);
+    numDescs = takeFlows(group, worker, descs, numDescs, maxDescs, CPA_TRUE);
+    worker->nextFlow = (worker->nextFlow + 1) % group->numFlows;
+
+    if (0 == numDescs && CPA_TRUE == group->stealing)
+    {
+        stealFlow(group, worker, (Cpa32U)(worker - group->workers));
+    }
+    return numDescs;
+}
+
+static void groupTx(Worker *worker, const PdcpDesc *descs, Cpa32U numDescs, void *arg)
+{
+    WorkerGroup *group = (WorkerGroup *)arg;
+    PdcpDesc cpls[WORKER_BURST_SIZE];
+    Cpa32U flowIdx = 0;
+    Cpa32U descIdx = 0;
+
+    for (descIdx = 0; descIdx < numDescs; descIdx++)
+    {
+        flowIdx = group->flowOfSession[descs[descIdx].sessionId];
+        group->flows[flowIdx].numInflight--;
+        cpls[descIdx] = descs[descIdx];
+        cpls[descIdx].sessionId = flowIdx;
+    }
+    group->tx(worker, cpls, numDescs, group->arg);
+}
+
+CpaStatus workerGroupInit(WorkerGroup *group,
+                          Cpa32U numWorkers,
+                          Cpa8U *region,
+                          Cpa32U regionSize,
+                          CpaBoolean stealing)
+{
+    Cpa32U workerIdx = 0;
+
+    memset(group, 0, sizeof(WorkerGroup));
+    if (0 == numWorkers || engineNumInstances() < numWorkers)
+    {
+        numWorkers = engineNumInstances();
+    }
+    for (workerIdx = 0; workerIdx < numWorkers; workerIdx++)
+    {
+        workerInit(&group->workers[workerIdx], workerIdx);
+        workerSetRegion(&group->workers[workerIdx], region, regionSize);
+    }
+    group->numWorkers = numWorkers;
+    group->stealing = stealing;
+
+    return (0 < numWorkers) ? CPA_STATUS_SUCCESS : CPA_STATUS_FAIL;
+}
+
+CpaStatus workerGroupAddFlow(WorkerGroup *group,
+                             const char *algoName,
+                             const Cpa8U *key,
+                             Cpa32U keySize,
+                             Cpa8U bearer,
+                             Cpa8U dir,
+                             Cpa32U digestSize,
+                             CpaBoolean verifyDigest,
+                             Cpa32U trafficClass,
+                             Cpa32U *flowIdx)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    WorkerFlow *flow = NULL;
+    Cpa32U workerIdx = 0;
+
+    if (WORKER_MAX_FLOWS == group->numFlows)
+    {
+        return CPA_STATUS_RESOURCE;
+    }
+    flow = &group->flows[group->numFlows];
+    stat = memAllocContig((void *)&flow->queue, RING_MEM_SIZE(WORKER_FLOW_DEPTH), RING_CACHE_LINE);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+    ringInit(flow->queue, WORKER_FLOW_DEPTH);
+
+    for (workerIdx = 0; CPA_STATUS_SUCCESS == stat && workerIdx < group->numWorkers; workerIdx++)
+    {
+        stat = workerCreateSession(&group->workers[workerIdx],
+                                   algoName,
+                                   key,
+                                   keySize,
+                                   bearer,
+                                   dir,
+                                   digestSize,
+                                   verifyDigest,
+                                   trafficClass,
+                                   &flow->sessionIds[workerIdx]);
+        if (CPA_STATUS_SUCCESS == stat)
+        {
+            group->flowOfSession[flow->sessionIds[workerIdx]] = (Cpa16U)group->numFlows;
+        }
+    }
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        while (0 < workerIdx--)
+        {
+            engineRetireSession(flow->sessionIds[workerIdx], &group->workers[workerIdx]);
+        }
+        memFreeContig((void *)&flow->queue);
+        return stat;
+    }
+
+    flow->trafficClass = trafficClass;
+    flow->owner = group->numFlows % group->numWorkers;
+    flow->thief = WORKER_NO_WORKER;
+    flow->numInflight = 0;
+    *flowIdx = group->numFlows++;
+
+    return CPA_STATUS_SUCCESS;
+}
+
+Cpa32U workerGroupEnqueue(WorkerGroup *group, Cpa32U flowIdx, const PdcpDesc *descs, Cpa32U numDescs)
+{
+    Cpa32U numEnqueued = ringEnqueueBurst(group->flows[flowIdx].queue, descs, numDescs);
+
+    workerWake(&group->workers[__atomic_load_n(&group->flows[flowIdx].owner, __ATOMIC_ACQUIRE)]);
+    return numEnqueued;
+}
+
+CpaStatus workerGroupStart(WorkerGroup *group, WorkerTxFn tx, void *arg)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    Cpa32U workerIdx = 0;
+
+    group->tx = tx;
+    group->arg = arg;
+    for (workerIdx = 0; CPA_STATUS_SUCCESS == stat && workerIdx < group->numWorkers; workerIdx++)
+    {
+        stat = workerStart(&group->workers[workerIdx], groupRx, groupTx, group);
+        CHECK_ERR_STATUS("workerStart", stat);
+    }
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        workerGroupStop(group);
+    }
+    return stat;
+}
+
+void workerGroupStop(WorkerGroup *group)
+{
+    Cpa32U workerIdx = 0;
+
+    for (workerIdx = 0; workerIdx < group->numWorkers; workerIdx++)
+    {
+        workerStop(&group->workers[workerIdx]);
+    }
+}
+
+void workerGroupFree(WorkerGroup *group)
+{
+    Cpa32U flowIdx = 0;
+
+    workerGroupStop(group);
+    for (flowIdx = 0; flowIdx < group->numFlows; flowIdx++)
+    {
+        memFreeContig((void *)&group->flows[flowIdx].queue);
+    }
+    group->numFlows = 0;
+}
@@ -0,0 +1,200 @@
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <pthread.h>
+
+#include "cpa.h"
+
+#include "batch.h"
+#include "engine.h"
+#include "ring.h"
+
+#define WORKER_NUM_BUFFERS ENGINE_OPS_PER_INSTANCE
+#define WORKER_BUFFER_SIZE (16 * 1024)
+#define WORKER_REGION_SIZE (WORKER_NUM_BUFFERS * WORKER_BUFFER_SIZE)
+#define WORKER_BURST_SIZE 32
+
+#define WORKER_MAX_FLOWS 256
+#define WORKER_FLOW_DEPTH 64
+/* PDUs a worker takes off one flow before turning to the next */
+#define WORKER_FLOW_BATCH 8
+#define WORKER_NO_WORKER 0xffffffff
+/* Backlog a worker must have before its flows are stolen */
+#define WORKER_STEAL_MIN_BACKLOG WORKER_BURST_SIZE
+#define WORKER_SPIN_US 50 /* without work before an adaptive worker goes to sleep */
+
+
+typedef struct _Worker Worker;
+
+/* How a worker waits for completions and new PDUs */
+enum
+{
+    WORKER_POLL_BUSY = 0, /* spin on the instance, the default */
+    WORKER_POLL_EVENT, /* sleep on the event fd of the instance after every round without work */
+    WORKER_POLL_ADAPTIVE, /* spin under load, sleep once without work for WORKER_SPIN_US */
+};
+
+/*
+ * Called in the loop of the worker: rx fills up to maxDescs descriptors of new PDUs, whose payloads were put
+ * in buffers from workerAllocBuffer(), tx gets the completed ones. The buffers of completed PDUs go back to
+ * the worker after tx returns.
+ */
+typedef Cpa32U (*WorkerRxFn)(Worker *worker, PdcpDesc *descs, Cpa32U maxDescs, void *arg);
+typedef void (*WorkerTxFn)(Worker *worker, const PdcpDesc *descs, Cpa32U numDescs, void *arg);
+
+enum
+{
+    WORKER_STATE_IDLE = 0,
+    WORKER_STATE_STARTING,
+    WORKER_STATE_RUNNING,
+    WORKER_STATE_FAILED,
+};
+
+/*
+ * Run-to-completion worker owning one instance, with its own buffer pool, completion ring and sessions.
+ * Everything in here is touched by the worker thread only, apart from state and stop.
+ */
+struct _Worker {
+    Cpa32U instanceIdx;
+    EnginePort *port;
+    Cpa8U *region;
+    Cpa32U regionSize;
+    CpaBoolean ownRegion; /* buffers come from the worker's pool, not from the caller */
+    Cpa32U freeBuffers[WORKER_NUM_BUFFERS];
+    Cpa32U numFreeBuffers;
+    PdcpDesc pending[WORKER_BURST_SIZE];
+    Cpa32U numPending;
+    Cpa64U pendingSinceNs; /* when the oldest pending descriptor came in */
+    BatchCtl batch;
+    WorkerRxFn rx;
+    WorkerTxFn tx;
+    void *arg;
+    pthread_t thread;
+    volatile Cpa32U state;
+    volatile CpaBoolean stop;
+    Cpa64U numRx;
+    Cpa64U numTx;
+    Cpa64U numLoops;
+    Cpa64U numIdleLoops;
+    Cpa64U numBatches;
+    Cpa64U numPolls;
+    Cpa32U nextFlow;
+    Cpa32U stealing; /* flow this worker asked for, WORKER_NO_WORKER for none */
+    Cpa64U numSteals;
+    Cpa64U numHandoffs;
+    /* Event mode */
+    Cpa32U pollMode;
+    int epollFd;
+    int wakeFd; /* eventfd workerWake() signals */
+    int eventFd; /* event fd of the instance registered with epollFd, -1 for none */
+    volatile Cpa32U sleeping; /* set by the worker before it sleeps, producers wake it then */
+    Cpa64U idleSinceNs; /* start of the rounds without work, 0 while there is work */
+    Cpa64U numSleeps;
+    Cpa64U numWakeups; /* sleeps ended by an event rather than the timeout */
+    Cpa64U cpuNs; /* CPU time of the worker thread, once it stopped */
+} __attribute__((aligned(RING_CACHE_LINE)));
+
+/*
+ * Sessions of a worker are created before it starts and retired once it stopped
+ */
+void workerInit(Worker *worker, Cpa32U instanceIdx);
+/* Work on PDUs in a region of the caller instead of the worker's pool, before the worker starts */
+void workerSetRegion(Worker *worker, Cpa8U *region, Cpa32U regionSize);
+/*
+ * Before the worker starts: size batches and space polls from the load so that they add at most targetUs to
+ * the latency of a PDU, 0 to submit every PDU at once and poll on every round (the default)
+ */
+void workerSetLatencyTarget(Worker *worker, Cpa32U targetUs);
+/*
+ * Before the worker starts: WORKER_POLL_EVENT or WORKER_POLL_ADAPTIVE let the worker sleep in epoll_wait() on the
+ * event fd of its instance and on its wake fd once it runs out of work, for at most ENGINE_EVENT_TIMEOUT_MS so
+ * that PDUs of an rx that does not wake the worker still come in. An instance without event fd is polled while
+ * requests are in flight.
+ */
+void workerSetPollMode(Worker *worker, Cpa32U pollMode);
+/* For a producer that just handed PDUs to the rx of the worker, outside of the worker thread */
+void workerWake(Worker *worker);
+CpaStatus workerCreateSession(Worker *worker,
+                              const char *algoName,
+                              const Cpa8U *key,
+                              Cpa32U keySize,
+                              Cpa8U bearer,
+                              Cpa8U dir,
+                              Cpa32U digestSize,
+                              CpaBoolean verifyDigest,
+                              Cpa32U trafficClass,
+                              Cpa32U *sessionId);
+CpaStatus workerStart(Worker *worker, WorkerRxFn rx, WorkerTxFn tx, void *arg);
+void workerStop(Worker *worker);
+
+/*
+ * For rx only, NULL when every buffer is in flight or the worker has no pool. offset is what goes in the
+ * descriptor.
+ */
+Cpa8U *workerAllocBuffer(Worker *worker, Cpa32U *offset);
+
+/*
+ *******************
+ * Work stealing
+ *******************
+ */
+
+/*
+ * Flow of PDUs of one bearer. PDUs are queued on the flow and processed by the worker owning it, which starts
+ * out as the flow's home worker. A worker without work asks for a flow of a worker with a backlog; the owner
+ * stops taking PDUs off the flow and, once those in flight completed, hands the flow over. A flow is thus
+ * never processed by two workers at once and its PDUs complete in order.
+ */
+typedef struct _WorkerFlow {
+    DescRing *queue; /* single producer, consumed by the owner */
+    Cpa32U sessionIds[MAX_INSTANCES]; /* session of the bearer on the instance of every worker */
+    Cpa32U trafficClass;
+    Cpa32U owner;
+    Cpa32U thief; /* worker asking for the flow, WORKER_NO_WORKER for none */
+    Cpa32U numInflight; /* taken off the queue and not completed, only touched by the owner */
+} __attribute__((aligned(RING_CACHE_LINE))) WorkerFlow;
+
+typedef struct _WorkerGroup {
+    Worker workers[MAX_INSTANCES];
+    Cpa32U numWorkers;
+    WorkerFlow flows[WORKER_MAX_FLOWS];
+    Cpa32U numFlows;
+    Cpa16U flowOfSession[ENGINE_MAX_SESSIONS];
+    CpaBoolean stealing;
+    WorkerTxFn tx;
+    void *arg;
+} WorkerGroup;
+
+/*
+ * One worker per instance, up to numWorkers, all working on PDUs in region. Without stealing every flow stays
+ * on its home worker.
+ */
+CpaStatus workerGroupInit(WorkerGroup *group,
+                          Cpa32U numWorkers,
+                          Cpa8U *region,
+                          Cpa32U regionSize,
+                          CpaBoolean stealing);
+/*
+ * Flows are spread over the workers round-robin and added before the group starts. A worker takes PDUs off
+ * high priority flows first, bulk flows keep 1 / (ENGINE_HIGH_PRIORITY_WEIGHT + 1) of each burst.
+ */
+CpaStatus workerGroupAddFlow(WorkerGroup *group,
+                             const char *algoName,
+                             const Cpa8U *key,
+                             Cpa32U keySize,
+                             Cpa8U bearer,
+                             Cpa8U dir,
+                             Cpa32U digestSize,
+                             CpaBoolean verifyDigest,
+                             Cpa32U trafficClass,
+                             Cpa32U *flowIdx);
+/*
+ * Queue PDUs on a flow, from one producer per flow; the session of a descriptor is set by the worker. tx gets
+ * completed descriptors with the flow index in sessionId.
+ */
+Cpa32U workerGroupEnqueue(WorkerGroup *group, Cpa32U flowIdx, const PdcpDesc *descs, Cpa32U numDescs);
+CpaStatus workerGroupStart(WorkerGroup *group, WorkerTxFn tx, void *arg);
+void workerGroupStop(WorkerGroup *group);
+void workerGroupFree(WorkerGroup *group);
+
+#endif
@@ -1,13 +1,30 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include "cpa.h"
+#include "cpa_cy_common.h"
 #include "qae_mem.h"
 
+#include "arena.h"
 #include "utils.h"
 
+/*
+ * Contiguous memory comes from the node of the calling thread, which callers bind next to their instance
+ * with bindThreadToInstance()
+ */
 CpaStatus memAllocContig(void **memAddr, Cpa32U sizeBytes, Cpa32U alignment)
 {
-    *memAddr = qaeMemAllocNUMA(sizeBytes, 0, alignment);
+    return memAllocContigNode(memAddr, sizeBytes, alignment, getCurrentNode());
+}
+
+CpaStatus memAllocContigNode(void **memAddr, Cpa32U sizeBytes, Cpa32U alignment, Cpa32U node)
+{
+    *memAddr = qaeMemAllocNUMA(sizeBytes, node, alignment);
     if (NULL == *memAddr)
     {
         return CPA_STATUS_RESOURCE;
@@ -15,9 +32,12 @@ CpaStatus memAllocContig(void **memAddr, Cpa32U sizeBytes, Cpa32U alignment)
     return CPA_STATUS_SUCCESS;
 }
 
+/*
+ * Host memory the device never reads comes from the hugepage arena, see arena.c
+ */
 CpaStatus memAllocOs(void **memAddr, Cpa32U sizeBytes)
 {
-    *memAddr = malloc(sizeBytes);
+    *memAddr = arenaAlloc(sizeBytes);
     if (NULL == *memAddr)
     {
         return CPA_STATUS_RESOURCE;
@@ -38,7 +58,141 @@ void memFreeOs(void **memAddr)
 {
     if (NULL != *memAddr)
     {
-        free(*memAddr);
+        arenaFree(*memAddr);
         *memAddr = NULL;
     }
 }
+
+/*
+ *****************
+ * NUMA functions
+ *****************
+ */
+Cpa32U getCurrentNode(void)
+{
+    unsigned int cpu = 0;
+    unsigned int node = 0;
+
+    if (0 != syscall(SYS_getcpu, &cpu, &node, NULL) || MAX_NODES <= node)
+    {
+        return 0;
+    }
+    return node;
+}
+
+Cpa32U getInstanceNode(CpaInstanceHandle cyInstHandle)
+{
+    CpaInstanceInfo2 info = {0};
+
+    if (CPA_STATUS_SUCCESS != cpaCyInstanceGetInfo2(cyInstHandle, &info) || MAX_NODES <= info.nodeAffinity)
+    {
+        return 0;
+    }
+    return info.nodeAffinity;
+}
+
+/*
+ * First instance on the node of the calling thread, or the first instance when the node has none
+ */
+CpaInstanceHandle getLocalInstance(const CpaInstanceHandle *cyInstHandles, Cpa16U numInstances)
+{
+    Cpa32U node = getCurrentNode();
+    Cpa16U instIdx = 0;
+
+    for (instIdx = 0; instIdx < numInstances; instIdx++)
+    {
+        if (node == getInstanceNode(cyInstHandles[instIdx]))
+        {
+            return cyInstHandles[instIdx];
+        }
+    }
+    return (0 < numInstances) ? cyInstHandles[0] : NULL;
+}
+
+/*
+ * Restrict the calling thread to the cores of an instance, the thread is left alone when the driver reports
+ * no core affinity
+ */
+CpaStatus bindThreadToInstance(CpaInstanceHandle cyInstHandle)
+{
+    CpaStatus stat = CPA_STATUS_SUCCESS;
+    CpaInstanceInfo2 info = {0};
+    cpu_set_t cpus;
+    Cpa32U cpu = 0;
+
+    stat = cpaCyInstanceGetInfo2(cyInstHandle, &info);
+    CHECK_ERR_STATUS("cpaCyInstanceGetInfo2", stat);
+    if (CPA_STATUS_SUCCESS != stat)
+    {
+        return stat;
+    }
+
+    CPU_ZERO(&cpus);
+    for (cpu = 0; cpu < CPA_MAX_CORES && cpu < CPU_SETSIZE; cpu++)
+    {
+        if (CPA_BITMAP_BIT_TEST(info.coreAffinity, cpu))
+        {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    if (0 == CPU_COUNT(&cpus))
+    {
+        return CPA_STATUS_SUCCESS;
+    }
+    if (0 != pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus))
+    {
+        PRINT_ERR("Failed to bind thread to the cores of node %u\n", info.nodeAffinity);
+        return CPA_STATUS_FAIL;
+    }
+    return CPA_STATUS_SUCCESS;
+}
+
+/*
+ ************
+ * Logging
+ ************
+ */
+int logLevel_g = LOG_LEVEL_DBG;
+
+void logInit(void)
+{
+    const char *level = getenv("PDCP_LOG_LEVEL");
+
+    if (NULL != level)
+    {
+        if (0 == strcmp(level, "err") || 0 == strcmp(level, "0"))
+        {
+            logLevel_g = LOG_LEVEL_ERR;
+        }
+        else if (0 == strcmp(level, "debug") || 0 == strcmp(level, "1"))
+        {
+            logLevel_g = LOG_LEVEL_DBG;
+        }
+        else if (0 == strcmp(level, "dump") || 0 == strcmp(level, "2"))
+        {
+            logLevel_g = LOG_LEVEL_DUMP;
+        }
+        else
+        {
+            PRINT_ERR("Unknown log level %s, err, debug or dump\n", level);
+        }
+    }
+    if (LOG_MAX_LEVEL < logLevel_g)
+    {
+        logLevel_g = LOG_MAX_LEVEL;
+    }
+    /* Debug output of the QAT sample code follows the same level */
+    gDebugParam = LOG_ENABLED(LOG_LEVEL_DBG) ? 1 : 0;
+}
+
+void printHex(const char *label, const Cpa8U *data, Cpa32U length)
+{
+    Cpa32U byteIdx = 0;
+
+    PRINT("%s", label);
+    for (byteIdx = 0; byteIdx < length; byteIdx++)
+    {
+        PRINT("%02x ", data[byteIdx]);
+    }
+    PRINT("\n");
+}